@@ -161,13 +161,37 @@ if (WOLF_SYSTEM_LZ4)
   vcpkg_install(lz4 lz4 TRUE)
   list(APPEND LIBS lz4::lz4)
 
+  # the dictionary functions of lz4frame are not exported by the shared lz4 before 1.10
+  if (WOLF_SYSTEM_LZ4_STATIC)
+    get_target_property(_lz4_type lz4::lz4 TYPE)
+    if (NOT _lz4_type STREQUAL "STATIC_LIBRARY")
+      message(FATAL_ERROR "WOLF_SYSTEM_LZ4_STATIC needs a static lz4, but lz4::lz4 is ${_lz4_type}")
+    endif()
+  endif()
+
   file(GLOB_RECURSE WOLF_SYSTEM_LZ4_SRCS
+    "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_compressor.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_lz4.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_lz4.hpp"
   )
   list(APPEND SRCS ${WOLF_SYSTEM_LZ4_SRCS})
 endif()
 
+if (WOLF_SYSTEM_ZSTD)
+  if (EMSCRIPTEN)
+        message(FATAL_ERROR "the wasm32 target is not supported for WOLF_SYSTEM_ZSTD")
+  endif()
+  vcpkg_install(zstd zstd TRUE)
+  list(APPEND LIBS $<IF:$<TARGET_EXISTS:zstd::libzstd_shared>,zstd::libzstd_shared,zstd::libzstd_static>)
+
+  file(GLOB_RECURSE WOLF_SYSTEM_ZSTD_SRCS
+    "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_compressor.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_zstd.cpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_zstd.hpp"
+  )
+  list(APPEND SRCS ${WOLF_SYSTEM_ZSTD_SRCS})
+endif()
+
 if (WOLF_SYSTEM_LZMA)
   if (EMSCRIPTEN)
         message(FATAL_ERROR "the wasm32 target is not supported for WOLF_SYSTEM_LZMA")
@@ -199,6 +223,8 @@ endif()
 # include socket/websocket sources
 if (WOLF_SYSTEM_SOCKET AND NOT EMSCRIPTEN)    
     file(GLOB_RECURSE WOLF_SYSTEM_SOCKET_SRC
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/socket/w_frame_codec.cpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/socket/w_frame_codec.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/socket/w_socket_options.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/socket/w_tcp_client.cpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/socket/w_tcp_client.hpp"
@@ -228,12 +254,21 @@ endif()
 if (WOLF_SYSTEM_ZLIB)
     vcpkg_install(ZLIB zlib FALSE)
     list(APPEND LIBS ZLIB::ZLIB)
+
+    file(GLOB_RECURSE WOLF_SYSTEM_ZLIB_SRCS
+      "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_compressor.hpp"
+      "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_zlib.cpp"
+      "${CMAKE_CURRENT_SOURCE_DIR}/system/compression/w_zlib.hpp"
+    )
+    list(APPEND SRCS ${WOLF_SYSTEM_ZLIB_SRCS})
 endif()
 
 if (WOLF_SYSTEM_POSTGRESQL)
     vcpkg_install(PostgreSQL libpq FALSE)
 
     file(GLOB_RECURSE WOLF_SYSTEM_POSTGRESQL_SRC
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/db/w_pgdb_async.hpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/db/w_pgdb_pool.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/db/w_postgresql.cpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/db/w_postgresql.hpp"
     )
@@ -318,6 +353,9 @@ if (EMSCRIPTEN)
     file (GLOB_RECURSE WOLF_SYSTEM_SRC
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_gametime.cpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_gametime.hpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_pooled_buffer.cpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_pooled_buffer.hpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_spsc_queue.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_trace.hpp"
     )
 else()
@@ -327,6 +365,10 @@ else()
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_gametime.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_leak_detector.cpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_leak_detector.hpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_pooled_buffer.cpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_pooled_buffer.hpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_spsc_queue.hpp"
+        "${CMAKE_CURRENT_SOURCE_DIR}/system/w_thread_pool.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_process.cpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_process.hpp"
         "${CMAKE_CURRENT_SOURCE_DIR}/system/w_time.cpp"
@@ -338,6 +380,8 @@ endif()
 file(GLOB_RECURSE WOLF_SYSTEM_TEST_SRC
     "${CMAKE_CURRENT_SOURCE_DIR}/system/test/*"
 )
+# it replaces the global operator new, so only the test and bench executables link it
+list(FILTER WOLF_SYSTEM_TEST_SRC EXCLUDE REGEX "alloc_counter\\.cpp$")
 
 list(APPEND SRCS 
     ${WOLF_SYSTEM_SRC} 
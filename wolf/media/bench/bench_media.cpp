@@ -0,0 +1,304 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+/*
+ * wolf_bench_media measures the encode, decode and convert stages of the
+ * ffmpeg module on a synthetic clip of a lavfi source, so it needs no
+ * external files. it reports fps, heap allocations per frame and latency
+ * percentiles of every stage as json for the regression tracking.
+ *
+ * usage: wolf_bench_media [--frames N] [--width W] [--height H] [--output path]
+ */
+
+#include <wolf/wolf.hpp>
+
+#include <media/ffmpeg/w_av_converter.hpp>
+#include <media/ffmpeg/w_av_frame_pool.hpp>
+#include <media/ffmpeg/w_ffmpeg.hpp>
+#include <system/test/alloc_counter.hpp>
+
+extern "C" {
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#include <libavutil/imgutils.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_packet = wolf::media::ffmpeg::w_av_packet;
+using w_av_codec_opt = wolf::media::ffmpeg::w_av_codec_opt;
+using w_av_set_opt = wolf::media::ffmpeg::w_av_set_opt;
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_frame_pool = wolf::media::ffmpeg::w_av_frame_pool;
+using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
+using steady_clock = std::chrono::steady_clock;
+
+struct w_bench_config {
+  int width = 1280;
+  int height = 720;
+  int fps = 30;
+  int frames = 300;
+  std::string output;
+};
+
+struct w_stage_result {
+  std::string name;
+  int frames = 0;
+  double seconds = 0;
+  uint64_t allocations = 0;
+  // the latency of every frame in microseconds
+  std::vector<double> latencies_us;
+};
+
+// measure one call of a stage and keep its latency
+template <typename F>
+static boost::leaf::result<void> s_measure(_Inout_ w_stage_result &p_result, _In_ F &&p_func) {
+  const auto _start = steady_clock::now();
+  BOOST_LEAF_CHECK(p_func());
+  const auto _elapsed = steady_clock::now() - _start;
+  p_result.seconds += std::chrono::duration<double>(_elapsed).count();
+  p_result.latencies_us.push_back(std::chrono::duration<double, std::micro>(_elapsed).count());
+  return {};
+}
+
+static double s_percentile(_In_ const std::vector<double> &p_sorted, _In_ double p_percentile) {
+  if (p_sorted.empty()) {
+    return 0;
+  }
+  const auto _index =
+      gsl::narrow_cast<size_t>(p_percentile * gsl::narrow_cast<double>(p_sorted.size()));
+  return p_sorted[std::min(_index, p_sorted.size() - 1)];
+}
+
+static std::string s_to_json(_In_ const w_bench_config &p_config,
+                             _In_ std::vector<w_stage_result> &p_stages) {
+  auto _json = wolf::format(
+      "{{\n  \"benchmark\": \"wolf_bench_media\",\n"
+      "  \"clip\": {{\"source\": \"testsrc2\", \"width\": {}, \"height\": {}, \"fps\": {}, "
+      "\"frames\": {}}},\n  \"stages\": [",
+      p_config.width, p_config.height, p_config.fps, p_config.frames);
+
+  for (size_t i = 0; i < p_stages.size(); ++i) {
+    auto &_stage = p_stages[i];
+    std::sort(_stage.latencies_us.begin(), _stage.latencies_us.end());
+    const auto _frames = std::max(_stage.frames, 1);
+    _json += wolf::format(
+        "{}\n    {{\"name\": \"{}\", \"frames\": {}, \"fps\": {:.2f}, "
+        "\"allocations_per_frame\": {:.2f}, \"latency_us\": {{\"p50\": {:.1f}, "
+        "\"p90\": {:.1f}, \"p99\": {:.1f}, \"max\": {:.1f}}}}}",
+        i == 0 ? "" : ",", _stage.name, _stage.frames,
+        _stage.seconds > 0 ? _stage.frames / _stage.seconds : 0.0,
+        gsl::narrow_cast<double>(_stage.allocations) / _frames,
+        s_percentile(_stage.latencies_us, 0.5), s_percentile(_stage.latencies_us, 0.9),
+        s_percentile(_stage.latencies_us, 0.99),
+        _stage.latencies_us.empty() ? 0.0 : _stage.latencies_us.back());
+  }
+  _json += "\n  ]\n}\n";
+  return _json;
+}
+
+// render the frames of a lavfi source through a filter graph
+static boost::leaf::result<std::vector<w_av_frame>> s_generate_clip(
+    _In_ const w_bench_config &p_config) {
+  auto *_graph = avfilter_graph_alloc();
+  auto *_av_frame = av_frame_alloc();
+  DEFER {
+    av_frame_free(&_av_frame);
+    avfilter_graph_free(&_graph);
+  });
+  if (_graph == nullptr || _av_frame == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the filter graph");
+  }
+
+  AVFilterContext *_src = nullptr;
+  AVFilterContext *_format = nullptr;
+  AVFilterContext *_sink = nullptr;
+  const auto _src_args =
+      wolf::format("size={}x{}:rate={}", p_config.width, p_config.height, p_config.fps);
+  if (avfilter_graph_create_filter(&_src, avfilter_get_by_name("testsrc2"), "src",
+                                   _src_args.c_str(), nullptr, _graph) < 0 ||
+      avfilter_graph_create_filter(&_format, avfilter_get_by_name("format"), "format",
+                                   "pix_fmts=yuv420p", nullptr, _graph) < 0 ||
+      avfilter_graph_create_filter(&_sink, avfilter_get_by_name("buffersink"), "sink", nullptr,
+                                   nullptr, _graph) < 0 ||
+      avfilter_link(_src, 0, _format, 0) < 0 || avfilter_link(_format, 0, _sink, 0) < 0 ||
+      avfilter_graph_config(_graph, nullptr) < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not create the lavfi testsrc2 graph");
+  }
+
+  std::vector<w_av_frame> _frames;
+  _frames.reserve(gsl::narrow_cast<size_t>(p_config.frames));
+  while (gsl::narrow_cast<int>(_frames.size()) < p_config.frames) {
+    const auto _ret = av_buffersink_get_frame(_sink, _av_frame);
+    if (_ret < 0) {
+      return W_FAILURE(std::errc::operation_canceled, "lavfi stopped because: {}",
+                       wolf::media::ffmpeg::w_ffmpeg_ctx::get_av_error_str(_ret));
+    }
+
+    auto _config =
+        w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, p_config.width, p_config.height);
+    auto _data =
+        std::vector<uint8_t>(gsl::narrow_cast<size_t>(_config.get_required_video_buffer_size()));
+    av_image_copy_to_buffer(_data.data(), gsl::narrow_cast<int>(_data.size()), _av_frame->data,
+                            _av_frame->linesize, AVPixelFormat::AV_PIX_FMT_YUV420P,
+                            p_config.width, p_config.height, 1);
+    av_frame_unref(_av_frame);
+
+    auto _frame = w_av_frame(std::move(_config));
+    BOOST_LEAF_CHECK(_frame.init());
+    BOOST_LEAF_CHECK(_frame.set_video_frame(std::move(_data)));
+    _frame.set_pts(gsl::narrow_cast<int64_t>(_frames.size()));
+    _frames.push_back(std::move(_frame));
+  }
+  return _frames;
+}
+
+static boost::leaf::result<std::vector<w_stage_result>> s_run(_In_ const w_bench_config &p_config) {
+  BOOST_LEAF_AUTO(_clip, s_generate_clip(p_config));
+  std::vector<w_stage_result> _stages;
+
+  const auto _config =
+      w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, p_config.width, p_config.height);
+
+  // encode
+  std::vector<w_av_packet> _packets;
+  _packets.reserve(_clip.size() + 1);
+  {
+    const auto _codec_opt = w_av_codec_opt{
+        4'000'000,    /*bitrate*/
+        p_config.fps, /*fps*/
+        p_config.fps, /*gop*/
+        -1,           /*level*/
+        0,            /*max_b_frames*/
+        1,            /*refs*/
+        -1,           /*thread_count*/
+    };
+    const auto _opts = std::vector<w_av_set_opt>{w_av_set_opt{"preset", "ultrafast"},
+                                                 w_av_set_opt{"tune", "zerolatency"}};
+    BOOST_LEAF_AUTO(_encoder, w_ffmpeg::create_encoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                       _codec_opt, _opts));
+
+    auto _stage = w_stage_result{"encode h264"};
+    const auto _sink = [&](w_av_packet &p_packet) {
+      _packets.push_back(std::move(p_packet));
+      return true;
+    };
+    const auto _allocations = get_test_alloc_count();
+    for (size_t i = 0; i < _clip.size(); ++i) {
+      BOOST_LEAF_CHECK(s_measure(_stage, [&]() -> boost::leaf::result<int> {
+        return _encoder.encode(_clip[i], _sink, i == _clip.size() - 1);
+      }));
+    }
+    _stage.allocations = get_test_alloc_count() - _allocations;
+    _stage.frames = gsl::narrow_cast<int>(_clip.size());
+    _stages.push_back(std::move(_stage));
+  }
+
+  // decode
+  {
+    const auto _codec_opt = w_av_codec_opt{0, p_config.fps, -1, -1, -1, -1, 0};
+    BOOST_LEAF_AUTO(_decoder,
+                    w_ffmpeg::create_decoder(_config, AVCodecID::AV_CODEC_ID_H264, _codec_opt));
+
+    auto _stage = w_stage_result{"decode h264"};
+    const auto _sink = [&](const w_av_frame &) {
+      _stage.frames++;
+      return true;
+    };
+    const auto _allocations = get_test_alloc_count();
+    for (size_t i = 0; i < _packets.size(); ++i) {
+      BOOST_LEAF_CHECK(s_measure(_stage, [&]() -> boost::leaf::result<int> {
+        return _decoder.decode(_packets[i], _sink, i == _packets.size() - 1);
+      }));
+    }
+    _stage.allocations = get_test_alloc_count() - _allocations;
+    if (_stage.frames != gsl::narrow_cast<int>(_clip.size())) {
+      return W_FAILURE(std::errc::operation_canceled, "decoded {} frames of {}", _stage.frames,
+                       _clip.size());
+    }
+    _stages.push_back(std::move(_stage));
+  }
+
+  // convert into pooled frames, the hot path of kernels and a scaling one of swscale
+  for (const auto &[_name, _format, _width, _height] :
+       {std::tuple{"convert yuv420p to rgba", AVPixelFormat::AV_PIX_FMT_RGBA, p_config.width,
+                   p_config.height},
+        std::tuple{"convert yuv420p to bgr24, half size", AVPixelFormat::AV_PIX_FMT_BGR24,
+                   p_config.width / 2, p_config.height / 2}}) {
+    auto _pool = w_av_frame_pool();
+    auto _converter = w_av_converter();
+    auto _stage = w_stage_result{_name};
+
+    const auto _allocations = get_test_alloc_count();
+    for (const auto &_frame : _clip) {
+      BOOST_LEAF_CHECK(s_measure(_stage, [&]() -> boost::leaf::result<int> {
+        // the converted frame goes back to the pool here
+        BOOST_LEAF_CHECK(
+            _converter.convert_video(_frame, w_av_config(_format, _width, _height), &_pool));
+        return 0;
+      }));
+    }
+    _stage.allocations = get_test_alloc_count() - _allocations;
+    _stage.frames = gsl::narrow_cast<int>(_clip.size());
+    _stages.push_back(std::move(_stage));
+  }
+
+  return _stages;
+}
+
+int main(int p_argc, char **p_argv) {
+  auto _config = w_bench_config{};
+  for (int i = 1; i + 1 < p_argc; i += 2) {
+    const auto _name = std::string_view(p_argv[i]);
+    const auto *_value = p_argv[i + 1];
+    if (_name == "--frames") {
+      _config.frames = std::max(std::atoi(_value), 1);
+    } else if (_name == "--width") {
+      _config.width = std::max(std::atoi(_value) & ~1, 2);
+    } else if (_name == "--height") {
+      _config.height = std::max(std::atoi(_value) & ~1, 2);
+    } else if (_name == "--output") {
+      _config.output = _value;
+    } else {
+      std::cerr << "unknown argument " << _name << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<int> {
+        BOOST_LEAF_AUTO(_stages, s_run(_config));
+        const auto _json = s_to_json(_config, _stages);
+
+        if (_config.output.empty()) {
+          std::cout << _json;
+        } else {
+          auto _file = std::ofstream(_config.output, std::ios::trunc);
+          _file << _json;
+          if (!_file) {
+            return W_FAILURE(std::errc::io_error, "could not write {}", _config.output);
+          }
+        }
+        return EXIT_SUCCESS;
+      },
+      [](const w_trace &p_trace) {
+        std::cerr << "wolf_bench_media got an error: " << p_trace.to_string() << std::endl;
+        return EXIT_FAILURE;
+      },
+      [] {
+        std::cerr << "wolf_bench_media got an error!" << std::endl;
+        return EXIT_FAILURE;
+      });
+}
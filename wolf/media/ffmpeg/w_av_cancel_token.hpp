@@ -0,0 +1,63 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+extern "C" {
+#include <libavformat/avio.h>
+}
+
+#include <atomic>
+
+namespace wolf::media::ffmpeg {
+
+/*
+ * a cancellation token which is checked by ffmpeg through AVIOInterruptCB,
+ * so the blocking calls of avformat such as avformat_open_input and
+ * av_read_frame return AVERROR_EXIT soon after cancel was called from any
+ * thread. it must outlive the format contexts which refer to it.
+ */
+class w_av_cancel_token {
+ public:
+  // constructor
+  w_av_cancel_token() noexcept = default;
+  // destructor
+  ~w_av_cancel_token() noexcept = default;
+
+  // request the cancellation, it can not be undone
+  void cancel() noexcept { this->_cancelled.store(true, std::memory_order_release); }
+
+  // returns true if the cancellation was requested
+  [[nodiscard]] bool is_cancelled() const noexcept {
+    return this->_cancelled.load(std::memory_order_acquire);
+  }
+
+  // returns the interrupt callback which refers to this token
+  [[nodiscard]] AVIOInterruptCB get_interrupt_cb() const noexcept {
+    return AVIOInterruptCB{&_interrupt, const_cast<w_av_cancel_token *>(this)};
+  }
+
+ private:
+  // copy constructor.
+  w_av_cancel_token(const w_av_cancel_token &) = delete;
+  // copy assignment operator.
+  w_av_cancel_token &operator=(const w_av_cancel_token &) = delete;
+  // the callback refers to this instance
+  w_av_cancel_token(w_av_cancel_token &&) = delete;
+  w_av_cancel_token &operator=(w_av_cancel_token &&) = delete;
+
+  static int _interrupt(_In_ void *p_opaque) noexcept {
+    return static_cast<const w_av_cancel_token *>(p_opaque)->is_cancelled() ? 1 : 0;
+  }
+
+  std::atomic<bool> _cancelled = false;
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
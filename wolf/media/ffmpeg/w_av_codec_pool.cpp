@@ -0,0 +1,202 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_codec_pool.hpp"
+
+using w_av_codec_pool = wolf::media::ffmpeg::w_av_codec_pool;
+using w_av_codec_pool_stats = wolf::media::ffmpeg::w_av_codec_pool_stats;
+using w_av_encoder_lease = wolf::media::ffmpeg::w_av_encoder_lease;
+using w_av_decoder_lease = wolf::media::ffmpeg::w_av_decoder_lease;
+using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_codec_opt = wolf::media::ffmpeg::w_av_codec_opt;
+using w_av_set_opt = wolf::media::ffmpeg::w_av_set_opt;
+using w_encoder = wolf::media::ffmpeg::w_encoder;
+using w_decoder = wolf::media::ffmpeg::w_decoder;
+using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
+
+// everything which w_ffmpeg passes to the codec is part of the key
+static std::string s_make_key(_In_ std::string_view p_kind, _In_ const std::string &p_id,
+                              _In_ const w_av_config &p_config,
+                              _In_ const w_av_codec_opt &p_codec_opts,
+                              _In_ const std::vector<w_av_set_opt> &p_opts) {
+  auto _key = wolf::format(
+      "{}|{}|{},{},{},{},{},{},{}|{},{},{},{},{},{},{},{},{}", p_kind, p_id,
+      static_cast<int>(p_config.format), p_config.width, p_config.height, p_config.alignment,
+      p_config.sample_rate, static_cast<int>(p_config.sample_fmts), p_config.nb_channels,
+      p_codec_opts.bitrate, p_codec_opts.fps, p_codec_opts.gop, p_codec_opts.level,
+      p_codec_opts.max_b_frames, p_codec_opts.refs, p_codec_opts.thread_count,
+      static_cast<int>(p_codec_opts.thread_type), p_codec_opts.low_delay);
+
+  for (const auto &_opt : p_opts) {
+    _key += '|';
+    _key += _opt.name;
+    _key += '=';
+    std::visit(
+        [&](const auto &p_value) {
+          using T = std::decay_t<decltype(p_value)>;
+          if constexpr (std::is_same_v<T, std::string>) {
+            _key += p_value;
+          } else {
+            _key += std::to_string(p_value);
+          }
+        },
+        _opt.value);
+  }
+  return _key;
+}
+
+w_av_codec_pool::w_av_codec_pool(_In_ size_t p_capacity) noexcept : _capacity(p_capacity) {}
+
+std::optional<w_av_codec_pool::w_codec> w_av_codec_pool::_take(
+    _In_ const std::string &p_key) noexcept {
+  std::scoped_lock _lock(this->_mutex);
+
+  const auto _iter = this->_index.find(p_key);
+  if (_iter == this->_index.end()) {
+    this->_stats.misses++;
+    return std::nullopt;
+  }
+
+  auto _codec = std::move(_iter->second->codec);
+  this->_entries.erase(_iter->second);
+  this->_index.erase(_iter);
+  this->_stats.hits++;
+  return _codec;
+}
+
+void w_av_codec_pool::_give_back(_In_ std::string &&p_key, _In_ w_codec &&p_codec) noexcept {
+  // reset it outside of the lock, the codec is owned by this thread
+  const auto _reset = std::visit(
+      [](auto &p_codec) -> bool {
+        return boost::leaf::try_handle_all(
+            [&]() -> boost::leaf::result<bool> {
+              BOOST_LEAF_CHECK(p_codec.reset());
+              return true;
+            },
+            []() { return false; });
+      },
+      p_codec);
+
+  // the evicted codecs are closed after the lock is released
+  auto _closed = w_entries();
+  {
+    std::scoped_lock _lock(this->_mutex);
+    if (!_reset || this->_capacity == 0) {
+      this->_stats.discards++;
+      return;
+    }
+
+    try {
+      this->_entries.push_front(w_entry{std::move(p_key), std::move(p_codec)});
+      this->_index.emplace(this->_entries.front().key, this->_entries.begin());
+    } catch (...) {
+      if (this->_entries.size() > this->_index.size()) {
+        this->_entries.pop_front();
+      }
+      this->_stats.discards++;
+      return;
+    }
+
+    while (this->_entries.size() > this->_capacity) {
+      const auto _oldest = std::prev(this->_entries.end());
+      auto [_begin, _end] = this->_index.equal_range(_oldest->key);
+      for (; _begin != _end; ++_begin) {
+        if (_begin->second == _oldest) {
+          this->_index.erase(_begin);
+          break;
+        }
+      }
+      _closed.splice(_closed.end(), this->_entries, _oldest);
+      this->_stats.evictions++;
+    }
+  }
+}
+
+boost::leaf::result<w_av_encoder_lease> w_av_codec_pool::acquire_encoder(
+    _In_ const w_av_config &p_config, _In_ AVCodecID p_id, _In_ const w_av_codec_opt &p_codec_opts,
+    _In_ const std::vector<w_av_set_opt> &p_opts) noexcept {
+  try {
+    auto _key = s_make_key("encoder", std::to_string(static_cast<int>(p_id)), p_config,
+                           p_codec_opts, p_opts);
+    auto _idle = _take(_key);
+    if (_idle.has_value()) {
+      return w_av_encoder_lease(this, std::move(_key), std::get<w_encoder>(std::move(*_idle)));
+    }
+    BOOST_LEAF_AUTO(_encoder, w_ffmpeg::create_encoder(p_config, p_id, p_codec_opts, p_opts));
+    return w_av_encoder_lease(this, std::move(_key), std::move(_encoder));
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not acquire an encoder because: {}",
+                     p_exc.what());
+  }
+}
+
+boost::leaf::result<w_av_encoder_lease> w_av_codec_pool::acquire_encoder(
+    _In_ const w_av_config &p_config, _In_ const std::string &p_id,
+    _In_ const w_av_codec_opt &p_codec_opts,
+    _In_ const std::vector<w_av_set_opt> &p_opts) noexcept {
+  try {
+    auto _key = s_make_key("encoder", p_id, p_config, p_codec_opts, p_opts);
+    auto _idle = _take(_key);
+    if (_idle.has_value()) {
+      return w_av_encoder_lease(this, std::move(_key), std::get<w_encoder>(std::move(*_idle)));
+    }
+    BOOST_LEAF_AUTO(_encoder, w_ffmpeg::create_encoder(p_config, p_id, p_codec_opts, p_opts));
+    return w_av_encoder_lease(this, std::move(_key), std::move(_encoder));
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not acquire an encoder because: {}",
+                     p_exc.what());
+  }
+}
+
+boost::leaf::result<w_av_decoder_lease> w_av_codec_pool::acquire_decoder(
+    _In_ const w_av_config &p_config, _In_ AVCodecID p_id, _In_ const w_av_codec_opt &p_codec_opts,
+    _In_ const std::vector<w_av_set_opt> &p_opts) noexcept {
+  try {
+    auto _key = s_make_key("decoder", std::to_string(static_cast<int>(p_id)), p_config,
+                           p_codec_opts, p_opts);
+    auto _idle = _take(_key);
+    if (_idle.has_value()) {
+      return w_av_decoder_lease(this, std::move(_key), std::get<w_decoder>(std::move(*_idle)));
+    }
+    BOOST_LEAF_AUTO(_decoder, w_ffmpeg::create_decoder(p_config, p_id, p_codec_opts, p_opts));
+    return w_av_decoder_lease(this, std::move(_key), std::move(_decoder));
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not acquire a decoder because: {}",
+                     p_exc.what());
+  }
+}
+
+boost::leaf::result<w_av_decoder_lease> w_av_codec_pool::acquire_decoder(
+    _In_ const w_av_config &p_config, _In_ const std::string &p_id,
+    _In_ const w_av_codec_opt &p_codec_opts,
+    _In_ const std::vector<w_av_set_opt> &p_opts) noexcept {
+  try {
+    auto _key = s_make_key("decoder", p_id, p_config, p_codec_opts, p_opts);
+    auto _idle = _take(_key);
+    if (_idle.has_value()) {
+      return w_av_decoder_lease(this, std::move(_key), std::get<w_decoder>(std::move(*_idle)));
+    }
+    BOOST_LEAF_AUTO(_decoder, w_ffmpeg::create_decoder(p_config, p_id, p_codec_opts, p_opts));
+    return w_av_decoder_lease(this, std::move(_key), std::move(_decoder));
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not acquire a decoder because: {}",
+                     p_exc.what());
+  }
+}
+
+void w_av_codec_pool::clear() noexcept {
+  auto _closed = w_entries();
+  {
+    std::scoped_lock _lock(this->_mutex);
+    _closed.swap(this->_entries);
+    this->_index.clear();
+  }
+}
+
+w_av_codec_pool_stats w_av_codec_pool::get_stats() const noexcept {
+  std::scoped_lock _lock(this->_mutex);
+  auto _stats = this->_stats;
+  _stats.idle = this->_entries.size();
+  return _stats;
+}
+
+#endif  // WOLF_MEDIA_FFMPEG
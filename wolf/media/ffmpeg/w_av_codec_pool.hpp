@@ -0,0 +1,230 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+#include "w_ffmpeg.hpp"
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <variant>
+
+namespace wolf::media::ffmpeg {
+
+class w_av_codec_pool;
+
+struct w_av_codec_pool_stats {
+  // number of acquisitions which were served by an idle codec
+  uint64_t hits = 0;
+  // number of acquisitions which opened a new codec
+  uint64_t misses = 0;
+  // number of idle codecs which were closed by the capacity
+  uint64_t evictions = 0;
+  // number of returned codecs which were closed because they could not be reset
+  uint64_t discards = 0;
+  // number of idle codecs
+  size_t idle = 0;
+};
+
+/*
+ * an encoder or a decoder which was drawn from a w_av_codec_pool, it goes
+ * back to the pool when the lease is destroyed
+ */
+template <typename T>
+class w_av_codec_lease {
+  friend w_av_codec_pool;
+
+ public:
+  // constructor
+  w_av_codec_lease() noexcept = default;
+  // destructor
+  ~w_av_codec_lease() noexcept { _release(); }
+
+  // move constructor.
+  w_av_codec_lease(w_av_codec_lease &&p_other) noexcept {
+    _move(std::forward<w_av_codec_lease &&>(p_other));
+  }
+  // move assignment operator.
+  w_av_codec_lease &operator=(w_av_codec_lease &&p_other) noexcept {
+    _move(std::forward<w_av_codec_lease &&>(p_other));
+    return *this;
+  }
+
+  T &operator*() noexcept { return *this->_codec; }
+  T *operator->() noexcept { return &*this->_codec; }
+
+  // returns true if the lease holds a codec
+  explicit operator bool() const noexcept { return this->_codec.has_value(); }
+
+  /*
+   * keep the codec out of the pool, the lease becomes empty
+   * @returns the codec
+   */
+  T detach() noexcept {
+    auto _codec = std::move(*this->_codec);
+    this->_codec.reset();
+    this->_pool = nullptr;
+    return _codec;
+  }
+
+ private:
+  // copy constructor.
+  w_av_codec_lease(const w_av_codec_lease &) = delete;
+  // copy assignment operator.
+  w_av_codec_lease &operator=(const w_av_codec_lease &) = delete;
+
+  w_av_codec_lease(_In_ w_av_codec_pool *p_pool, _In_ std::string &&p_key,
+                   _In_ T &&p_codec) noexcept
+      : _pool(p_pool), _key(std::move(p_key)), _codec(std::move(p_codec)) {}
+
+  // give the codec back to the pool
+  void _release() noexcept;
+  // move
+  void _move(w_av_codec_lease &&p_other) noexcept {
+    if (this == &p_other) {
+      return;
+    }
+    _release();
+    this->_pool = std::exchange(p_other._pool, nullptr);
+    this->_key = std::move(p_other._key);
+    this->_codec = std::move(p_other._codec);
+    p_other._codec.reset();
+  }
+
+  w_av_codec_pool *_pool = nullptr;
+  std::string _key;
+  std::optional<T> _codec = std::nullopt;
+};
+
+using w_av_encoder_lease = w_av_codec_lease<w_encoder>;
+using w_av_decoder_lease = w_av_codec_lease<w_decoder>;
+
+/*
+ * a pool of opened encoders and decoders keyed by their codec, config,
+ * codec options and options, so short sessions skip avcodec_open2 which
+ * takes milliseconds for codecs such as libx264. a returned codec is reset
+ * and kept idle, the least recently returned ones are closed when more than
+ * the capacity are idle. it is thread-safe and must outlive its leases.
+ */
+class w_av_codec_pool {
+  template <typename T>
+  friend class w_av_codec_lease;
+
+ public:
+  /*
+   * constructor
+   * @param p_capacity, the maximum number of idle codecs
+   */
+  W_API explicit w_av_codec_pool(_In_ size_t p_capacity = 16) noexcept;
+
+  // destructor
+  W_API virtual ~w_av_codec_pool() noexcept = default;
+
+  /*
+   * get an idle encoder or create one like w_ffmpeg::create_encoder
+   * @param p_config, the video config
+   * @param p_id, the avcodec id
+   * @param p_codec_opts, the codec settings
+   * @param p_opts, the codec options
+   * @returns the lease of encoder
+   */
+  W_API boost::leaf::result<w_av_encoder_lease> acquire_encoder(
+      _In_ const w_av_config &p_config, _In_ AVCodecID p_id,
+      _In_ const w_av_codec_opt &p_codec_opts,
+      _In_ const std::vector<w_av_set_opt> &p_opts = {}) noexcept;
+
+  /*
+   * get an idle encoder or create one like w_ffmpeg::create_encoder
+   * @param p_config, the video config
+   * @param p_id, the avcodec id in string (e.g. "libsvtav1", "libvpx")
+   * @param p_codec_opts, the codec settings
+   * @param p_opts, the codec options
+   * @returns the lease of encoder
+   */
+  W_API boost::leaf::result<w_av_encoder_lease> acquire_encoder(
+      _In_ const w_av_config &p_config, _In_ const std::string &p_id,
+      _In_ const w_av_codec_opt &p_codec_opts,
+      _In_ const std::vector<w_av_set_opt> &p_opts = {}) noexcept;
+
+  /*
+   * get an idle decoder or create one like w_ffmpeg::create_decoder
+   * @param p_config, the avconfig
+   * @param p_id, the avcodec id
+   * @param p_codec_opts, the codec settings
+   * @param p_opts, the codec options
+   * @returns the lease of decoder
+   */
+  W_API boost::leaf::result<w_av_decoder_lease> acquire_decoder(
+      _In_ const w_av_config &p_config, _In_ AVCodecID p_id,
+      _In_ const w_av_codec_opt &p_codec_opts,
+      _In_ const std::vector<w_av_set_opt> &p_opts = {}) noexcept;
+
+  /*
+   * get an idle decoder or create one like w_ffmpeg::create_decoder
+   * @param p_config, the avconfig
+   * @param p_id, the avcodec id in string (e.g. "libsvtav1", "libvpx")
+   * @param p_codec_opts, the codec settings
+   * @param p_opts, the codec options
+   * @returns the lease of decoder
+   */
+  W_API boost::leaf::result<w_av_decoder_lease> acquire_decoder(
+      _In_ const w_av_config &p_config, _In_ const std::string &p_id,
+      _In_ const w_av_codec_opt &p_codec_opts,
+      _In_ const std::vector<w_av_set_opt> &p_opts = {}) noexcept;
+
+  // close all idle codecs
+  W_API void clear() noexcept;
+
+  // returns the statistics of pool
+  W_API w_av_codec_pool_stats get_stats() const noexcept;
+
+ private:
+  // copy constructor.
+  w_av_codec_pool(const w_av_codec_pool &) = delete;
+  // copy assignment operator.
+  w_av_codec_pool &operator=(const w_av_codec_pool &) = delete;
+  // the leases refer to this instance
+  w_av_codec_pool(w_av_codec_pool &&) = delete;
+  w_av_codec_pool &operator=(w_av_codec_pool &&) = delete;
+
+  using w_codec = std::variant<w_encoder, w_decoder>;
+
+  struct w_entry {
+    std::string key;
+    w_codec codec;
+  };
+  using w_entries = std::list<w_entry>;
+
+  // take an idle codec of the key
+  std::optional<w_codec> _take(_In_ const std::string &p_key) noexcept;
+  // reset a returned codec and keep it idle
+  void _give_back(_In_ std::string &&p_key, _In_ w_codec &&p_codec) noexcept;
+
+  size_t _capacity;
+
+  mutable std::mutex _mutex;
+  // the idle codecs, the most recently returned one is at the front
+  w_entries _entries;
+  std::unordered_multimap<std::string, w_entries::iterator> _index;
+  w_av_codec_pool_stats _stats = {};
+};
+
+template <typename T>
+void w_av_codec_lease<T>::_release() noexcept {
+  if (this->_pool != nullptr && this->_codec.has_value()) {
+    this->_pool->_give_back(std::move(this->_key), std::move(*this->_codec));
+  }
+  this->_codec.reset();
+  this->_pool = nullptr;
+}
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
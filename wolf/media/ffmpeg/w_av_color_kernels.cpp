@@ -0,0 +1,480 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_color_kernels.hpp"
+
+#include <wolf/system/w_thread_pool.hpp>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define W_AV_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define W_AV_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// the x86 kernels are compiled for their own targets and picked at runtime,
+// msvc does not need a flag for the intrinsics
+#if defined(W_AV_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define W_AV_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define W_AV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define W_AV_TARGET_SSE4
+#define W_AV_TARGET_AVX2
+#endif
+
+using w_av_color_kernels = wolf::media::ffmpeg::w_av_color_kernels;
+using w_av_simd_level = wolf::media::ffmpeg::w_av_simd_level;
+using w_thread_pool = wolf::system::w_thread_pool;
+
+namespace {
+
+// bt.601 limited range in 6-bit fixed point, the sums of the simd kernels
+// saturate only above 32767 where the scalar result is clamped to 255 too
+constexpr int s_y_mul = 75;     // 1.164
+constexpr int s_v_to_r = 102;   // 1.596
+constexpr int s_u_to_g = 25;    // 0.391
+constexpr int s_v_to_g = 52;    // 0.813
+constexpr int s_u_to_b = 129;   // 2.018
+constexpr int s_round = 32;
+
+// one row of the source and the destination, the chroma of nv12 is read
+// from u with a step of two and v is u + 1
+struct w_row {
+  const uint8_t *y = nullptr;
+  const uint8_t *u = nullptr;
+  const uint8_t *v = nullptr;
+  uint8_t *dst = nullptr;
+  int width = 0;
+};
+
+using w_row_fn = void (*)(const w_row &) noexcept;
+
+inline uint8_t s_clamp(_In_ int p_value) noexcept {
+  return gsl::narrow_cast<uint8_t>(std::clamp(p_value, 0, 255));
+}
+
+template <bool t_nv12, bool t_bgr24>
+void s_row_scalar(_In_ const w_row &p_row, _In_ int p_x) noexcept {
+  constexpr int _step = t_nv12 ? 2 : 1;
+  constexpr int _bpp = t_bgr24 ? 3 : 4;
+
+  for (int x = p_x; x < p_row.width; ++x) {
+    const int _u = p_row.u[(x >> 1) * _step] - 128;
+    const int _v = p_row.v[(x >> 1) * _step] - 128;
+    const int _y = (p_row.y[x] - 16) * s_y_mul + s_round;
+
+    const auto _r = s_clamp((_y + s_v_to_r * _v) >> 6);
+    const auto _g = s_clamp((_y - (s_u_to_g * _u + s_v_to_g * _v)) >> 6);
+    const auto _b = s_clamp((_y + s_u_to_b * _u) >> 6);
+
+    auto *_dst = p_row.dst + gsl::narrow_cast<ptrdiff_t>(x) * _bpp;
+    if constexpr (t_bgr24) {
+      _dst[0] = _b;
+      _dst[1] = _g;
+      _dst[2] = _r;
+    } else {
+      _dst[0] = _r;
+      _dst[1] = _g;
+      _dst[2] = _b;
+      _dst[3] = 255;
+    }
+  }
+}
+
+template <bool t_nv12, bool t_bgr24>
+void s_row_scalar(_In_ const w_row &p_row) noexcept {
+  s_row_scalar<t_nv12, t_bgr24>(p_row, 0);
+}
+
+#ifdef W_AV_KERNELS_X86
+
+// the 16 bit rgb of 8 pixels from their luma and their duplicated chroma
+struct w_rgb16 {
+  __m128i r;
+  __m128i g;
+  __m128i b;
+};
+
+W_AV_TARGET_SSE4 inline w_rgb16 s_rgb16_sse4(_In_ __m128i p_y, _In_ __m128i p_rc, _In_ __m128i p_gc,
+                                              _In_ __m128i p_bc) noexcept {
+  const auto _y = _mm_add_epi16(
+      _mm_mullo_epi16(_mm_sub_epi16(p_y, _mm_set1_epi16(16)), _mm_set1_epi16(s_y_mul)),
+      _mm_set1_epi16(s_round));
+  return w_rgb16{_mm_srai_epi16(_mm_adds_epi16(_y, p_rc), 6),
+                 _mm_srai_epi16(_mm_subs_epi16(_y, p_gc), 6),
+                 _mm_srai_epi16(_mm_adds_epi16(_y, p_bc), 6)};
+}
+
+// store 16 pixels whose channels are packed into bytes
+template <bool t_bgr24>
+W_AV_TARGET_SSE4 inline void s_store_sse4(_In_ __m128i p_r, _In_ __m128i p_g, _In_ __m128i p_b,
+                                          _Inout_ uint8_t *p_dst) noexcept {
+  const auto _a = _mm_set1_epi8(-1);
+  const auto _first = t_bgr24 ? p_b : p_r;
+  const auto _third = t_bgr24 ? p_r : p_b;
+
+  const auto _xy_lo = _mm_unpacklo_epi8(_first, p_g);
+  const auto _xy_hi = _mm_unpackhi_epi8(_first, p_g);
+  const auto _za_lo = _mm_unpacklo_epi8(_third, _a);
+  const auto _za_hi = _mm_unpackhi_epi8(_third, _a);
+
+  const __m128i _pixels[4] = {
+      _mm_unpacklo_epi16(_xy_lo, _za_lo), _mm_unpackhi_epi16(_xy_lo, _za_lo),
+      _mm_unpacklo_epi16(_xy_hi, _za_hi), _mm_unpackhi_epi16(_xy_hi, _za_hi)};
+
+  if constexpr (t_bgr24) {
+    // drop the alpha of every 4 pixels, each store writes 4 bytes past its 12
+    // which the next store or the scalar tail overwrites
+    const auto _shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for (int i = 0; i < 4; ++i) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(p_dst + i * 12),
+                       _mm_shuffle_epi8(_pixels[i], _shuffle));
+    }
+  } else {
+    for (int i = 0; i < 4; ++i) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(p_dst + i * 16), _pixels[i]);
+    }
+  }
+}
+
+// load the u and v of 8 chroma samples as 16 bit and subtract 128
+template <bool t_nv12>
+W_AV_TARGET_SSE4 inline void s_load_uv_sse4(_In_ const w_row &p_row, _In_ int p_x,
+                                            _Out_ __m128i &p_u, _Out_ __m128i &p_v) noexcept {
+  const auto _bias = _mm_set1_epi16(128);
+  if constexpr (t_nv12) {
+    const auto _uv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row.u + p_x));
+    p_u = _mm_sub_epi16(_mm_and_si128(_uv, _mm_set1_epi16(0x00FF)), _bias);
+    p_v = _mm_sub_epi16(_mm_srli_epi16(_uv, 8), _bias);
+  } else {
+    p_u = _mm_sub_epi16(
+        _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p_row.u + p_x / 2))),
+        _bias);
+    p_v = _mm_sub_epi16(
+        _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p_row.v + p_x / 2))),
+        _bias);
+  }
+}
+
+template <bool t_nv12, bool t_bgr24>
+W_AV_TARGET_SSE4 void s_row_sse4(_In_ const w_row &p_row) noexcept {
+  constexpr int _bpp = t_bgr24 ? 3 : 4;
+  // the stores of bgr24 write two pixels past the block
+  constexpr int _overrun = t_bgr24 ? 2 : 0;
+
+  int x = 0;
+  for (; x + 16 + _overrun <= p_row.width; x += 16) {
+    __m128i _u;
+    __m128i _v;
+    s_load_uv_sse4<t_nv12>(p_row, x, _u, _v);
+
+    const auto _rc = _mm_mullo_epi16(_v, _mm_set1_epi16(s_v_to_r));
+    const auto _gc = _mm_add_epi16(_mm_mullo_epi16(_u, _mm_set1_epi16(s_u_to_g)),
+                                   _mm_mullo_epi16(_v, _mm_set1_epi16(s_v_to_g)));
+    const auto _bc = _mm_mullo_epi16(_u, _mm_set1_epi16(s_u_to_b));
+
+    const auto _y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row.y + x));
+    const auto _lo = s_rgb16_sse4(_mm_cvtepu8_epi16(_y), _mm_unpacklo_epi16(_rc, _rc),
+                                  _mm_unpacklo_epi16(_gc, _gc), _mm_unpacklo_epi16(_bc, _bc));
+    const auto _hi = s_rgb16_sse4(_mm_unpackhi_epi8(_y, _mm_setzero_si128()),
+                                  _mm_unpackhi_epi16(_rc, _rc), _mm_unpackhi_epi16(_gc, _gc),
+                                  _mm_unpackhi_epi16(_bc, _bc));
+
+    s_store_sse4<t_bgr24>(_mm_packus_epi16(_lo.r, _hi.r), _mm_packus_epi16(_lo.g, _hi.g),
+                          _mm_packus_epi16(_lo.b, _hi.b),
+                          p_row.dst + gsl::narrow_cast<ptrdiff_t>(x) * _bpp);
+  }
+  s_row_scalar<t_nv12, t_bgr24>(p_row, x);
+}
+
+template <bool t_nv12, bool t_bgr24>
+W_AV_TARGET_AVX2 void s_row_avx2(_In_ const w_row &p_row) noexcept {
+  constexpr int _bpp = t_bgr24 ? 3 : 4;
+  constexpr int _overrun = t_bgr24 ? 2 : 0;
+
+  const auto _bias = _mm256_set1_epi16(128);
+  const auto _y_bias = _mm256_set1_epi16(16);
+  const auto _y_mul = _mm256_set1_epi16(s_y_mul);
+  const auto _round = _mm256_set1_epi16(s_round);
+
+  int x = 0;
+  for (; x + 32 + _overrun <= p_row.width; x += 32) {
+    // 16 chroma samples in order
+    __m256i _u;
+    __m256i _v;
+    if constexpr (t_nv12) {
+      const auto _uv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p_row.u + x));
+      _u = _mm256_sub_epi16(_mm256_and_si256(_uv, _mm256_set1_epi16(0x00FF)), _bias);
+      _v = _mm256_sub_epi16(_mm256_srli_epi16(_uv, 8), _bias);
+    } else {
+      _u = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(
+                                reinterpret_cast<const __m128i *>(p_row.u + x / 2))),
+                            _bias);
+      _v = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(
+                                reinterpret_cast<const __m128i *>(p_row.v + x / 2))),
+                            _bias);
+    }
+
+    // the unpacks work inside 128 bit lanes, so the chroma is reordered to
+    // 0-3, 8-11 | 4-7, 12-15 and the unpacks give the pixels in order
+    const auto _rc = _mm256_permute4x64_epi64(_mm256_mullo_epi16(_v, _mm256_set1_epi16(s_v_to_r)),
+                                              0xD8);
+    const auto _gc = _mm256_permute4x64_epi64(
+        _mm256_add_epi16(_mm256_mullo_epi16(_u, _mm256_set1_epi16(s_u_to_g)),
+                         _mm256_mullo_epi16(_v, _mm256_set1_epi16(s_v_to_g))),
+        0xD8);
+    const auto _bc = _mm256_permute4x64_epi64(_mm256_mullo_epi16(_u, _mm256_set1_epi16(s_u_to_b)),
+                                              0xD8);
+
+    const __m256i _ys[2] = {
+        _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row.y + x))),
+        _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p_row.y + x + 16)))};
+    const __m256i _rcs[2] = {_mm256_unpacklo_epi16(_rc, _rc), _mm256_unpackhi_epi16(_rc, _rc)};
+    const __m256i _gcs[2] = {_mm256_unpacklo_epi16(_gc, _gc), _mm256_unpackhi_epi16(_gc, _gc)};
+    const __m256i _bcs[2] = {_mm256_unpacklo_epi16(_bc, _bc), _mm256_unpackhi_epi16(_bc, _bc)};
+
+    for (int i = 0; i < 2; ++i) {
+      const auto _y = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(_ys[i], _y_bias), _y_mul),
+                                       _round);
+      const auto _r = _mm256_srai_epi16(_mm256_adds_epi16(_y, _rcs[i]), 6);
+      const auto _g = _mm256_srai_epi16(_mm256_subs_epi16(_y, _gcs[i]), 6);
+      const auto _b = _mm256_srai_epi16(_mm256_adds_epi16(_y, _bcs[i]), 6);
+
+      s_store_sse4<t_bgr24>(
+          _mm_packus_epi16(_mm256_castsi256_si128(_r), _mm256_extracti128_si256(_r, 1)),
+          _mm_packus_epi16(_mm256_castsi256_si128(_g), _mm256_extracti128_si256(_g, 1)),
+          _mm_packus_epi16(_mm256_castsi256_si128(_b), _mm256_extracti128_si256(_b, 1)),
+          p_row.dst + gsl::narrow_cast<ptrdiff_t>(x + i * 16) * _bpp);
+    }
+  }
+  s_row_scalar<t_nv12, t_bgr24>(p_row, x);
+}
+
+bool s_detect_sse4() noexcept {
+#ifdef _MSC_VER
+  int _info[4] = {};
+  __cpuid(_info, 1);
+  return (_info[2] & (1 << 19)) != 0;
+#else
+  return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+
+bool s_detect_avx2() noexcept {
+#ifdef _MSC_VER
+  int _info[4] = {};
+  __cpuid(_info, 0);
+  if (_info[0] < 7) {
+    return false;
+  }
+  // the os must save the ymm registers
+  __cpuid(_info, 1);
+  constexpr int _osxsave_avx = (1 << 27) | (1 << 28);
+  if ((_info[2] & _osxsave_avx) != _osxsave_avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(_info, 7, 0);
+  return (_info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif  // W_AV_KERNELS_X86
+
+#ifdef W_AV_KERNELS_NEON
+
+template <bool t_nv12, bool t_bgr24>
+void s_row_neon(_In_ const w_row &p_row) noexcept {
+  constexpr int _bpp = t_bgr24 ? 3 : 4;
+
+  const auto _bias = vdupq_n_s16(128);
+  const auto _y_bias = vdupq_n_s16(16);
+  const auto _round = vdupq_n_s16(s_round);
+
+  int x = 0;
+  for (; x + 16 <= p_row.width; x += 16) {
+    uint8x8_t _u8;
+    uint8x8_t _v8;
+    if constexpr (t_nv12) {
+      const auto _uv = vld2_u8(p_row.u + x);
+      _u8 = _uv.val[0];
+      _v8 = _uv.val[1];
+    } else {
+      _u8 = vld1_u8(p_row.u + x / 2);
+      _v8 = vld1_u8(p_row.v + x / 2);
+    }
+    const auto _u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(_u8)), _bias);
+    const auto _v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(_v8)), _bias);
+
+    const auto _rc = vmulq_n_s16(_v, s_v_to_r);
+    const auto _gc = vaddq_s16(vmulq_n_s16(_u, s_u_to_g), vmulq_n_s16(_v, s_v_to_g));
+    const auto _bc = vmulq_n_s16(_u, s_u_to_b);
+    const auto _rcs = vzipq_s16(_rc, _rc);
+    const auto _gcs = vzipq_s16(_gc, _gc);
+    const auto _bcs = vzipq_s16(_bc, _bc);
+
+    const auto _y8 = vld1q_u8(p_row.y + x);
+    const int16x8_t _ys[2] = {vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(_y8))),
+                              vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(_y8)))};
+
+    uint8x8_t _r[2];
+    uint8x8_t _g[2];
+    uint8x8_t _b[2];
+    for (int i = 0; i < 2; ++i) {
+      const auto _y = vaddq_s16(vmulq_n_s16(vsubq_s16(_ys[i], _y_bias), s_y_mul), _round);
+      _r[i] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(_y, _rcs.val[i]), 6));
+      _g[i] = vqmovun_s16(vshrq_n_s16(vqsubq_s16(_y, _gcs.val[i]), 6));
+      _b[i] = vqmovun_s16(vshrq_n_s16(vqaddq_s16(_y, _bcs.val[i]), 6));
+    }
+
+    auto *_dst = p_row.dst + gsl::narrow_cast<ptrdiff_t>(x) * _bpp;
+    if constexpr (t_bgr24) {
+      vst3q_u8(_dst, uint8x16x3_t{{vcombine_u8(_b[0], _b[1]), vcombine_u8(_g[0], _g[1]),
+                                   vcombine_u8(_r[0], _r[1])}});
+    } else {
+      vst4q_u8(_dst, uint8x16x4_t{{vcombine_u8(_r[0], _r[1]), vcombine_u8(_g[0], _g[1]),
+                                   vcombine_u8(_b[0], _b[1]), vdupq_n_u8(255)}});
+    }
+  }
+  s_row_scalar<t_nv12, t_bgr24>(p_row, x);
+}
+
+#endif  // W_AV_KERNELS_NEON
+
+template <bool t_nv12, bool t_bgr24>
+w_row_fn s_select(_In_ w_av_simd_level p_level) noexcept {
+  switch (p_level) {
+    default:
+      return &s_row_scalar<t_nv12, t_bgr24>;
+#ifdef W_AV_KERNELS_X86
+    case w_av_simd_level::sse4:
+      return &s_row_sse4<t_nv12, t_bgr24>;
+    case w_av_simd_level::avx2:
+      return &s_row_avx2<t_nv12, t_bgr24>;
+#endif
+#ifdef W_AV_KERNELS_NEON
+    case w_av_simd_level::neon:
+      return &s_row_neon<t_nv12, t_bgr24>;
+#endif
+  }
+}
+
+w_av_simd_level s_detect() noexcept {
+#if defined(W_AV_KERNELS_X86)
+  if (s_detect_avx2()) {
+    return w_av_simd_level::avx2;
+  }
+  if (s_detect_sse4()) {
+    return w_av_simd_level::sse4;
+  }
+#elif defined(W_AV_KERNELS_NEON)
+  return w_av_simd_level::neon;
+#endif
+  return w_av_simd_level::scalar;
+}
+
+}  // namespace
+
+w_av_simd_level w_av_color_kernels::get_simd_level() noexcept {
+  static const auto s_level = s_detect();
+  return s_level;
+}
+
+bool w_av_color_kernels::is_available(_In_ w_av_simd_level p_level) noexcept {
+  switch (p_level) {
+    case w_av_simd_level::none:
+    case w_av_simd_level::scalar:
+      return true;
+    case w_av_simd_level::sse4:
+      return get_simd_level() == w_av_simd_level::sse4 ||
+             get_simd_level() == w_av_simd_level::avx2;
+    case w_av_simd_level::avx2:
+    case w_av_simd_level::neon:
+      return get_simd_level() == p_level;
+  }
+  return false;
+}
+
+bool w_av_color_kernels::is_supported(_In_ AVPixelFormat p_src_format,
+                                      _In_ AVPixelFormat p_dst_format) noexcept {
+  return (p_src_format == AVPixelFormat::AV_PIX_FMT_NV12 ||
+          p_src_format == AVPixelFormat::AV_PIX_FMT_YUV420P) &&
+         (p_dst_format == AVPixelFormat::AV_PIX_FMT_RGBA ||
+          p_dst_format == AVPixelFormat::AV_PIX_FMT_BGR24);
+}
+
+boost::leaf::result<int> w_av_color_kernels::convert(_In_ const AVFrame *p_src,
+                                                     _Inout_ AVFrame *p_dst,
+                                                     _In_ w_av_simd_level p_level,
+                                                     _In_opt_ w_thread_pool *p_pool) noexcept {
+  if (p_src == nullptr || p_dst == nullptr || p_dst->data[0] == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the frames of w_av_color_kernels must be initialized");
+  }
+  const auto _src_format = gsl::narrow_cast<AVPixelFormat>(p_src->format);
+  const auto _dst_format = gsl::narrow_cast<AVPixelFormat>(p_dst->format);
+  if (!is_supported(_src_format, _dst_format)) {
+    return W_FAILURE(std::errc::not_supported,
+                     "w_av_color_kernels does not support the conversion of {} into {}",
+                     static_cast<int>(_src_format), static_cast<int>(_dst_format));
+  }
+  if (p_src->width != p_dst->width || p_src->height != p_dst->height || p_src->width <= 0 ||
+      p_src->height <= 0) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "w_av_color_kernels does not scale, the sizes of frames must be equal");
+  }
+  if (p_level == w_av_simd_level::none || !is_available(p_level)) {
+    return W_FAILURE(std::errc::not_supported,
+                     "the simd level {} of w_av_color_kernels is not available",
+                     static_cast<int>(p_level));
+  }
+
+  const auto _nv12 = _src_format == AVPixelFormat::AV_PIX_FMT_NV12;
+  const auto _bgr24 = _dst_format == AVPixelFormat::AV_PIX_FMT_BGR24;
+  const auto _row_fn = _nv12 ? (_bgr24 ? s_select<true, true>(p_level)
+                                       : s_select<true, false>(p_level))
+                             : (_bgr24 ? s_select<false, true>(p_level)
+                                       : s_select<false, false>(p_level));
+
+  const auto _width = p_src->width;
+  const auto _height = p_src->height;
+  const auto _convert_rows = [&](_In_ int p_begin, _In_ int p_end) noexcept {
+    auto _row = w_row{};
+    _row.width = _width;
+    for (int j = p_begin; j < p_end; ++j) {
+      const auto _chroma = gsl::narrow_cast<ptrdiff_t>(j >> 1);
+      _row.y = p_src->data[0] + gsl::narrow_cast<ptrdiff_t>(j) * p_src->linesize[0];
+      _row.u = p_src->data[1] + _chroma * p_src->linesize[1];
+      _row.v = _nv12 ? _row.u + 1 : p_src->data[2] + _chroma * p_src->linesize[2];
+      _row.dst = p_dst->data[0] + gsl::narrow_cast<ptrdiff_t>(j) * p_dst->linesize[0];
+      _row_fn(_row);
+    }
+  };
+
+  const auto _concurrency = p_pool != nullptr ? p_pool->get_concurrency() : size_t{1};
+  if (_concurrency <= 1 || _height < 4) {
+    _convert_rows(0, _height);
+    return _height;
+  }
+
+  // slices of an even number of rows, so no chroma row is split
+  auto _slice_rows = (_height + gsl::narrow_cast<int>(_concurrency) - 1) /
+                     gsl::narrow_cast<int>(_concurrency);
+  _slice_rows += _slice_rows & 1;
+  const auto _slices = gsl::narrow_cast<size_t>((_height + _slice_rows - 1) / _slice_rows);
+
+  p_pool->parallel_for(_slices, [&](size_t p_index) noexcept {
+    const auto _begin = gsl::narrow_cast<int>(p_index) * _slice_rows;
+    _convert_rows(_begin, std::min(_begin + _slice_rows, _height));
+  });
+  return _height;
+}
+
+#endif  // WOLF_MEDIA_FFMPEG
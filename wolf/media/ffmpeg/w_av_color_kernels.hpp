@@ -0,0 +1,72 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+namespace wolf::system {
+class w_thread_pool;
+}  // namespace wolf::system
+
+namespace wolf::media::ffmpeg {
+
+/*
+ * the instruction set of color conversion kernels
+ */
+enum class w_av_simd_level : int {
+  // no kernel, every conversion goes through swscale
+  none = 0,
+  // the portable kernel which the others match byte for byte
+  scalar,
+  sse4,
+  avx2,
+  neon,
+};
+
+/*
+ * the kernels of the hot color conversions, nv12 and yuv420p into rgba and
+ * bgr24 without scaling. they use the bt.601 limited range matrix in 6-bit
+ * fixed point and share a chroma sample between each 2x2 block like the
+ * unscaled path of swscale, every simd kernel gives the same bytes as the
+ * scalar one. the rows can be split into slices which run on a thread pool.
+ */
+class w_av_color_kernels {
+ public:
+  // returns the best level which this cpu and os support, it is detected once
+  W_API static w_av_simd_level get_simd_level() noexcept;
+
+  // returns true if the kernels of the level can run on this cpu
+  W_API static bool is_available(_In_ w_av_simd_level p_level) noexcept;
+
+  // returns true if there is a kernel for the pair of formats
+  W_API static bool is_supported(_In_ AVPixelFormat p_src_format,
+                                 _In_ AVPixelFormat p_dst_format) noexcept;
+
+  /*
+   * convert a frame into a frame of the same size
+   * @param p_src, the source frame
+   * @param p_dst, the destination frame whose buffer was allocated
+   * @param p_level, an available level other than none
+   * @param p_pool, an optional pool which converts the slices of rows
+   * @returns the height of output
+   */
+  W_API static boost::leaf::result<int> convert(
+      _In_ const AVFrame *p_src, _Inout_ AVFrame *p_dst, _In_ w_av_simd_level p_level,
+      _In_opt_ wolf::system::w_thread_pool *p_pool = nullptr) noexcept;
+
+ private:
+  w_av_color_kernels() = delete;
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
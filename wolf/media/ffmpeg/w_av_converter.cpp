@@ -0,0 +1,203 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_converter.hpp"
+#include "w_ffmpeg_ctx.hpp"
+
+extern "C" {
+#include <libswresample/swresample.h>
+}
+
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_scale_algorithm = wolf::media::ffmpeg::w_av_scale_algorithm;
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_frame_pool = wolf::media::ffmpeg::w_av_frame_pool;
+using w_av_color_kernels = wolf::media::ffmpeg::w_av_color_kernels;
+using w_av_simd_level = wolf::media::ffmpeg::w_av_simd_level;
+using w_thread_pool = wolf::system::w_thread_pool;
+using w_ffmpeg_ctx = wolf::media::ffmpeg::w_ffmpeg_ctx;
+
+w_av_converter::w_av_converter(_In_ w_av_scale_algorithm p_algorithm) noexcept
+    : _algorithm(p_algorithm) {}
+
+void w_av_converter::_release() noexcept {
+  if (this->_sws != nullptr) {
+    sws_freeContext(this->_sws);
+    this->_sws = nullptr;
+  }
+  if (this->_swr != nullptr) {
+    swr_free(&this->_swr);
+  }
+  this->_audio_key = {};
+}
+
+void w_av_converter::_move(w_av_converter &&p_other) noexcept {
+  if (this == &p_other) {
+    return;
+  }
+  _release();
+
+  this->_algorithm = p_other._algorithm;
+  this->_simd_level = p_other._simd_level;
+  this->_slice_pool = std::move(p_other._slice_pool);
+  this->_sws = std::exchange(p_other._sws, nullptr);
+  this->_swr = std::exchange(p_other._swr, nullptr);
+  this->_audio_key = std::exchange(p_other._audio_key, {});
+}
+
+void w_av_converter::set_algorithm(_In_ w_av_scale_algorithm p_algorithm) noexcept {
+  this->_algorithm = p_algorithm;
+}
+
+w_av_scale_algorithm w_av_converter::get_algorithm() const noexcept { return this->_algorithm; }
+
+boost::leaf::result<int> w_av_converter::set_simd_level(_In_ w_av_simd_level p_level) noexcept {
+  if (!w_av_color_kernels::is_available(p_level)) {
+    return W_FAILURE(std::errc::not_supported, "the simd level {} is not available on this cpu",
+                     static_cast<int>(p_level));
+  }
+  this->_simd_level = p_level;
+  return 0;
+}
+
+w_av_simd_level w_av_converter::get_simd_level() const noexcept { return this->_simd_level; }
+
+boost::leaf::result<int> w_av_converter::set_slice_threads(_In_ size_t p_threads) noexcept {
+  try {
+    this->_slice_pool.reset();
+    if (p_threads > 1) {
+      this->_slice_pool = std::make_unique<w_thread_pool>(p_threads);
+    }
+    return 0;
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::resource_unavailable_try_again,
+                     "could not create the slice threads of w_av_converter because: {}",
+                     p_exc.what());
+  }
+}
+
+boost::leaf::result<w_av_frame> w_av_converter::convert_video(_In_ const w_av_frame &p_src,
+                                                              _In_ w_av_config &&p_dst_config,
+                                                              _Inout_ w_av_frame_pool *p_pool) {
+  // create a buffer and dst frame
+  auto _dst_frame = w_av_frame(std::move(p_dst_config));
+  BOOST_LEAF_CHECK(_dst_frame.init());
+  if (p_pool != nullptr) {
+    BOOST_LEAF_CHECK(_dst_frame.set_video_frame(*p_pool));
+  } else {
+    BOOST_LEAF_CHECK(_dst_frame.set_video_frame(std::vector<uint8_t>()));
+  }
+  BOOST_LEAF_CHECK(convert_video(p_src, _dst_frame));
+  return _dst_frame;
+}
+
+boost::leaf::result<int> w_av_converter::convert_video(_In_ const w_av_frame &p_src,
+                                                       _Inout_ w_av_frame &p_dst) noexcept {
+  const AVFrame *_src = p_src._av_frame;
+  AVFrame *_dst = p_dst._av_frame;
+  if (_src == nullptr || _dst == nullptr || _dst->data[0] == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the source and the destination frames of w_av_converter must be "
+                     "initialized and the destination must have a buffer");
+  }
+
+  // the decoded frames carry their own shape
+  const auto _src_width = _src->width > 0 ? _src->width : p_src._config.width;
+  const auto _src_height = _src->height > 0 ? _src->height : p_src._config.height;
+  const auto _src_format =
+      _src->format >= 0 ? gsl::narrow_cast<AVPixelFormat>(_src->format) : p_src._config.format;
+
+  // the hot conversions which do not scale have their own kernels
+  if (this->_simd_level != w_av_simd_level::none && _src->width == _dst->width &&
+      _src->height == _dst->height &&
+      w_av_color_kernels::is_supported(gsl::narrow_cast<AVPixelFormat>(_src->format),
+                                       gsl::narrow_cast<AVPixelFormat>(_dst->format))) {
+    return w_av_color_kernels::convert(_src, _dst, this->_simd_level, this->_slice_pool.get());
+  }
+
+  // the context is only rebuilt when the shapes or the algorithm change
+  this->_sws = sws_getCachedContext(this->_sws, _src_width, _src_height, _src_format,
+                                    p_dst._config.width, p_dst._config.height,
+                                    p_dst._config.format, static_cast<int>(this->_algorithm),
+                                    nullptr, nullptr, nullptr);
+  if (this->_sws == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not create sws context");
+  }
+
+  const auto _height =
+      sws_scale(this->_sws, gsl::narrow_cast<const uint8_t *const *>(_src->data),
+                gsl::narrow_cast<const int *>(_src->linesize), 0, _src_height,
+                gsl::narrow_cast<uint8_t *const *>(_dst->data),
+                gsl::narrow_cast<const int *>(_dst->linesize));
+  if (_height < 0) {
+    return W_FAILURE(std::errc::invalid_argument, "w_av_converter sws_scale failed because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_height));
+  }
+  return _height;
+}
+
+boost::leaf::result<w_av_frame> w_av_converter::convert_audio(_In_ const w_av_frame &p_src,
+                                                              _In_ w_av_config &&p_dst_config) {
+  const AVFrame *_src = p_src._av_frame;
+  if (_src == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the source frame is not initialized");
+  }
+
+  auto _dst_frame = w_av_frame(std::move(p_dst_config));
+  BOOST_LEAF_CHECK(_dst_frame.init());
+  AVFrame *_dst = _dst_frame._av_frame;
+  const auto &_dst_config = _dst_frame._config;
+
+  const auto _key =
+      w_audio_key{_src->format,           _src->sample_rate,
+                  _src->ch_layout.nb_channels, gsl::narrow_cast<int>(_dst_config.sample_fmts),
+                  _dst_config.sample_rate, _dst_config.nb_channels};
+  if (this->_swr == nullptr || _key != this->_audio_key) {
+    swr_free(&this->_swr);
+
+    auto _ret = swr_alloc_set_opts2(&this->_swr, &_dst->ch_layout, _dst_config.sample_fmts,
+                                    _dst_config.sample_rate, &_src->ch_layout,
+                                    gsl::narrow_cast<AVSampleFormat>(_src->format),
+                                    _src->sample_rate, 0, nullptr);
+    if (_ret < 0 || this->_swr == nullptr) {
+      swr_free(&this->_swr);
+      return W_FAILURE(std::errc::operation_canceled, "could not create audio SwrContext");
+    }
+
+    _ret = swr_init(this->_swr);
+    if (_ret < 0) {
+      swr_free(&this->_swr);
+      return W_FAILURE(std::errc::operation_canceled,
+                       "could not initialize audio SwrContext because: {}",
+                       w_ffmpeg_ctx::get_av_error_str(_ret));
+    }
+    this->_audio_key = _key;
+  }
+
+  // the destination holds the delayed samples and the new ones
+  const auto _src_sample_rate = gsl::narrow_cast<int64_t>(_src->sample_rate);
+  const auto _nb_samples = av_rescale_rnd(swr_get_delay(this->_swr, _src_sample_rate) +
+                                              _src->nb_samples,
+                                          gsl::narrow_cast<int64_t>(_dst_config.sample_rate),
+                                          _src_sample_rate, AV_ROUND_UP);
+
+  _dst->format = gsl::narrow_cast<int>(_dst_config.sample_fmts);
+  _dst->nb_samples = gsl::narrow_cast<int>(_nb_samples);
+  auto _ret = av_frame_get_buffer(_dst, 0);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not allocate memory for buffer of audio");
+  }
+
+  _ret = swr_convert(this->_swr, gsl::narrow_cast<uint8_t **>(_dst->data), _dst->nb_samples,
+                     (const uint8_t **)(_src->extended_data), _src->nb_samples);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "error while audio converting because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+  _dst->nb_samples = _ret;
+
+  return _dst_frame;
+}
+
+#endif  // WOLF_MEDIA_FFMPEG
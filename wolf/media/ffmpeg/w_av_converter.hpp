@@ -0,0 +1,166 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+#include <wolf/system/w_thread_pool.hpp>
+
+#include "w_av_color_kernels.hpp"
+#include "w_av_frame.hpp"
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <memory>
+
+struct SwrContext;
+
+namespace wolf::media::ffmpeg {
+
+/*
+ * the scaling algorithm of video conversion
+ */
+enum class w_av_scale_algorithm : int {
+  fast_bilinear = SWS_FAST_BILINEAR,
+  bilinear = SWS_BILINEAR,
+  bicubic = SWS_BICUBIC,
+  point = SWS_POINT,
+  area = SWS_AREA,
+  lanczos = SWS_LANCZOS,
+};
+
+/*
+ * convert video and audio frames with the swscale and swresample contexts
+ * which are created once and reused. the video context is rebuilt only when
+ * the formats, sizes or algorithm change, the audio context keeps its
+ * delayed samples between calls, so one converter should be used per
+ * stream. the video conversions of w_av_color_kernels::is_supported without
+ * scaling use the simd kernels instead of swscale, their rows can be split
+ * across slice threads. an instance must not be used by several threads at
+ * the same time.
+ */
+class w_av_converter {
+ public:
+  /*
+   * constructor
+   * @param p_algorithm, the scaling algorithm of video frames
+   */
+  W_API explicit w_av_converter(
+      _In_ w_av_scale_algorithm p_algorithm = w_av_scale_algorithm::bicubic) noexcept;
+
+  // destructor
+  W_API virtual ~w_av_converter() noexcept { _release(); }
+
+  // move constructor.
+  W_API w_av_converter(w_av_converter &&p_other) noexcept {
+    _move(std::forward<w_av_converter &&>(p_other));
+  }
+  // move assignment operator.
+  W_API w_av_converter &operator=(w_av_converter &&p_other) noexcept {
+    _move(std::forward<w_av_converter &&>(p_other));
+    return *this;
+  }
+
+  /*
+   * convert a video frame into a new frame
+   * @param p_src, the source frame
+   * @param p_dst_config, the config of destination frame
+   * @param p_pool, an optional pool for the buffer of destination
+   * @returns the converted frame
+   */
+  W_API boost::leaf::result<w_av_frame> convert_video(_In_ const w_av_frame &p_src,
+                                                      _In_ w_av_config &&p_dst_config,
+                                                      _Inout_ w_av_frame_pool *p_pool = nullptr);
+
+  /*
+   * convert a video frame into an initialized frame whose buffer was set by
+   * set_video_frame, nothing is allocated while the shapes do not change
+   * @param p_src, the source frame
+   * @param p_dst, the destination frame
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> convert_video(_In_ const w_av_frame &p_src,
+                                               _Inout_ w_av_frame &p_dst) noexcept;
+
+  /*
+   * convert an audio frame into a new frame, the samples which are delayed
+   * by resampling are returned with the next call
+   * @param p_src, the source frame
+   * @param p_dst_config, the config of destination frame
+   * @returns the converted frame
+   */
+  W_API boost::leaf::result<w_av_frame> convert_audio(_In_ const w_av_frame &p_src,
+                                                      _In_ w_av_config &&p_dst_config);
+
+  /*
+   * set the scaling algorithm, the video context will be rebuilt by the
+   * next conversion
+   * @param p_algorithm, the scaling algorithm
+   */
+  W_API void set_algorithm(_In_ w_av_scale_algorithm p_algorithm) noexcept;
+
+  // returns the scaling algorithm
+  W_API w_av_scale_algorithm get_algorithm() const noexcept;
+
+  /*
+   * set the kernels of the conversions which do not scale, none sends every
+   * conversion to swscale. the default is the best level of this cpu
+   * @param p_level, an available level
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> set_simd_level(_In_ w_av_simd_level p_level) noexcept;
+
+  // returns the level of kernels
+  W_API w_av_simd_level get_simd_level() const noexcept;
+
+  /*
+   * split the rows of the kernel conversions across threads, the threads are
+   * owned by this converter and sleep between the frames
+   * @param p_threads, number of threads including the calling one, zero or
+   * one converts on the calling thread
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> set_slice_threads(_In_ size_t p_threads) noexcept;
+
+ private:
+  // copy constructor.
+  w_av_converter(const w_av_converter &) = delete;
+  // copy assignment operator.
+  w_av_converter &operator=(const w_av_converter &) = delete;
+
+  // release
+  void _release() noexcept;
+  // move
+  void _move(w_av_converter &&p_other) noexcept;
+
+  // the shape of audio which the resampling context was built for
+  struct w_audio_key {
+    int src_format = -1;
+    int src_sample_rate = 0;
+    int src_channels = 0;
+    int dst_format = -1;
+    int dst_sample_rate = 0;
+    int dst_channels = 0;
+
+    bool operator==(const w_audio_key &) const noexcept = default;
+  };
+
+  w_av_scale_algorithm _algorithm = w_av_scale_algorithm::bicubic;
+  w_av_simd_level _simd_level = w_av_color_kernels::get_simd_level();
+  // the threads of slices, null converts on the calling thread
+  std::unique_ptr<wolf::system::w_thread_pool> _slice_pool;
+  // the scaling context, it is checked by sws_getCachedContext
+  gsl::owner<SwsContext *> _sws = nullptr;
+  // the resampling context
+  gsl::owner<SwrContext *> _swr = nullptr;
+  w_audio_key _audio_key = {};
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
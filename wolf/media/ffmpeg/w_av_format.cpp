@@ -1,105 +1,360 @@
 #ifdef WOLF_MEDIA_FFMPEG
 
 #include "w_av_format.hpp"
-#include "w_av_frame.hpp"
+#include "w_ffmpeg_ctx.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using w_av_format = wolf::media::ffmpeg::w_av_format;
+using w_av_io_config = wolf::media::ffmpeg::w_av_io_config;
+using w_av_packet = wolf::media::ffmpeg::w_av_packet;
+using w_ffmpeg_ctx = wolf::media::ffmpeg::w_ffmpeg_ctx;
 
-w_av_format::w_av_format() noexcept
-    : _stream_buffer(nullptr), _fmt_ctx(nullptr), _io_ctx(nullptr) {}
+/*
+ * a ring which a thread fills from on_read_callback. the source is only
+ * touched while source_mutex is held, so a seek waits for the read in
+ * flight and then drops the data which was read ahead of the new position.
+ */
+struct w_av_format::w_read_ahead {
+  explicit w_read_ahead(_In_ size_t p_size) : ring(p_size) {}
 
-void w_av_format::_release() noexcept {
-  if (this->_stream_buffer != nullptr) {
-    auto _ptr = this->_stream_buffer.get();
-    free(_ptr);
-    this->_stream_buffer = nullptr;
+  // copy up to p_size bytes to the demuxer
+  int read(_Inout_ uint8_t *p_buf, _In_ int p_size) {
+    std::unique_lock _lock(this->ring_mutex);
+    this->cv.wait(_lock, [&]() { return this->stop || this->size > 0 || this->status != 0; });
+    if (this->size == 0) {
+      return this->stop ? AVERROR_EXIT : this->status;
+    }
+
+    const auto _capacity = this->ring.size();
+    const auto _count = std::min(this->size, gsl::narrow_cast<size_t>(p_size));
+    const auto _first = std::min(_count, _capacity - this->head);
+    std::memcpy(p_buf, this->ring.data() + this->head, _first);
+    std::memcpy(p_buf + _first, this->ring.data(), _count - _first);
+
+    this->head = (this->head + _count) % _capacity;
+    this->size -= _count;
+    _lock.unlock();
+    this->cv.notify_all();
+
+    return gsl::narrow_cast<int>(_count);
   }
+
+  std::vector<uint8_t> ring;
+  size_t head = 0;
+  size_t size = 0;
+  // it changes with every seek
+  uint64_t generation = 0;
+  // AVERROR_EOF or the error of source
+  int status = 0;
+  bool stop = false;
+
+  std::mutex source_mutex;
+  std::mutex ring_mutex;
+  std::condition_variable cv;
+  std::thread thread;
+};
+
+w_av_format::w_av_format() noexcept = default;
+
+w_av_format::~w_av_format() noexcept { _release(); }
+
+void w_av_format::_release() noexcept {
   if (this->_fmt_ctx != nullptr) {
-    auto _ptr = this->_fmt_ctx.get();
-    avformat_close_input(&_ptr);
-    this->_stream_buffer = nullptr;
+    // the custom io is not closed by avformat
+    avformat_close_input(&this->_fmt_ctx);
+  }
+
+  if (this->_read_ahead != nullptr) {
+    {
+      std::scoped_lock _lock(this->_read_ahead->ring_mutex);
+      this->_read_ahead->stop = true;
+    }
+    this->_read_ahead->cv.notify_all();
+    if (this->_read_ahead->thread.joinable()) {
+      this->_read_ahead->thread.join();
+    }
+    this->_read_ahead.reset();
   }
+
   if (this->_io_ctx != nullptr) {
-    auto _ptr = this->_io_ctx.get();
-    av_free(_ptr);
-    this->_stream_buffer = nullptr;
+    // avio may have replaced the buffer which was passed to it
+    av_freep(&this->_io_ctx->buffer);
+    avio_context_free(&this->_io_ctx);
   }
+
+  this->_data = nullptr;
+  this->_data_size = 0;
+  this->_position = 0;
 }
 
-static int s_read_packet(void *p_opaque, _Inout_ uint8_t *p_buf, _In_ int p_buf_size) {
-  auto _av_fmt = gsl::narrow_cast<w_av_format *>(p_opaque);
-  if (_av_fmt) {
-    if (_av_fmt->on_read_callback) {
-      return _av_fmt->on_read_callback(p_buf, p_buf_size);
+int w_av_format::_read(_In_ void *p_opaque, _Inout_ uint8_t *p_buf,
+                       _In_ int p_buf_size) noexcept {
+  auto *_fmt = gsl::narrow_cast<w_av_format *>(p_opaque);
+
+  int _ret = 0;
+  if (_fmt->_data != nullptr) {
+    const auto _remaining = _fmt->_data_size - gsl::narrow_cast<size_t>(_fmt->_position);
+    _ret = gsl::narrow_cast<int>(std::min(_remaining, gsl::narrow_cast<size_t>(p_buf_size)));
+    std::memcpy(p_buf, _fmt->_data + _fmt->_position, _ret);
+  } else if (_fmt->_read_ahead != nullptr) {
+    _ret = _fmt->_read_ahead->read(p_buf, p_buf_size);
+  } else {
+    try {
+      _ret = _fmt->on_read_callback(p_buf, p_buf_size);
+    } catch (...) {
+      return AVERROR_EXTERNAL;
     }
   }
-  return -1;  // failed
+
+  if (_ret == 0) {
+    return AVERROR_EOF;
+  }
+  if (_ret > 0) {
+    _fmt->_position += _ret;
+  }
+  return _ret;
 }
 
-boost::leaf::result<int> w_av_format::init(_In_ int p_stream_buf_size) noexcept {
-  _release();
+int64_t w_av_format::_seek(_In_ void *p_opaque, _In_ int64_t p_offset,
+                           _In_ int p_whence) noexcept {
+  auto *_fmt = gsl::narrow_cast<w_av_format *>(p_opaque);
+  const auto _whence = p_whence & ~AVSEEK_FORCE;
+
+  if (_fmt->_data != nullptr) {
+    const auto _size = gsl::narrow_cast<int64_t>(_fmt->_data_size);
+    int64_t _target = 0;
+    switch (_whence) {
+      case AVSEEK_SIZE:
+        return _size;
+      case SEEK_SET:
+        _target = p_offset;
+        break;
+      case SEEK_CUR:
+        _target = _fmt->_position + p_offset;
+        break;
+      case SEEK_END:
+        _target = _size + p_offset;
+        break;
+      default:
+        return AVERROR(EINVAL);
+    }
+    if (_target < 0 || _target > _size) {
+      return AVERROR(EINVAL);
+    }
+    _fmt->_position = _target;
+    return _target;
+  }
+
+  // the source is ahead of the demuxer when it is read ahead, so the
+  // relative seeks are turned into absolute ones
+  auto _offset = p_offset;
+  auto _source_whence = _whence;
+  if (_whence == SEEK_CUR) {
+    _offset = _fmt->_position + p_offset;
+    _source_whence = SEEK_SET;
+  }
+
+  int64_t _ret = 0;
+  try {
+    if (_fmt->_read_ahead == nullptr) {
+      _ret = _fmt->on_seek_callback(_offset, _source_whence);
+    } else {
+      auto &_read_ahead = *_fmt->_read_ahead;
+      std::scoped_lock _source_lock(_read_ahead.source_mutex);
+      _ret = _fmt->on_seek_callback(_offset, _source_whence);
+      if (_ret >= 0 && _whence != AVSEEK_SIZE) {
+        {
+          std::scoped_lock _lock(_read_ahead.ring_mutex);
+          _read_ahead.head = 0;
+          _read_ahead.size = 0;
+          _read_ahead.status = 0;
+          _read_ahead.generation++;
+        }
+        _read_ahead.cv.notify_all();
+      }
+    }
+  } catch (...) {
+    return AVERROR_EXTERNAL;
+  }
+
+  if (_ret >= 0 && _whence != AVSEEK_SIZE) {
+    _fmt->_position = _ret;
+  }
+  return _ret;
+}
+
+void w_av_format::_read_ahead_loop() noexcept {
+  auto &_read_ahead = *this->_read_ahead;
+
+  for (;;) {
+    uint8_t *_dst = nullptr;
+    size_t _size = 0;
+    uint64_t _generation = 0;
+    {
+      // wait for free space, without holding the source
+      std::unique_lock _lock(_read_ahead.ring_mutex);
+      _read_ahead.cv.wait(_lock, [&]() {
+        return _read_ahead.stop ||
+               (_read_ahead.status == 0 && _read_ahead.size < _read_ahead.ring.size());
+      });
+      if (_read_ahead.stop) {
+        return;
+      }
+      const auto _capacity = _read_ahead.ring.size();
+      const auto _tail = (_read_ahead.head + _read_ahead.size) % _capacity;
+      _dst = _read_ahead.ring.data() + _tail;
+      _size = std::min(_capacity - _read_ahead.size, _capacity - _tail);
+      _generation = _read_ahead.generation;
+    }
 
-  // alloc a buffer for the stream
-  auto _ptr = gsl::narrow_cast<uint8_t *>(malloc(p_stream_buf_size));
-  if (_ptr == nullptr) {
-    // out of memory
+    std::scoped_lock _source_lock(_read_ahead.source_mutex);
+    {
+      // a seek between the two locks moved the ring
+      std::scoped_lock _lock(_read_ahead.ring_mutex);
+      if (_read_ahead.stop || _generation != _read_ahead.generation) {
+        continue;
+      }
+    }
+
+    // the free space is not touched by the demuxer, so it is filled without a lock
+    int _ret = 0;
+    try {
+      _ret = this->on_read_callback(_dst, gsl::narrow_cast<int>(std::min<size_t>(_size, INT_MAX)));
+    } catch (...) {
+      _ret = AVERROR_EXTERNAL;
+    }
+
+    {
+      std::scoped_lock _lock(_read_ahead.ring_mutex);
+      if (_ret > 0) {
+        _read_ahead.size += gsl::narrow_cast<size_t>(_ret);
+      } else {
+        _read_ahead.status = _ret == 0 ? AVERROR_EOF : _ret;
+      }
+    }
+    _read_ahead.cv.notify_all();
+  }
+}
+
+boost::leaf::result<int> w_av_format::_open(_In_ const w_av_io_config &p_config) noexcept {
+  if (p_config.buffer_size <= 0) {
+    return W_FAILURE(std::errc::invalid_argument, "the buffer size of io must be positive");
+  }
+
+  // alloc a buffer for the stream, avio owns it from now on
+  auto *_buffer = gsl::narrow_cast<uint8_t *>(av_malloc(p_config.buffer_size));
+  if (_buffer == nullptr) {
     return W_FAILURE(std::errc::not_enough_memory, "could not allocate memory for stream buffer");
   }
-  this->_stream_buffer.reset(_ptr);
-
-  // get a AVContext stream
-  auto _io_ctx_ptr =
-      avio_alloc_context(this->_stream_buffer.get(),  // buffer
-                         p_stream_buf_size,           // buffer size
-                         0,              // buffer is only readable - set to 1 for read/write
-                         this,           // use your specified data
-                         s_read_packet,  // function - reading Packets (see example)
-                         nullptr,        // function - write Packets
-                         nullptr         // function - seek to position in stream (see example)
-      );
-  if (_io_ctx_ptr == nullptr) {
-    // out of memory
+
+  // the source is seekable if it is memory or it has a seek callback
+  const auto _seekable = this->_data != nullptr || this->on_seek_callback != nullptr;
+  this->_io_ctx = avio_alloc_context(_buffer, p_config.buffer_size, 0, this, &_read, nullptr,
+                                     _seekable ? &_seek : nullptr);
+  if (this->_io_ctx == nullptr) {
+    av_free(_buffer);
     return W_FAILURE(std::errc::not_enough_memory, "could not allocate io context");
   }
-  this->_io_ctx.reset(_io_ctx_ptr);
 
-  // allocate a AVContext
-  auto _fmt_ctx_ptr = avformat_alloc_context();
-  if (_fmt_ctx_ptr == nullptr) {
-    // out of memory
+  if (this->_data == nullptr && p_config.read_ahead_size > 0) {
+    try {
+      this->_read_ahead = std::make_unique<w_read_ahead>(p_config.read_ahead_size);
+      this->_read_ahead->thread = std::thread([this]() { _read_ahead_loop(); });
+    } catch (const std::exception &p_exc) {
+      this->_read_ahead.reset();
+      return W_FAILURE(std::errc::resource_unavailable_try_again,
+                       "could not start the read-ahead of io because: {}", p_exc.what());
+    }
+  }
+
+  this->_fmt_ctx = avformat_alloc_context();
+  if (this->_fmt_ctx == nullptr) {
     return W_FAILURE(std::errc::not_enough_memory, "could not allocate avformat context");
   }
-  this->_fmt_ctx.reset(_fmt_ctx_ptr);
 
-  // Set up the format context based on custom IO
-  this->_fmt_ctx->pb = _io_ctx_ptr;
+  // set up the format context based on custom IO
+  this->_fmt_ctx->pb = this->_io_ctx;
   this->_fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
 
-  // open "file" (open our custom IO)
-  // empty string is where filename would go. doesn't matter since we aren't
-  // reading a file NULL params are format and demuxer settings, respectively
-  if (avformat_open_input(&_fmt_ctx_ptr, "", nullptr, nullptr) < 0) {
-    // error on opening input
-    return W_FAILURE(std::errc::not_enough_memory, "could not allocate io context");
+  // the context is freed by avformat_open_input when it fails
+  auto _ret = avformat_open_input(&this->_fmt_ctx, "", nullptr, nullptr);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not open the input of io because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
   }
 
-  // find the stream info
-  if (avformat_find_stream_info(_fmt_ctx_ptr, nullptr) < 0) {
-    // Error on finding stream info
-    return W_FAILURE(std::errc::operation_canceled, "could not get stream info");
+  _ret = avformat_find_stream_info(this->_fmt_ctx, nullptr);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not get stream info because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
   }
 
   // find best stream
-  const auto _ret =
-      av_find_best_stream(_fmt_ctx_ptr, AVMediaType::AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+  _ret = av_find_best_stream(this->_fmt_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
   if (_ret < 0) {
-    // Error on finding stream info
     return W_FAILURE(std::errc::operation_canceled, "could not find best stream");
   }
 
   return 0;
 }
 
+boost::leaf::result<int> w_av_format::init(_In_ int p_stream_buf_size) noexcept {
+  auto _config = w_av_io_config{};
+  _config.buffer_size = p_stream_buf_size;
+  return init(_config);
+}
+
+boost::leaf::result<int> w_av_format::init(_In_ const w_av_io_config &p_config) noexcept {
+  _release();
+
+  if (this->on_read_callback == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "missing on_read_callback of w_av_format");
+  }
+  return _open(p_config);
+}
+
+boost::leaf::result<int> w_av_format::init(_In_ const uint8_t *p_data, _In_ size_t p_size,
+                                           _In_ const w_av_io_config &p_config) noexcept {
+  _release();
+
+  if (p_data == nullptr || p_size == 0) {
+    return W_FAILURE(std::errc::invalid_argument, "the memory of w_av_format is empty");
+  }
+  this->_data = p_data;
+  this->_data_size = p_size;
+  return _open(p_config);
+}
+
+boost::leaf::result<bool> w_av_format::read_packet(_Inout_ w_av_packet &p_packet) noexcept {
+  if (this->_fmt_ctx == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "w_av_format is not initialized");
+  }
+  if (p_packet._packet == nullptr) {
+    BOOST_LEAF_CHECK(p_packet.init());
+  } else {
+    p_packet.unref();
+  }
+
+  const auto _ret = av_read_frame(this->_fmt_ctx, p_packet._packet);
+  if (_ret == AVERROR_EOF) {
+    return false;
+  }
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not read packet because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+  return true;
+}
+
+AVFormatContext *w_av_format::get_format_ctx() const noexcept { return this->_fmt_ctx; }
+
 uint8_t *w_av_format::get_io_ctx_buffer() const {
   if (this->_io_ctx) {
     return this->_io_ctx->buffer;
@@ -114,4 +369,4 @@ int w_av_format::get_io_ctx_size() const {
   return -1;
 }
 
-#endif // WOLF_MEDIA_FFMPEG
\ No newline at end of file
+#endif  // WOLF_MEDIA_FFMPEG
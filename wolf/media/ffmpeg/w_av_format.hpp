@@ -9,42 +9,117 @@
 
 #include <wolf/wolf.hpp>
 
+#include "w_av_packet.hpp"
+
 extern "C" {
 #include <libavformat/avformat.h>
 }
 
+#include <functional>
+#include <memory>
+
 namespace wolf::media::ffmpeg {
+
+struct w_av_io_config {
+  // the size of AVIO buffer, a larger one means fewer reads of the source
+  int buffer_size = 32'768;
+  // the size of a ring which a thread fills from on_read_callback ahead of
+  // the demuxer, zero reads on the thread of demuxer. memory sources ignore it
+  size_t read_ahead_size = 0;
+};
+
+/*
+ * demux from a custom source through an AVIOContext. the source is either a
+ * memory buffer or on_read_callback with an optional on_seek_callback, the
+ * containers which need seeking such as mp4 with a moov atom at the end can
+ * be demuxed when the source is seekable. the AVIOContext refers to this
+ * instance, so it can not be moved.
+ */
 class w_av_format {
  public:
 #pragma region Constructors /Destructor
   W_API w_av_format() noexcept;
-  W_API ~w_av_format() noexcept { _release(); };
-  // move constructor.
-  W_API w_av_format(w_av_format &&p_other) noexcept = default;
-  // move assignment operator.
-  W_API w_av_format &operator=(w_av_format &&p_other) noexcept = default;
+  W_API ~w_av_format() noexcept;
 #pragma endregion
 
-  boost::leaf::result<int> init(_In_ int p_stream_buf_size = 32'767) noexcept;
+  /*
+   * open the source of on_read_callback and on_seek_callback
+   * @param p_stream_buf_size, the size of AVIO buffer
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> init(_In_ int p_stream_buf_size = 32'767) noexcept;
+
+  /*
+   * open the source of on_read_callback and on_seek_callback
+   * @param p_config, the config of io
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> init(_In_ const w_av_io_config &p_config) noexcept;
+
+  /*
+   * open a memory buffer, it is seekable and must outlive this instance
+   * @param p_data, the data of container
+   * @param p_size, the size of data
+   * @param p_config, the config of io
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> init(_In_ const uint8_t *p_data, _In_ size_t p_size,
+                                      _In_ const w_av_io_config &p_config = {}) noexcept;
+
+  /*
+   * read the next packet of any stream
+   * @param p_packet, the packet
+   * @returns false at the end of source
+   */
+  W_API boost::leaf::result<bool> read_packet(_Inout_ w_av_packet &p_packet) noexcept;
+
+  // returns the format context, it is valid until the next init
+  W_API AVFormatContext *get_format_ctx() const noexcept;
 
   uint8_t *get_io_ctx_buffer() const;
   int get_io_ctx_size() const;
 
+  // read up to p_buf_size bytes, returns the number of bytes, zero or
+  // AVERROR_EOF at the end, or a negative AVERROR
   std::function<int(_Inout_ uint8_t * /*p_buf*/, _In_ int /*p_buf_size*/)>
       on_read_callback;
 
+  // seek like fseek with SEEK_SET, SEEK_CUR or SEEK_END and return the new
+  // position, for AVSEEK_SIZE return the size of source. it is optional
+  std::function<int64_t(_In_ int64_t /*p_offset*/, _In_ int /*p_whence*/)>
+      on_seek_callback;
+
  private:
   // copy constructor.
   w_av_format(const w_av_format &) = delete;
   // copy assignment operator.
   w_av_format &operator=(const w_av_format &) = delete;
+  // the AVIOContext refers to this instance
+  w_av_format(w_av_format &&) = delete;
+  w_av_format &operator=(w_av_format &&) = delete;
 
+  // the callbacks of AVIOContext
+  static int _read(_In_ void *p_opaque, _Inout_ uint8_t *p_buf, _In_ int p_buf_size) noexcept;
+  static int64_t _seek(_In_ void *p_opaque, _In_ int64_t p_offset, _In_ int p_whence) noexcept;
+
+  // create the io and open the input
+  boost::leaf::result<int> _open(_In_ const w_av_io_config &p_config) noexcept;
+  // fill the ring of read-ahead
+  void _read_ahead_loop() noexcept;
   // release
   void _release() noexcept;
 
-  std::unique_ptr<uint8_t[]> _stream_buffer = nullptr;
-  std::unique_ptr<AVFormatContext> _fmt_ctx = nullptr;
-  std::unique_ptr<AVIOContext> _io_ctx = nullptr;
+  struct w_read_ahead;
+
+  gsl::owner<AVFormatContext *> _fmt_ctx = nullptr;
+  gsl::owner<AVIOContext *> _io_ctx = nullptr;
+  std::unique_ptr<w_read_ahead> _read_ahead;
+
+  // the memory source
+  const uint8_t *_data = nullptr;
+  size_t _data_size = 0;
+  // the position which the demuxer has read up to
+  int64_t _position = 0;
 };
 }  // namespace wolf::media::ffmpeg
 
@@ -1,6 +1,7 @@
 #ifdef WOLF_MEDIA_FFMPEG
 
 #include "w_av_frame.hpp"
+#include "w_av_converter.hpp"
 #include "w_ffmpeg_ctx.hpp"
 
 extern "C" {
@@ -16,15 +17,17 @@ extern "C" {
 
 using w_av_frame = wolf::media::ffmpeg::w_av_frame;
 using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_scale_algorithm = wolf::media::ffmpeg::w_av_scale_algorithm;
+using w_av_frame_pool = wolf::media::ffmpeg::w_av_frame_pool;
+using w_ffmpeg_ctx = wolf::media::ffmpeg::w_ffmpeg_ctx;
 
 w_av_frame::w_av_frame(_In_ w_av_config &&p_config) noexcept : _config(std::move(p_config)) {}
 
 void w_av_frame::_release() noexcept {
   if (this->_av_frame != nullptr) {
+    // it also uninitializes the channel layout
     av_frame_free(&this->_av_frame);
-    if (this->_config.nb_channels > 0) {
-      av_channel_layout_uninit(&this->_av_frame->ch_layout);
-    }
   }
 }
 
@@ -32,6 +35,8 @@ void w_av_frame::_move(w_av_frame &&p_other) noexcept {
   if (this == &p_other) {
     return;
   }
+  _release();
+
   this->_av_frame = std::exchange(p_other._av_frame, nullptr);
   this->_config = std::move(p_other._config);
   this->_data = std::move(p_other._data);
@@ -71,6 +76,9 @@ boost::leaf::result<int> w_av_frame::set_video_frame(
     return W_FAILURE(std::errc::invalid_argument, "width or height of w_av_frame is zero");
   }
 
+  // the frame does not refer to a pooled buffer anymore
+  _unref_buffers();
+
   // move the owenership of data to buffer
   this->_data = std::forward<std::vector<uint8_t> &&>(p_data);
 
@@ -96,130 +104,99 @@ boost::leaf::result<int> w_av_frame::set_video_frame(
   return _ret;
 }
   
-void w_av_frame::set_pts(_In_ int64_t p_pts) noexcept { this->_av_frame->pts = p_pts; }
-
-std::tuple<uint8_t **, int> w_av_frame::get() const noexcept {
-  if (this->_av_frame) {
-    auto _buffer_size =
-        av_image_get_buffer_size(gsl::narrow_cast<AVPixelFormat>(this->_av_frame->format),
-                                 this->_av_frame->width, this->_av_frame->height, 4);
+boost::leaf::result<int> w_av_frame::set_video_frame(_Inout_ w_av_frame_pool &p_pool) noexcept {
+  if (this->_av_frame == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "w_av_frame is not initialized");
+  }
+  if (this->_config.width <= 0 || this->_config.height <= 0) {
+    return W_FAILURE(std::errc::invalid_argument, "width or height of w_av_frame is zero");
+  }
 
-    return std::make_tuple(this->_av_frame->data, _buffer_size);
+  const auto _buffer_size = this->_config.get_required_video_buffer_size();
+  if (_buffer_size <= 0) {
+    return W_FAILURE(std::errc::invalid_argument, "could not get the buffer size of w_av_frame");
   }
-  return std::make_tuple(nullptr, 0);
-}
 
-w_av_config w_av_frame::get_config() const noexcept { return this->_config; }
+  // the previous buffer goes back to its pool
+  _unref_buffers();
+  this->_data = {};
 
-boost::leaf::result<w_av_frame> w_av_frame::convert_audio(_In_ w_av_config &&p_dst_config) {
-  auto _ret = 0;
-
-  SwrContext *swr = nullptr;
-  auto _dst_frame = w_av_frame(std::move(p_dst_config));
-  _dst_frame.init();
-
-  DEFER {
-    if (_ret) {
-      if (swr) {
-        if (swr_is_initialized(swr)) {
-          swr_close(swr);
-        }
-        swr_free(&swr);
-      }
-    }
-  });
+  BOOST_LEAF_AUTO(_buffer, p_pool.acquire(gsl::narrow_cast<size_t>(_buffer_size)));
+  this->_av_frame->buf[0] = _buffer;
 
-  swr_alloc_set_opts2(&swr, &this->_channel_layout, p_dst_config.sample_fmts,
-                      p_dst_config.sample_rate, &this->_av_frame->ch_layout,
-                      gsl::narrow_cast<AVSampleFormat>(this->_av_frame->format),
-                      this->_av_frame->sample_rate, 0, nullptr);
+  const auto _ret = av_image_fill_arrays(this->_av_frame->data, this->_av_frame->linesize,
+                                         _buffer->data, this->_config.format,
+                                         this->_config.width, this->_config.height,
+                                         this->_config.alignment);
+  if (_ret < 0) {
+    _unref_buffers();
+    return W_FAILURE(std::errc::operation_canceled, "av_image_fill_arrays failed");
+  }
+  return _ret;
+}
 
-  if (swr == nullptr) {
-    _ret = -1;
-    return W_FAILURE(std::errc::operation_canceled, "could not create audio SwrContext");
+boost::leaf::result<w_av_frame> w_av_frame::ref() const noexcept {
+  if (this->_av_frame == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "w_av_frame is not initialized");
   }
 
-  _ret = swr_init(swr);
+  auto _frame = w_av_frame(w_av_config(this->_config));
+  _frame._av_frame = av_frame_alloc();
+  if (_frame._av_frame == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate memory for AVFrame");
+  }
 
+  // the frames which are not refcounted are copied
+  const auto _ret = av_frame_ref(_frame._av_frame, this->_av_frame);
   if (_ret < 0) {
-    return W_FAILURE(std::errc::operation_canceled, "could not initialize audio SwrContext");
+    return W_FAILURE(std::errc::not_enough_memory, "av_frame_ref failed because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
   }
+  return _frame;
+}
 
-  // get number of samples
-  auto _sample_rate = gsl::narrow_cast<int64_t>(this->_av_frame->sample_rate);
-
-  auto _delay = swr_get_delay(swr, _sample_rate);
-
-  const auto _rescale_rnd =
-      av_rescale_rnd(_delay + _sample_rate, gsl::narrow_cast<int64_t>(p_dst_config.sample_rate),
-                     _sample_rate, AV_ROUND_UP);
-
-  _dst_frame._av_frame->nb_samples = gsl::narrow_cast<int>(_rescale_rnd);
-
-  auto size = av_samples_alloc(gsl::narrow_cast<uint8_t **>(&_dst_frame._av_frame->data[0]),
-                               &_dst_frame._av_frame->linesize[0],
-                               this->_channel_layout.nb_channels, _dst_frame._config.nb_channels,
-                               gsl::narrow_cast<AVSampleFormat>(p_dst_config.sample_fmts), 1);
-
-  if (size < 0) {
-    _ret = -1;
-    return W_FAILURE(std::errc::operation_canceled,
-                     "could not allocate memory for buffer of audio");
+void w_av_frame::_unref_buffers() noexcept {
+  if (this->_av_frame == nullptr) {
+    return;
   }
-
-  /* convert to destination format */
-  size = swr_convert(swr, gsl::narrow_cast<uint8_t **>(&_dst_frame._av_frame->data[0]),
-                     _dst_frame._av_frame->nb_samples,
-                     (const uint8_t **)(&this->_av_frame->data[0]), this->_av_frame->nb_samples);
-
-  if (size < 0) {
-    _ret = -1;
-    return W_FAILURE(std::errc::operation_canceled, "error while audio converting\n");
+  for (auto &_buffer : this->_av_frame->buf) {
+    av_buffer_unref(&_buffer);
   }
+}
 
-  const auto _buffer_size = av_samples_get_buffer_size(&_dst_frame._av_frame->linesize[0],
-                                                       _dst_frame._av_frame->ch_layout.nb_channels,
-                                                       size, p_dst_config.sample_fmts, 1);
+void w_av_frame::set_pts(_In_ int64_t p_pts) noexcept { this->_av_frame->pts = p_pts; }
 
-  if (_buffer_size < 0) {
-    _ret = -1;
-    return W_FAILURE(std::errc::operation_canceled, "could not get sample buffer size\n");
+int64_t w_av_frame::get_pts() const noexcept {
+  if (this->_av_frame == nullptr) {
+    return AV_NOPTS_VALUE;
   }
-
-  return _dst_frame;
+  return this->_av_frame->best_effort_timestamp != AV_NOPTS_VALUE
+             ? this->_av_frame->best_effort_timestamp
+             : this->_av_frame->pts;
 }
 
-boost::leaf::result<w_av_frame> w_av_frame::convert_video(_In_ w_av_config &&p_dst_config) {
-  // create a buffer and dst frame
-  auto _video_buffer = std::vector<uint8_t>();
-  auto _dst_frame = w_av_frame(std::move(p_dst_config));
-  BOOST_LEAF_CHECK(_dst_frame.init());
-  BOOST_LEAF_CHECK(_dst_frame.set_video_frame(std::move(_video_buffer)));
-
-  auto *_context = sws_getContext(
-      this->_config.width, this->_config.height, this->_config.format, _dst_frame._config.width,
-      _dst_frame._config.height, _dst_frame._config.format, SWS_BICUBIC, nullptr, nullptr, nullptr);
-  if (_context == nullptr) {
-    return W_FAILURE(std::errc::not_enough_memory, "could not create sws context");
-  }
+std::tuple<uint8_t **, int> w_av_frame::get() const noexcept {
+  if (this->_av_frame) {
+    auto _buffer_size =
+        av_image_get_buffer_size(gsl::narrow_cast<AVPixelFormat>(this->_av_frame->format),
+                                 this->_av_frame->width, this->_av_frame->height, 4);
 
-  auto _dst_frame_nn = gsl::not_null<AVFrame *>(_dst_frame._av_frame);
-  const auto _height =
-      sws_scale(_context, gsl::narrow_cast<const uint8_t *const *>(this->_av_frame->data),
-                gsl::narrow_cast<const int *>(this->_av_frame->linesize), 0, this->_config.height,
-                gsl::narrow_cast<uint8_t *const *>(_dst_frame_nn->data),
-                gsl::narrow_cast<const int *>(_dst_frame_nn->linesize));
+    return std::make_tuple(this->_av_frame->data, _buffer_size);
+  }
+  return std::make_tuple(nullptr, 0);
+}
 
-  // free context
-  sws_freeContext(_context);
+w_av_config w_av_frame::get_config() const noexcept { return this->_config; }
 
-  if (_height < 0) {
-    return W_FAILURE(
-        std::errc::invalid_argument,
-        "w_av_frame sws_scale failed because: \"" + w_ffmpeg_ctx::get_av_error_str(_height) + "\"");
-  }
+boost::leaf::result<w_av_frame> w_av_frame::convert_audio(_In_ w_av_config &&p_dst_config) {
+  auto _converter = w_av_converter();
+  return _converter.convert_audio(*this, std::move(p_dst_config));
+}
 
-  return _dst_frame;
+boost::leaf::result<w_av_frame> w_av_frame::convert_video(_In_ w_av_config &&p_dst_config) {
+  // the scaling context is reused while the shapes of frames do not change
+  static thread_local auto s_converter = w_av_converter(w_av_scale_algorithm::bicubic);
+  return s_converter.convert_video(*this, std::move(p_dst_config));
 }
 
 boost::leaf::result<w_av_frame> w_av_frame::load_video_frame_from_img_file(
@@ -10,6 +10,7 @@
 #include <wolf/wolf.hpp>
 
 #include "w_av_config.hpp"
+#include "w_av_frame_pool.hpp"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -19,14 +20,20 @@ extern "C" {
 
 namespace wolf::media::ffmpeg {
 
+class w_av_converter;
 class w_decoder;
 class w_encoder;
 
 class w_av_frame {
+  friend w_av_converter;
   friend w_decoder;
   friend w_encoder;
 
  public:
+  // default constructor, an empty frame which is used by queues and must be
+  // assigned or initialized before use
+  W_API w_av_frame() noexcept = default;
+
   /**
    * constructor the av_frame with specific config
    * @param p_config, the av audio config
@@ -62,6 +69,22 @@ class w_av_frame {
   W_API boost::leaf::result<int> set_video_frame(
       _Inout_ std::vector<uint8_t> &&p_data) noexcept;
 
+  /**
+   * set the AVFrame data from a refcounted buffer of the pool, the previous
+   * buffer goes back to its pool. reusing a frame this way does not allocate
+   * once the pool is warm
+   * @param p_pool, the pool of frame buffers
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> set_video_frame(_Inout_ w_av_frame_pool &p_pool) noexcept;
+
+  /**
+   * create a new reference to the frame, the refcounted buffers are shared
+   * instead of copied, so the reference can be passed to another thread
+   * @returns the new frame
+   */
+  W_API boost::leaf::result<w_av_frame> ref() const noexcept;
+
   /**
    * set the AVFrame's pts
    * @param p_pts, the pts data
@@ -69,6 +92,13 @@ class w_av_frame {
    */
   W_API void set_pts(_In_ int64_t p_pts) noexcept;
 
+  /**
+   * get the presentation timestamp, the decoded frames return the best
+   * effort timestamp of decoder
+   * @returns the pts or AV_NOPTS_VALUE
+   */
+  W_API int64_t get_pts() const noexcept;
+
   /**
    * get data and linesize as a tuple
    * @returns tuple<int*[8], int[8]>
@@ -77,7 +107,9 @@ class w_av_frame {
   std::tuple<uint8_t **, int> get() const noexcept;
 
   /**
-   * convert the ffmpeg video AVFrame
+   * convert the ffmpeg video AVFrame with a bicubic w_av_converter of the
+   * calling thread, use a w_av_converter to choose the algorithm or to
+   * convert into an existing frame
    * @returns the converted instance of AVFrame
    */
   W_API
@@ -85,7 +117,8 @@ class w_av_frame {
       _In_ w_av_config &&p_dst_config);
 
   /**
-   * convert the ffmpeg audio AVFrame
+   * convert the ffmpeg audio AVFrame, use a w_av_converter per stream to
+   * reuse the resampling context and keep its delayed samples
    * @returns the converted instance of AVFrame
    */
   W_API
@@ -123,6 +156,8 @@ class w_av_frame {
 
   // release
   void _release() noexcept;
+  // release the refcounted buffers of AVFrame
+  void _unref_buffers() noexcept;
   // move
   void _move(w_av_frame &&p_other) noexcept;
 
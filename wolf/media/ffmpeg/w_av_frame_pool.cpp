@@ -0,0 +1,61 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_frame_pool.hpp"
+
+#include <algorithm>
+
+using w_av_frame_pool = wolf::media::ffmpeg::w_av_frame_pool;
+using w_av_frame_pool_stats = wolf::media::ffmpeg::w_av_frame_pool_stats;
+
+w_av_frame_pool::~w_av_frame_pool() noexcept {
+  for (auto &_class : this->_classes) {
+    av_buffer_pool_uninit(&_class.pool);
+  }
+}
+
+AVBufferRef *w_av_frame_pool::_alloc(_In_ void *p_opaque, _In_ size_t p_size) noexcept {
+  auto *_pool = gsl::narrow_cast<w_av_frame_pool *>(p_opaque);
+  _pool->_allocations.fetch_add(1, std::memory_order_relaxed);
+  return av_buffer_alloc(p_size);
+}
+
+boost::leaf::result<AVBufferRef *> w_av_frame_pool::acquire(_In_ size_t p_size) noexcept {
+  if (p_size == 0) {
+    return W_FAILURE(std::errc::invalid_argument, "the size of frame buffer is zero");
+  }
+  const auto _size = (p_size + SIZE_CLASS_ALIGNMENT - 1) & ~(SIZE_CLASS_ALIGNMENT - 1);
+
+  std::scoped_lock _lock(this->_mutex);
+
+  auto _iter = std::find_if(this->_classes.begin(), this->_classes.end(),
+                            [&](const w_size_class &p_class) { return p_class.size == _size; });
+  if (_iter == this->_classes.end()) {
+    auto *_pool = av_buffer_pool_init2(_size, this, &_alloc, nullptr);
+    if (_pool == nullptr) {
+      return W_FAILURE(std::errc::not_enough_memory, "could not create AVBufferPool");
+    }
+    try {
+      this->_classes.push_back({_size, _pool});
+    } catch (...) {
+      av_buffer_pool_uninit(&_pool);
+      return W_FAILURE(std::errc::not_enough_memory, "could not add a size class");
+    }
+    _iter = std::prev(this->_classes.end());
+  }
+
+  auto *_buffer = av_buffer_pool_get(_iter->pool);
+  if (_buffer == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     "could not get a buffer of {} bytes from AVBufferPool", _size);
+  }
+  this->_acquisitions++;
+  return _buffer;
+}
+
+w_av_frame_pool_stats w_av_frame_pool::get_stats() const noexcept {
+  std::scoped_lock _lock(this->_mutex);
+  return w_av_frame_pool_stats{this->_allocations.load(std::memory_order_relaxed),
+                               this->_acquisitions};
+}
+
+#endif  // WOLF_MEDIA_FFMPEG
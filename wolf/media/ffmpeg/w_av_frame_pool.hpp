@@ -0,0 +1,80 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+extern "C" {
+#include <libavutil/buffer.h>
+}
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace wolf::media::ffmpeg {
+
+struct w_av_frame_pool_stats {
+  // number of buffers which were allocated by the pools
+  uint64_t allocations = 0;
+  // number of buffers which were handed out
+  uint64_t acquisitions = 0;
+};
+
+/*
+ * a pool of refcounted frame buffers, backed by one AVBufferPool per size
+ * class. a buffer goes back to its pool when the last AVBufferRef of it is
+ * released, so frames which share their buffers can be passed between
+ * threads and decode/convert steps without copies. it is thread-safe and
+ * must outlive the frames which were drawn from it.
+ */
+class w_av_frame_pool {
+ public:
+  // the granularity of size classes
+  static constexpr size_t SIZE_CLASS_ALIGNMENT = 4096;
+
+  // constructor
+  W_API w_av_frame_pool() noexcept = default;
+
+  // destructor, the buffers in use are freed when they are released
+  W_API virtual ~w_av_frame_pool() noexcept;
+
+  /*
+   * get a buffer from the pool of its size class
+   * @param p_size, the minimum size of buffer
+   * @returns the buffer, the caller owns the reference
+   */
+  W_API boost::leaf::result<AVBufferRef *> acquire(_In_ size_t p_size) noexcept;
+
+  // returns the statistics of pool
+  W_API w_av_frame_pool_stats get_stats() const noexcept;
+
+ private:
+  // copy constructor.
+  w_av_frame_pool(const w_av_frame_pool &) = delete;
+  // copy assignment operator.
+  w_av_frame_pool &operator=(const w_av_frame_pool &) = delete;
+  // the pools refer to this instance
+  w_av_frame_pool(w_av_frame_pool &&) = delete;
+  w_av_frame_pool &operator=(w_av_frame_pool &&) = delete;
+
+  static AVBufferRef *_alloc(_In_ void *p_opaque, _In_ size_t p_size) noexcept;
+
+  struct w_size_class {
+    size_t size;
+    AVBufferPool *pool;
+  };
+
+  mutable std::mutex _mutex;
+  std::vector<w_size_class> _classes;
+  std::atomic<uint64_t> _allocations = 0;
+  uint64_t _acquisitions = 0;
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
@@ -0,0 +1,501 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_frame_seeker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+using w_av_keyframe_index = wolf::media::ffmpeg::w_av_keyframe_index;
+using w_av_seek_config = wolf::media::ffmpeg::w_av_seek_config;
+using w_av_frame_seeker = wolf::media::ffmpeg::w_av_frame_seeker;
+using w_av_frame_seeker_stats = wolf::media::ffmpeg::w_av_frame_seeker_stats;
+using w_av_codec_opt = wolf::media::ffmpeg::w_av_codec_opt;
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+using w_av_packet = wolf::media::ffmpeg::w_av_packet;
+using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
+using w_ffmpeg_ctx = wolf::media::ffmpeg::w_ffmpeg_ctx;
+
+constexpr std::array<char, 4> s_sidecar_magic = {'W', 'I', 'D', 'X'};
+constexpr uint32_t s_sidecar_version = 2;
+
+template <typename T>
+static void s_write(_Inout_ std::ofstream &p_file, _In_ const T &p_value) {
+  p_file.write(reinterpret_cast<const char *>(&p_value), sizeof(T));
+}
+
+template <typename T>
+static bool s_read(_Inout_ std::ifstream &p_file, _Inout_ T &p_value) {
+  return static_cast<bool>(p_file.read(reinterpret_cast<char *>(&p_value), sizeof(T)));
+}
+
+static std::filesystem::path s_sidecar_path(_In_ const std::filesystem::path &p_path) {
+  auto _path = p_path;
+  _path += ".widx";
+  return _path;
+}
+
+boost::leaf::result<w_av_keyframe_index> w_av_keyframe_index::build(
+    _Inout_ AVFormatContext *p_fmt_ctx, _In_ int p_stream_index) noexcept {
+  if (p_fmt_ctx == nullptr || p_stream_index < 0 ||
+      gsl::narrow_cast<unsigned int>(p_stream_index) >= p_fmt_ctx->nb_streams) {
+    return W_FAILURE(std::errc::invalid_argument, "invalid stream index {} for the keyframe index",
+                     p_stream_index);
+  }
+
+  auto *_packet = av_packet_alloc();
+  if (_packet == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate packet for the index");
+  }
+  DEFER { av_packet_free(&_packet); });
+
+  try {
+    auto _index = w_av_keyframe_index();
+    auto _keyframes = std::vector<w_keyframe>();
+
+    for (;;) {
+      av_packet_unref(_packet);
+      const auto _ret = av_read_frame(p_fmt_ctx, _packet);
+      if (_ret == AVERROR_EOF) {
+        break;
+      }
+      if (_ret < 0) {
+        return W_FAILURE(std::errc::operation_canceled,
+                         "could not read packet for the index because: {}",
+                         w_ffmpeg_ctx::get_av_error_str(_ret));
+      }
+      if (_packet->stream_index != p_stream_index) {
+        continue;
+      }
+
+      const auto _pts = _packet->pts != AV_NOPTS_VALUE ? _packet->pts : _packet->dts;
+      if (_pts == AV_NOPTS_VALUE) {
+        return W_FAILURE(std::errc::not_supported,
+                         "could not index a packet of stream {} without timestamps",
+                         p_stream_index);
+      }
+
+      _index.pts.push_back(_pts);
+      if ((_packet->flags & AV_PKT_FLAG_KEY) != 0) {
+        const auto _dts = _packet->dts != AV_NOPTS_VALUE ? _packet->dts : _pts;
+        _keyframes.push_back(w_keyframe{0, _pts, _dts});
+      }
+    }
+
+    if (_keyframes.empty()) {
+      return W_FAILURE(std::errc::not_supported, "the stream {} does not have any keyframe",
+                       p_stream_index);
+    }
+
+    // the packets are in decoding order, the frames are numbered in presentation order
+    std::sort(_index.pts.begin(), _index.pts.end());
+    for (auto &_keyframe : _keyframes) {
+      _keyframe.frame = _index.find_frame(_keyframe.pts);
+    }
+    std::sort(_keyframes.begin(), _keyframes.end(),
+              [](const w_keyframe &p_lhs, const w_keyframe &p_rhs) {
+                return p_lhs.frame < p_rhs.frame;
+              });
+    _index.keyframes = std::move(_keyframes);
+
+    return _index;
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not build the keyframe index because: {}",
+                     p_exc.what());
+  }
+}
+
+boost::leaf::result<w_av_keyframe_index> w_av_keyframe_index::load(
+    _In_ const std::filesystem::path &p_path, _In_ int64_t p_source_size,
+    _In_ int64_t p_source_time) noexcept {
+  try {
+    auto _file = std::ifstream(p_path, std::ios::binary | std::ios::ate);
+    if (!_file) {
+      return W_FAILURE(std::errc::no_such_file_or_directory,
+                       "could not open the keyframe index: {}", p_path.string());
+    }
+    const auto _file_size = gsl::narrow_cast<uint64_t>(_file.tellg());
+    _file.seekg(0);
+
+    auto _magic = std::array<char, 4>();
+    uint32_t _version = 0;
+    auto _index = w_av_keyframe_index();
+    if (!s_read(_file, _magic) || _magic != s_sidecar_magic || !s_read(_file, _version) ||
+        _version != s_sidecar_version || !s_read(_file, _index.source_size) ||
+        !s_read(_file, _index.source_time)) {
+      return W_FAILURE(std::errc::invalid_argument, "invalid keyframe index: {}", p_path.string());
+    }
+    if (_index.source_size != p_source_size || _index.source_time != p_source_time) {
+      return W_FAILURE(std::errc::invalid_argument, "the keyframe index {} is stale",
+                       p_path.string());
+    }
+
+    // a count can't be more than the records which are left in the file
+    const auto _read_count = [&](_In_ size_t p_record_size, _Inout_ uint64_t &p_count) {
+      return s_read(_file, p_count) &&
+             p_count <= (_file_size - gsl::narrow_cast<uint64_t>(_file.tellg())) / p_record_size;
+    };
+
+    uint64_t _count = 0;
+    if (!_read_count(sizeof(int64_t), _count)) {
+      return W_FAILURE(std::errc::invalid_argument, "invalid keyframe index: {}", p_path.string());
+    }
+    _index.pts.resize(gsl::narrow_cast<size_t>(_count));
+    for (auto &_pts : _index.pts) {
+      if (!s_read(_file, _pts)) {
+        return W_FAILURE(std::errc::invalid_argument, "truncated keyframe index: {}",
+                         p_path.string());
+      }
+    }
+
+    if (!_read_count(3 * sizeof(int64_t), _count) || _count == 0) {
+      return W_FAILURE(std::errc::invalid_argument, "invalid keyframe index: {}", p_path.string());
+    }
+    _index.keyframes.resize(gsl::narrow_cast<size_t>(_count));
+    for (auto &_keyframe : _index.keyframes) {
+      if (!s_read(_file, _keyframe.frame) || !s_read(_file, _keyframe.pts) ||
+          !s_read(_file, _keyframe.dts)) {
+        return W_FAILURE(std::errc::invalid_argument, "truncated keyframe index: {}",
+                         p_path.string());
+      }
+    }
+
+    // the lookups rely on the order of pts and keyframes
+    auto _valid = std::is_sorted(_index.pts.cbegin(), _index.pts.cend());
+    auto _previous = int64_t(-1);
+    for (const auto &_keyframe : _index.keyframes) {
+      _valid = _valid && _keyframe.frame > _previous &&
+               _keyframe.frame < _index.get_frame_count();
+      _previous = _keyframe.frame;
+    }
+    if (!_valid) {
+      return W_FAILURE(std::errc::invalid_argument, "corrupted keyframe index: {}",
+                       p_path.string());
+    }
+
+    return _index;
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not load the keyframe index because: {}",
+                     p_exc.what());
+  }
+}
+
+boost::leaf::result<int> w_av_keyframe_index::save(
+    _In_ const std::filesystem::path &p_path) const noexcept {
+  try {
+    auto _file = std::ofstream(p_path, std::ios::binary | std::ios::trunc);
+    if (!_file) {
+      return W_FAILURE(std::errc::permission_denied, "could not create the keyframe index: {}",
+                       p_path.string());
+    }
+
+    s_write(_file, s_sidecar_magic);
+    s_write(_file, s_sidecar_version);
+    s_write(_file, this->source_size);
+    s_write(_file, this->source_time);
+    s_write(_file, gsl::narrow_cast<uint64_t>(this->pts.size()));
+    for (const auto _pts : this->pts) {
+      s_write(_file, _pts);
+    }
+    s_write(_file, gsl::narrow_cast<uint64_t>(this->keyframes.size()));
+    for (const auto &_keyframe : this->keyframes) {
+      s_write(_file, _keyframe.frame);
+      s_write(_file, _keyframe.pts);
+      s_write(_file, _keyframe.dts);
+    }
+
+    _file.flush();
+    if (!_file) {
+      return W_FAILURE(std::errc::io_error, "could not write the keyframe index: {}",
+                       p_path.string());
+    }
+    return 0;
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::io_error, "could not save the keyframe index because: {}",
+                     p_exc.what());
+  }
+}
+
+int64_t w_av_keyframe_index::find_frame(_In_ int64_t p_pts) const noexcept {
+  const auto _iter = std::lower_bound(this->pts.cbegin(), this->pts.cend(), p_pts);
+  if (_iter == this->pts.cend() || *_iter != p_pts) {
+    return -1;
+  }
+  return std::distance(this->pts.cbegin(), _iter);
+}
+
+const w_av_keyframe_index::w_keyframe &w_av_keyframe_index::find_keyframe(
+    _In_ int64_t p_frame) const noexcept {
+  // the first keyframe after the frame, the one before it is the answer
+  const auto _iter =
+      std::upper_bound(this->keyframes.cbegin(), this->keyframes.cend(), p_frame,
+                       [](int64_t p_value, const w_keyframe &p_keyframe) {
+                         return p_value < p_keyframe.frame;
+                       });
+  return _iter == this->keyframes.cbegin() ? this->keyframes.front() : *std::prev(_iter);
+}
+
+int64_t w_av_keyframe_index::get_frame_count() const noexcept {
+  return gsl::narrow_cast<int64_t>(this->pts.size());
+}
+
+w_av_frame_seeker::~w_av_frame_seeker() noexcept { _release(); }
+
+void w_av_frame_seeker::_release() noexcept {
+  this->_cache_index.clear();
+  this->_cache.clear();
+  this->_packet = w_av_packet();
+  this->_decoder.reset();
+  if (this->_fmt_ctx != nullptr) {
+    avformat_close_input(&this->_fmt_ctx);
+  }
+  this->_stream_index = -1;
+  this->_index = w_av_keyframe_index();
+  this->_next_frame = -1;
+  this->_drained = false;
+  this->_stats = {};
+}
+
+boost::leaf::result<int> w_av_frame_seeker::open(_In_ const std::filesystem::path &p_path,
+                                                 _In_ const w_av_seek_config &p_config) noexcept {
+  _release();
+  this->_config = p_config;
+
+  auto _ec = std::error_code();
+  const auto _source_size = gsl::narrow_cast<int64_t>(std::filesystem::file_size(p_path, _ec));
+  if (_ec) {
+    return W_FAILURE(std::errc::no_such_file_or_directory, "could not open {} because: {}",
+                     p_path.string(), _ec.message());
+  }
+  // a re-encode of the same size is told apart by its write time
+  const auto _source_time = gsl::narrow_cast<int64_t>(
+      std::filesystem::last_write_time(p_path, _ec).time_since_epoch().count());
+  if (_ec) {
+    return W_FAILURE(std::errc::no_such_file_or_directory, "could not open {} because: {}",
+                     p_path.string(), _ec.message());
+  }
+
+  auto _ret = avformat_open_input(&this->_fmt_ctx, p_path.string().c_str(), nullptr, nullptr);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not open input {} because: {}",
+                     p_path.string(), w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+
+  _ret = avformat_find_stream_info(this->_fmt_ctx, nullptr);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "could not find stream info of {} because: {}", p_path.string(),
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+
+  this->_stream_index = av_find_best_stream(this->_fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+  if (this->_stream_index < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not find a video stream in {}",
+                     p_path.string());
+  }
+
+  // only the video stream is demuxed
+  for (unsigned int i = 0; i < this->_fmt_ctx->nb_streams; ++i) {
+    if (gsl::narrow_cast<int>(i) != this->_stream_index) {
+      this->_fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+  }
+
+  const auto _sidecar = s_sidecar_path(p_path);
+  auto _loaded = false;
+  if (p_config.use_sidecar) {
+    _loaded = boost::leaf::try_handle_all(
+        [&]() -> boost::leaf::result<bool> {
+          BOOST_LEAF_AUTO(_index,
+                          w_av_keyframe_index::load(_sidecar, _source_size, _source_time));
+          this->_index = std::move(_index);
+          return true;
+        },
+        []() { return false; });
+  }
+
+  if (!_loaded) {
+    BOOST_LEAF_AUTO(_index, w_av_keyframe_index::build(this->_fmt_ctx, this->_stream_index));
+    this->_index = std::move(_index);
+    this->_index.source_size = _source_size;
+    this->_index.source_time = _source_time;
+
+    if (p_config.use_sidecar) {
+      // the index is rebuilt next time if it could not be saved
+      std::ignore = boost::leaf::try_handle_all(
+          [&]() -> boost::leaf::result<int> { return this->_index.save(_sidecar); },
+          []() { return -1; });
+    }
+  }
+
+  auto _codec_opts = w_av_codec_opt();
+  _codec_opts.thread_count = p_config.thread_count;
+  _codec_opts.thread_type = p_config.thread_type;
+  BOOST_LEAF_AUTO(_decoder, w_ffmpeg::create_decoder(
+                                this->_fmt_ctx->streams[this->_stream_index]->codecpar,
+                                _codec_opts));
+  this->_decoder.emplace(std::move(_decoder));
+
+  BOOST_LEAF_CHECK(this->_packet.init());
+
+  // the position of demuxer is unknown, so the first frame needs a seek
+  this->_next_frame = -1;
+  return 0;
+}
+
+boost::leaf::result<w_av_frame> w_av_frame_seeker::get_frame(_In_ int64_t p_frame) noexcept {
+  if (!this->_decoder.has_value()) {
+    return W_FAILURE(std::errc::operation_not_permitted, "the seeker was not opened");
+  }
+  if (p_frame < 0 || p_frame >= this->_index.get_frame_count()) {
+    return W_FAILURE(std::errc::invalid_argument, "the frame {} is out of range [0, {})", p_frame,
+                     this->_index.get_frame_count());
+  }
+
+  if (const auto *_cached = _find_cached(p_frame)) {
+    this->_stats.cache_hits++;
+    return _cached->ref();
+  }
+
+  // decoding forward is cheaper than a seek if no keyframe lies between the decoder and the frame
+  const auto &_keyframe = this->_index.find_keyframe(p_frame);
+  const auto _reachable = !this->_drained && this->_next_frame >= 0 &&
+                          p_frame >= this->_next_frame && _keyframe.frame <= this->_next_frame;
+  if (!_reachable) {
+    BOOST_LEAF_CHECK(_seek(_keyframe));
+  }
+
+  auto _frame = w_av_frame();
+  BOOST_LEAF_AUTO(_found, _decode_until(p_frame, _frame));
+  if (!_found && _reachable) {
+    // the decoder did not produce the frame from its position, so start over from the keyframe
+    BOOST_LEAF_CHECK(_seek(_keyframe));
+    BOOST_LEAF_ASSIGN(_found, _decode_until(p_frame, _frame));
+  }
+  if (!_found) {
+    return W_FAILURE(std::errc::no_message_available, "could not decode the frame {}", p_frame);
+  }
+  return _frame;
+}
+
+boost::leaf::result<int> w_av_frame_seeker::_seek(
+    _In_ const w_av_keyframe_index::w_keyframe &p_keyframe) noexcept {
+  // the dts of a keyframe is not after its pts, so the backward seek lands on or before it
+  const auto _ret = av_seek_frame(this->_fmt_ctx, this->_stream_index, p_keyframe.dts,
+                                  AVSEEK_FLAG_BACKWARD);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "could not seek to the keyframe {} because: {}", p_keyframe.frame,
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+  BOOST_LEAF_CHECK(this->_decoder->reset());
+
+  this->_next_frame = p_keyframe.frame;
+  this->_drained = false;
+  this->_stats.seeks++;
+  return 0;
+}
+
+boost::leaf::result<bool> w_av_frame_seeker::_decode_until(_In_ int64_t p_frame,
+                                                           _Inout_ w_av_frame &p_out) noexcept {
+  auto _found = false;
+  boost::leaf::result<int> _sink_res = 0;
+
+  const auto _sink = [&](const w_av_frame &p_decoded) -> bool {
+    const auto _number = this->_index.find_frame(p_decoded.get_pts());
+    if (_number < 0) {
+      // a frame which is not in the index, such as a leading frame of an open gop
+      return true;
+    }
+
+    this->_stats.decoded_frames++;
+    this->_next_frame = std::max(this->_next_frame, _number + 1);
+
+    _sink_res = _cache_frame(_number, p_decoded);
+    if (!_sink_res) {
+      return false;
+    }
+    if (_number == p_frame) {
+      auto _ref = p_decoded.ref();
+      if (!_ref) {
+        _sink_res = _ref.error();
+        return false;
+      }
+      p_out = std::move(*_ref);
+      _found = true;
+    }
+    return true;
+  };
+
+  while (!_found) {
+    this->_packet.unref();
+    const auto _ret = av_read_frame(this->_fmt_ctx, this->_packet._packet);
+    if (_ret == AVERROR_EOF) {
+      // drain the frames which are delayed by the decoder
+      this->_packet.unref();
+      BOOST_LEAF_CHECK(this->_decoder->decode(this->_packet, _sink, true));
+      BOOST_LEAF_CHECK(_sink_res);
+      this->_drained = true;
+      break;
+    }
+    if (_ret < 0) {
+      return W_FAILURE(std::errc::operation_canceled,
+                       "could not read packet for the frame {} because: {}", p_frame,
+                       w_ffmpeg_ctx::get_av_error_str(_ret));
+    }
+    if (this->_packet.get_stream_index() != this->_stream_index) {
+      continue;
+    }
+
+    BOOST_LEAF_CHECK(this->_decoder->decode(this->_packet, _sink, false));
+    BOOST_LEAF_CHECK(_sink_res);
+  }
+
+  return _found;
+}
+
+boost::leaf::result<int> w_av_frame_seeker::_cache_frame(
+    _In_ int64_t p_frame, _In_ const w_av_frame &p_decoded) noexcept {
+  if (this->_config.cache_size == 0 || _find_cached(p_frame) != nullptr) {
+    return 0;
+  }
+
+  // the buffer stays in the pool of codec
+  BOOST_LEAF_AUTO(_ref, p_decoded.ref());
+  try {
+    this->_cache.emplace_front(p_frame, std::move(_ref));
+    this->_cache_index.emplace(p_frame, this->_cache.begin());
+  } catch (const std::exception &p_exc) {
+    if (this->_cache.size() > this->_cache_index.size()) {
+      this->_cache.pop_front();
+    }
+    return W_FAILURE(std::errc::not_enough_memory, "could not cache the frame {} because: {}",
+                     p_frame, p_exc.what());
+  }
+
+  while (this->_cache.size() > this->_config.cache_size) {
+    this->_cache_index.erase(this->_cache.back().first);
+    this->_cache.pop_back();
+  }
+  return 0;
+}
+
+const w_av_frame *w_av_frame_seeker::_find_cached(_In_ int64_t p_frame) noexcept {
+  const auto _iter = this->_cache_index.find(p_frame);
+  if (_iter == this->_cache_index.end()) {
+    return nullptr;
+  }
+  this->_cache.splice(this->_cache.begin(), this->_cache, _iter->second);
+  return &_iter->second->second;
+}
+
+int64_t w_av_frame_seeker::get_frame_count() const noexcept {
+  return this->_index.get_frame_count();
+}
+
+const w_av_keyframe_index &w_av_frame_seeker::get_index() const noexcept { return this->_index; }
+
+w_av_frame_seeker_stats w_av_frame_seeker::get_stats() const noexcept { return this->_stats; }
+
+#endif  // WOLF_MEDIA_FFMPEG
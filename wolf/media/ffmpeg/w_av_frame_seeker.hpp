@@ -0,0 +1,194 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+#include "w_ffmpeg.hpp"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace wolf::media::ffmpeg {
+
+/*
+ * the keyframes of a video stream and the pts of its frames in presentation
+ * order. it is built by demuxing the stream once without decoding, and can
+ * be kept in a sidecar file so the next open skips that pass.
+ */
+class w_av_keyframe_index {
+ public:
+  struct w_keyframe {
+    // the number of frame in presentation order
+    int64_t frame = 0;
+    int64_t pts = 0;
+    int64_t dts = 0;
+  };
+
+  /*
+   * demux every packet of the stream and index the keyframes, the format
+   * context is left at the end of the file
+   * @param p_fmt_ctx, the opened input
+   * @param p_stream_index, the index of video stream
+   * @returns the index
+   */
+  W_API static boost::leaf::result<w_av_keyframe_index> build(_Inout_ AVFormatContext *p_fmt_ctx,
+                                                              _In_ int p_stream_index) noexcept;
+
+  /*
+   * load an index which was saved for the same source, a corrupted one fails
+   * @param p_path, the path of sidecar file
+   * @param p_source_size, the size of source file, an index of another size is stale
+   * @param p_source_time, the last write time of source file, an index of
+   * another time is stale
+   * @returns the index
+   */
+  W_API static boost::leaf::result<w_av_keyframe_index> load(
+      _In_ const std::filesystem::path &p_path, _In_ int64_t p_source_size,
+      _In_ int64_t p_source_time) noexcept;
+
+  /*
+   * save the index, the file is written in the byte order of this machine
+   * @param p_path, the path of sidecar file
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> save(_In_ const std::filesystem::path &p_path) const noexcept;
+
+  /*
+   * find the frame of a pts
+   * @param p_pts, the pts of frame
+   * @returns the number of frame or -1 if no frame has the pts
+   */
+  W_API int64_t find_frame(_In_ int64_t p_pts) const noexcept;
+
+  /*
+   * find the keyframe which a decoder must start from to reach a frame
+   * @param p_frame, the number of frame, it must be less than get_frame_count
+   * @returns the last keyframe at or before the frame
+   */
+  W_API const w_keyframe &find_keyframe(_In_ int64_t p_frame) const noexcept;
+
+  // returns the number of frames
+  W_API int64_t get_frame_count() const noexcept;
+
+  // the pts of every frame in presentation order
+  std::vector<int64_t> pts;
+  // the keyframes in presentation order
+  std::vector<w_keyframe> keyframes;
+  // the size of source file which the index belongs to
+  int64_t source_size = 0;
+  // the last write time of source file in ticks of std::filesystem::file_time_type
+  int64_t source_time = 0;
+};
+
+struct w_av_seek_config {
+  // keep the keyframe index next to the file as <path>.widx and reuse it
+  bool use_sidecar = false;
+  // the number of decoded frames which are kept for scrubbing back and forth
+  size_t cache_size = 16;
+  // the threading of decoder
+  int thread_count = 0;
+  w_av_thread_type thread_type = w_av_thread_type::codec_default;
+};
+
+struct w_av_frame_seeker_stats {
+  // number of frames which were served by the cache
+  uint64_t cache_hits = 0;
+  // number of seeks to a keyframe
+  uint64_t seeks = 0;
+  // number of frames which were decoded
+  uint64_t decoded_frames = 0;
+};
+
+/*
+ * frame accurate random access to the video stream of a file. the frame N
+ * is decoded from the nearest keyframe before it, or from the current
+ * position if the decoder is already between that keyframe and N, and the
+ * decoded frames are kept in a small lru cache. it is not thread-safe.
+ */
+class w_av_frame_seeker {
+ public:
+  // constructor
+  W_API w_av_frame_seeker() noexcept = default;
+  // destructor
+  W_API virtual ~w_av_frame_seeker() noexcept;
+
+  /*
+   * open a file and build or load its keyframe index
+   * @param p_path, the path of file
+   * @param p_config, the config of seeker
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> open(_In_ const std::filesystem::path &p_path,
+                                      _In_ const w_av_seek_config &p_config = {}) noexcept;
+
+  /*
+   * decode a frame
+   * @param p_frame, the number of frame in presentation order
+   * @returns a reference of the decoded frame
+   */
+  W_API boost::leaf::result<w_av_frame> get_frame(_In_ int64_t p_frame) noexcept;
+
+  // returns the number of frames
+  W_API int64_t get_frame_count() const noexcept;
+
+  // returns the keyframe index
+  W_API const w_av_keyframe_index &get_index() const noexcept;
+
+  // returns the statistics of seeker
+  W_API w_av_frame_seeker_stats get_stats() const noexcept;
+
+ private:
+  // copy constructor.
+  w_av_frame_seeker(const w_av_frame_seeker &) = delete;
+  // copy assignment operator.
+  w_av_frame_seeker &operator=(const w_av_frame_seeker &) = delete;
+  // the members of decoder refer to each other
+  w_av_frame_seeker(w_av_frame_seeker &&) = delete;
+  w_av_frame_seeker &operator=(w_av_frame_seeker &&) = delete;
+
+  // seek to a keyframe and reset the decoder
+  boost::leaf::result<int> _seek(_In_ const w_av_keyframe_index::w_keyframe &p_keyframe) noexcept;
+  // decode until the frame is decoded or the stream ends, returns false if it was not found
+  boost::leaf::result<bool> _decode_until(_In_ int64_t p_frame, _Inout_ w_av_frame &p_out) noexcept;
+  // keep a decoded frame in the cache
+  boost::leaf::result<int> _cache_frame(_In_ int64_t p_frame,
+                                        _In_ const w_av_frame &p_decoded) noexcept;
+  // find a cached frame and make it the most recently used one
+  const w_av_frame *_find_cached(_In_ int64_t p_frame) noexcept;
+  // release
+  void _release() noexcept;
+
+  using w_cache = std::list<std::pair<int64_t, w_av_frame>>;
+
+  w_av_seek_config _config = {};
+  gsl::owner<AVFormatContext *> _fmt_ctx = nullptr;
+  int _stream_index = -1;
+  w_av_keyframe_index _index = {};
+  std::optional<w_decoder> _decoder = std::nullopt;
+  w_av_packet _packet = {};
+
+  // the number of next frame which the decoder returns, -1 before a seek
+  int64_t _next_frame = -1;
+  // true after the decoder was drained at the end of stream
+  bool _drained = false;
+
+  // the most recently used frame is at the front
+  w_cache _cache;
+  std::unordered_map<int64_t, w_cache::iterator> _cache_index;
+  w_av_frame_seeker_stats _stats = {};
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
@@ -1,8 +1,10 @@
 #ifdef WOLF_MEDIA_FFMPEG
 
 #include "w_av_packet.hpp"
+#include "w_ffmpeg_ctx.hpp"
 
 using w_av_packet = wolf::media::ffmpeg::w_av_packet;
+using w_ffmpeg_ctx = wolf::media::ffmpeg::w_ffmpeg_ctx;
 
 w_av_packet::w_av_packet(_In_ AVPacket *p_av_packet) noexcept
     : _packet(p_av_packet) {}
@@ -19,6 +21,7 @@ boost::leaf::result<int> w_av_packet::init(_Inout_ std::vector<uint8_t> &&p_data
 }
 
 boost::leaf::result<int> w_av_packet::init(_In_ uint8_t *p_data, _In_ size_t p_data_len) noexcept {
+  _release();
 
   this->_packet = av_packet_alloc();
   if (this->_packet == nullptr) {
@@ -32,6 +35,25 @@ boost::leaf::result<int> w_av_packet::init(_In_ uint8_t *p_data, _In_ size_t p_d
   return 0;
 }
 
+boost::leaf::result<w_av_packet> w_av_packet::ref() const noexcept {
+  if (this->_packet == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "w_av_packet is not initialized");
+  }
+
+  auto _packet = w_av_packet(av_packet_alloc());
+  if (_packet._packet == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate memory for av packet");
+  }
+
+  // the packets which are not refcounted are copied
+  const auto _ret = av_packet_ref(_packet._packet, this->_packet);
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::not_enough_memory, "av_packet_ref failed because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+  return _packet;
+}
+
 void w_av_packet::unref() noexcept { av_packet_unref(this->_packet); }
 
 uint8_t *w_av_packet::get_data() const noexcept {
@@ -46,6 +68,14 @@ int w_av_packet::get_stream_index() const noexcept {
   return this->_packet->stream_index;
 }
 
+bool w_av_packet::is_key_frame() const noexcept {
+  return this->_packet != nullptr && (this->_packet->flags & AV_PKT_FLAG_KEY) != 0;
+}
+
+bool w_av_packet::is_refcounted() const noexcept {
+  return this->_packet != nullptr && this->_packet->buf != nullptr;
+}
+
 void w_av_packet::_release() noexcept {
   if (this->_packet != nullptr) {
     av_packet_free(&this->_packet);
@@ -57,6 +87,8 @@ void w_av_packet::_move(_Inout_ w_av_packet &&p_other) noexcept {
   if (this == &p_other) {
     return;
   }
+  _release();
+
   this->_packet = std::exchange(p_other._packet, nullptr);
   this->_own_data = std::move(p_other._own_data);
 }
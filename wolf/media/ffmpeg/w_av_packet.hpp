@@ -17,11 +17,15 @@ extern "C" {
 
 namespace wolf::media::ffmpeg {
 
+class w_av_format;
+class w_av_frame_seeker;
 class w_decoder;
 class w_encoder;
 class w_ffmpeg;
 
 class w_av_packet {
+  friend w_av_format;
+  friend w_av_frame_seeker;
   friend w_decoder;
   friend w_encoder;
   friend w_ffmpeg;
@@ -68,6 +72,13 @@ class w_av_packet {
   W_API boost::leaf::result<int> init(
       _Inout_ std::vector<uint8_t> &&p_data) noexcept;
 
+  /**
+   * create a new reference to the packet, the refcounted data is shared
+   * instead of copied, so the reference can be passed to another thread
+   * @returns the new packet
+   */
+  W_API boost::leaf::result<w_av_packet> ref() const noexcept;
+
   /**
    * unref av_packet
    */
@@ -82,6 +93,13 @@ class w_av_packet {
   // get stream index
   W_API int get_stream_index() const noexcept;
 
+  // returns true if the packet holds a key frame
+  W_API bool is_key_frame() const noexcept;
+
+  // returns true if the data is owned by a refcounted buffer, such as the
+  // packets of encoder, which can be shared without a copy
+  W_API bool is_refcounted() const noexcept;
+
  private:
   // copy constructor.
   w_av_packet(const w_av_packet &) = delete;
@@ -0,0 +1,400 @@
+#ifdef WOLF_MEDIA_FFMPEG
+
+#include "w_av_pipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using w_av_pipeline = wolf::media::ffmpeg::w_av_pipeline;
+using w_av_pipeline_config = wolf::media::ffmpeg::w_av_pipeline_config;
+using w_av_pipeline_stats = wolf::media::ffmpeg::w_av_pipeline_stats;
+using w_av_stage_stats = wolf::media::ffmpeg::w_av_stage_stats;
+using w_av_cancel_token = wolf::media::ffmpeg::w_av_cancel_token;
+using w_av_codec_opt = wolf::media::ffmpeg::w_av_codec_opt;
+using w_av_config = wolf::media::ffmpeg::w_av_config;
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_drop_policy = wolf::media::ffmpeg::w_av_drop_policy;
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+using w_av_packet = wolf::media::ffmpeg::w_av_packet;
+using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
+
+void w_av_pipeline::w_stage_counters::add(_In_ clock::duration p_latency) noexcept {
+  const auto _us = gsl::narrow_cast<uint64_t>(
+      std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(p_latency).count(), 0));
+
+  this->items.fetch_add(1, std::memory_order_relaxed);
+  this->total_latency_us.fetch_add(_us, std::memory_order_relaxed);
+
+  auto _max = this->max_latency_us.load(std::memory_order_relaxed);
+  while (_us > _max &&
+         !this->max_latency_us.compare_exchange_weak(_max, _us, std::memory_order_relaxed)) {
+  }
+}
+
+w_av_stage_stats w_av_pipeline::w_stage_counters::get() const noexcept {
+  auto _stats = w_av_stage_stats{};
+  _stats.items = this->items.load(std::memory_order_relaxed);
+  _stats.dropped = this->dropped.load(std::memory_order_relaxed);
+  _stats.max_latency_us = this->max_latency_us.load(std::memory_order_relaxed);
+  if (_stats.items > 0) {
+    _stats.average_latency_us =
+        static_cast<double>(this->total_latency_us.load(std::memory_order_relaxed)) /
+        static_cast<double>(_stats.items);
+  }
+  return _stats;
+}
+
+w_av_pipeline::w_av_pipeline(_In_ w_av_pipeline_config &&p_config)
+    : _config(std::move(p_config)),
+      _packets(_config.packet_queue_size),
+      _decoded(_config.frame_queue_size),
+      _converted(_config.frame_queue_size) {}
+
+w_av_pipeline::~w_av_pipeline() noexcept { std::ignore = stop(); }
+
+boost::leaf::result<int> w_av_pipeline::start() noexcept {
+  if (this->_demux_thread.joinable() || this->_cancel_token.is_cancelled()) {
+    return W_FAILURE(std::errc::operation_not_permitted, "the pipeline can be started once");
+  }
+  if (this->_config.url.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the url of pipeline is empty");
+  }
+
+  try {
+    this->_convert_thread = std::thread([this]() { _convert(); });
+    this->_decode_thread = std::thread([this]() { _decode(); });
+    this->_demux_thread = std::thread([this]() { _demux(); });
+  } catch (const std::exception &p_exc) {
+    std::ignore = stop();
+    return W_FAILURE(std::errc::resource_unavailable_try_again,
+                     "could not start the threads of pipeline because: {}", p_exc.what());
+  }
+  return 0;
+}
+
+boost::leaf::result<int> w_av_pipeline::stop() noexcept {
+  this->_cancel_token.cancel();
+
+  for (auto *_thread : {&this->_demux_thread, &this->_decode_thread, &this->_convert_thread}) {
+    try {
+      if (_thread->joinable()) {
+        _thread->join();
+      }
+    } catch (...) {
+    }
+  }
+
+  std::scoped_lock _lock(this->_error_mutex);
+  if (!this->_error.empty()) {
+    return W_FAILURE(std::errc::operation_canceled, "the pipeline failed because: {}",
+                     this->_error);
+  }
+  return 0;
+}
+
+void w_av_pipeline::_fail(_In_ std::string &&p_error) noexcept {
+  {
+    std::scoped_lock _lock(this->_error_mutex);
+    if (this->_error.empty()) {
+      this->_error = std::move(p_error);
+    }
+  }
+  // the other stages stop at their next check
+  this->_cancel_token.cancel();
+}
+
+template <typename T>
+bool w_av_pipeline::_push(_Inout_ wolf::system::w_spsc_queue<T> &p_queue,
+                          _Inout_ T &p_item) noexcept {
+  if (this->_config.drop_policy == w_av_drop_policy::drop_oldest) {
+    return p_queue.try_push(p_item);
+  }
+  while (!p_queue.try_push(p_item)) {
+    if (this->_cancel_token.is_cancelled()) {
+      return false;
+    }
+    std::this_thread::sleep_for(this->_config.poll_interval);
+  }
+  return true;
+}
+
+template <typename T>
+std::optional<T> w_av_pipeline::_pop(_Inout_ wolf::system::w_spsc_queue<T> &p_queue,
+                                     _Inout_ w_stage_counters &p_counters) noexcept {
+  auto _item = p_queue.try_pop();
+  if (!_item || this->_config.drop_policy != w_av_drop_policy::drop_oldest) {
+    return _item;
+  }
+  // a consumer which fell behind skips to the newest item
+  while (auto _next = p_queue.try_pop()) {
+    _item = std::move(_next);
+    p_counters.dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  return _item;
+}
+
+void w_av_pipeline::_demux() noexcept {
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        boost::leaf::result<int> _callback_res = 0;
+        bool _wait_key_frame = false;
+
+        const auto _on_packet = [&](const w_av_packet &p_packet, const AVStream *,
+                                    const AVStream *p_video_stream) -> bool {
+          if (this->_cancel_token.is_cancelled()) {
+            return false;
+          }
+          if (p_video_stream == nullptr) {
+            _callback_res = W_FAILURE(std::errc::invalid_argument,
+                                      "the url of pipeline has no video stream");
+            return false;
+          }
+          if (p_packet.get_stream_index() != p_video_stream->index) {
+            return true;
+          }
+
+          if (!this->_decoder.has_value()) {
+            const auto _rate = p_video_stream->avg_frame_rate;
+            const auto _fps =
+                _rate.num > 0 && _rate.den > 0 ? gsl::narrow_cast<int>(std::lround(av_q2d(_rate)))
+                                               : 30;
+            const auto _codec_opt = w_av_codec_opt{
+                0,                          /*bitrate*/
+                std::max(_fps, 1),          /*fps*/
+                -1,                         /*gop*/
+                -1,                         /*level*/
+                -1,                         /*max_b_frames*/
+                -1,                         /*refs*/
+                this->_config.thread_count, /*thread_count*/
+                this->_config.thread_type,  /*thread_type*/
+                this->_config.low_delay,    /*low_delay*/
+            };
+            auto _decoder_res = w_ffmpeg::create_decoder(p_video_stream->codecpar, _codec_opt);
+            if (!_decoder_res) {
+              _callback_res = _decoder_res.error();
+              return false;
+            }
+            // it is published to the decode stage by the push of first packet
+            this->_decoder.emplace(std::move(_decoder_res.value()));
+          }
+
+          // a live stream can not decode the packets which follow a dropped one
+          if (_wait_key_frame) {
+            if (!p_packet.is_key_frame()) {
+              this->_demux_counters.dropped.fetch_add(1, std::memory_order_relaxed);
+              return true;
+            }
+            _wait_key_frame = false;
+          }
+
+          // the packet of demuxer is reused, so the queue takes a reference
+          auto _ref = p_packet.ref();
+          if (!_ref) {
+            _callback_res = _ref.error();
+            return false;
+          }
+
+          auto _item = w_packet_item{std::move(_ref.value()), clock::now()};
+          const auto _start = _item.time;
+          if (!_push(this->_packets, _item)) {
+            if (this->_cancel_token.is_cancelled()) {
+              return false;
+            }
+            this->_demux_counters.dropped.fetch_add(1, std::memory_order_relaxed);
+            _wait_key_frame = true;
+            return true;
+          }
+          this->_demux_counters.add(clock::now() - _start);
+          return true;
+        };
+
+        BOOST_LEAF_CHECK(w_ffmpeg::open_stream(this->_config.url, this->_config.opts, _on_packet,
+                                               &this->_cancel_token));
+        BOOST_LEAF_CHECK(_callback_res);
+        return {};
+      },
+      [&](const w_trace &p_trace) {
+        if (!this->_cancel_token.is_cancelled()) {
+          _fail(p_trace.to_string());
+        }
+      },
+      [&] {
+        if (!this->_cancel_token.is_cancelled()) {
+          _fail("the demux stage of pipeline got an error");
+        }
+      });
+
+  this->_demux_done.store(true, std::memory_order_release);
+}
+
+void w_av_pipeline::_decode() noexcept {
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        auto _flush_packet = w_av_packet();
+        BOOST_LEAF_CHECK(_flush_packet.init());
+
+        boost::leaf::result<int> _sink_res = 0;
+        auto _time = clock::time_point();
+
+        const auto _sink = [&](const w_av_frame &p_frame) -> bool {
+          // the buffer stays in the pool of codec
+          auto _ref = p_frame.ref();
+          if (!_ref) {
+            _sink_res = _ref.error();
+            return false;
+          }
+
+          const auto _now = clock::now();
+          auto _item = w_frame_item{std::move(_ref.value()), _now};
+          if (!_push(this->_decoded, _item)) {
+            if (this->_cancel_token.is_cancelled()) {
+              return false;
+            }
+            this->_decode_counters.dropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+          }
+          this->_decode_counters.add(_now - _time);
+          return true;
+        };
+
+        for (;;) {
+          if (this->_cancel_token.is_cancelled()) {
+            return {};
+          }
+
+          auto _item = this->_packets.try_pop();
+          if (!_item.has_value()) {
+            if (!this->_demux_done.load(std::memory_order_acquire)) {
+              std::this_thread::sleep_for(this->_config.poll_interval);
+              continue;
+            }
+            // the demuxer may have pushed before it finished
+            _item = this->_packets.try_pop();
+            if (!_item.has_value()) {
+              if (this->_decoder.has_value()) {
+                _time = clock::now();
+                BOOST_LEAF_CHECK(this->_decoder->decode(_flush_packet, _sink, true));
+                BOOST_LEAF_CHECK(_sink_res);
+              }
+              return {};
+            }
+          }
+
+          _time = _item->time;
+          BOOST_LEAF_CHECK(this->_decoder->decode(_item->packet, _sink, false));
+          BOOST_LEAF_CHECK(_sink_res);
+        }
+      },
+      [&](const w_trace &p_trace) {
+        if (!this->_cancel_token.is_cancelled()) {
+          _fail(p_trace.to_string());
+        }
+      },
+      [&] {
+        if (!this->_cancel_token.is_cancelled()) {
+          _fail("the decode stage of pipeline got an error");
+        }
+      });
+
+  this->_decode_done.store(true, std::memory_order_release);
+}
+
+void w_av_pipeline::_convert() noexcept {
+  auto _converter = w_av_converter(this->_config.algorithm);
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        for (;;) {
+          if (this->_cancel_token.is_cancelled()) {
+            return {};
+          }
+
+          auto _item = _pop(this->_decoded, this->_convert_counters);
+          if (!_item.has_value()) {
+            if (this->_decode_done.load(std::memory_order_acquire) && this->_decoded.empty()) {
+              return {};
+            }
+            std::this_thread::sleep_for(this->_config.poll_interval);
+            continue;
+          }
+
+          auto _out = w_frame_item{};
+          if (this->_config.format == AVPixelFormat::AV_PIX_FMT_NONE) {
+            _out.frame = std::move(_item->frame);
+          } else {
+            const auto _src_config = _item->frame.get_config();
+            auto _dst_config = w_av_config(
+                this->_config.format,
+                this->_config.width > 0 ? this->_config.width : _src_config.width,
+                this->_config.height > 0 ? this->_config.height : _src_config.height);
+            BOOST_LEAF_AUTO(_frame, _converter.convert_video(_item->frame, std::move(_dst_config),
+                                                             &this->_pool));
+            _out.frame = std::move(_frame);
+          }
+
+          const auto _now = clock::now();
+          _out.time = _now;
+          if (!_push(this->_converted, _out)) {
+            if (this->_cancel_token.is_cancelled()) {
+              return {};
+            }
+            this->_convert_counters.dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          this->_convert_counters.add(_now - _item->time);
+        }
+      },
+      [&](const w_trace &p_trace) {
+        if (!this->_cancel_token.is_cancelled()) {
+          _fail(p_trace.to_string());
+        }
+      },
+      [&] {
+        if (!this->_cancel_token.is_cancelled()) {
+          _fail("the convert stage of pipeline got an error");
+        }
+      });
+
+  this->_convert_done.store(true, std::memory_order_release);
+}
+
+std::optional<w_av_frame> w_av_pipeline::try_pop() noexcept {
+  auto _item = _pop(this->_converted, this->_convert_counters);
+  if (!_item.has_value()) {
+    return std::nullopt;
+  }
+  return std::move(_item->frame);
+}
+
+std::optional<w_av_frame> w_av_pipeline::pop(_In_ std::chrono::microseconds p_timeout) noexcept {
+  const auto _deadline = clock::now() + p_timeout;
+  for (;;) {
+    if (auto _frame = try_pop()) {
+      return _frame;
+    }
+    if (is_finished()) {
+      return std::nullopt;
+    }
+    const auto _now = clock::now();
+    if (_now >= _deadline) {
+      return std::nullopt;
+    }
+    std::this_thread::sleep_for(std::min<clock::duration>(this->_config.poll_interval,
+                                                          _deadline - _now));
+  }
+}
+
+bool w_av_pipeline::is_finished() const noexcept {
+  return this->_convert_done.load(std::memory_order_acquire) && this->_converted.empty();
+}
+
+w_av_pipeline_stats w_av_pipeline::get_stats() const noexcept {
+  return w_av_pipeline_stats{this->_demux_counters.get(), this->_decode_counters.get(),
+                             this->_convert_counters.get()};
+}
+
+const w_av_cancel_token &w_av_pipeline::get_cancel_token() const noexcept {
+  return this->_cancel_token;
+}
+
+#endif  // WOLF_MEDIA_FFMPEG
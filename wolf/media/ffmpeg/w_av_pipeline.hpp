@@ -0,0 +1,213 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#ifdef WOLF_MEDIA_FFMPEG
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+#include <wolf/system/w_spsc_queue.hpp>
+
+#include "w_av_cancel_token.hpp"
+#include "w_av_converter.hpp"
+#include "w_av_frame_pool.hpp"
+#include "w_ffmpeg.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace wolf::media::ffmpeg {
+
+/*
+ * what a stage does when the queue of the next stage is full
+ */
+enum class w_av_drop_policy {
+  // wait for the next stage, nothing is lost, for files
+  block,
+  // never wait, the stages which fall behind skip to the newest frame and
+  // the packets are dropped up to the next key frame, for live streams
+  drop_oldest,
+};
+
+struct w_av_pipeline_config {
+  // the url of file or stream
+  std::string url;
+  // the options of avformat_open_input
+  std::vector<w_av_set_opt> opts = {};
+  // the policy of queues
+  w_av_drop_policy drop_policy = w_av_drop_policy::block;
+  // the capacity of the queue between demux and decode
+  size_t packet_queue_size = 64;
+  // the capacity of the queues of decoded and converted frames
+  size_t frame_queue_size = 8;
+  // the pixel format of output, AV_PIX_FMT_NONE keeps the decoded frames
+  AVPixelFormat format = AVPixelFormat::AV_PIX_FMT_NONE;
+  // the size of output, zero keeps the size of stream
+  int width = 0;
+  int height = 0;
+  // the scaling algorithm of conversion
+  w_av_scale_algorithm algorithm = w_av_scale_algorithm::bilinear;
+  // the threading of decoder
+  int thread_count = 0;
+  w_av_thread_type thread_type = w_av_thread_type::codec_default;
+  bool low_delay = false;
+  // how long a blocked stage sleeps before it checks its queue again
+  std::chrono::microseconds poll_interval = std::chrono::microseconds(200);
+};
+
+struct w_av_stage_stats {
+  // number of items which were passed to the next stage
+  uint64_t items = 0;
+  // number of items which were dropped
+  uint64_t dropped = 0;
+  // the average and the maximum latency in microseconds, for the demux stage
+  // it is the time which was spent waiting for the decode stage, for the
+  // others it is the time from the push of input to the push of output
+  double average_latency_us = 0;
+  uint64_t max_latency_us = 0;
+};
+
+struct w_av_pipeline_stats {
+  w_av_stage_stats demux = {};
+  w_av_stage_stats decode = {};
+  w_av_stage_stats convert = {};
+};
+
+/*
+ * an asynchronous demux -> decode -> convert pipeline of the video stream of
+ * a file or url. each stage runs on its own thread and they are connected by
+ * bounded spsc queues of refcounted packets and frames, so nothing is copied
+ * between the stages and the converted frames come from a w_av_frame_pool.
+ * a slow consumer never stalls the demuxer of a live stream when the
+ * drop_oldest policy is used. stop cancels the blocking reads of avformat.
+ * only one thread may pop the frames.
+ */
+class w_av_pipeline {
+ public:
+  /*
+   * constructor
+   * @param p_config, the config of pipeline
+   */
+  W_API explicit w_av_pipeline(_In_ w_av_pipeline_config &&p_config);
+
+  // destructor, it stops the pipeline
+  W_API virtual ~w_av_pipeline() noexcept;
+
+  /*
+   * start the threads of stages, a pipeline is started once
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> start() noexcept;
+
+  /*
+   * pop a converted frame
+   * @returns the frame or std::nullopt if none is ready
+   */
+  W_API std::optional<w_av_frame> try_pop() noexcept;
+
+  /*
+   * wait for a converted frame
+   * @param p_timeout, the maximum time of waiting
+   * @returns the frame or std::nullopt if none was ready in time or the
+   * pipeline finished
+   */
+  W_API std::optional<w_av_frame> pop(_In_ std::chrono::microseconds p_timeout) noexcept;
+
+  /*
+   * cancel the stages and join their threads, the frames which were not
+   * popped are released with the pipeline
+   * @returns zero on success, or the error which stopped a stage
+   */
+  W_API boost::leaf::result<int> stop() noexcept;
+
+  // returns true if every stage exited and all frames were popped
+  W_API bool is_finished() const noexcept;
+
+  // returns the counters of stages
+  W_API w_av_pipeline_stats get_stats() const noexcept;
+
+  // returns the token which stops the pipeline, for the owners of blocking calls
+  W_API const w_av_cancel_token &get_cancel_token() const noexcept;
+
+ private:
+  // copy constructor.
+  w_av_pipeline(const w_av_pipeline &) = delete;
+  // copy assignment operator.
+  w_av_pipeline &operator=(const w_av_pipeline &) = delete;
+  // the threads refer to this instance
+  w_av_pipeline(w_av_pipeline &&) = delete;
+  w_av_pipeline &operator=(w_av_pipeline &&) = delete;
+
+  using clock = std::chrono::steady_clock;
+
+  struct w_packet_item {
+    w_av_packet packet = {};
+    clock::time_point time = {};
+  };
+
+  struct w_frame_item {
+    w_av_frame frame = {};
+    clock::time_point time = {};
+  };
+
+  struct w_stage_counters {
+    std::atomic<uint64_t> items = 0;
+    std::atomic<uint64_t> dropped = 0;
+    std::atomic<uint64_t> total_latency_us = 0;
+    std::atomic<uint64_t> max_latency_us = 0;
+
+    void add(_In_ clock::duration p_latency) noexcept;
+    w_av_stage_stats get() const noexcept;
+  };
+
+  // the stages
+  void _demux() noexcept;
+  void _decode() noexcept;
+  void _convert() noexcept;
+
+  // push an item by the drop policy, returns false if it was dropped
+  template <typename T>
+  bool _push(_Inout_ wolf::system::w_spsc_queue<T> &p_queue, _Inout_ T &p_item) noexcept;
+  // pop an item by the drop policy, the skipped items are counted as dropped
+  template <typename T>
+  std::optional<T> _pop(_Inout_ wolf::system::w_spsc_queue<T> &p_queue,
+                        _Inout_ w_stage_counters &p_counters) noexcept;
+
+  // keep the first error of stages and cancel the others
+  void _fail(_In_ std::string &&p_error) noexcept;
+
+  w_av_pipeline_config _config;
+  w_av_cancel_token _cancel_token = {};
+  w_av_frame_pool _pool = {};
+
+  wolf::system::w_spsc_queue<w_packet_item> _packets;
+  wolf::system::w_spsc_queue<w_frame_item> _decoded;
+  wolf::system::w_spsc_queue<w_frame_item> _converted;
+
+  // it is created by the demux stage before the first packet is pushed, the
+  // decode stage uses it after it popped that packet
+  std::optional<w_decoder> _decoder = std::nullopt;
+
+  std::atomic<bool> _demux_done = false;
+  std::atomic<bool> _decode_done = false;
+  std::atomic<bool> _convert_done = false;
+
+  w_stage_counters _demux_counters = {};
+  w_stage_counters _decode_counters = {};
+  w_stage_counters _convert_counters = {};
+
+  mutable std::mutex _error_mutex;
+  std::string _error;
+
+  std::thread _demux_thread;
+  std::thread _decode_thread;
+  std::thread _convert_thread;
+};
+}  // namespace wolf::media::ffmpeg
+
+#endif  // WOLF_MEDIA_FFMPEG
@@ -3,68 +3,194 @@
 #include "w_decoder.hpp"
 
 using w_decoder = wolf::media::ffmpeg::w_decoder;
+using w_decoder_sink = wolf::media::ffmpeg::w_decoder_sink;
+using w_av_frame = wolf::media::ffmpeg::w_av_frame;
 
-boost::leaf::result<int> w_decoder::decode_frame_from_packet(_In_ AVPacket *p_packet,
-                                                             _Inout_ w_av_frame &p_frame) {
-  // start decoding
+boost::leaf::result<bool> w_decoder::_decode_packet(_In_ const AVPacket *p_packet,
+                                                    _In_ const w_decoder_sink &p_sink,
+                                                    _Inout_ int &p_count) noexcept {
+  // start decoding, a null packet enters the draining mode
   auto _ret = avcodec_send_packet(this->ctx.codec_ctx, p_packet);
-  if (_ret < 0) {
+  if (_ret < 0 && _ret != AVERROR_EOF) {
     return W_FAILURE(std::errc::operation_canceled,
-                     "could not parse packet for decoding because:\"" +
-                         w_ffmpeg_ctx::get_av_error_str(_ret) + "\"");
+                     "could not send packet for decoding because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
   }
 
+  // a packet may hold several frames, so receive until the codec needs more input
+  auto *_av_frame = this->_frame._av_frame;
   for (;;) {
-    _ret = avcodec_receive_frame(this->ctx.codec_ctx, p_frame._av_frame);
-    if (_ret == 0 || _ret == AVERROR(EAGAIN) || _ret == AVERROR_EOF) {
-      break;
+    _ret = avcodec_receive_frame(this->ctx.codec_ctx, _av_frame);
+    if (_ret == AVERROR(EAGAIN) || _ret == AVERROR_EOF) {
+      return true;
     }
     if (_ret < 0) {
       return W_FAILURE(std::errc::operation_canceled,
-                       "error happened during the encoding because:\"" +
-                           w_ffmpeg_ctx::get_av_error_str(_ret) + "\"");
+                       "error happened during the decoding because: {}",
+                       w_ffmpeg_ctx::get_av_error_str(_ret));
+    }
+
+    // the frame carries the shape of decoded picture or samples
+    auto &_config = this->_frame._config;
+    if (this->ctx.codec_ctx->codec_type == AVMEDIA_TYPE_AUDIO) {
+      _config.sample_fmts = gsl::narrow_cast<AVSampleFormat>(_av_frame->format);
+      _config.sample_rate = _av_frame->sample_rate;
+      _config.nb_channels = _av_frame->ch_layout.nb_channels;
+    } else {
+      _config.format = gsl::narrow_cast<AVPixelFormat>(_av_frame->format);
+      _config.width = _av_frame->width;
+      _config.height = _av_frame->height;
+    }
+    p_count++;
+
+    bool _continue = false;
+    try {
+      _continue = p_sink(this->_frame);
+    } catch (const std::exception &p_exc) {
+      av_frame_unref(_av_frame);
+      return W_FAILURE(std::errc::operation_canceled, "the decoder sink threw: {}",
+                       p_exc.what());
+    }
+    // give the buffer back to the pool of codec
+    av_frame_unref(_av_frame);
+    if (!_continue) {
+      return false;
     }
   }
-  return 0;
 }
 
 boost::leaf::result<int> w_decoder::decode(_In_ const w_av_packet &p_packet,
-                                           _Inout_ w_av_frame &p_frame,
+                                           _In_ const w_decoder_sink &p_sink,
                                            _In_ bool p_flush) noexcept {
-  auto _dst_packet = w_av_packet();
-  _dst_packet.init();
+  if (this->ctx.codec_ctx == nullptr || this->ctx.parser == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the decoder was not created");
+  }
+  if (!p_sink) {
+    return W_FAILURE(std::errc::invalid_argument, "missing the sink of decoder");
+  }
 
-  for (;;) {
-    const auto _bytes =
-        av_parser_parse2(this->ctx.parser, this->ctx.codec_ctx, &_dst_packet._packet->data,
-                         &_dst_packet._packet->size, p_packet._packet->data, p_packet._packet->size,
-                         AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+  if (this->_frame._av_frame == nullptr) {
+    BOOST_LEAF_CHECK(this->_frame.init());
+  }
+  if (this->_parser_packet._packet == nullptr) {
+    BOOST_LEAF_CHECK(this->_parser_packet.init());
+  }
+
+  const AVPacket *_src = p_packet._packet;
+  const uint8_t *_data = _src != nullptr ? _src->data : nullptr;
+  int _size = _src != nullptr ? _src->size : 0;
+  auto _pts = _src != nullptr ? _src->pts : AV_NOPTS_VALUE;
+  auto _dts = _src != nullptr ? _src->dts : AV_NOPTS_VALUE;
+
+  int _count = 0;
+  AVPacket *_dst = this->_parser_packet._packet;
 
-    if (_bytes == 0) {
-      break;
+  // an empty input drains the frame which is buffered in the parser
+  while (_size > 0 || p_flush) {
+    // the output points into the buffer of parser, nothing is allocated here
+    const auto _bytes =
+        av_parser_parse2(this->ctx.parser, this->ctx.codec_ctx, &_dst->data, &_dst->size, _data,
+                         _size, _pts, _dts, 0);
+    if (_bytes < 0) {
+      return W_FAILURE(std::errc::operation_canceled,
+                       "could not parse packet for decoding because: {}",
+                       w_ffmpeg_ctx::get_av_error_str(_bytes));
     }
+    _data += _bytes;
+    _size -= _bytes;
+    // the timestamps belong to the first frame of the input
+    _pts = AV_NOPTS_VALUE;
+    _dts = AV_NOPTS_VALUE;
 
-    if (_dst_packet._packet->size == 0) {
-      // try decode the inputed packet
-      BOOST_LEAF_CHECK(decode_frame_from_packet(p_packet._packet, p_frame));
-    } else {
-      if (_bytes < 0) {
-        return W_FAILURE(std::errc::operation_canceled, "could not parse packet for decoding");
-      }
-      p_packet._packet->data += _bytes;
-      p_packet._packet->size -= _bytes;
-      if (_dst_packet._packet->size > 0) {
-        BOOST_LEAF_CHECK(decode_frame_from_packet(_dst_packet._packet, p_frame));
+    if (_dst->size == 0) {
+      if (_size == 0) {
+        break;
       }
+      continue;
+    }
+
+    _dst->pts = this->ctx.parser->pts;
+    _dst->dts = this->ctx.parser->dts;
+    _dst->flags = this->ctx.parser->key_frame == 1 ? AV_PKT_FLAG_KEY : 0;
+
+    BOOST_LEAF_AUTO(_continue, _decode_packet(_dst, p_sink, _count));
+    if (!_continue) {
+      return _count;
     }
   }
 
   if (p_flush) {
-    // flush the decoder
-    BOOST_LEAF_CHECK(decode_frame_from_packet(nullptr, p_frame));
+    // flush the decoder and leave the draining mode, so it can be reused
+    BOOST_LEAF_CHECK(_decode_packet(nullptr, p_sink, _count));
+    avcodec_flush_buffers(this->ctx.codec_ctx);
+  }
+
+  return _count;
+}
+
+boost::leaf::result<int> w_decoder::reset() noexcept {
+  if (this->ctx.codec_ctx == nullptr || this->ctx.parser == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the decoder was not created");
   }
 
+  // a parser can not be flushed, so a new one replaces it with the same flags
+  auto *_parser = av_parser_init(this->ctx.codec->id);
+  if (_parser == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not initialize parser for codec id: {}",
+                     static_cast<int>(this->ctx.codec->id));
+  }
+  _parser->flags = this->ctx.parser->flags;
+  av_parser_close(this->ctx.parser);
+  this->ctx.parser = _parser;
+
+  avcodec_flush_buffers(this->ctx.codec_ctx);
   return 0;
 }
 
-#endif // WOLF_MEDIA_FFMPEG
\ No newline at end of file
+boost::leaf::result<int> w_decoder::decode(_In_ const w_av_packet &p_packet,
+                                           _Inout_ std::vector<w_av_frame> &p_frames,
+                                           _In_ bool p_flush) noexcept {
+  bool _failed = false;
+  BOOST_LEAF_AUTO(_count, decode(
+                              p_packet,
+                              [&](const w_av_frame &p_frame) {
+                                auto _ref = p_frame.ref();
+                                if (!_ref) {
+                                  _failed = true;
+                                  return false;
+                                }
+                                p_frames.push_back(std::move(_ref.value()));
+                                return true;
+                              },
+                              p_flush));
+  if (_failed) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not reference the decoded frame");
+  }
+  return _count;
+}
+
+boost::leaf::result<int> w_decoder::decode(_In_ const w_av_packet &p_packet,
+                                           _Inout_ w_av_frame &p_frame,
+                                           _In_ bool p_flush) noexcept {
+  if (p_frame._av_frame == nullptr) {
+    BOOST_LEAF_CHECK(p_frame.init());
+  }
+
+  int _ret = 0;
+  BOOST_LEAF_AUTO(_count, decode(
+                              p_packet,
+                              [&](const w_av_frame &p_decoded) {
+                                // share the buffers of the last frame
+                                av_frame_unref(p_frame._av_frame);
+                                _ret = av_frame_ref(p_frame._av_frame, p_decoded._av_frame);
+                                return _ret >= 0;
+                              },
+                              p_flush));
+  if (_ret < 0) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not reference the decoded frame: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
+  return _count;
+}
+
+#endif // WOLF_MEDIA_FFMPEG
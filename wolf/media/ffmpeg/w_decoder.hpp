@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <functional>
 #include <variant>
+#include <vector>
 
 #include "w_av_frame.hpp"
 #include "w_av_packet.hpp"
@@ -15,6 +17,13 @@
 
 namespace wolf::media::ffmpeg {
 
+/*
+ * the sink of decoded frames. the frame belongs to the decoder and is valid
+ * until the sink returns, use w_av_frame::ref to keep its buffers without a
+ * copy. return false to stop decoding, the rest of packet is dropped.
+ */
+using w_decoder_sink = std::function<bool(_In_ const w_av_frame & /*p_frame*/)>;
+
 class w_decoder {
  public:
   w_ffmpeg_ctx ctx = {};
@@ -29,19 +38,64 @@ class w_decoder {
   // move assignment operator.
   W_API w_decoder &operator=(w_decoder &&p_other) noexcept = default;
 
+  /*
+   * decode a packet which may hold several frames, every decoded frame is
+   * passed to the sink
+   * @param p_packet, the packet, it is not modified
+   * @param p_sink, the sink of decoded frames
+   * @param p_flush, drain the parser and the decoder after this packet
+   * @returns the number of decoded frames
+   */
+  W_API boost::leaf::result<int> decode(_In_ const w_av_packet &p_packet,
+                                        _In_ const w_decoder_sink &p_sink,
+                                        _In_ bool p_flush = false) noexcept;
+
+  /*
+   * decode a packet and append a reference of every decoded frame, the
+   * buffers of frames come from the pool of codec and are not copied
+   * @param p_packet, the packet, it is not modified
+   * @param p_frames, the output queue
+   * @param p_flush, drain the parser and the decoder after this packet
+   * @returns the number of decoded frames
+   */
+  W_API boost::leaf::result<int> decode(_In_ const w_av_packet &p_packet,
+                                        _Inout_ std::vector<w_av_frame> &p_frames,
+                                        _In_ bool p_flush = false) noexcept;
+
+  /*
+   * decode a packet and keep the last decoded frame
+   * @param p_packet, the packet, it is not modified
+   * @param p_frame, the last decoded frame
+   * @param p_flush, drain the parser and the decoder after this packet
+   * @returns the number of decoded frames
+   */
   W_API boost::leaf::result<int> decode(_In_ const w_av_packet &p_packet,
                                         _Inout_ w_av_frame &p_frame,
                                         _In_ bool p_flush = false) noexcept;
 
+  /*
+   * make the decoder ready for a new stream, the data which is buffered in
+   * the parser and the codec is dropped
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> reset() noexcept;
+
  private:
   // copy constructor
   w_decoder(const w_decoder &) = delete;
   // copy operator
   w_decoder &operator=(const w_decoder &) = delete;
 
-  boost::leaf::result<int> decode_frame_from_packet(
-      _In_ AVPacket *p_packet, _Inout_ w_av_frame &p_frame);
+  // send a packet and pass the frames to the sink, returns false if the sink stopped
+  boost::leaf::result<bool> _decode_packet(_In_ const AVPacket *p_packet,
+                                           _In_ const w_decoder_sink &p_sink,
+                                           _Inout_ int &p_count) noexcept;
+
+  // the output of parser, it is reused by all calls
+  w_av_packet _parser_packet = {};
+  // the frame which is received from the codec
+  w_av_frame _frame = w_av_frame(w_av_config());
 };
 }  // namespace wolf::media::ffmpeg
 
-#endif  // WOLF_MEDIA_FFMPEG
\ No newline at end of file
+#endif  // WOLF_MEDIA_FFMPEG
@@ -2,61 +2,142 @@
 
 #include "w_encoder.hpp"
 
+#include <numeric>
+
 using w_encoder = wolf::media::ffmpeg::w_encoder;
+using w_encoder_sink = wolf::media::ffmpeg::w_encoder_sink;
 using w_av_packet = wolf::media::ffmpeg::w_av_packet;
 
-boost::leaf::result<int> w_encoder::_encode_frame_to_packet(
-    _In_ const AVFrame *p_frame, _Inout_ std::vector<uint8_t> &p_packet_data) const noexcept {
-  auto _packet = w_av_packet();
-  _packet.init();
+boost::leaf::result<bool> w_encoder::_encode_frame(_In_ const AVFrame *p_frame,
+                                                   _In_ const w_encoder_sink &p_sink,
+                                                   _Inout_ int &p_count) noexcept {
+  // a null frame enters the draining mode
+  auto _ret = avcodec_send_frame(this->ctx.codec_ctx, p_frame);
+  if (_ret == AVERROR_EOF && p_frame != nullptr) {
+    // a flushed encoder without AV_CODEC_CAP_ENCODER_FLUSH never leaves the draining mode
+    return W_FAILURE(std::errc::operation_canceled,
+                     "the encoder {} was drained, reset or recreate it before encoding",
+                     this->ctx.codec->name);
+  }
+  if (_ret < 0 && _ret != AVERROR_EOF) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "failed to send the avframe for encoding because: {}",
+                     w_ffmpeg_ctx::get_av_error_str(_ret));
+  }
 
   for (;;) {
-    auto _ret = avcodec_send_frame(this->ctx.codec_ctx, p_frame);
+    // the sink may have moved the previous packet out
+    if (this->_packet._packet == nullptr) {
+      BOOST_LEAF_CHECK(this->_packet.init());
+    }
+
+    _ret = avcodec_receive_packet(this->ctx.codec_ctx, this->_packet._packet);
+    if (_ret == AVERROR(EAGAIN) || _ret == AVERROR_EOF) {
+      return true;
+    }
     if (_ret < 0) {
       return W_FAILURE(std::errc::operation_canceled,
-                       "failed to send the avframe for encoding because:\"" +
-                           w_ffmpeg_ctx::get_av_error_str(_ret) + "\"");
+                       "error happened during the encoding because: {}",
+                       w_ffmpeg_ctx::get_av_error_str(_ret));
     }
+    p_count++;
 
-    for (;;) {
-      _ret = avcodec_receive_packet(this->ctx.codec_ctx, _packet._packet);
-      if (_ret == 0 || _ret == AVERROR_EOF) {
-        if (_packet._packet->size) {
-          std::copy(_packet._packet->data, _packet._packet->data + _packet._packet->size,
-                    std::back_inserter(p_packet_data));
-        }
-        return 0;
-      }
+    bool _continue = false;
+    try {
+      _continue = p_sink(this->_packet);
+    } catch (const std::exception &p_exc) {
+      this->_packet.unref();
+      return W_FAILURE(std::errc::operation_canceled, "the encoder sink threw: {}",
+                       p_exc.what());
+    }
+    if (this->_packet._packet != nullptr) {
+      this->_packet.unref();
+    }
+    if (!_continue) {
+      return false;
+    }
+  }
+}
 
-      _packet.unref();
+boost::leaf::result<int> w_encoder::encode(_In_ const w_av_frame &p_frame,
+                                           _In_ const w_encoder_sink &p_sink,
+                                           _In_ bool p_flush) noexcept {
+  if (this->ctx.codec_ctx == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the encoder was not created");
+  }
+  if (!p_sink) {
+    return W_FAILURE(std::errc::invalid_argument, "missing the sink of encoder");
+  }
 
-      if (_ret == AVERROR(EAGAIN)) {
-        break;
-      }
-      return W_FAILURE(std::errc::operation_canceled,
-                       "error happened during the encoding because:\"" +
-                           w_ffmpeg_ctx::get_av_error_str(_ret) + "\"");
+  int _count = 0;
+  this->_dirty = true;
+  BOOST_LEAF_AUTO(_continue, _encode_frame(p_frame._av_frame, p_sink, _count));
+  if (_continue && p_flush) {
+    BOOST_LEAF_CHECK(_encode_frame(nullptr, p_sink, _count));
+    // leave the draining mode if the encoder supports it
+    if (this->ctx.codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH) {
+      avcodec_flush_buffers(this->ctx.codec_ctx);
+      this->_dirty = false;
     }
   }
+  return _count;
+}
+
+boost::leaf::result<int> w_encoder::reset() noexcept {
+  if (this->ctx.codec_ctx == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the encoder was not created");
+  }
+  if (!this->_dirty) {
+    return 0;
+  }
+  if ((this->ctx.codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH) == 0) {
+    return W_FAILURE(std::errc::not_supported, "the encoder {} can not be flushed",
+                     this->ctx.codec->name);
+  }
+  avcodec_flush_buffers(this->ctx.codec_ctx);
+  this->_dirty = false;
   return 0;
 }
 
 boost::leaf::result<int> w_encoder::encode(_In_ const w_av_frame &p_frame,
-                                           _Inout_ w_av_packet &p_packet,
+                                           _Inout_ std::vector<w_av_packet> &p_packets,
                                            _In_ bool p_flush) noexcept {
-  std::vector<uint8_t> _packet_data;
+  return encode(
+      p_frame,
+      [&](w_av_packet &p_packet) {
+        p_packets.push_back(std::move(p_packet));
+        return true;
+      },
+      p_flush);
+}
 
-  // encode frame to packet
-  BOOST_LEAF_CHECK(_encode_frame_to_packet(p_frame._av_frame, _packet_data));
-  if (p_flush) {
-    // flush
-    BOOST_LEAF_CHECK(_encode_frame_to_packet(nullptr, _packet_data));
-  }
+boost::leaf::result<int> w_encoder::encode(_In_ const w_av_frame &p_frame,
+                                           _Inout_ w_av_packet &p_packet,
+                                           _In_ bool p_flush) noexcept {
+  try {
+    std::vector<w_av_packet> _packets;
+    BOOST_LEAF_AUTO(_count, encode(p_frame, _packets, p_flush));
 
-  // init packet
-  p_packet.init(std::move(_packet_data));
+    if (_packets.size() == 1) {
+      p_packet = std::move(_packets.front());
+      return _count;
+    }
 
-  return {};
+    // the packets of a flush are joined into one buffer
+    const auto _size = std::accumulate(
+        _packets.cbegin(), _packets.cend(), size_t{0},
+        [](size_t p_sum, const w_av_packet &p_item) { return p_sum + p_item.get_size(); });
+    std::vector<uint8_t> _data;
+    _data.reserve(_size);
+    for (const auto &_item : _packets) {
+      _data.insert(_data.end(), _item.get_data(), _item.get_data() + _item.get_size());
+    }
+    BOOST_LEAF_CHECK(p_packet.init(std::move(_data)));
+    return _count;
+  } catch (const std::exception &p_exc) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not join the encoded packets: {}",
+                     p_exc.what());
+  }
 }
 
-#endif // WOLF_MEDIA_FFMPEG
\ No newline at end of file
+#endif // WOLF_MEDIA_FFMPEG
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <functional>
 #include <variant>
 #include <vector>
 
@@ -16,6 +17,13 @@
 
 namespace wolf::media::ffmpeg {
 
+/*
+ * the sink of encoded packets. the packet wraps the refcounted buffer of
+ * codec, move it out of the reference to keep it without a copy, otherwise
+ * it is released when the sink returns. return false to stop receiving.
+ */
+using w_encoder_sink = std::function<bool(_Inout_ w_av_packet & /*p_packet*/)>;
+
 class w_encoder {
  public:
   // constructor
@@ -28,10 +36,49 @@ class w_encoder {
   // move assignment operator.
   W_API w_encoder &operator=(w_encoder &&p_other) noexcept = default;
 
+  /*
+   * encode a frame and pass every encoded packet to the sink
+   * @param p_frame, the frame
+   * @param p_sink, the sink of encoded packets
+   * @param p_flush, drain the encoder after this frame, a codec without
+   * AV_CODEC_CAP_ENCODER_FLUSH fails the next frames until it is recreated
+   * @returns the number of encoded packets
+   */
+  W_API boost::leaf::result<int> encode(_In_ const w_av_frame &p_frame,
+                                        _In_ const w_encoder_sink &p_sink,
+                                        _In_ bool p_flush = true) noexcept;
+
+  /*
+   * encode a frame and append the encoded packets, their data is not copied
+   * @param p_frame, the frame
+   * @param p_packets, the output queue
+   * @param p_flush, drain the encoder after this frame
+   * @returns the number of encoded packets
+   */
+  W_API boost::leaf::result<int> encode(_In_ const w_av_frame &p_frame,
+                                        _Inout_ std::vector<w_av_packet> &p_packets,
+                                        _In_ bool p_flush = true) noexcept;
+
+  /*
+   * encode a frame into one packet, a single encoded packet is moved without
+   * a copy, several packets are joined into one buffer
+   * @param p_frame, the frame
+   * @param p_packet, the packet
+   * @param p_flush, drain the encoder after this frame
+   * @returns the number of encoded packets
+   */
   W_API boost::leaf::result<int> encode(_In_ const w_av_frame &p_frame,
                                         _Inout_ w_av_packet &p_packet,
                                         _In_ bool p_flush = true) noexcept;
 
+  /*
+   * make the encoder ready for a new stream, the frames which were sent and
+   * not drained are dropped. a drained encoder whose codec lacks
+   * AV_CODEC_CAP_ENCODER_FLUSH can not be reset
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> reset() noexcept;
+
   w_ffmpeg_ctx ctx = {};
 
  private:
@@ -40,9 +87,15 @@ class w_encoder {
   // copy operator
   w_encoder &operator=(const w_encoder &) = delete;
 
-  boost::leaf::result<int> _encode_frame_to_packet(
-      _In_ const AVFrame *p_frame,
-      _Inout_ std::vector<uint8_t> &p_packet_data) const noexcept;
+  // send a frame and pass the packets to the sink, returns false if the sink stopped
+  boost::leaf::result<bool> _encode_frame(_In_ const AVFrame *p_frame,
+                                          _In_ const w_encoder_sink &p_sink,
+                                          _Inout_ int &p_count) noexcept;
+
+  // the packet which is received from the codec
+  w_av_packet _packet = {};
+  // a frame was sent since the encoder was opened or flushed
+  bool _dirty = false;
 };
 }  // namespace wolf::media::ffmpeg
 
@@ -6,9 +6,11 @@ extern "C" {
 #include <libavutil/opt.h>
 }
 
+using w_av_cancel_token = wolf::media::ffmpeg::w_av_cancel_token;
 using w_av_codec_opt = wolf::media::ffmpeg::w_av_codec_opt;
 using w_av_config = wolf::media::ffmpeg::w_av_config;
 using w_av_set_opt = wolf::media::ffmpeg::w_av_set_opt;
+using w_av_thread_type = wolf::media::ffmpeg::w_av_thread_type;
 using w_decoder = wolf::media::ffmpeg::w_decoder;
 using w_encoder = wolf::media::ffmpeg::w_encoder;
 using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
@@ -68,7 +70,8 @@ static boost::leaf::result<AVDictionary *> s_set_dict(
 static boost::leaf::result<int> s_create(_Inout_ w_ffmpeg_ctx &p_ctx,
                                          _In_ const w_av_config &p_config,
                                          _In_ const w_av_codec_opt &p_codec_opts,
-                                         _In_ const std::vector<w_av_set_opt> &p_opts) noexcept {
+                                         _In_ const std::vector<w_av_set_opt> &p_opts,
+                                         _In_opt_ const AVCodecParameters *p_params = nullptr) noexcept {
   p_ctx.codec_ctx = avcodec_alloc_context3(p_ctx.codec);
   if (p_ctx.codec_ctx == nullptr) {
     return W_FAILURE(std::errc::not_enough_memory,
@@ -84,6 +87,17 @@ static boost::leaf::result<int> s_create(_Inout_ w_ffmpeg_ctx &p_ctx,
     }
   });
 
+  // the stream parameters carry the extradata which some decoders need
+  if (p_params != nullptr) {
+    const auto _ret = avcodec_parameters_to_context(p_ctx.codec_ctx, p_params);
+    if (_ret < 0) {
+      _has_error = true;
+      return W_FAILURE(std::errc::invalid_argument,
+                       "could not copy the codec parameters because: {}",
+                       w_ffmpeg_ctx::get_av_error_str(_ret));
+    }
+  }
+
   p_ctx.codec_ctx->width = p_config.width;
   p_ctx.codec_ctx->height = p_config.height;
   p_ctx.codec_ctx->bit_rate = p_codec_opts.bitrate;
@@ -107,6 +121,14 @@ static boost::leaf::result<int> s_create(_Inout_ w_ffmpeg_ctx &p_ctx,
   if (p_codec_opts.thread_count >= 0) {
     p_ctx.codec_ctx->thread_count = p_codec_opts.thread_count;
   }
+  // set thread type
+  if (p_codec_opts.thread_type != w_av_thread_type::codec_default) {
+    p_ctx.codec_ctx->thread_type = static_cast<int>(p_codec_opts.thread_type);
+  }
+  // set low delay
+  if (p_codec_opts.low_delay) {
+    p_ctx.codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+  }
   // set level
   if (p_codec_opts.level >= 0) {
     p_ctx.codec_ctx->level = p_codec_opts.level;
@@ -248,11 +270,42 @@ boost::leaf::result<w_decoder> w_ffmpeg::create_decoder(
   return _decoder;
 }
 
+boost::leaf::result<w_decoder> w_ffmpeg::create_decoder(
+    _In_ const AVCodecParameters *p_params, _In_ const w_av_codec_opt &p_codec_opts,
+    _In_ const std::vector<w_av_set_opt> &p_opts) noexcept {
+  if (p_params == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "missing the codec parameters");
+  }
+
+  w_decoder _decoder = {};
+
+  _decoder.ctx.codec = avcodec_find_decoder(p_params->codec_id);
+  if (_decoder.ctx.codec == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "could not find decoder codec id: {}",
+                     gsl::narrow_cast<int>(p_params->codec_id));
+  }
+
+  _decoder.ctx.parser = av_parser_init(_decoder.ctx.codec->id);
+  if (_decoder.ctx.parser == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "could not initialize parser for codec id: {}",
+                     gsl::narrow_cast<int>(p_params->codec_id));
+  }
+  // the demuxed packets hold whole frames, so the parser does not wait for the next one
+  _decoder.ctx.parser->flags |= PARSER_FLAG_COMPLETE_FRAMES;
+
+  const auto _config = w_av_config(gsl::narrow_cast<AVPixelFormat>(p_params->format),
+                                   p_params->width, p_params->height);
+  BOOST_LEAF_CHECK(s_create(_decoder.ctx, _config, p_codec_opts, p_opts, p_params));
+
+  return _decoder;
+}
+
 boost::leaf::result<int> w_ffmpeg::open_stream(
     _In_ const std::string &p_url, _In_ const std::vector<w_av_set_opt> &p_opts,
     _In_ const
         std::function<bool(const w_av_packet & /*p_packet*/, const AVStream * /*p_audio_stream*/,
-                           const AVStream * /*p_video_stream*/)> &p_on_frame) noexcept {
+                           const AVStream * /*p_video_stream*/)> &p_on_frame,
+    _In_opt_ const w_av_cancel_token *p_cancel_token) noexcept {
   try {
     // url is invalid
     if (p_url.empty()) {
@@ -269,12 +322,16 @@ boost::leaf::result<int> w_ffmpeg::open_stream(
 
     DEFER {
       if (_fmt_ctx != nullptr) {
-        // free av format context
-        avformat_free_context(_fmt_ctx);
-        _fmt_ctx = nullptr;
+        // close the input and free av format context
+        avformat_close_input(&_fmt_ctx);
       }
     });
 
+    // the blocking calls of avformat check the token
+    if (p_cancel_token != nullptr) {
+      _fmt_ctx->interrupt_callback = p_cancel_token->get_interrupt_cb();
+    }
+
     // allocate memory for packet
     auto _packet = w_av_packet();
     BOOST_LEAF_CHECK(_packet.init());
@@ -284,6 +341,7 @@ boost::leaf::result<int> w_ffmpeg::open_stream(
 
     // open input url
     int _ret = avformat_open_input(&_fmt_ctx, p_url.c_str(), nullptr, &_dict);
+    av_dict_free(&_dict);
     if (_ret < 0) {
       return W_FAILURE(std::errc::operation_canceled,
                        "could not open input url: " + p_url +
@@ -11,6 +11,7 @@
 #include <variant>
 #include <vector>
 
+#include "w_av_cancel_token.hpp"
 #include "w_av_packet.hpp"
 #include "w_decoder.hpp"
 #include "w_encoder.hpp"
@@ -18,6 +19,18 @@
 
 namespace wolf::media::ffmpeg {
 
+// the threading model of codec
+enum class w_av_thread_type : int {
+  // keep the default of codec
+  codec_default = 0,
+  // decode several frames at once, it adds one frame of delay per thread
+  frame = FF_THREAD_FRAME,
+  // decode the slices of one frame at once
+  slice = FF_THREAD_SLICE,
+  // let the codec choose between frame and slice threading
+  frame_and_slice = FF_THREAD_FRAME | FF_THREAD_SLICE,
+};
+
 struct w_av_codec_opt {
   int64_t bitrate;
   int fps;
@@ -25,7 +38,11 @@ struct w_av_codec_opt {
   int level;
   int max_b_frames;
   int refs;
+  // zero means automatic
   int thread_count;
+  w_av_thread_type thread_type = w_av_thread_type::codec_default;
+  // set AV_CODEC_FLAG_LOW_DELAY, ffmpeg turns off frame threading for it
+  bool low_delay = false;
 };
 
 struct w_av_set_opt {
@@ -89,11 +106,25 @@ class w_ffmpeg {
       _In_ const w_av_codec_opt &p_codec_opts,
       _In_ const std::vector<w_av_set_opt> &p_opts = {}) noexcept;
 
+  /*
+   * create ffmpeg decoder for a demuxed stream, the parameters of stream
+   * such as the extradata are copied into the codec
+   * @param p_params, the codec parameters of stream
+   * @param p_codec_opts, the codec settings
+   * @param p_opts, the codec options
+   * @returns decoder object on success
+   */
+  W_API static boost::leaf::result<w_decoder> create_decoder(
+      _In_ const AVCodecParameters *p_params, _In_ const w_av_codec_opt &p_codec_opts,
+      _In_ const std::vector<w_av_set_opt> &p_opts = {}) noexcept;
+
   /*
    * open and receive stream from file or url
    * @param p_url, the url
    * @param p_opts, the codec options
    * @param p_on_frame, on frame data recieved callback
+   * @param p_cancel_token, an optional token which interrupts the blocking
+   * reads of avformat
    * @returns encoder object on success
    */
   W_API static boost::leaf::result<int> open_stream(
@@ -101,7 +132,8 @@ class w_ffmpeg {
       _In_ const std::vector<w_av_set_opt> &p_opts,
       _In_ const std::function<bool(
           const w_av_packet & /*p_packet*/, const AVStream * /*p_audio_stream*/,
-          const AVStream * /*p_video_stream*/)> &p_on_frame) noexcept;
+          const AVStream * /*p_video_stream*/)> &p_on_frame,
+      _In_opt_ const w_av_cancel_token *p_cancel_token = nullptr) noexcept;
 };
 }  // namespace wolf::media::ffmpeg
 
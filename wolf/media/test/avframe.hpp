@@ -49,4 +49,270 @@ BOOST_AUTO_TEST_CASE(avframe_test) {
   std::cout << "leaving test case 'avframe_test'" << std::endl;
 }
 
-#endif
\ No newline at end of file
+#endif  // defined(WOLF_TEST) && defined(WOLF_MEDIA_FFMPEG) && defined(WOLF_MEDIA_STB)
+
+#if defined(WOLF_TEST) && defined(WOLF_MEDIA_FFMPEG)
+
+#include <boost/test/included/unit_test.hpp>
+#include <media/ffmpeg/w_av_converter.hpp>
+#include <media/ffmpeg/w_av_frame.hpp>
+#include <media/ffmpeg/w_av_frame_pool.hpp>
+#include <system/test/alloc_counter.hpp>
+#include <system/w_leak_detector.hpp>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <array>
+#include <chrono>
+#include <cstring>
+
+// a yuv420p frame with a pattern
+static boost::leaf::result<wolf::media::ffmpeg::w_av_frame> s_make_yuv_frame(_In_ int p_width,
+                                                                             _In_ int p_height) {
+  using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+  using w_av_config = wolf::media::ffmpeg::w_av_config;
+
+  auto _config = w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, p_width, p_height);
+  const auto _size = gsl::narrow_cast<size_t>(_config.get_required_video_buffer_size());
+  auto _data = std::vector<uint8_t>(_size);
+  for (size_t i = 0; i < _size; ++i) {
+    _data[i] = gsl::narrow_cast<uint8_t>((i * 7) ^ (i >> 11));
+  }
+
+  auto _frame = w_av_frame(std::move(_config));
+  BOOST_LEAF_CHECK(_frame.init());
+  BOOST_LEAF_CHECK(_frame.set_video_frame(std::move(_data)));
+  return _frame;
+}
+
+BOOST_AUTO_TEST_CASE(av_converter_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_converter_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+        using w_av_config = wolf::media::ffmpeg::w_av_config;
+        using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+        using w_av_scale_algorithm = wolf::media::ffmpeg::w_av_scale_algorithm;
+
+        BOOST_LEAF_AUTO(_src, s_make_yuv_frame(640, 360));
+
+        // the converter and the per-call conversion give the same pixels
+        auto _converter = w_av_converter(w_av_scale_algorithm::bicubic);
+        BOOST_LEAF_AUTO(_expected,
+                        _src.convert_video(w_av_config(AVPixelFormat::AV_PIX_FMT_RGBA, 640, 360)));
+
+        auto _dst = w_av_frame(w_av_config(AVPixelFormat::AV_PIX_FMT_RGBA, 640, 360));
+        BOOST_LEAF_CHECK(_dst.init());
+        BOOST_LEAF_CHECK(_dst.set_video_frame(std::vector<uint8_t>()));
+        for (int i = 0; i < 3; ++i) {
+          BOOST_LEAF_AUTO(_height, _converter.convert_video(_src, _dst));
+          BOOST_REQUIRE(_height == 360);
+        }
+
+        const auto [_expected_data, _expected_size] = _expected.get();
+        const auto [_dst_data, _dst_size] = _dst.get();
+        BOOST_REQUIRE(_expected_size == _dst_size);
+        BOOST_REQUIRE(std::memcmp(_expected_data[0], _dst_data[0], _dst_size) == 0);
+
+        // the shape changes rebuild the context
+        _converter.set_algorithm(w_av_scale_algorithm::fast_bilinear);
+        BOOST_LEAF_AUTO(_small,
+                        _converter.convert_video(
+                            _src, w_av_config(AVPixelFormat::AV_PIX_FMT_BGR24, 320, 180)));
+        BOOST_REQUIRE(_small.get_config().width == 320);
+
+        // an uninitialized destination fails
+        auto _empty = w_av_frame(w_av_config(AVPixelFormat::AV_PIX_FMT_RGBA, 640, 360));
+        BOOST_REQUIRE(_converter.convert_video(_src, _empty).has_error());
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_converter_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_converter_test got an error!"); });
+
+  std::cout << "leaving test case 'av_converter_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_converter_benchmark) {
+  std::cout << "entering test case 'av_converter_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+        using w_av_config = wolf::media::ffmpeg::w_av_config;
+        using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+        using w_av_scale_algorithm = wolf::media::ffmpeg::w_av_scale_algorithm;
+        using clock = std::chrono::steady_clock;
+
+        constexpr int _width = 1920;
+        constexpr int _height = 1080;
+        constexpr int _frames = 120;
+
+        BOOST_LEAF_AUTO(_src, s_make_yuv_frame(_width, _height));
+        const auto _rgba_config = w_av_config(AVPixelFormat::AV_PIX_FMT_RGBA, _width, _height);
+
+        const auto _report = [&](const char *p_name, clock::duration p_elapsed) {
+          std::cout << wolf::format("{:<40} | {:>7.1f} fps", p_name,
+                                    _frames / std::chrono::duration<double>(p_elapsed).count())
+                    << std::endl;
+        };
+
+        auto _dst = w_av_frame(w_av_config(_rgba_config));
+        BOOST_LEAF_CHECK(_dst.init());
+        BOOST_LEAF_CHECK(_dst.set_video_frame(std::vector<uint8_t>()));
+        const auto [_src_data, _src_size] = _src.get();
+        const auto [_dst_data, _dst_size] = _dst.get();
+        const auto _src_linesize = std::array<int, 3>{_width, _width / 2, _width / 2};
+        const auto _dst_linesize = std::array<int, 1>{_width * 4};
+
+        // the previous path, a context per frame
+        for (const auto [_name, _flags] :
+             {std::pair{"sws_getContext per frame, bicubic", SWS_BICUBIC},
+              std::pair{"sws_getContext per frame, fast bilinear", SWS_FAST_BILINEAR}}) {
+          const auto _start = clock::now();
+          for (int i = 0; i < _frames; ++i) {
+            auto *_context = sws_getContext(_width, _height, AVPixelFormat::AV_PIX_FMT_YUV420P,
+                                            _width, _height, AVPixelFormat::AV_PIX_FMT_RGBA,
+                                            _flags, nullptr, nullptr, nullptr);
+            BOOST_REQUIRE(_context != nullptr);
+            sws_scale(_context, _src_data, _src_linesize.data(), 0, _height, _dst_data,
+                      _dst_linesize.data());
+            sws_freeContext(_context);
+          }
+          _report(_name, clock::now() - _start);
+        }
+
+        // a cached context into a new frame and into the same frame
+        for (const auto [_name, _algorithm] :
+             {std::pair{"w_av_converter, bicubic", w_av_scale_algorithm::bicubic},
+              std::pair{"w_av_converter, fast bilinear", w_av_scale_algorithm::fast_bilinear}}) {
+          auto _converter = w_av_converter(_algorithm);
+
+          auto _start = clock::now();
+          for (int i = 0; i < _frames; ++i) {
+            BOOST_LEAF_AUTO(_frame, _converter.convert_video(_src, w_av_config(_rgba_config)));
+          }
+          _report(wolf::format("{}, new frame", _name).c_str(), clock::now() - _start);
+
+          _start = clock::now();
+          for (int i = 0; i < _frames; ++i) {
+            BOOST_LEAF_CHECK(_converter.convert_video(_src, _dst));
+          }
+          _report(wolf::format("{}, reused frame", _name).c_str(), clock::now() - _start);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_converter_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_converter_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'av_converter_benchmark'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_frame_pool_benchmark) {
+  std::cout << "entering test case 'av_frame_pool_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_av_frame = wolf::media::ffmpeg::w_av_frame;
+        using w_av_config = wolf::media::ffmpeg::w_av_config;
+        using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+        using w_av_frame_pool = wolf::media::ffmpeg::w_av_frame_pool;
+        using clock = std::chrono::steady_clock;
+
+        constexpr int _width = 1920;
+        constexpr int _height = 1080;
+        constexpr size_t _frames = 120;
+        constexpr size_t _in_flight = 3;
+
+        BOOST_LEAF_AUTO(_src, s_make_yuv_frame(_width, _height));
+        const auto _rgba_config = w_av_config(AVPixelFormat::AV_PIX_FMT_RGBA, _width, _height);
+        auto _converter = w_av_converter();
+
+        const auto _report = [&](const char *p_name, clock::duration p_elapsed,
+                                 uint64_t p_allocs, uint64_t p_pool_allocs) {
+          std::cout << wolf::format(
+                           "{:<24} | {:>7.1f} fps | {:>5.2f} heap allocs/frame | {:>5.2f} pool "
+                           "allocs/frame",
+                           p_name, _frames / std::chrono::duration<double>(p_elapsed).count(),
+                           static_cast<double>(p_allocs) / _frames,
+                           static_cast<double>(p_pool_allocs) / _frames)
+                    << std::endl;
+        };
+
+        // a vector per converted frame
+        {
+          const auto _allocs = get_test_alloc_count();
+          const auto _start = clock::now();
+          for (size_t i = 0; i < _frames; ++i) {
+            BOOST_LEAF_AUTO(_frame, _converter.convert_video(_src, w_av_config(_rgba_config)));
+          }
+          _report("vector per frame", clock::now() - _start, get_test_alloc_count() - _allocs, 0);
+        }
+
+        // recycled frames with pooled buffers, a few of them in flight and the
+        // latest one shared with a consumer
+        {
+          auto _pool = w_av_frame_pool();
+          std::vector<w_av_frame> _frames_in_flight;
+          for (size_t i = 0; i < _in_flight; ++i) {
+            auto _frame = w_av_frame(w_av_config(_rgba_config));
+            BOOST_LEAF_CHECK(_frame.init());
+            _frames_in_flight.push_back(std::move(_frame));
+          }
+          auto _consumer = w_av_frame(w_av_config(_rgba_config));
+
+          const auto _step = [&](size_t p_index) -> boost::leaf::result<void> {
+            auto &_frame = _frames_in_flight[p_index % _in_flight];
+            BOOST_LEAF_CHECK(_frame.set_video_frame(_pool));
+            BOOST_LEAF_CHECK(_converter.convert_video(_src, _frame));
+            BOOST_LEAF_ASSIGN(_consumer, _frame.ref());
+            return {};
+          };
+
+          // warm up the pool
+          for (size_t i = 0; i < 2 * _in_flight; ++i) {
+            BOOST_LEAF_CHECK(_step(i));
+          }
+
+          const auto _stats = _pool.get_stats();
+          const auto _allocs = get_test_alloc_count();
+          const auto _start = clock::now();
+          for (size_t i = 0; i < _frames; ++i) {
+            BOOST_LEAF_CHECK(_step(i));
+          }
+          const auto _elapsed = clock::now() - _start;
+          const auto _heap_allocs = get_test_alloc_count() - _allocs;
+          const auto _pool_allocs = _pool.get_stats().allocations - _stats.allocations;
+          _report("w_av_frame_pool", _elapsed, _heap_allocs, _pool_allocs);
+
+          BOOST_REQUIRE(_heap_allocs == 0);
+          BOOST_REQUIRE(_pool_allocs == 0);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_frame_pool_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_frame_pool_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'av_frame_pool_benchmark'" << std::endl;
+}
+
+#endif  // defined(WOLF_TEST) && defined(WOLF_MEDIA_FFMPEG)
\ No newline at end of file
@@ -6,16 +6,46 @@
 #if defined(WOLF_TEST) && defined(WOLF_MEDIA_FFMPEG) && defined(WOLF_MEDIA_STB)
 
 #include <boost/test/included/unit_test.hpp>
+#include <media/ffmpeg/w_av_codec_pool.hpp>
+#include <media/ffmpeg/w_av_color_kernels.hpp>
+#include <media/ffmpeg/w_av_converter.hpp>
+#include <media/ffmpeg/w_av_format.hpp>
+#include <media/ffmpeg/w_av_frame_seeker.hpp>
+#include <media/ffmpeg/w_av_pipeline.hpp>
 #include <media/ffmpeg/w_encoder.hpp>
 #include <media/ffmpeg/w_ffmpeg.hpp>
 #include <system/w_leak_detector.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <tuple>
+
 using w_av_frame = wolf::media::ffmpeg::w_av_frame;
 using w_av_codec_opt = wolf::media::ffmpeg::w_av_codec_opt;
 using w_av_config = wolf::media::ffmpeg::w_av_config;
 using w_av_set_opt = wolf::media::ffmpeg::w_av_set_opt;
 using w_av_packet = wolf::media::ffmpeg::w_av_packet;
 using w_ffmpeg = wolf::media::ffmpeg::w_ffmpeg;
+using w_av_thread_type = wolf::media::ffmpeg::w_av_thread_type;
+using w_av_pipeline = wolf::media::ffmpeg::w_av_pipeline;
+using w_av_pipeline_config = wolf::media::ffmpeg::w_av_pipeline_config;
+using w_av_pipeline_stats = wolf::media::ffmpeg::w_av_pipeline_stats;
+using w_av_drop_policy = wolf::media::ffmpeg::w_av_drop_policy;
+using w_av_format = wolf::media::ffmpeg::w_av_format;
+using w_av_io_config = wolf::media::ffmpeg::w_av_io_config;
+using w_av_converter = wolf::media::ffmpeg::w_av_converter;
+using w_av_color_kernels = wolf::media::ffmpeg::w_av_color_kernels;
+using w_av_simd_level = wolf::media::ffmpeg::w_av_simd_level;
+using w_av_codec_pool = wolf::media::ffmpeg::w_av_codec_pool;
+using w_av_codec_pool_stats = wolf::media::ffmpeg::w_av_codec_pool_stats;
+using w_av_frame_seeker = wolf::media::ffmpeg::w_av_frame_seeker;
+using w_av_seek_config = wolf::media::ffmpeg::w_av_seek_config;
 
 static boost::leaf::result<std::tuple<w_av_packet, w_av_config, w_av_config>>
 s_encode(_In_ const std::string &p_name,
@@ -245,4 +275,1299 @@ BOOST_AUTO_TEST_CASE(x264_encode_decode_test) {
   std::cout << "leaving test case 'x264_encode_decode_test'" << std::endl;
 }
 
-#endif
\ No newline at end of file
+// a yuv420p frame with a moving pattern
+static boost::leaf::result<w_av_frame> s_make_pattern_frame(_In_ int p_width, _In_ int p_height,
+                                                           _In_ int p_index) {
+  auto _config = w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, p_width, p_height);
+  const auto _size = gsl::narrow_cast<size_t>(_config.get_required_video_buffer_size());
+  const auto _luma_size = gsl::narrow_cast<size_t>(p_width) * p_height;
+
+  auto _data = std::vector<uint8_t>(_size, 128);
+  for (size_t j = 0; j < _luma_size; ++j) {
+    const auto _x = j % p_width;
+    const auto _y = j / p_width;
+    _data[j] = gsl::narrow_cast<uint8_t>(_x + _y + gsl::narrow_cast<size_t>(p_index) * 4);
+  }
+
+  auto _frame = w_av_frame(std::move(_config));
+  BOOST_LEAF_CHECK(_frame.init());
+  BOOST_LEAF_CHECK(_frame.set_video_frame(std::move(_data)));
+  _frame.set_pts(p_index);
+  return _frame;
+}
+
+// create a low latency h264 encoder for the generated clips
+static boost::leaf::result<wolf::media::ffmpeg::w_encoder> s_create_h264_encoder(
+    _In_ int p_width, _In_ int p_height, _In_ int p_gop = 30) {
+  const auto _config = w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, p_width, p_height);
+  const auto _codec_opt = w_av_codec_opt{
+      2'000'000, /*bitrate*/
+      30,        /*fps*/
+      p_gop,     /*gop*/
+      -1,        /*level*/
+      0,         /*max_b_frames*/
+      1,         /*refs*/
+      -1,        /*thread_count*/
+  };
+  const auto _opts = std::vector<w_av_set_opt>{w_av_set_opt{"preset", "ultrafast"},
+                                               w_av_set_opt{"tune", "zerolatency"}};
+  return w_ffmpeg::create_encoder(_config, AVCodecID::AV_CODEC_ID_H264, _codec_opt, _opts);
+}
+
+// encode a moving pattern into an h264 elementary stream
+static boost::leaf::result<std::vector<uint8_t>> s_make_h264_clip(_In_ int p_width,
+                                                                  _In_ int p_height,
+                                                                  _In_ int p_frames,
+                                                                  _In_ int p_gop = 30) {
+  BOOST_LEAF_AUTO(_encoder, s_create_h264_encoder(p_width, p_height, p_gop));
+
+  std::vector<uint8_t> _clip;
+  for (int i = 0; i < p_frames; ++i) {
+    BOOST_LEAF_AUTO(_frame, s_make_pattern_frame(p_width, p_height, i));
+
+    auto _packet = w_av_packet();
+    BOOST_LEAF_CHECK(_encoder.encode(_frame, _packet, i == p_frames - 1));
+    if (_packet.get_size() > 0) {
+      _clip.insert(_clip.end(), _packet.get_data(), _packet.get_data() + _packet.get_size());
+    }
+  }
+  return _clip;
+}
+
+BOOST_AUTO_TEST_CASE(decoder_benchmark) {
+  std::cout << "entering test case 'decoder_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_decoder = wolf::media::ffmpeg::w_decoder;
+        using clock = std::chrono::steady_clock;
+        using w_encoder = wolf::media::ffmpeg::w_encoder;
+        using w_decoder = wolf::media::ffmpeg::w_decoder;
+
+        constexpr int _width = 1280;
+        constexpr int _height = 720;
+        constexpr int _frames = 240;
+        constexpr int _frames_per_packet = 4;
+
+        BOOST_LEAF_AUTO(_clip, s_make_h264_clip(_width, _height, _frames));
+        BOOST_REQUIRE(!_clip.empty());
+
+        // the chunks do not follow the frame boundaries, so each one holds
+        // several frames and leaves the parser with a partial one
+        const auto _chunk_size = std::max<size_t>(_clip.size() * _frames_per_packet / _frames, 1);
+        std::vector<w_av_packet> _packets;
+        for (size_t _offset = 0; _offset < _clip.size(); _offset += _chunk_size) {
+          auto _packet = w_av_packet();
+          BOOST_LEAF_CHECK(_packet.init(_clip.data() + _offset,
+                                        std::min(_chunk_size, _clip.size() - _offset)));
+          _packets.push_back(std::move(_packet));
+        }
+
+        const auto _config = w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, _width, _height);
+        const auto _report = [&](const std::string &p_name, clock::duration p_elapsed) {
+          std::cout << wolf::format("{:<40} | {:>7.1f} fps", p_name,
+                                    _frames / std::chrono::duration<double>(p_elapsed).count())
+                    << std::endl;
+        };
+
+        for (const auto &[_name, _thread_type, _low_delay] :
+             {std::tuple{"sink, single thread", w_av_thread_type::codec_default, true},
+              std::tuple{"sink, slice threads", w_av_thread_type::slice, false},
+              std::tuple{"sink, frame threads", w_av_thread_type::frame, false}}) {
+          // one thread for the single threaded run, otherwise automatic
+          const auto _thread_count = _thread_type == w_av_thread_type::codec_default ? 1 : 0;
+          const auto _codec_opt = w_av_codec_opt{
+              0,             /*bitrate*/
+              30,            /*fps*/
+              -1,            /*gop*/
+              -1,            /*level*/
+              -1,            /*max_b_frames*/
+              -1,            /*refs*/
+              _thread_count, /*thread_count*/
+              _thread_type,  /*thread_type*/
+              _low_delay,    /*low_delay*/
+          };
+          BOOST_LEAF_AUTO(_decoder, w_ffmpeg::create_decoder(
+                                        _config, AVCodecID::AV_CODEC_ID_H264, _codec_opt));
+
+          int _count = 0;
+          const auto _start = clock::now();
+          for (size_t i = 0; i < _packets.size(); ++i) {
+            BOOST_LEAF_CHECK(_decoder.decode(
+                _packets[i],
+                [&](const w_av_frame &) {
+                  _count++;
+                  return true;
+                },
+                i == _packets.size() - 1));
+          }
+          _report(_name, clock::now() - _start);
+          BOOST_REQUIRE_EQUAL(_count, _frames);
+        }
+
+        // the output queue keeps references of the frames
+        const auto _codec_opt = w_av_codec_opt{0, 30, -1, -1, -1, -1, 0};
+        BOOST_LEAF_AUTO(_decoder, w_ffmpeg::create_decoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                           _codec_opt));
+        std::vector<w_av_frame> _queue;
+        _queue.reserve(_frames);
+        const auto _start = clock::now();
+        for (size_t i = 0; i < _packets.size(); ++i) {
+          BOOST_LEAF_CHECK(_decoder.decode(_packets[i], _queue, i == _packets.size() - 1));
+        }
+        _report("output queue", clock::now() - _start);
+        BOOST_REQUIRE_EQUAL(_queue.size(), gsl::narrow_cast<size_t>(_frames));
+        BOOST_REQUIRE_EQUAL(_queue.back().get_config().width, _width);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("decoder_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("decoder_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'decoder_benchmark'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(encoder_benchmark) {
+  std::cout << "entering test case 'encoder_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using clock = std::chrono::steady_clock;
+        using w_encoder = wolf::media::ffmpeg::w_encoder;
+        using w_decoder = wolf::media::ffmpeg::w_decoder;
+
+        constexpr int _width = 1280;
+        constexpr int _height = 720;
+        constexpr int _frames = 240;
+        constexpr int _patterns = 8;
+
+        std::vector<w_av_frame> _sources;
+        for (int i = 0; i < _patterns; ++i) {
+          BOOST_LEAF_AUTO(_frame, s_make_pattern_frame(_width, _height, i));
+          _sources.push_back(std::move(_frame));
+        }
+
+        const auto _report = [&](const char *p_name, size_t p_packets, size_t p_copied,
+                                 clock::duration p_elapsed) {
+          std::cout << wolf::format("{:<40} | {:>8.1f} packets/s | {:>10} bytes copied", p_name,
+                                    p_packets / std::chrono::duration<double>(p_elapsed).count(),
+                                    p_copied)
+                    << std::endl;
+        };
+
+        // the previous path, every packet is appended to a vector byte by byte
+        {
+          BOOST_LEAF_AUTO(_encoder, s_create_h264_encoder(_width, _height));
+          std::vector<uint8_t> _data;
+          size_t _packets = 0;
+          size_t _copied = 0;
+
+          const auto _start = clock::now();
+          for (int i = 0; i < _frames; ++i) {
+            auto &_frame = _sources[i % _patterns];
+            _frame.set_pts(i);
+            BOOST_LEAF_CHECK(_encoder.encode(
+                _frame,
+                [&](w_av_packet &p_packet) {
+                  _data.clear();
+                  std::copy(p_packet.get_data(), p_packet.get_data() + p_packet.get_size(),
+                            std::back_inserter(_data));
+                  _packets++;
+                  _copied += p_packet.get_size();
+                  return true;
+                },
+                i == _frames - 1));
+          }
+          _report("copy into std::vector", _packets, _copied, clock::now() - _start);
+          BOOST_REQUIRE_EQUAL(_packets, gsl::narrow_cast<size_t>(_frames));
+        }
+
+        // the packets keep the refcounted buffers of codec
+        {
+          BOOST_LEAF_AUTO(_encoder, s_create_h264_encoder(_width, _height));
+          std::vector<w_av_packet> _queue;
+          size_t _packets = 0;
+          size_t _copied = 0;
+
+          const auto _start = clock::now();
+          for (int i = 0; i < _frames; ++i) {
+            auto &_frame = _sources[i % _patterns];
+            _frame.set_pts(i);
+            _queue.clear();
+            BOOST_LEAF_CHECK(_encoder.encode(_frame, _queue, i == _frames - 1));
+            for (const auto &_packet : _queue) {
+              _packets++;
+              if (!_packet.is_refcounted()) {
+                _copied += _packet.get_size();
+              }
+            }
+          }
+          _report("refcounted w_av_packet", _packets, _copied, clock::now() - _start);
+          BOOST_REQUIRE_EQUAL(_packets, gsl::narrow_cast<size_t>(_frames));
+          BOOST_REQUIRE_EQUAL(_copied, size_t{0});
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("encoder_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("encoder_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'encoder_benchmark'" << std::endl;
+}
+
+static void s_print_pipeline_stats(_In_ const w_av_pipeline_stats &p_stats) {
+  for (const auto &[_name, _stage] :
+       {std::pair{"demux", p_stats.demux}, std::pair{"decode", p_stats.decode},
+        std::pair{"convert", p_stats.convert}}) {
+    std::cout << wolf::format("{:<8} | {:>6} items | {:>6} dropped | {:>9.1f} us avg | {:>8} us max",
+                              _name, _stage.items, _stage.dropped, _stage.average_latency_us,
+                              _stage.max_latency_us)
+              << std::endl;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(av_pipeline_file_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_pipeline_file_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        constexpr int _width = 320;
+        constexpr int _height = 240;
+        constexpr int _frames = 120;
+
+        BOOST_LEAF_AUTO(_clip, s_make_h264_clip(_width, _height, _frames));
+        const auto _path = std::filesystem::temp_directory_path() / "wolf_av_pipeline.h264";
+        {
+          auto _file = std::ofstream(_path, std::ios::binary | std::ios::trunc);
+          _file.write(reinterpret_cast<const char *>(_clip.data()),
+                      gsl::narrow_cast<std::streamsize>(_clip.size()));
+        }
+
+        auto _config = w_av_pipeline_config{};
+        _config.url = _path.string();
+        _config.drop_policy = w_av_drop_policy::block;
+        _config.format = AVPixelFormat::AV_PIX_FMT_RGBA;
+        _config.frame_queue_size = 4;
+
+        auto _pipeline = w_av_pipeline(std::move(_config));
+        BOOST_LEAF_CHECK(_pipeline.start());
+
+        // a slow consumer makes every stage wait, nothing is dropped
+        int _count = 0;
+        while (auto _frame = _pipeline.pop(std::chrono::seconds(5))) {
+          const auto _frame_config = _frame->get_config();
+          BOOST_REQUIRE_EQUAL(_frame_config.format, AVPixelFormat::AV_PIX_FMT_RGBA);
+          BOOST_REQUIRE_EQUAL(_frame_config.width, _width);
+          if (_count++ % 16 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          }
+        }
+        BOOST_REQUIRE(_pipeline.is_finished());
+        BOOST_LEAF_CHECK(_pipeline.stop());
+
+        const auto _stats = _pipeline.get_stats();
+        s_print_pipeline_stats(_stats);
+        BOOST_REQUIRE_EQUAL(_count, _frames);
+        BOOST_REQUIRE_EQUAL(_stats.demux.dropped + _stats.decode.dropped + _stats.convert.dropped,
+                            uint64_t{0});
+
+        std::filesystem::remove(_path);
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_pipeline_file_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_pipeline_file_test got an error!"); });
+
+  std::cout << "leaving test case 'av_pipeline_file_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_pipeline_loopback_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_pipeline_loopback_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        constexpr int _width = 320;
+        constexpr int _height = 240;
+        constexpr int _frames = 240;
+        constexpr auto _port = 18'554;
+
+        BOOST_LEAF_AUTO(_clip, s_make_h264_clip(_width, _height, _frames));
+
+        // the pipeline listens and the sender plays the live source
+        auto _config = w_av_pipeline_config{};
+        _config.url = wolf::format("tcp://127.0.0.1:{}?listen=1", _port);
+        _config.drop_policy = w_av_drop_policy::drop_oldest;
+        _config.format = AVPixelFormat::AV_PIX_FMT_BGR24;
+        _config.low_delay = true;
+
+        auto _pipeline = w_av_pipeline(std::move(_config));
+        BOOST_LEAF_CHECK(_pipeline.start());
+
+        auto _sender = std::thread([&]() {
+          AVIOContext *_io = nullptr;
+          const auto _url = wolf::format("tcp://127.0.0.1:{}", _port);
+          for (int i = 0; i < 100 && _io == nullptr; ++i) {
+            if (avio_open2(&_io, _url.c_str(), AVIO_FLAG_WRITE, nullptr, nullptr) < 0) {
+              _io = nullptr;
+              std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+          }
+          if (_io == nullptr) {
+            return;
+          }
+          constexpr size_t _chunk = 4096;
+          for (size_t _offset = 0; _offset < _clip.size(); _offset += _chunk) {
+            avio_write(_io, _clip.data() + _offset,
+                       gsl::narrow_cast<int>(std::min(_chunk, _clip.size() - _offset)));
+            avio_flush(_io);
+          }
+          avio_closep(&_io);
+        });
+
+        int _count = 0;
+        while (auto _frame = _pipeline.pop(std::chrono::seconds(5))) {
+          BOOST_REQUIRE_EQUAL(_frame->get_config().format, AVPixelFormat::AV_PIX_FMT_BGR24);
+          _count++;
+        }
+        _sender.join();
+        BOOST_LEAF_CHECK(_pipeline.stop());
+
+        const auto _stats = _pipeline.get_stats();
+        s_print_pipeline_stats(_stats);
+        BOOST_REQUIRE_GT(_count, 0);
+        BOOST_REQUIRE_LE(_count, _frames);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_pipeline_loopback_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_pipeline_loopback_test got an error!"); });
+
+  std::cout << "leaving test case 'av_pipeline_loopback_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_pipeline_cancel_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_pipeline_cancel_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        // nobody connects, so the demuxer blocks in avformat_open_input
+        auto _config = w_av_pipeline_config{};
+        _config.url = "tcp://127.0.0.1:18555?listen=1";
+
+        auto _pipeline = w_av_pipeline(std::move(_config));
+        BOOST_LEAF_CHECK(_pipeline.start());
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        BOOST_REQUIRE(!_pipeline.try_pop().has_value());
+
+        const auto _start = std::chrono::steady_clock::now();
+        BOOST_LEAF_CHECK(_pipeline.stop());
+        const auto _elapsed = std::chrono::steady_clock::now() - _start;
+
+        BOOST_REQUIRE(_pipeline.get_cancel_token().is_cancelled());
+        BOOST_REQUIRE(_elapsed < std::chrono::seconds(1));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_pipeline_cancel_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_pipeline_cancel_test got an error!"); });
+
+  std::cout << "leaving test case 'av_pipeline_cancel_test'" << std::endl;
+}
+
+// remux a generated h264 clip into an mp4 whose moov atom is at the end
+static boost::leaf::result<std::vector<uint8_t>> s_make_mp4(_In_ int p_width, _In_ int p_height,
+                                                             _In_ int p_frames,
+                                                             _In_ int p_gop = 30) {
+  BOOST_LEAF_AUTO(_clip, s_make_h264_clip(p_width, p_height, p_frames, p_gop));
+
+  const auto _dir = std::filesystem::temp_directory_path();
+  const auto _h264_path = (_dir / "wolf_av_format.h264").string();
+  const auto _mp4_path = (_dir / "wolf_av_format.mp4").string();
+  {
+    auto _file = std::ofstream(_h264_path, std::ios::binary | std::ios::trunc);
+    _file.write(reinterpret_cast<const char *>(_clip.data()),
+                gsl::narrow_cast<std::streamsize>(_clip.size()));
+  }
+
+  AVFormatContext *_input = nullptr;
+  AVFormatContext *_output = nullptr;
+  AVPacket *_packet = av_packet_alloc();
+  DEFER {
+    av_packet_free(&_packet);
+    if (_input != nullptr) {
+      avformat_close_input(&_input);
+    }
+    if (_output != nullptr) {
+      avio_closep(&_output->pb);
+      avformat_free_context(_output);
+    }
+    std::error_code _error;
+    std::filesystem::remove(_h264_path, _error);
+    std::filesystem::remove(_mp4_path, _error);
+  });
+
+  if (_packet == nullptr ||
+      avformat_open_input(&_input, _h264_path.c_str(), nullptr, nullptr) < 0 ||
+      avformat_find_stream_info(_input, nullptr) < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not open the h264 clip");
+  }
+  if (avformat_alloc_output_context2(&_output, nullptr, "mp4", _mp4_path.c_str()) < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not create the mp4 muxer");
+  }
+
+  auto *_stream = avformat_new_stream(_output, nullptr);
+  if (_stream == nullptr ||
+      avcodec_parameters_copy(_stream->codecpar, _input->streams[0]->codecpar) < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not create the mp4 stream");
+  }
+  _stream->codecpar->codec_tag = 0;
+  _stream->time_base = AVRational{1, 30};
+
+  if (avio_open(&_output->pb, _mp4_path.c_str(), AVIO_FLAG_WRITE) < 0 ||
+      avformat_write_header(_output, nullptr) < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not write the mp4 header");
+  }
+
+  // the raw clip has no timestamps and no b-frames
+  int64_t _index = 0;
+  while (av_read_frame(_input, _packet) >= 0) {
+    _packet->stream_index = 0;
+    _packet->pts = _index;
+    _packet->dts = _index;
+    _packet->duration = 1;
+    _packet->pos = -1;
+    _index++;
+    av_packet_rescale_ts(_packet, AVRational{1, 30}, _stream->time_base);
+    if (av_interleaved_write_frame(_output, _packet) < 0) {
+      return W_FAILURE(std::errc::operation_canceled, "could not write the mp4 packet");
+    }
+  }
+  if (av_write_trailer(_output) < 0) {
+    return W_FAILURE(std::errc::operation_canceled, "could not write the mp4 trailer");
+  }
+  avio_closep(&_output->pb);
+
+  auto _file = std::ifstream(_mp4_path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(_file),
+                              std::istreambuf_iterator<char>());
+}
+
+// demux every packet of a memory buffer, through the seekable callbacks if p_callbacks is set
+static boost::leaf::result<size_t> s_demux_memory(_In_ const std::vector<uint8_t> &p_data,
+                                                  _In_ const w_av_io_config &p_config,
+                                                  _In_ bool p_callbacks) {
+  auto _format = w_av_format();
+  size_t _position = 0;
+
+  if (p_callbacks) {
+    _format.on_read_callback = [&](uint8_t *p_buf, int p_buf_size) -> int {
+      const auto _size = std::min(p_data.size() - _position, gsl::narrow_cast<size_t>(p_buf_size));
+      std::memcpy(p_buf, p_data.data() + _position, _size);
+      _position += _size;
+      return gsl::narrow_cast<int>(_size);
+    };
+    _format.on_seek_callback = [&](int64_t p_offset, int p_whence) -> int64_t {
+      const auto _size = gsl::narrow_cast<int64_t>(p_data.size());
+      if (p_whence == AVSEEK_SIZE) {
+        return _size;
+      }
+      const auto _target = p_whence == SEEK_END ? _size + p_offset : p_offset;
+      if (_target < 0 || _target > _size) {
+        return AVERROR(EINVAL);
+      }
+      _position = gsl::narrow_cast<size_t>(_target);
+      return _target;
+    };
+    BOOST_LEAF_CHECK(_format.init(p_config));
+  } else {
+    BOOST_LEAF_CHECK(_format.init(p_data.data(), p_data.size(), p_config));
+  }
+
+  size_t _count = 0;
+  auto _packet = w_av_packet();
+  for (;;) {
+    BOOST_LEAF_AUTO(_has_packet, _format.read_packet(_packet));
+    if (!_has_packet) {
+      break;
+    }
+    _count++;
+  }
+  return _count;
+}
+
+BOOST_AUTO_TEST_CASE(av_format_memory_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_format_memory_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        constexpr int _frames = 60;
+        BOOST_LEAF_AUTO(_mp4, s_make_mp4(320, 240, _frames));
+
+        // the moov atom is at the end, so the demuxer must seek
+        auto _config = w_av_io_config{};
+        BOOST_LEAF_AUTO(_memory_count, s_demux_memory(_mp4, _config, false));
+        BOOST_REQUIRE_EQUAL(_memory_count, gsl::narrow_cast<size_t>(_frames));
+
+        // a read-ahead smaller than the file drops its ring on every seek
+        _config.buffer_size = 4096;
+        _config.read_ahead_size = 64 * 1024;
+        BOOST_LEAF_AUTO(_read_ahead_count, s_demux_memory(_mp4, _config, true));
+        BOOST_REQUIRE_EQUAL(_read_ahead_count, gsl::narrow_cast<size_t>(_frames));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_format_memory_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_format_memory_test got an error!"); });
+
+  std::cout << "leaving test case 'av_format_memory_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_format_benchmark) {
+  std::cout << "entering test case 'av_format_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using clock = std::chrono::steady_clock;
+
+        constexpr int _frames = 600;
+        constexpr int _runs = 10;
+        BOOST_LEAF_AUTO(_mp4, s_make_mp4(640, 360, _frames));
+
+        const auto _path = std::filesystem::temp_directory_path() / "wolf_av_format_bench.mp4";
+        {
+          auto _file = std::ofstream(_path, std::ios::binary | std::ios::trunc);
+          _file.write(reinterpret_cast<const char *>(_mp4.data()),
+                      gsl::narrow_cast<std::streamsize>(_mp4.size()));
+        }
+
+        const auto _report = [&](const std::string &p_name, clock::duration p_elapsed) {
+          const auto _seconds = std::chrono::duration<double>(p_elapsed).count();
+          std::cout << wolf::format("{:<40} | {:>8.2f} ms/run | {:>8.1f} MiB/s", p_name,
+                                    _seconds * 1000.0 / _runs,
+                                    _mp4.size() * _runs / _seconds / (1024.0 * 1024.0))
+                    << std::endl;
+        };
+
+        // the baseline, avformat reads the file itself
+        auto _start = clock::now();
+        for (int i = 0; i < _runs; ++i) {
+          size_t _count = 0;
+          BOOST_LEAF_CHECK(w_ffmpeg::open_stream(
+              _path.string(), {}, [&](const w_av_packet &, const AVStream *, const AVStream *) {
+                _count++;
+                return true;
+              }));
+          BOOST_REQUIRE_EQUAL(_count, gsl::narrow_cast<size_t>(_frames));
+        }
+        _report("file, avformat_open_input", clock::now() - _start);
+
+        for (const auto &[_name, _buffer_size, _read_ahead_size, _callbacks] :
+             {std::tuple{"memory, 32 KiB buffer", 32 * 1024, size_t{0}, false},
+              std::tuple{"memory, 256 KiB buffer", 256 * 1024, size_t{0}, false},
+              std::tuple{"callbacks, 32 KiB buffer", 32 * 1024, size_t{0}, true},
+              std::tuple{"callbacks, 1 MiB read-ahead", 32 * 1024, size_t{1024 * 1024}, true}}) {
+          auto _config = w_av_io_config{};
+          _config.buffer_size = _buffer_size;
+          _config.read_ahead_size = _read_ahead_size;
+
+          _start = clock::now();
+          for (int i = 0; i < _runs; ++i) {
+            BOOST_LEAF_AUTO(_count, s_demux_memory(_mp4, _config, _callbacks));
+            BOOST_REQUIRE_EQUAL(_count, gsl::narrow_cast<size_t>(_frames));
+          }
+          _report(_name, clock::now() - _start);
+        }
+
+        std::error_code _error;
+        std::filesystem::remove(_path, _error);
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("av_format_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_format_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'av_format_benchmark'" << std::endl;
+}
+
+// a yuv420p or nv12 frame of noise, or of smooth gradients which survive
+// the chroma interpolation of swscale
+static boost::leaf::result<w_av_frame> s_make_yuv_frame(_In_ AVPixelFormat p_format,
+                                                        _In_ int p_width, _In_ int p_height,
+                                                        _In_ bool p_noise) {
+  auto _config = w_av_config(p_format, p_width, p_height);
+  auto _data =
+      std::vector<uint8_t>(gsl::narrow_cast<size_t>(_config.get_required_video_buffer_size()));
+
+  if (p_noise) {
+    uint32_t _seed = 0x9E37'79B9;
+    for (auto &_byte : _data) {
+      _seed = _seed * 1'664'525 + 1'013'904'223;
+      _byte = gsl::narrow_cast<uint8_t>(_seed >> 24);
+    }
+  } else {
+    const auto _chroma_width = (p_width + 1) / 2;
+    const auto _chroma_height = (p_height + 1) / 2;
+    auto *_luma = _data.data();
+    auto *_chroma = _luma + gsl::narrow_cast<ptrdiff_t>(p_width) * p_height;
+
+    for (int y = 0; y < p_height; ++y) {
+      for (int x = 0; x < p_width; ++x) {
+        _luma[y * p_width + x] =
+            gsl::narrow_cast<uint8_t>(16 + (x * 219 / p_width + y * 219 / p_height) / 2);
+      }
+    }
+    for (int y = 0; y < _chroma_height; ++y) {
+      for (int x = 0; x < _chroma_width; ++x) {
+        const auto _u = gsl::narrow_cast<uint8_t>(64 + x * 128 / _chroma_width);
+        const auto _v = gsl::narrow_cast<uint8_t>(64 + y * 128 / _chroma_height);
+        const auto _index = y * _chroma_width + x;
+        if (p_format == AVPixelFormat::AV_PIX_FMT_NV12) {
+          _chroma[_index * 2] = _u;
+          _chroma[_index * 2 + 1] = _v;
+        } else {
+          _chroma[_index] = _u;
+          _chroma[_chroma_width * _chroma_height + _index] = _v;
+        }
+      }
+    }
+  }
+
+  auto _frame = w_av_frame(std::move(_config));
+  BOOST_LEAF_CHECK(_frame.init());
+  BOOST_LEAF_CHECK(_frame.set_video_frame(std::move(_data)));
+  return _frame;
+}
+
+// the packed pixels of a frame whose rows are not padded
+static gsl::span<const uint8_t> s_packed_pixels(_In_ const w_av_frame &p_frame) {
+  const auto _config = p_frame.get_config();
+  const auto _bpp = _config.format == AVPixelFormat::AV_PIX_FMT_BGR24 ? 3 : 4;
+  const auto *_data = std::get<0>(p_frame.get())[0];
+  return {_data, gsl::narrow_cast<size_t>(_config.width) * _config.height * _bpp};
+}
+
+BOOST_AUTO_TEST_CASE(av_color_kernels_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_color_kernels_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        std::cout << "best simd level: "
+                  << static_cast<int>(w_av_color_kernels::get_simd_level()) << std::endl;
+
+        for (const auto _src_format :
+             {AVPixelFormat::AV_PIX_FMT_NV12, AVPixelFormat::AV_PIX_FMT_YUV420P}) {
+          for (const auto _dst_format :
+               {AVPixelFormat::AV_PIX_FMT_RGBA, AVPixelFormat::AV_PIX_FMT_BGR24}) {
+            // odd sizes run the scalar tails and the last chroma row
+            for (const auto &[_width, _height] : {std::pair{67, 35}, std::pair{320, 240}}) {
+              BOOST_LEAF_AUTO(_noise, s_make_yuv_frame(_src_format, _width, _height, true));
+
+              auto _scalar = w_av_converter();
+              BOOST_LEAF_CHECK(_scalar.set_simd_level(w_av_simd_level::scalar));
+              BOOST_LEAF_AUTO(_expected, _scalar.convert_video(
+                                             _noise, w_av_config(_dst_format, _width, _height)));
+              const auto _expected_pixels = s_packed_pixels(_expected);
+
+              // every kernel and the slices give the bytes of the scalar one
+              for (const auto _level :
+                   {w_av_simd_level::sse4, w_av_simd_level::avx2, w_av_simd_level::neon}) {
+                if (!w_av_color_kernels::is_available(_level)) {
+                  continue;
+                }
+                for (const size_t _threads : {size_t{1}, size_t{4}}) {
+                  auto _converter = w_av_converter();
+                  BOOST_LEAF_CHECK(_converter.set_simd_level(_level));
+                  BOOST_LEAF_CHECK(_converter.set_slice_threads(_threads));
+                  BOOST_LEAF_AUTO(_actual,
+                                  _converter.convert_video(
+                                      _noise, w_av_config(_dst_format, _width, _height)));
+                  const auto _pixels = s_packed_pixels(_actual);
+                  BOOST_REQUIRE(std::equal(_pixels.begin(), _pixels.end(),
+                                           _expected_pixels.begin(), _expected_pixels.end()));
+                }
+              }
+
+              // the fixed point matrix stays close to swscale, which uses
+              // more bits and interpolates the chroma of nv12
+              BOOST_LEAF_AUTO(_smooth, s_make_yuv_frame(_src_format, _width, _height, false));
+              auto _swscale = w_av_converter(wolf::media::ffmpeg::w_av_scale_algorithm::point);
+              BOOST_LEAF_CHECK(_swscale.set_simd_level(w_av_simd_level::none));
+              BOOST_LEAF_AUTO(_reference, _swscale.convert_video(
+                                              _smooth, w_av_config(_dst_format, _width, _height)));
+              auto _kernel = w_av_converter();
+              BOOST_LEAF_AUTO(_converted, _kernel.convert_video(
+                                              _smooth, w_av_config(_dst_format, _width, _height)));
+
+              const auto _reference_pixels = s_packed_pixels(_reference);
+              const auto _converted_pixels = s_packed_pixels(_converted);
+              BOOST_REQUIRE_EQUAL(_reference_pixels.size(), _converted_pixels.size());
+
+              int _max_error = 0;
+              uint64_t _total_error = 0;
+              for (size_t i = 0; i < _reference_pixels.size(); ++i) {
+                const auto _error = std::abs(_reference_pixels[i] - _converted_pixels[i]);
+                _max_error = std::max(_max_error, _error);
+                _total_error += gsl::narrow_cast<uint64_t>(_error);
+              }
+              const auto _mean_error = gsl::narrow_cast<double>(_total_error) /
+                                       gsl::narrow_cast<double>(_reference_pixels.size());
+              BOOST_REQUIRE_LE(_max_error, 6);
+              BOOST_REQUIRE(_mean_error < 1.5);
+            }
+          }
+        }
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_color_kernels_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_color_kernels_test got an error!"); });
+
+  std::cout << "leaving test case 'av_color_kernels_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_color_kernels_benchmark) {
+  std::cout << "entering test case 'av_color_kernels_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using clock = std::chrono::steady_clock;
+
+        constexpr int _width = 1920;
+        constexpr int _height = 1080;
+        constexpr int _runs = 100;
+        const auto _best = w_av_color_kernels::get_simd_level();
+        const auto _cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        for (const auto _src_format :
+             {AVPixelFormat::AV_PIX_FMT_NV12, AVPixelFormat::AV_PIX_FMT_YUV420P}) {
+          BOOST_LEAF_AUTO(_src, s_make_yuv_frame(_src_format, _width, _height, true));
+
+          for (const auto _dst_format :
+               {AVPixelFormat::AV_PIX_FMT_RGBA, AVPixelFormat::AV_PIX_FMT_BGR24}) {
+            for (const auto &[_name, _level, _threads] :
+                 {std::tuple{"swscale", w_av_simd_level::none, size_t{1}},
+                  std::tuple{"scalar", w_av_simd_level::scalar, size_t{1}},
+                  std::tuple{"simd", _best, size_t{1}},
+                  std::tuple{"simd, slices", _best, _cores}}) {
+              auto _converter = w_av_converter(wolf::media::ffmpeg::w_av_scale_algorithm::point);
+              BOOST_LEAF_CHECK(_converter.set_simd_level(_level));
+              BOOST_LEAF_CHECK(_converter.set_slice_threads(_threads));
+
+              auto _dst = w_av_frame(w_av_config(_dst_format, _width, _height));
+              BOOST_LEAF_CHECK(_dst.init());
+              BOOST_LEAF_CHECK(_dst.set_video_frame(std::vector<uint8_t>()));
+              BOOST_LEAF_CHECK(_converter.convert_video(_src, _dst));
+
+              const auto _start = clock::now();
+              for (int i = 0; i < _runs; ++i) {
+                BOOST_LEAF_CHECK(_converter.convert_video(_src, _dst));
+              }
+              const auto _seconds = std::chrono::duration<double>(clock::now() - _start).count();
+
+              std::cout << wolf::format(
+                               "{} -> {} {:<14} | {:>8.3f} ms/frame | {:>8.1f} MPixel/s",
+                               _src_format == AVPixelFormat::AV_PIX_FMT_NV12 ? "nv12" : "yuv420p",
+                               _dst_format == AVPixelFormat::AV_PIX_FMT_RGBA ? "rgba" : "bgr24",
+                               _name, _seconds * 1000.0 / _runs,
+                               gsl::narrow_cast<double>(_width) * _height * _runs / _seconds / 1e6)
+                        << std::endl;
+            }
+          }
+        }
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_color_kernels_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_color_kernels_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'av_color_kernels_benchmark'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_codec_pool_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_codec_pool_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        constexpr int _width = 320;
+        constexpr int _height = 240;
+        constexpr int _frames = 20;
+
+        BOOST_LEAF_AUTO(_clip, s_make_h264_clip(_width, _height, _frames));
+        auto _packet = w_av_packet();
+        BOOST_LEAF_CHECK(_packet.init(_clip.data(), _clip.size()));
+
+        const auto _config = w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, _width, _height);
+        const auto _codec_opt = w_av_codec_opt{0, 30, -1, -1, -1, -1, 0};
+        const auto _count_frames = [](int &p_count) {
+          return [&p_count](const w_av_frame &) {
+            p_count++;
+            return true;
+          };
+        };
+
+        auto _pool = w_av_codec_pool(1);
+        {
+          BOOST_LEAF_AUTO(_decoder,
+                          _pool.acquire_decoder(_config, AVCodecID::AV_CODEC_ID_H264, _codec_opt));
+          int _count = 0;
+          BOOST_LEAF_CHECK(_decoder->decode(_packet, _count_frames(_count), true));
+          BOOST_REQUIRE_EQUAL(_count, _frames);
+        }
+        auto _stats = _pool.get_stats();
+        BOOST_REQUIRE_EQUAL(_stats.misses, 1U);
+        BOOST_REQUIRE_EQUAL(_stats.idle, size_t{1});
+
+        // a session which stops in the middle of the stream
+        {
+          BOOST_LEAF_AUTO(_decoder,
+                          _pool.acquire_decoder(_config, AVCodecID::AV_CODEC_ID_H264, _codec_opt));
+          auto _half = w_av_packet();
+          BOOST_LEAF_CHECK(_half.init(_clip.data(), _clip.size() / 2));
+          int _count = 0;
+          BOOST_LEAF_CHECK(_decoder->decode(_half, _count_frames(_count), false));
+        }
+
+        // the reset decoder starts the next stream from scratch
+        {
+          BOOST_LEAF_AUTO(_decoder,
+                          _pool.acquire_decoder(_config, AVCodecID::AV_CODEC_ID_H264, _codec_opt));
+          int _count = 0;
+          BOOST_LEAF_CHECK(_decoder->decode(_packet, _count_frames(_count), true));
+          BOOST_REQUIRE_EQUAL(_count, _frames);
+        }
+        _stats = _pool.get_stats();
+        BOOST_REQUIRE_EQUAL(_stats.hits, 2U);
+        BOOST_REQUIRE_EQUAL(_stats.misses, 1U);
+
+        // another key misses and the least recently returned decoder is evicted
+        {
+          auto _other_opt = _codec_opt;
+          _other_opt.thread_count = 1;
+          BOOST_LEAF_AUTO(_first,
+                          _pool.acquire_decoder(_config, AVCodecID::AV_CODEC_ID_H264, _codec_opt));
+          BOOST_LEAF_AUTO(_second, _pool.acquire_decoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                         _other_opt));
+        }
+        _stats = _pool.get_stats();
+        BOOST_REQUIRE_EQUAL(_stats.misses, 2U);
+        BOOST_REQUIRE_EQUAL(_stats.evictions, 1U);
+        BOOST_REQUIRE_EQUAL(_stats.idle, size_t{1});
+
+        // an untouched encoder is always kept, a drained one only if it can be flushed
+        _pool.clear();
+        const auto _encoder_opt = w_av_codec_opt{2'000'000, 30, 30, -1, 0, 1, -1};
+        const auto _opts = std::vector<w_av_set_opt>{w_av_set_opt{"preset", "ultrafast"},
+                                                     w_av_set_opt{"tune", "zerolatency"}};
+        {
+          BOOST_LEAF_AUTO(_encoder, _pool.acquire_encoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                          _encoder_opt, _opts));
+        }
+        BOOST_REQUIRE_EQUAL(_pool.get_stats().idle, size_t{1});
+        {
+          BOOST_LEAF_AUTO(_encoder, _pool.acquire_encoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                          _encoder_opt, _opts));
+          BOOST_LEAF_AUTO(_frame, s_make_pattern_frame(_width, _height, 0));
+          auto _encoded = w_av_packet();
+          BOOST_LEAF_CHECK(_encoder->encode(_frame, _encoded, true));
+          BOOST_REQUIRE(_encoded.get_size() > 0);
+        }
+        _stats = _pool.get_stats();
+        BOOST_REQUIRE_EQUAL(_stats.idle + _stats.discards, 1U);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("av_codec_pool_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_codec_pool_test got an error!"); });
+
+  std::cout << "leaving test case 'av_codec_pool_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_codec_pool_benchmark) {
+  std::cout << "entering test case 'av_codec_pool_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using clock = std::chrono::steady_clock;
+        using w_encoder = wolf::media::ffmpeg::w_encoder;
+        using w_decoder = wolf::media::ffmpeg::w_decoder;
+
+        constexpr int _width = 1280;
+        constexpr int _height = 720;
+        constexpr int _sessions = 50;
+
+        const auto _config = w_av_config(AVPixelFormat::AV_PIX_FMT_YUV420P, _width, _height);
+        const auto _encoder_opt = w_av_codec_opt{2'000'000, 30, 30, -1, 0, 1, -1};
+        const auto _decoder_opt = w_av_codec_opt{0, 30, -1, -1, -1, -1, 0};
+        const auto _opts = std::vector<w_av_set_opt>{w_av_set_opt{"preset", "ultrafast"},
+                                                     w_av_set_opt{"tune", "zerolatency"}};
+        BOOST_LEAF_AUTO(_frame, s_make_pattern_frame(_width, _height, 0));
+
+        // a session opens a transcoder and moves one frame through it
+        const auto _run_session = [&](w_encoder &p_encoder,
+                                      w_decoder &p_decoder) -> boost::leaf::result<void> {
+          auto _packet = w_av_packet();
+          BOOST_LEAF_CHECK(p_encoder.encode(_frame, _packet, true));
+          int _count = 0;
+          BOOST_LEAF_CHECK(p_decoder.decode(
+              _packet,
+              [&](const w_av_frame &) {
+                _count++;
+                return true;
+              },
+              true));
+          BOOST_REQUIRE_EQUAL(_count, 1);
+          return {};
+        };
+
+        const auto _report = [&](const std::string &p_name, clock::duration p_setup) {
+          std::cout << wolf::format(
+                           "{:<10} | {:>10.1f} us setup/session",
+                           p_name,
+                           std::chrono::duration<double, std::micro>(p_setup).count() / _sessions)
+                    << std::endl;
+        };
+
+        auto _setup = clock::duration::zero();
+        for (int i = 0; i < _sessions; ++i) {
+          const auto _start = clock::now();
+          BOOST_LEAF_AUTO(_encoder, w_ffmpeg::create_encoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                             _encoder_opt, _opts));
+          BOOST_LEAF_AUTO(_decoder, w_ffmpeg::create_decoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                             _decoder_opt));
+          _setup += clock::now() - _start;
+          BOOST_LEAF_CHECK(_run_session(_encoder, _decoder));
+        }
+        _report("no pool", _setup);
+
+        auto _pool = w_av_codec_pool();
+        _setup = clock::duration::zero();
+        for (int i = 0; i < _sessions; ++i) {
+          const auto _start = clock::now();
+          BOOST_LEAF_AUTO(_encoder, _pool.acquire_encoder(_config, AVCodecID::AV_CODEC_ID_H264,
+                                                          _encoder_opt, _opts));
+          BOOST_LEAF_AUTO(_decoder,
+                          _pool.acquire_decoder(_config, AVCodecID::AV_CODEC_ID_H264, _decoder_opt));
+          _setup += clock::now() - _start;
+          BOOST_LEAF_CHECK(_run_session(*_encoder, *_decoder));
+        }
+        _report("pool", _setup);
+
+        const auto _stats = _pool.get_stats();
+        std::cout << wolf::format("pool hits: {} misses: {} discards: {} evictions: {}",
+                                  _stats.hits, _stats.misses, _stats.discards, _stats.evictions)
+                  << std::endl;
+        BOOST_REQUIRE_EQUAL(_stats.hits + _stats.misses, 2U * _sessions);
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_codec_pool_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_codec_pool_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'av_codec_pool_benchmark'" << std::endl;
+}
+
+// write a generated clip into a temporary file
+static std::filesystem::path s_write_temp(_In_ const std::string &p_name,
+                                          _In_ const std::vector<uint8_t> &p_data) {
+  const auto _path = std::filesystem::temp_directory_path() / p_name;
+  auto _file = std::ofstream(_path, std::ios::binary | std::ios::trunc);
+  _file.write(reinterpret_cast<const char *>(p_data.data()),
+              gsl::narrow_cast<std::streamsize>(p_data.size()));
+  return _path;
+}
+
+// the fnv-1a hash of the luma plane of a decoded frame
+static uint64_t s_luma_hash(_In_ const w_av_frame &p_frame) {
+  const auto _config = p_frame.get_config();
+  const auto [_data, _linesize] = p_frame.get();
+
+  uint64_t _hash = 14'695'981'039'346'656'037ULL;
+  for (int y = 0; y < _config.height; ++y) {
+    const auto *_row = _data[0] + gsl::narrow_cast<ptrdiff_t>(y) * _linesize;
+    for (int x = 0; x < _config.width; ++x) {
+      _hash = (_hash ^ _row[x]) * 1'099'511'628'211ULL;
+    }
+  }
+  return _hash;
+}
+
+BOOST_AUTO_TEST_CASE(av_frame_seeker_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'av_frame_seeker_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        constexpr int _frames = 300;
+        constexpr int _gop = 30;
+        BOOST_LEAF_AUTO(_mp4, s_make_mp4(320, 240, _frames, _gop));
+        const auto _path = s_write_temp("wolf_av_frame_seeker.mp4", _mp4);
+        auto _sidecar = _path;
+        _sidecar += ".widx";
+        DEFER {
+          std::error_code _error;
+          std::filesystem::remove(_path, _error);
+          std::filesystem::remove(_sidecar, _error);
+        });
+
+        auto _config = w_av_seek_config{};
+        _config.use_sidecar = true;
+
+        // the reference, every frame in order needs only the first seek
+        auto _hashes = std::vector<uint64_t>();
+        {
+          auto _seeker = w_av_frame_seeker();
+          BOOST_LEAF_CHECK(_seeker.open(_path, _config));
+          BOOST_REQUIRE_EQUAL(_seeker.get_frame_count(), _frames);
+
+          const auto &_index = _seeker.get_index();
+          BOOST_REQUIRE_EQUAL(_index.keyframes.size(), gsl::narrow_cast<size_t>(_frames / _gop));
+          for (size_t i = 0; i < _index.keyframes.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(_index.keyframes[i].frame, gsl::narrow_cast<int64_t>(i) * _gop);
+          }
+
+          for (int64_t i = 0; i < _frames; ++i) {
+            BOOST_LEAF_AUTO(_frame, _seeker.get_frame(i));
+            BOOST_REQUIRE_EQUAL(_frame.get_pts(), _index.pts[gsl::narrow_cast<size_t>(i)]);
+            _hashes.push_back(s_luma_hash(_frame));
+          }
+          BOOST_REQUIRE_EQUAL(_seeker.get_stats().seeks, 1U);
+          BOOST_REQUIRE(!_seeker.get_frame(_frames));
+        }
+        BOOST_REQUIRE(std::filesystem::exists(_sidecar));
+
+        // the sidecar belongs to the size and the write time of source
+        {
+          using w_av_keyframe_index = wolf::media::ffmpeg::w_av_keyframe_index;
+          const auto _size = gsl::narrow_cast<int64_t>(std::filesystem::file_size(_path));
+          const auto _time = gsl::narrow_cast<int64_t>(
+              std::filesystem::last_write_time(_path).time_since_epoch().count());
+          BOOST_LEAF_CHECK(w_av_keyframe_index::load(_sidecar, _size, _time));
+          BOOST_REQUIRE(!w_av_keyframe_index::load(_sidecar, _size, _time + 1));
+
+          // a keyframe out of the frames is rejected, the magic number,
+          // version, size, time and the counts come before the records
+          auto _file = std::fstream(_sidecar, std::ios::binary | std::ios::in | std::ios::out);
+          const auto _keyframes_offset = 4 + 4 + 8 + 8 + 8 + _frames * 8 + 8;
+          const auto _out_of_range = int64_t(_frames);
+          _file.seekp(_keyframes_offset);
+          _file.write(reinterpret_cast<const char *>(&_out_of_range), sizeof(_out_of_range));
+          _file.close();
+          BOOST_REQUIRE(!w_av_keyframe_index::load(_sidecar, _size, _time));
+
+          // a huge count is rejected before allocating
+          _file.open(_sidecar, std::ios::binary | std::ios::in | std::ios::out);
+          const auto _huge = uint64_t(1) << 60;
+          _file.seekp(4 + 4 + 8 + 8);
+          _file.write(reinterpret_cast<const char *>(&_huge), sizeof(_huge));
+          _file.close();
+          BOOST_REQUIRE(!w_av_keyframe_index::load(_sidecar, _size, _time));
+
+          // the corrupted sidecar is replaced by a rebuilt index
+          auto _rebuilt = w_av_frame_seeker();
+          BOOST_LEAF_CHECK(_rebuilt.open(_path, _config));
+          BOOST_REQUIRE_EQUAL(_rebuilt.get_frame_count(), _frames);
+          BOOST_LEAF_CHECK(w_av_keyframe_index::load(_sidecar, _size, _time));
+        }
+
+        // the index is loaded from the sidecar, the frames are fetched in a random order
+        auto _seeker = w_av_frame_seeker();
+        BOOST_LEAF_CHECK(_seeker.open(_path, _config));
+        BOOST_REQUIRE_EQUAL(_seeker.get_frame_count(), _frames);
+
+        auto _random = std::mt19937(7);
+        auto _dist = std::uniform_int_distribution<int64_t>(0, _frames - 1);
+        for (int i = 0; i < 100; ++i) {
+          const auto _number = _dist(_random);
+          BOOST_LEAF_AUTO(_frame, _seeker.get_frame(_number));
+          BOOST_REQUIRE_EQUAL(s_luma_hash(_frame), _hashes[gsl::narrow_cast<size_t>(_number)]);
+        }
+
+        // scrubbing back is served by the cache
+        BOOST_LEAF_CHECK(_seeker.get_frame(_frames / 2));
+        BOOST_LEAF_CHECK(_seeker.get_frame(_frames / 2 + 1));
+        const auto _hits = _seeker.get_stats().cache_hits;
+        BOOST_LEAF_AUTO(_frame, _seeker.get_frame(_frames / 2));
+        BOOST_REQUIRE_EQUAL(s_luma_hash(_frame), _hashes[_frames / 2]);
+        BOOST_REQUIRE_EQUAL(_seeker.get_stats().cache_hits, _hits + 1);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_frame_seeker_test got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_frame_seeker_test got an error!"); });
+
+  std::cout << "leaving test case 'av_frame_seeker_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(av_frame_seeker_benchmark) {
+  std::cout << "entering test case 'av_frame_seeker_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using clock = std::chrono::steady_clock;
+
+        // a long clip with a keyframe every 10 seconds
+        constexpr int _frames = 1800;
+        constexpr int _gop = 300;
+        constexpr int _accesses = 200;
+        constexpr int _baseline_accesses = 20;
+        BOOST_LEAF_AUTO(_mp4, s_make_mp4(640, 360, _frames, _gop));
+        const auto _path = s_write_temp("wolf_av_frame_seeker_bench.mp4", _mp4);
+        auto _sidecar = _path;
+        _sidecar += ".widx";
+        DEFER {
+          std::error_code _error;
+          std::filesystem::remove(_path, _error);
+          std::filesystem::remove(_sidecar, _error);
+        });
+
+        auto _random = std::mt19937(42);
+        auto _dist = std::uniform_int_distribution<int64_t>(0, _frames - 1);
+        auto _targets = std::vector<int64_t>(_accesses);
+        for (auto &_target : _targets) {
+          _target = _dist(_random);
+        }
+
+        const auto _report = [](const std::string &p_name,
+                                std::vector<clock::duration> &p_latencies) {
+          std::sort(p_latencies.begin(), p_latencies.end());
+          const auto _ms = [&](double p_quantile) {
+            const auto _index = gsl::narrow_cast<size_t>(p_quantile * (p_latencies.size() - 1));
+            return std::chrono::duration<double, std::milli>(p_latencies[_index]).count();
+          };
+          std::cout << wolf::format("{:<32} | p50 {:>8.2f} ms | p99 {:>8.2f} ms | max {:>8.2f} ms",
+                                    p_name, _ms(0.5), _ms(0.99), _ms(1.0))
+                    << std::endl;
+        };
+
+        // the baseline decodes from the start of file for every access
+        auto _latencies = std::vector<clock::duration>();
+        for (int i = 0; i < _baseline_accesses; ++i) {
+          const auto _target = _targets[i];
+          const auto _start = clock::now();
+
+          auto _decoder = std::optional<wolf::media::ffmpeg::w_decoder>();
+          int64_t _count = 0;
+          boost::leaf::result<int> _res = 0;
+          BOOST_LEAF_CHECK(w_ffmpeg::open_stream(
+              _path.string(), {},
+              [&](const w_av_packet &p_packet, const AVStream *, const AVStream *p_video) {
+                if (!_decoder.has_value()) {
+                  auto _created = w_ffmpeg::create_decoder(p_video->codecpar, w_av_codec_opt{});
+                  if (!_created) {
+                    _res = _created.error();
+                    return false;
+                  }
+                  _decoder.emplace(std::move(*_created));
+                }
+                _res = _decoder->decode(p_packet, [&](const w_av_frame &) {
+                  return _count++ < _target;
+                });
+                return _res && _count <= _target;
+              }));
+          BOOST_LEAF_CHECK(_res);
+          _latencies.push_back(clock::now() - _start);
+        }
+        _report("decode from start", _latencies);
+
+        // the index is built by the first open and loaded by the others
+        for (const auto *_name : {"open, build index", "open, sidecar index"}) {
+          auto _config = w_av_seek_config{};
+          _config.use_sidecar = true;
+
+          const auto _start = clock::now();
+          auto _seeker = w_av_frame_seeker();
+          BOOST_LEAF_CHECK(_seeker.open(_path, _config));
+          const auto _elapsed = std::chrono::duration<double, std::milli>(clock::now() - _start);
+          std::cout << wolf::format("{:<32} | {:>8.2f} ms", _name, _elapsed.count())
+                    << std::endl;
+        }
+
+        auto _seeker = w_av_frame_seeker();
+        BOOST_LEAF_CHECK(_seeker.open(_path));
+
+        _latencies.clear();
+        for (const auto _target : _targets) {
+          const auto _start = clock::now();
+          BOOST_LEAF_CHECK(_seeker.get_frame(_target));
+          _latencies.push_back(clock::now() - _start);
+        }
+        _report("keyframe seek, random", _latencies);
+
+        // scrubbing back and forth around a point stays in the cache
+        _latencies.clear();
+        for (int i = 0; i < _accesses; ++i) {
+          const auto _start = clock::now();
+          BOOST_LEAF_CHECK(_seeker.get_frame(_frames / 2 + (i % 8)));
+          _latencies.push_back(clock::now() - _start);
+        }
+        _report("keyframe seek, scrub", _latencies);
+
+        const auto _stats = _seeker.get_stats();
+        std::cout << wolf::format("seeks: {} decoded frames: {} cache hits: {}", _stats.seeks,
+                                  _stats.decoded_frames, _stats.cache_hits)
+                  << std::endl;
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("av_frame_seeker_benchmark got an error: {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("av_frame_seeker_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'av_frame_seeker_benchmark'" << std::endl;
+}
+
+#endif
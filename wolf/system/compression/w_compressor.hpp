@@ -0,0 +1,69 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <vector>
+
+namespace wolf::system::compression {
+
+/*
+ * the progress of a streaming step
+ */
+struct w_compress_progress {
+  // number of bytes which were consumed from the source
+  size_t consumed = 0;
+  // number of bytes which were written into the destination
+  size_t produced = 0;
+  // true if the end of frame was written or decoded
+  bool done = false;
+};
+
+/*
+ * a codec with reusable contexts which compresses and decompresses whole
+ * frames, either into the caller's spans or into vectors. every codec
+ * (w_lz4_stream, w_zlib, w_zstd) satisfies it, so the generic code and
+ * benchmarks can pick a codec per workload.
+ */
+template <typename T>
+concept w_compressor = requires(T &p_codec, const T &p_const_codec, size_t p_size,
+                                gsl::span<const std::byte> p_src, gsl::span<std::byte> p_dst) {
+  { p_const_codec.get_compress_bound(p_size) } -> std::same_as<size_t>;
+  { p_codec.compress(p_src, p_dst) } -> std::same_as<boost::leaf::result<size_t>>;
+  {
+    p_codec.compress(p_src)
+    } -> std::same_as<boost::leaf::result<std::vector<std::byte>>>;
+  { p_codec.decompress(p_src, p_dst) } -> std::same_as<boost::leaf::result<size_t>>;
+  {
+    p_codec.decompress(p_src)
+    } -> std::same_as<boost::leaf::result<std::vector<std::byte>>>;
+};
+
+/*
+ * a codec which also compresses and decompresses a frame in chunks of any
+ * size. compress_update is called for each chunk, then compress_end until
+ * done is true, the next call starts a new frame. decompress_update is
+ * called until done is true.
+ */
+template <typename T>
+concept w_stream_compressor =
+    w_compressor<T> && requires(T &p_codec, gsl::span<const std::byte> p_src,
+                                gsl::span<std::byte> p_dst) {
+      {
+        p_codec.compress_update(p_src, p_dst)
+        } -> std::same_as<boost::leaf::result<w_compress_progress>>;
+      {
+        p_codec.compress_end(p_dst)
+        } -> std::same_as<boost::leaf::result<w_compress_progress>>;
+      {
+        p_codec.decompress_update(p_src, p_dst)
+        } -> std::same_as<boost::leaf::result<w_compress_progress>>;
+    };
+
+}  // namespace wolf::system::compression
@@ -4,9 +4,28 @@
 
 #include <DISABLE_ANALYSIS_BEGIN>
 #include <lz4.h>
+// the dictionary functions of lz4frame are only exported by the shared
+// library of lz4 since v1.10, older ones need a static lz4
+#if LZ4_VERSION_NUMBER >= 11000 || defined(WOLF_SYSTEM_LZ4_STATIC)
+#define W_LZ4_HAS_DICTIONARY
+#define LZ4F_STATIC_LINKING_ONLY
+#endif
+#include <lz4frame.h>
 #include <DISABLE_ANALYSIS_END>
 
+#include <wolf/system/w_thread_pool.hpp>
+
+#include <atomic>
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+#include <limits>
+
 using w_lz4 = wolf::system::compression::w_lz4;
+using w_lz4_stream = wolf::system::compression::w_lz4_stream;
+using w_lz4_stream_progress = wolf::system::compression::w_lz4_stream_progress;
+using w_lz4_blocks = wolf::system::compression::w_lz4_blocks;
+using w_lz4_blocks_index = wolf::system::compression::w_lz4_blocks_index;
+using w_thread_pool = wolf::system::w_thread_pool;
 
 static boost::leaf::result<int>
 s_check_input_len(_In_ const size_t p_src_size) noexcept {
@@ -123,4 +142,577 @@ w_lz4::decompress(_In_ const gsl::span<const std::byte> p_src,
                    "could not decompress lz4 stream after " + _max_retry_str);
 }
 
+static LZ4F_preferences_t s_preferences(_In_ int p_compression_level,
+                                        _In_ size_t p_content_size) noexcept {
+  LZ4F_preferences_t _prefs = LZ4F_INIT_PREFERENCES;
+  _prefs.compressionLevel = p_compression_level;
+  _prefs.frameInfo.contentSize = p_content_size;
+  // compress_update writes everything into the caller's span instead of
+  // keeping it in the context
+  _prefs.autoFlush = 1;
+  return _prefs;
+}
+
+static std::string s_lz4f_error(_In_ const char *p_func, _In_ size_t p_code) {
+  return wolf::format("{} failed because: {}", p_func, LZ4F_getErrorName(p_code));
+}
+
+bool w_lz4_stream::has_dictionary_support() noexcept {
+#ifdef W_LZ4_HAS_DICTIONARY
+  return true;
+#else
+  return false;
+#endif
+}
+
+boost::leaf::result<w_lz4_stream> w_lz4_stream::make(
+    _In_ int p_compression_level, _In_ gsl::span<const std::byte> p_dictionary) noexcept {
+  auto _stream = w_lz4_stream();
+  _stream._compression_level = p_compression_level;
+
+  auto _ret = LZ4F_createCompressionContext(&_stream._cctx, LZ4F_VERSION);
+  if (LZ4F_isError(_ret)) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     s_lz4f_error("LZ4F_createCompressionContext", _ret));
+  }
+
+  _ret = LZ4F_createDecompressionContext(&_stream._dctx, LZ4F_VERSION);
+  if (LZ4F_isError(_ret)) {
+    return W_FAILURE(std::errc::not_enough_memory,
+                     s_lz4f_error("LZ4F_createDecompressionContext", _ret));
+  }
+
+  if (!p_dictionary.empty()) {
+#ifdef W_LZ4_HAS_DICTIONARY
+    try {
+      _stream._dictionary.assign(p_dictionary.begin(), p_dictionary.end());
+    } catch (...) {
+      return W_FAILURE(std::errc::not_enough_memory, "could not copy the lz4 dictionary");
+    }
+    // digest the dictionary once for all the frames
+    _stream._cdict = LZ4F_createCDict(_stream._dictionary.data(), _stream._dictionary.size());
+    if (_stream._cdict == nullptr) {
+      return W_FAILURE(std::errc::not_enough_memory, "LZ4F_createCDict failed");
+    }
+#else
+    return W_FAILURE(std::errc::not_supported,
+                     "lz4 dictionaries need lz4 v1.10 or WOLF_SYSTEM_LZ4_STATIC");
+#endif
+  }
+
+  return _stream;
+}
+
+void w_lz4_stream::_move(w_lz4_stream &&p_other) noexcept {
+  if (this == &p_other) {
+    return;
+  }
+  _release();
+
+  this->_compression_level = p_other._compression_level;
+  this->_dictionary = std::move(p_other._dictionary);
+  this->_cctx = std::exchange(p_other._cctx, nullptr);
+  this->_dctx = std::exchange(p_other._dctx, nullptr);
+  this->_cdict = std::exchange(p_other._cdict, nullptr);
+}
+
+void w_lz4_stream::_release() noexcept {
+  if (this->_cctx != nullptr) {
+    LZ4F_freeCompressionContext(this->_cctx);
+    this->_cctx = nullptr;
+  }
+  if (this->_dctx != nullptr) {
+    LZ4F_freeDecompressionContext(this->_dctx);
+    this->_dctx = nullptr;
+  }
+#ifdef W_LZ4_HAS_DICTIONARY
+  if (this->_cdict != nullptr) {
+    LZ4F_freeCDict(this->_cdict);
+    this->_cdict = nullptr;
+  }
+#endif
+}
+
+size_t w_lz4_stream::get_compress_bound(_In_ size_t p_src_size) const noexcept {
+  const auto _prefs = s_preferences(this->_compression_level, p_src_size);
+  return LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound(p_src_size, &_prefs) +
+         LZ4F_compressBound(0, &_prefs);
+}
+
+size_t w_lz4_stream::get_compress_update_bound(_In_ size_t p_src_size) const noexcept {
+  const auto _prefs = s_preferences(this->_compression_level, 0);
+  return LZ4F_compressBound(p_src_size, &_prefs);
+}
+
+boost::leaf::result<size_t> w_lz4_stream::compress_begin(_Inout_ gsl::span<std::byte> p_dst,
+                                                         _In_ size_t p_content_size) noexcept {
+  const auto _prefs = s_preferences(this->_compression_level, p_content_size);
+
+#ifdef W_LZ4_HAS_DICTIONARY
+  const auto _ret =
+      this->_cdict == nullptr
+          ? LZ4F_compressBegin(this->_cctx, p_dst.data(), p_dst.size(), &_prefs)
+          : LZ4F_compressBegin_usingCDict(this->_cctx, p_dst.data(), p_dst.size(),
+                                          this->_cdict, &_prefs);
+#else
+  const auto _ret = LZ4F_compressBegin(this->_cctx, p_dst.data(), p_dst.size(), &_prefs);
+#endif
+  if (LZ4F_isError(_ret)) {
+    return W_FAILURE(std::errc::operation_canceled, s_lz4f_error("LZ4F_compressBegin", _ret));
+  }
+  return _ret;
+}
+
+boost::leaf::result<size_t> w_lz4_stream::compress_update(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  const auto _ret = LZ4F_compressUpdate(this->_cctx, p_dst.data(), p_dst.size(), p_src.data(),
+                                        p_src.size(), nullptr);
+  if (LZ4F_isError(_ret)) {
+    return W_FAILURE(std::errc::operation_canceled, s_lz4f_error("LZ4F_compressUpdate", _ret));
+  }
+  return _ret;
+}
+
+boost::leaf::result<size_t> w_lz4_stream::compress_end(
+    _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  const auto _ret = LZ4F_compressEnd(this->_cctx, p_dst.data(), p_dst.size(), nullptr);
+  if (LZ4F_isError(_ret)) {
+    return W_FAILURE(std::errc::operation_canceled, s_lz4f_error("LZ4F_compressEnd", _ret));
+  }
+  return _ret;
+}
+
+boost::leaf::result<size_t> w_lz4_stream::compress(_In_ gsl::span<const std::byte> p_src,
+                                                   _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  if (p_dst.size() < get_compress_bound(p_src.size())) {
+    return W_FAILURE(std::errc::no_buffer_space,
+                     "the destination is smaller than the compress bound");
+  }
+
+  BOOST_LEAF_AUTO(_header_size, compress_begin(p_dst, p_src.size()));
+  auto _offset = _header_size;
+
+  BOOST_LEAF_AUTO(_body_size, compress_update(p_src, p_dst.subspan(_offset)));
+  _offset += _body_size;
+
+  BOOST_LEAF_AUTO(_end_size, compress_end(p_dst.subspan(_offset)));
+  return _offset + _end_size;
+}
+
+boost::leaf::result<std::vector<std::byte>> w_lz4_stream::compress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  std::vector<std::byte> _dst;
+  try {
+    _dst.resize(get_compress_bound(p_src.size()));
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 frame");
+  }
+
+  BOOST_LEAF_AUTO(_size, compress(p_src, _dst));
+  // shrinking keeps the storage, so there is no second allocation
+  _dst.resize(_size);
+  return _dst;
+}
+
+boost::leaf::result<size_t> w_lz4_stream::get_content_size(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  // magic number (4 bytes), FLG (1 byte), BD (1 byte), content size (8 bytes)
+  constexpr uint32_t _magic_number = 0x184D2204;
+  constexpr uint8_t _content_size_flag = 0x08;
+  constexpr size_t _header_size = 14;
+
+  if (p_src.size() < 6) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 frame header is not complete");
+  }
+
+  uint32_t _magic = 0;
+  std::memcpy(&_magic, p_src.data(), sizeof(_magic));
+  if (boost::endian::little_to_native(_magic) != _magic_number) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is not an lz4 frame");
+  }
+
+  const auto _flags = std::to_integer<uint8_t>(p_src[4]);
+  if ((_flags & _content_size_flag) == 0) {
+    return 0;
+  }
+  if (p_src.size() < _header_size) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 frame header is not complete");
+  }
+
+  uint64_t _content_size = 0;
+  std::memcpy(&_content_size, p_src.data() + 6, sizeof(_content_size));
+  _content_size = boost::endian::little_to_native(_content_size);
+  if (_content_size > std::numeric_limits<size_t>::max()) {
+    return W_FAILURE(std::errc::value_too_large, "the lz4 frame is too big");
+  }
+  return gsl::narrow_cast<size_t>(_content_size);
+}
+
+boost::leaf::result<w_lz4_stream_progress> w_lz4_stream::decompress_update(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  auto _src_size = p_src.size();
+  auto _dst_size = p_dst.size();
+
+#ifdef W_LZ4_HAS_DICTIONARY
+  const auto _ret =
+      this->_dictionary.empty()
+          ? LZ4F_decompress(this->_dctx, p_dst.data(), &_dst_size, p_src.data(), &_src_size,
+                            nullptr)
+          : LZ4F_decompress_usingDict(this->_dctx, p_dst.data(), &_dst_size, p_src.data(),
+                                      &_src_size, this->_dictionary.data(),
+                                      this->_dictionary.size(), nullptr);
+#else
+  const auto _ret =
+      LZ4F_decompress(this->_dctx, p_dst.data(), &_dst_size, p_src.data(), &_src_size, nullptr);
+#endif
+  if (LZ4F_isError(_ret)) {
+    // the context must be reset before the next frame
+    LZ4F_resetDecompressionContext(this->_dctx);
+    return W_FAILURE(std::errc::illegal_byte_sequence, s_lz4f_error("LZ4F_decompress", _ret));
+  }
+
+  return w_lz4_stream_progress{_src_size, _dst_size, _ret == 0};
+}
+
+boost::leaf::result<size_t> w_lz4_stream::decompress(_In_ gsl::span<const std::byte> p_src,
+                                                     _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  if (p_src.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  // start from a clean state even if the last frame was left unfinished
+  LZ4F_resetDecompressionContext(this->_dctx);
+
+  size_t _consumed = 0;
+  size_t _produced = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    BOOST_LEAF_AUTO(_progress, decompress_update(p_src.subspan(_consumed),
+                                                 p_dst.subspan(_produced)));
+    _consumed += _progress.consumed;
+    _produced += _progress.produced;
+
+    if (_progress.done) {
+      return _produced;
+    }
+    if (_progress.consumed == 0 && _progress.produced == 0) {
+      LZ4F_resetDecompressionContext(this->_dctx);
+      return W_FAILURE(_consumed == p_src.size() ? std::errc::invalid_argument
+                                                 : std::errc::no_buffer_space,
+                       _consumed == p_src.size() ? "the lz4 frame is not complete"
+                                                 : "the destination is too small");
+    }
+  }
+}
+
+// a byte of lz4 can't expand to more than 255 bytes
+constexpr uint64_t s_lz4_max_ratio = 255;
+
+boost::leaf::result<std::vector<std::byte>> w_lz4_stream::decompress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  BOOST_LEAF_AUTO(_content_size, get_content_size(p_src));
+
+  // the output starts from a bounded hint and grows, a forged frame header
+  // can't make it allocate more up front
+  const size_t _max_hint = std::max<size_t>(p_src.size() * 2, 64 * 1024);
+
+  std::vector<std::byte> _dst;
+  try {
+    if (_content_size != 0 &&
+        _content_size <= std::max<uint64_t>(p_src.size() * s_lz4_max_ratio, _max_hint)) {
+      // the frame tells the size, so allocate once
+      _dst.resize(_content_size);
+      BOOST_LEAF_AUTO(_size, decompress(p_src, _dst));
+      _dst.resize(_size);
+      return _dst;
+    }
+
+    // the frame does not carry a plausible size, grow the output while decoding
+    _dst.resize(_max_hint);
+    size_t _consumed = 0;
+    size_t _produced = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      BOOST_LEAF_AUTO(_progress,
+                      decompress_update(p_src.subspan(_consumed),
+                                        gsl::span(_dst).subspan(_produced)));
+      _consumed += _progress.consumed;
+      _produced += _progress.produced;
+
+      if (_progress.done) {
+        _dst.resize(_produced);
+        return _dst;
+      }
+      if (_produced == _dst.size()) {
+        _dst.resize(_dst.size() * 2);
+      } else if (_progress.consumed == 0 && _progress.produced == 0 &&
+                 _consumed == p_src.size()) {
+        LZ4F_resetDecompressionContext(this->_dctx);
+        return W_FAILURE(std::errc::invalid_argument, "the lz4 frame is not complete");
+      }
+    }
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 output");
+  }
+}
+
+// the high bit of a block size marks a block which is stored as it is
+constexpr uint32_t s_stored_block_flag = 0x80000000;
+
+template <typename T>
+static void s_store_le(_Inout_ std::byte *p_dst, _In_ T p_value) noexcept {
+  boost::endian::native_to_little_inplace(p_value);
+  std::memcpy(p_dst, &p_value, sizeof(p_value));
+}
+
+template <typename T> static T s_load_le(_In_ const std::byte *p_src) noexcept {
+  T _value = 0;
+  std::memcpy(&_value, p_src, sizeof(_value));
+  return boost::endian::little_to_native(_value);
+}
+
+boost::leaf::result<w_lz4_blocks> w_lz4_blocks::make(_In_ size_t p_block_size,
+                                                     _In_ size_t p_concurrency,
+                                                     _In_ int p_acceleration) noexcept {
+  if (p_block_size == 0 || p_block_size >= LZ4_MAX_INPUT_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "the block size must be between 1 and LZ4_MAX_INPUT_SIZE");
+  }
+
+  auto _blocks = w_lz4_blocks();
+  _blocks._block_size = p_block_size;
+  _blocks._acceleration = p_acceleration;
+  try {
+    _blocks._pool = std::make_unique<w_thread_pool>(p_concurrency);
+  } catch (...) {
+    return W_FAILURE(std::errc::resource_unavailable_try_again,
+                     "could not create the threads of w_lz4_blocks");
+  }
+  return _blocks;
+}
+
+w_lz4_blocks::w_lz4_blocks(w_lz4_blocks &&p_other) noexcept = default;
+w_lz4_blocks &w_lz4_blocks::operator=(w_lz4_blocks &&p_other) noexcept = default;
+w_lz4_blocks::~w_lz4_blocks() noexcept = default;
+
+size_t w_lz4_blocks::get_concurrency() const noexcept {
+  return this->_pool ? this->_pool->get_concurrency() : 0;
+}
+
+boost::leaf::result<std::vector<std::byte>> w_lz4_blocks::compress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  const auto _block_size = this->_block_size;
+  const auto _blocks_count = (p_src.size() + _block_size - 1) / _block_size;
+  if (_blocks_count > std::numeric_limits<uint32_t>::max()) {
+    return W_FAILURE(std::errc::value_too_large, "the source has too many lz4 blocks");
+  }
+
+  const auto _bound = gsl::narrow_cast<size_t>(
+      LZ4_compressBound(gsl::narrow_cast<int>(_block_size)));
+  const auto _index_size = HEADER_SIZE + _blocks_count * sizeof(uint32_t);
+
+  std::vector<std::byte> _dst;
+  try {
+    // the scratch and sizes keep their storage between calls
+    this->_scratch.resize(_blocks_count * _bound);
+    this->_sizes.resize(_blocks_count);
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 blocks");
+  }
+
+  // compress every block into its own slot of scratch
+  this->_pool->parallel_for(_blocks_count, [&](size_t p_block) {
+    const auto _offset = p_block * _block_size;
+    const auto _size = std::min(_block_size, p_src.size() - _offset);
+    const auto _bytes = LZ4_compress_fast(
+        reinterpret_cast<const char *>(p_src.data() + _offset),
+        reinterpret_cast<char *>(this->_scratch.data() + p_block * _bound),
+        gsl::narrow_cast<int>(_size), gsl::narrow_cast<int>(_bound), this->_acceleration);
+    // keep the incompressible blocks as they are
+    this->_sizes[p_block] = _bytes > 0 && gsl::narrow_cast<size_t>(_bytes) < _size
+                                ? gsl::narrow_cast<uint32_t>(_bytes)
+                                : gsl::narrow_cast<uint32_t>(_size) | s_stored_block_flag;
+  });
+
+  auto _total_size = _index_size;
+  for (const auto _size : this->_sizes) {
+    _total_size += _size & ~s_stored_block_flag;
+  }
+
+  try {
+    _dst.resize(_total_size);
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 container");
+  }
+
+  s_store_le<uint32_t>(_dst.data(), MAGIC);
+  s_store_le<uint32_t>(_dst.data() + 4, VERSION);
+  s_store_le<uint32_t>(_dst.data() + 8, gsl::narrow_cast<uint32_t>(_block_size));
+  s_store_le<uint32_t>(_dst.data() + 12, gsl::narrow_cast<uint32_t>(_blocks_count));
+  s_store_le<uint64_t>(_dst.data() + 16, p_src.size());
+
+  // the offsets are reused as the destination of each block
+  std::vector<size_t> _offsets;
+  try {
+    _offsets.resize(_blocks_count);
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 index");
+  }
+  auto _offset = _index_size;
+  for (size_t i = 0; i < _blocks_count; ++i) {
+    s_store_le<uint32_t>(_dst.data() + HEADER_SIZE + i * sizeof(uint32_t), this->_sizes[i]);
+    _offsets[i] = _offset;
+    _offset += this->_sizes[i] & ~s_stored_block_flag;
+  }
+
+  // pack the blocks behind the index
+  this->_pool->parallel_for(_blocks_count, [&](size_t p_block) {
+    const auto _size = this->_sizes[p_block];
+    const auto _bytes = _size & ~s_stored_block_flag;
+    const auto *_src = (_size & s_stored_block_flag) != 0
+                           ? p_src.data() + p_block * _block_size
+                           : this->_scratch.data() + p_block * _bound;
+    std::memcpy(_dst.data() + _offsets[p_block], _src, _bytes);
+  });
+
+  return _dst;
+}
+
+boost::leaf::result<w_lz4_blocks_index> w_lz4_blocks::read_index(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  if (p_src.size() < HEADER_SIZE) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 container header is not complete");
+  }
+  if (s_load_le<uint32_t>(p_src.data()) != MAGIC) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is not an lz4 container");
+  }
+  if (s_load_le<uint32_t>(p_src.data() + 4) != VERSION) {
+    return W_FAILURE(std::errc::not_supported, "the version of lz4 container is not supported");
+  }
+
+  const auto _block_size = s_load_le<uint32_t>(p_src.data() + 8);
+  const auto _blocks_count = s_load_le<uint32_t>(p_src.data() + 12);
+  const auto _content_size = s_load_le<uint64_t>(p_src.data() + 16);
+  // the count of blocks is rounded up without overflowing near UINT64_MAX
+  if (_block_size == 0 || _block_size >= LZ4_MAX_INPUT_SIZE ||
+      _content_size > std::numeric_limits<size_t>::max() ||
+      _content_size > uint64_t(_blocks_count) * _block_size ||
+      _content_size / _block_size + (_content_size % _block_size != 0) != _blocks_count) {
+    return W_FAILURE(std::errc::illegal_byte_sequence, "the lz4 container header is corrupted");
+  }
+  if (_content_size > uint64_t(p_src.size()) * s_lz4_max_ratio) {
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     "the content size of lz4 container is bigger than its blocks can hold");
+  }
+
+  const auto _index_size = HEADER_SIZE + size_t(_blocks_count) * sizeof(uint32_t);
+  if (p_src.size() < _index_size) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 container index is not complete");
+  }
+
+  w_lz4_blocks_index _index;
+  _index.block_size = _block_size;
+  _index.content_size = gsl::narrow_cast<size_t>(_content_size);
+  try {
+    _index.blocks.resize(_blocks_count);
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 index");
+  }
+
+  const auto _bound = gsl::narrow_cast<uint32_t>(LZ4_compressBound(gsl::narrow_cast<int>(_block_size)));
+  uint64_t _offset = _index_size;
+  for (size_t i = 0; i < _blocks_count; ++i) {
+    const auto _size = s_load_le<uint32_t>(p_src.data() + HEADER_SIZE + i * sizeof(uint32_t));
+    auto &_block = _index.blocks[i];
+    _block.offset = _offset;
+    _block.size = _size & ~s_stored_block_flag;
+    _block.stored = (_size & s_stored_block_flag) != 0;
+    if (_block.size > _bound ||
+        (_block.stored && _block.size != _index.get_block_content_size(i))) {
+      return W_FAILURE(std::errc::illegal_byte_sequence, "the lz4 container index is corrupted");
+    }
+    _offset += _block.size;
+  }
+  if (_offset > p_src.size()) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 container is not complete");
+  }
+
+  return _index;
+}
+
+boost::leaf::result<size_t> w_lz4_blocks::decompress_block(
+    _In_ gsl::span<const std::byte> p_src, _In_ const w_lz4_blocks_index &p_index,
+    _In_ size_t p_block_index, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  if (p_block_index >= p_index.blocks.size()) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 block index is out of range");
+  }
+
+  const auto &_block = p_index.blocks[p_block_index];
+  const auto _content_size = p_index.get_block_content_size(p_block_index);
+  if (_block.offset + _block.size > p_src.size()) {
+    return W_FAILURE(std::errc::invalid_argument, "the lz4 block is out of the container");
+  }
+  if (p_dst.size() < _content_size) {
+    return W_FAILURE(std::errc::no_buffer_space, "the destination is smaller than the block");
+  }
+
+  const auto *_src = p_src.data() + _block.offset;
+  if (_block.stored) {
+    std::memcpy(p_dst.data(), _src, _content_size);
+    return _content_size;
+  }
+
+  const auto _bytes = LZ4_decompress_safe(
+      reinterpret_cast<const char *>(_src), reinterpret_cast<char *>(p_dst.data()),
+      gsl::narrow_cast<int>(_block.size), gsl::narrow_cast<int>(_content_size));
+  if (_bytes < 0 || gsl::narrow_cast<size_t>(_bytes) != _content_size) {
+    return W_FAILURE(std::errc::illegal_byte_sequence, "the lz4 block is corrupted");
+  }
+  return _content_size;
+}
+
+boost::leaf::result<size_t> w_lz4_blocks::decompress(_In_ gsl::span<const std::byte> p_src,
+                                                     _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  BOOST_LEAF_AUTO(_index, read_index(p_src));
+  if (p_dst.size() < _index.content_size) {
+    return W_FAILURE(std::errc::no_buffer_space,
+                     "the destination is smaller than the content size");
+  }
+
+  std::atomic<bool> _failed = false;
+  this->_pool->parallel_for(_index.blocks.size(), [&](size_t p_block) {
+    const auto _ret = decompress_block(
+        p_src, _index, p_block,
+        p_dst.subspan(p_block * _index.block_size, _index.get_block_content_size(p_block)));
+    if (!_ret) {
+      _failed.store(true, std::memory_order_relaxed);
+    }
+  });
+  if (_failed.load(std::memory_order_relaxed)) {
+    return W_FAILURE(std::errc::illegal_byte_sequence, "the lz4 container is corrupted");
+  }
+  return _index.content_size;
+}
+
+boost::leaf::result<std::vector<std::byte>> w_lz4_blocks::decompress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  BOOST_LEAF_AUTO(_index, read_index(p_src));
+
+  std::vector<std::byte> _dst;
+  try {
+    _dst.resize(_index.content_size);
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lz4 output");
+  }
+
+  BOOST_LEAF_CHECK(decompress(p_src, _dst));
+  return _dst;
+}
+
 #endif // WOLF_SYSTEM_LZ4
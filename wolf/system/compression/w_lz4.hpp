@@ -8,10 +8,21 @@
 #ifdef WOLF_SYSTEM_LZ4
 
 #include "wolf.hpp"
+#include "w_compressor.hpp"
 
+#include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
+struct LZ4F_cctx_s;
+struct LZ4F_dctx_s;
+struct LZ4F_CDict_s;
+
+namespace wolf::system {
+class w_thread_pool;
+}  // namespace wolf::system
+
 namespace wolf::system::compression {
 
 struct w_lz4 {
@@ -50,6 +61,298 @@ struct w_lz4 {
       _In_ const gsl::span<const std::byte> p_src,
       _In_ const size_t p_max_retry) noexcept;
 };
+
+// the progress of streaming decompression
+using w_lz4_stream_progress = w_compress_progress;
+
+/*
+ * compress and decompress lz4 frames (LZ4F) with contexts which are created
+ * once and reused for every frame. the frames carry their content size, so
+ * decompression allocates the output once, and the caller may provide the
+ * output spans to avoid any allocation at all. an optional dictionary
+ * primes the compression of small messages, the same dictionary must be
+ * used for decompression. it satisfies w_compressor.
+ * a stream must not be used by several threads at the same time.
+ */
+class w_lz4_stream {
+ public:
+  /*
+   * create the contexts of a stream
+   * @param p_compression_level, zero for the fast mode of lz4, 3 to 12 for
+   * the high compression modes
+   * @param p_dictionary, an optional dictionary, it will be copied, see
+   * has_dictionary_support
+   * @returns the stream
+   */
+  W_API static boost::leaf::result<w_lz4_stream> make(
+      _In_ int p_compression_level = 0,
+      _In_ gsl::span<const std::byte> p_dictionary = {}) noexcept;
+
+  // returns true if dictionaries are supported by the linked lz4, they need
+  // lz4 v1.10 or a static lz4 (WOLF_SYSTEM_LZ4_STATIC)
+  W_API static bool has_dictionary_support() noexcept;
+
+  // destructor
+  W_API virtual ~w_lz4_stream() noexcept { _release(); }
+
+  // move constructor.
+  W_API w_lz4_stream(w_lz4_stream &&p_other) noexcept {
+    _move(std::forward<w_lz4_stream &&>(p_other));
+  }
+  // move assignment operator.
+  W_API w_lz4_stream &operator=(w_lz4_stream &&p_other) noexcept {
+    _move(std::forward<w_lz4_stream &&>(p_other));
+    return *this;
+  }
+
+  /*
+   * get the maximum size of a frame which contains p_src_size bytes
+   * @param p_src_size, the input size
+   * @returns the size of bound
+   */
+  W_API size_t get_compress_bound(_In_ size_t p_src_size) const noexcept;
+
+  /*
+   * compress a whole frame into the destination
+   * @param p_src, the input source
+   * @param p_dst, the destination, at least get_compress_bound bytes
+   * @returns the size of frame
+   */
+  W_API boost::leaf::result<size_t> compress(
+      _In_ gsl::span<const std::byte> p_src,
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * compress a whole frame
+   * @param p_src, the input source
+   * @returns the vector of frame
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> compress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * start a frame which will be compressed in chunks
+   * @param p_dst, the destination of header, at least 19 bytes
+   * @param p_content_size, the total size of content if it is known, it will
+   * be written into the header
+   * @returns the size of header
+   */
+  W_API boost::leaf::result<size_t> compress_begin(
+      _Inout_ gsl::span<std::byte> p_dst, _In_ size_t p_content_size = 0) noexcept;
+
+  /*
+   * get the maximum size which compress_update or compress_end may write
+   * @param p_src_size, the size of chunk
+   * @returns the size of bound
+   */
+  W_API size_t get_compress_update_bound(_In_ size_t p_src_size) const noexcept;
+
+  /*
+   * compress a chunk of the frame which was started with compress_begin
+   * @param p_src, the chunk
+   * @param p_dst, the destination, at least get_compress_update_bound bytes
+   * @returns number of bytes which were written, it may be zero
+   */
+  W_API boost::leaf::result<size_t> compress_update(
+      _In_ gsl::span<const std::byte> p_src,
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * flush the buffered data and end the frame
+   * @param p_dst, the destination, at least get_compress_update_bound(0)
+   * bytes
+   * @returns number of bytes which were written
+   */
+  W_API boost::leaf::result<size_t> compress_end(
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * read the content size from the header of a frame
+   * @param p_src, the frame
+   * @returns the content size, zero if the frame does not carry it
+   */
+  W_API boost::leaf::result<size_t> get_content_size(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * decompress the next chunk of a frame, call it until done is true, the
+   * source and destination can be of any size
+   * @param p_src, the next bytes of frame
+   * @param p_dst, the destination
+   * @returns the progress
+   */
+  W_API boost::leaf::result<w_lz4_stream_progress> decompress_update(
+      _In_ gsl::span<const std::byte> p_src,
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress a whole frame into the destination
+   * @param p_src, the frame
+   * @param p_dst, the destination, at least the content size of frame
+   * @returns number of decompressed bytes
+   */
+  W_API boost::leaf::result<size_t> decompress(
+      _In_ gsl::span<const std::byte> p_src,
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress a whole frame, the output will be allocated once if the
+   * frame carries its content size
+   * @param p_src, the frame
+   * @returns the vector of decompressed stream
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> decompress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+ private:
+  // default constructor
+  w_lz4_stream() noexcept = default;
+  // copy constructor.
+  w_lz4_stream(const w_lz4_stream &) = delete;
+  // copy assignment operator.
+  w_lz4_stream &operator=(const w_lz4_stream &) = delete;
+
+  W_API void _move(w_lz4_stream &&p_other) noexcept;
+  W_API void _release() noexcept;
+
+  int _compression_level = 0;
+  std::vector<std::byte> _dictionary;
+  LZ4F_cctx_s *_cctx = nullptr;
+  LZ4F_dctx_s *_dctx = nullptr;
+  LZ4F_CDict_s *_cdict = nullptr;
+};
+
+/*
+ * a block of the indexed lz4 container
+ */
+struct w_lz4_block {
+  // the offset of block from the beginning of container
+  uint64_t offset = 0;
+  // the size of block in the container
+  uint32_t size = 0;
+  // true if the block was incompressible and is stored as it is
+  bool stored = false;
+};
+
+/*
+ * the index of an indexed lz4 container
+ */
+struct w_lz4_blocks_index {
+  // the size of uncompressed blocks, the last one may be smaller
+  size_t block_size = 0;
+  // the size of whole uncompressed content
+  size_t content_size = 0;
+  // the blocks in order of content
+  std::vector<w_lz4_block> blocks;
+
+  // returns the uncompressed size of a block
+  [[nodiscard]] size_t get_block_content_size(_In_ size_t p_block_index) const noexcept {
+    const auto _begin = p_block_index * this->block_size;
+    return std::min(this->block_size, this->content_size - _begin);
+  }
+};
+
+/*
+ * compress the content as independent lz4 blocks on a pool of threads and
+ * write them into a container which starts with a block index. the
+ * container can be decompressed in parallel, and any single block can be
+ * decompressed on its own without touching the others.
+ * the layout is little endian:
+ *  magic (4 bytes) | version (4 bytes) | block size (4 bytes) |
+ *  number of blocks (4 bytes) | content size (8 bytes) |
+ *  compressed size of each block (4 bytes, the high bit marks a stored
+ *  block) | blocks
+ * an instance must not be used by several threads at the same time.
+ */
+class w_lz4_blocks {
+ public:
+  // the magic number of container, "WLZB"
+  static constexpr uint32_t MAGIC = 0x425A4C57;
+  static constexpr uint32_t VERSION = 1;
+  static constexpr size_t HEADER_SIZE = 24;
+
+  /*
+   * create a parallel compressor
+   * @param p_block_size, the size of blocks, smaller blocks give finer
+   * random access and more parallelism but a lower ratio
+   * @param p_concurrency, number of threads including the caller, zero for
+   * the number of cores
+   * @param p_acceleration, a value between 1 - 65536 as in compress_fast
+   * @returns the compressor
+   */
+  W_API static boost::leaf::result<w_lz4_blocks> make(
+      _In_ size_t p_block_size = 1024 * 1024, _In_ size_t p_concurrency = 0,
+      _In_ int p_acceleration = 1) noexcept;
+
+  W_API w_lz4_blocks(w_lz4_blocks &&p_other) noexcept;
+  W_API w_lz4_blocks &operator=(w_lz4_blocks &&p_other) noexcept;
+  W_API virtual ~w_lz4_blocks() noexcept;
+
+  /*
+   * compress the source into an indexed container
+   * @param p_src, the input source
+   * @returns the container
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> compress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * decompress all blocks of a container in parallel
+   * @param p_src, the container
+   * @param p_dst, the destination, at least the content size
+   * @returns number of decompressed bytes
+   */
+  W_API boost::leaf::result<size_t> decompress(
+      _In_ gsl::span<const std::byte> p_src,
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress all blocks of a container in parallel
+   * @param p_src, the container
+   * @returns the vector of decompressed content
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> decompress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * parse and validate the index of a container
+   * @param p_src, the container
+   * @returns the index
+   */
+  W_API static boost::leaf::result<w_lz4_blocks_index> read_index(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * decompress a single block of a container on the calling thread
+   * @param p_src, the container
+   * @param p_index, the index which was read from the container
+   * @param p_block_index, the block, the content at offset o lives in block
+   * o / block_size
+   * @param p_dst, the destination, at least the content size of block
+   * @returns number of decompressed bytes
+   */
+  W_API static boost::leaf::result<size_t> decompress_block(
+      _In_ gsl::span<const std::byte> p_src, _In_ const w_lz4_blocks_index &p_index,
+      _In_ size_t p_block_index, _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  // returns number of threads which run the blocks, including the caller
+  W_API size_t get_concurrency() const noexcept;
+
+ private:
+  // default constructor
+  w_lz4_blocks() noexcept = default;
+  // copy constructor.
+  w_lz4_blocks(const w_lz4_blocks &) = delete;
+  // copy assignment operator.
+  w_lz4_blocks &operator=(const w_lz4_blocks &) = delete;
+
+  size_t _block_size = 0;
+  int _acceleration = 1;
+  std::unique_ptr<w_thread_pool> _pool;
+  // the compressed blocks before they are packed, reused between calls
+  std::vector<std::byte> _scratch;
+  std::vector<uint32_t> _sizes;
+};
 }  // namespace wolf::system::compression
 
 #endif  // WOLF_SYSTEM_LZ4
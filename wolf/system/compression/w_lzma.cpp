@@ -9,7 +9,15 @@
 #include <LzmaEnc.h>
 #include <DISABLE_ANALYSIS_END>
 
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+
 using w_lzma = wolf::system::compression::w_lzma;
+using w_lzma2_decoder = wolf::system::compression::w_lzma2_decoder;
+using w_lzma_allocator = wolf::system::compression::w_lzma_allocator;
+using w_lzma_pooled_allocator = wolf::system::compression::w_lzma_pooled_allocator;
+using w_lzma_pooled_allocator_stats = wolf::system::compression::w_lzma_pooled_allocator_stats;
+using w_compress_progress = wolf::system::compression::w_compress_progress;
 
 constexpr auto LZMA_HEADER_SRC_SIZE = 8;
 constexpr auto MAX_HEADER_SIZE = 256 * 1024 * 1024;
@@ -25,6 +33,96 @@ static void s_lzma_free(ISzAllocPtr p_ptr, void *p_addr) noexcept {
 
 constexpr ISzAlloc s_alloc_funcs = {s_lzma_alloc, s_lzma_free};
 
+// an ISzAlloc which forwards to a w_lzma_allocator, the lzma sdk passes the
+// address of funcs back to the callbacks
+struct w_lzma_alloc_adapter {
+  ISzAlloc funcs;
+  w_lzma_allocator *allocator;
+};
+
+static void *s_adapter_alloc(ISzAllocPtr p_ptr, size_t p_size) noexcept {
+  return reinterpret_cast<const w_lzma_alloc_adapter *>(p_ptr)->allocator->allocate(p_size);
+}
+static void s_adapter_free(ISzAllocPtr p_ptr, void *p_addr) noexcept {
+  reinterpret_cast<const w_lzma_alloc_adapter *>(p_ptr)->allocator->deallocate(p_addr);
+}
+
+static w_lzma_alloc_adapter s_make_alloc(_In_ w_lzma_allocator *p_allocator) noexcept {
+  if (p_allocator == nullptr) {
+    return w_lzma_alloc_adapter{s_alloc_funcs, nullptr};
+  }
+  return w_lzma_alloc_adapter{{s_adapter_alloc, s_adapter_free}, p_allocator};
+}
+
+// the pooled blocks keep their size in front of them
+constexpr size_t s_block_prefix_size = alignof(std::max_align_t);
+
+w_lzma_pooled_allocator::w_lzma_pooled_allocator(_In_ size_t p_max_cached_bytes) noexcept
+    : _max_cached_bytes(p_max_cached_bytes) {}
+
+w_lzma_pooled_allocator::~w_lzma_pooled_allocator() noexcept { trim(); }
+
+void *w_lzma_pooled_allocator::allocate(_In_ size_t p_size) noexcept {
+  {
+    const auto _lock = std::scoped_lock(this->_mutex);
+    for (auto _iter = this->_blocks.rbegin(); _iter != this->_blocks.rend(); ++_iter) {
+      if (_iter->size == p_size) {
+        auto *_ptr = _iter->ptr;
+        *_iter = this->_blocks.back();
+        this->_blocks.pop_back();
+        this->_stats.reuses++;
+        this->_stats.cached_bytes -= p_size;
+        return _ptr;
+      }
+    }
+    this->_stats.allocations++;
+  }
+
+  auto *_block = static_cast<std::byte *>(malloc(s_block_prefix_size + p_size));
+  if (_block == nullptr) {
+    return nullptr;
+  }
+  std::memcpy(_block, &p_size, sizeof(p_size));
+  return _block + s_block_prefix_size;
+}
+
+void w_lzma_pooled_allocator::deallocate(_In_ void *p_ptr) noexcept {
+  if (p_ptr == nullptr) {
+    return;
+  }
+
+  auto *_block = static_cast<std::byte *>(p_ptr) - s_block_prefix_size;
+  size_t _size = 0;
+  std::memcpy(&_size, _block, sizeof(_size));
+  {
+    const auto _lock = std::scoped_lock(this->_mutex);
+    if (this->_stats.cached_bytes + _size <= this->_max_cached_bytes) {
+      try {
+        this->_blocks.push_back(w_block{_size, p_ptr});
+        this->_stats.cached_bytes += _size;
+        return;
+      } catch (...) {
+        // the block goes back to the system
+      }
+    }
+  }
+  free(_block);
+}
+
+void w_lzma_pooled_allocator::trim() noexcept {
+  const auto _lock = std::scoped_lock(this->_mutex);
+  for (const auto &_block : this->_blocks) {
+    free(static_cast<std::byte *>(_block.ptr) - s_block_prefix_size);
+  }
+  this->_blocks.clear();
+  this->_stats.cached_bytes = 0;
+}
+
+w_lzma_pooled_allocator_stats w_lzma_pooled_allocator::get_stats() noexcept {
+  const auto _lock = std::scoped_lock(this->_mutex);
+  return this->_stats;
+}
+
 static void s_lzma_prop(_Inout_ CLzmaEncProps *p_prop, _In_ uint32_t p_level,
                         _In_ int p_src_size) noexcept {
   // set up properties
@@ -54,12 +152,14 @@ static void s_lzma_prop(_Inout_ CLzmaEncProps *p_prop, _In_ uint32_t p_level,
 
 boost::leaf::result<std::vector<std::byte>>
 w_lzma::compress_lzma1(_In_ const gsl::span<const std::byte> p_src,
-                       _In_ uint32_t p_level) {
+                       _In_ uint32_t p_level, _In_ w_lzma_allocator *p_allocator) {
   const auto _src_size = gsl::narrow_cast<int>(p_src.size());
   if (_src_size == 0) {
     return W_FAILURE(std::errc::invalid_argument, "the source is empty");
   }
 
+  const auto _alloc = s_make_alloc(p_allocator);
+
   // set up properties
   CLzmaEncProps _props = {};
   s_lzma_prop(&_props, p_level, _src_size);
@@ -82,7 +182,7 @@ w_lzma::compress_lzma1(_In_ const gsl::span<const std::byte> p_src,
       LzmaEncode(reinterpret_cast<Byte *>(_tmp.data()), &_output_size_64,
                  reinterpret_cast<const Byte *>(p_src.data()), p_src.size(),
                  &_props, reinterpret_cast<Byte *>(_props_encoded.data()),
-                 &_props_size, 0, nullptr, &s_alloc_funcs, &s_alloc_funcs);
+                 &_props_size, 0, nullptr, &_alloc.funcs, &_alloc.funcs);
 
   const auto _compressed_size =
       _output_size_64 + LZMA_HEADER_SRC_SIZE + LZMA_PROPS_SIZE;
@@ -96,8 +196,9 @@ w_lzma::compress_lzma1(_In_ const gsl::span<const std::byte> p_src,
     std::copy(_props_encoded.begin(), _props_encoded.begin() + LZMA_PROPS_SIZE,
               std::back_inserter(_dst));
 
+    const auto _header_size = static_cast<uint64_t>(p_src.size());
     for (int i = 0; i < LZMA_HEADER_SRC_SIZE; i++) {
-      _dst.push_back(std::byte((_src_size >> (i * 8)) & 0xFF));
+      _dst.push_back(std::byte((_header_size >> (i * 8)) & 0xFF));
     }
 
     // copy the compressed size
@@ -111,13 +212,14 @@ w_lzma::compress_lzma1(_In_ const gsl::span<const std::byte> p_src,
 
 boost::leaf::result<std::vector<std::byte>>
 w_lzma::compress_lzma2(_In_ const gsl::span<const std::byte> p_src,
-                       _In_ uint32_t p_level) {
+                       _In_ uint32_t p_level, _In_ w_lzma_allocator *p_allocator) {
   const auto _src_size = gsl::narrow_cast<int>(p_src.size());
   if (_src_size == 0) {
     return W_FAILURE(std::errc::invalid_argument, "the source is empty");
   }
 
-  auto _enc_handler = Lzma2Enc_Create(&s_alloc_funcs, &s_alloc_funcs);
+  const auto _alloc = s_make_alloc(p_allocator);
+  auto _enc_handler = Lzma2Enc_Create(&_alloc.funcs, &_alloc.funcs);
   if (!_enc_handler) {
     return W_FAILURE(std::errc::operation_canceled,
                      "failed on creating lzma2 encoder");
@@ -167,8 +269,9 @@ w_lzma::compress_lzma2(_In_ const gsl::span<const std::byte> p_src,
         1 byte properties + 8 bytes uncompressed size
     */
     _dst.push_back(std::byte(properties));
+    const auto _header_size = static_cast<uint64_t>(p_src.size());
     for (int i = 0; i < LZMA_HEADER_SRC_SIZE; i++) {
-      _dst.push_back(std::byte((_src_size >> (i * 8)) & 0xFF));
+      _dst.push_back(std::byte((_header_size >> (i * 8)) & 0xFF));
     }
 
     // copy the compressed size
@@ -181,7 +284,8 @@ w_lzma::compress_lzma2(_In_ const gsl::span<const std::byte> p_src,
 }
 
 boost::leaf::result<std::vector<std::byte>>
-w_lzma::decompress_lzma1(_In_ const gsl::span<const std::byte> p_src) {
+w_lzma::decompress_lzma1(_In_ const gsl::span<const std::byte> p_src,
+                         _In_ w_lzma_allocator *p_allocator) {
   const auto _src_size = p_src.size();
 
   if (_src_size < LZMA_HEADER_SRC_SIZE + LZMA_PROPS_SIZE) {
@@ -199,6 +303,7 @@ w_lzma::decompress_lzma1(_In_ const gsl::span<const std::byte> p_src) {
     }
   }
 
+  const auto _alloc = s_make_alloc(p_allocator);
   std::vector<std::byte> _dst;
   if (_size_from_header <= MAX_HEADER_SIZE) {
     // allocate memory
@@ -213,7 +318,7 @@ w_lzma::decompress_lzma1(_In_ const gsl::span<const std::byte> p_src) {
         reinterpret_cast<const Byte *>(
             &gsl::at(p_src, LZMA_HEADER_SRC_SIZE + LZMA_PROPS_SIZE)),
         &_proc_in_size, reinterpret_cast<const Byte *>(p_src.data()),
-        LZMA_PROPS_SIZE, LZMA_FINISH_END, &_lzma_status, &s_alloc_funcs);
+        LZMA_PROPS_SIZE, LZMA_FINISH_END, &_lzma_status, &_alloc.funcs);
     // return on success
     if (_status == SZ_OK && _proc_out_size == _size_from_header) {
       return _dst;
@@ -223,77 +328,243 @@ w_lzma::decompress_lzma1(_In_ const gsl::span<const std::byte> p_src) {
 }
 
 boost::leaf::result<std::vector<std::byte>>
-w_lzma::decompress_lzma2(_In_ gsl::span<const std::byte> p_src) {
-  const auto _src_size = p_src.size();
-
-  if (_src_size < LZMA_HEADER_SRC_SIZE + sizeof(Byte)) {
+w_lzma::decompress_lzma2(_In_ gsl::span<const std::byte> p_src,
+                         _In_ w_lzma_allocator *p_allocator) {
+  constexpr auto _header_size = LZMA_HEADER_SRC_SIZE + sizeof(Byte);
+  if (p_src.size() < _header_size) {
     return W_FAILURE(std::errc::invalid_argument, "invalid lzma2 header size");
   }
 
-  // extract the size from the header
-  uint64_t _size_from_header = 0;
-  for (uint64_t i = 0; i < LZMA_HEADER_SRC_SIZE; i++) {
-    const auto _h1 = gsl::at(p_src, sizeof(Byte) + i);
-    const auto _h2 = i * 8;
-    const auto _h3 = gsl::narrow_cast<uint64_t>(_h1 << _h2);
-    if (_h3 < std::numeric_limits<uint64_t>::max()) {
-      _size_from_header |= _h3;
-    }
+  BOOST_LEAF_AUTO(_decoder, w_lzma2_decoder::make(p_allocator));
+
+  // the header tells the size of content
+  BOOST_LEAF_CHECK(_decoder.decode(p_src.first(_header_size), gsl::span<std::byte>{}));
+  BOOST_LEAF_AUTO(_size_from_header, _decoder.get_content_size());
+  if (_size_from_header > MAX_HEADER_SIZE) {
+    return W_FAILURE(std::errc::value_too_large,
+                     "the lzma2 stream is too big, use w_lzma2_decoder instead");
   }
 
-  const auto _pre_out_size = _size_from_header * 2;
-  if (_size_from_header <= MAX_HEADER_SIZE) {
-    std::vector<std::byte> _dst;
-    _dst.resize(_size_from_header);
+  std::vector<std::byte> _dst;
+  _dst.resize(gsl::narrow_cast<size_t>(_size_from_header));
+
+  size_t _consumed = _header_size;
+  size_t _produced = 0;
 
-    CLzma2Dec _dec{};
-    Lzma2Dec_Construct(&_dec);
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    BOOST_LEAF_AUTO(_progress, _decoder.decode(p_src.subspan(_consumed),
+                                               gsl::span(_dst).subspan(_produced)));
+    _consumed += _progress.consumed;
+    _produced += _progress.produced;
 
-    auto _res = Lzma2Dec_Allocate(&_dec, 0, &s_alloc_funcs);
-    if (_res != SZ_OK) {
-      return W_FAILURE(std::errc::invalid_argument,
-                       "could not allocate memory for lzma2 decoder");
+    if (_progress.done) {
+      return _dst;
+    }
+    if (_progress.consumed == 0 && _progress.produced == 0) {
+      return W_FAILURE(std::errc::operation_canceled, "lzma2 decompress failed");
     }
+  }
+}
 
-    Lzma2Dec_Init(&_dec);
-    const auto properties = gsl::at(p_src, 0);
-    unsigned _out_pos = 0, _in_pos = LZMA_HEADER_SRC_SIZE + sizeof(properties);
-
-    ELzmaStatus _status = LZMA_STATUS_NOT_SPECIFIED;
-    constexpr uint32_t BUF_SIZE = 10240;
-
-    while (_out_pos < _pre_out_size) {
-      auto _dest_len = std::min(gsl::narrow_cast<uint64_t>(BUF_SIZE),
-                                _pre_out_size - _out_pos);
-      auto _src_len = std::min(gsl::narrow_cast<size_t>(BUF_SIZE),
-                               _src_size - gsl::narrow_cast<size_t>(_in_pos));
-
-      _res = Lzma2Dec_DecodeToBuf(
-          &_dec, reinterpret_cast<Byte *>(&gsl::at(_dst, _out_pos)), &_dest_len,
-          reinterpret_cast<const Byte *>(&gsl::at(p_src, _in_pos)), &_src_len,
-          (_out_pos + _dest_len == _size_from_header) ? LZMA_FINISH_END
-                                                      : LZMA_FINISH_ANY,
-          &_status);
-      if (_res != SZ_OK) {
-        return W_FAILURE(std::errc::invalid_argument,
-                         "Lzma2Dec_DecodeToBuf failed");
-      }
+struct w_lzma2_decoder::w_state {
+  CLzma2Dec dec;
+  w_lzma_alloc_adapter alloc;
+  // the properties and the content size of stream
+  std::array<std::byte, LZMA_HEADER_SRC_SIZE + sizeof(Byte)> header;
+  size_t header_size;
+  uint64_t content_size;
+  uint64_t decoded;
+  bool done;
+};
+
+boost::leaf::result<w_lzma2_decoder> w_lzma2_decoder::make(
+    _In_ w_lzma_allocator *p_allocator) noexcept {
+  auto _decoder = w_lzma2_decoder();
+  _decoder._state = new (std::nothrow) w_state{};
+  if (_decoder._state == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the lzma2 decoder");
+  }
+  Lzma2Dec_Construct(&_decoder._state->dec);
+  _decoder._state->alloc = s_make_alloc(p_allocator);
+  return _decoder;
+}
 
-      _in_pos += gsl::narrow_cast<uint32_t>(_src_len);
-      _out_pos += gsl::narrow_cast<uint32_t>(_dest_len);
-      if (_status == LZMA_STATUS_FINISHED_WITH_MARK) {
-        break;
-      }
+void w_lzma2_decoder::_move(w_lzma2_decoder &&p_other) noexcept {
+  if (this == &p_other) {
+    return;
+  }
+  _release();
+  this->_state = std::exchange(p_other._state, nullptr);
+}
+
+void w_lzma2_decoder::_release() noexcept {
+  if (this->_state != nullptr) {
+    Lzma2Dec_Free(&this->_state->dec, &this->_state->alloc.funcs);
+    delete this->_state;
+    this->_state = nullptr;
+  }
+}
+
+boost::leaf::result<uint64_t> w_lzma2_decoder::get_content_size() const noexcept {
+  if (this->_state == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the lzma2 decoder was not created");
+  }
+  return this->_state->content_size;
+}
+
+boost::leaf::result<int> w_lzma2_decoder::reset() noexcept {
+  if (this->_state == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the lzma2 decoder was not created");
+  }
+  _reset();
+  return 0;
+}
+
+void w_lzma2_decoder::_reset() noexcept {
+  // the dictionary is released or reused by the next Lzma2Dec_Allocate
+  this->_state->header_size = 0;
+  this->_state->content_size = 0;
+  this->_state->decoded = 0;
+  this->_state->done = false;
+}
+
+boost::leaf::result<size_t> w_lzma2_decoder::decode_header(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  auto &_state = *this->_state;
+  if (_state.header_size == _state.header.size()) {
+    return 0;
+  }
+
+  const auto _size = std::min(p_src.size(), _state.header.size() - _state.header_size);
+  std::memcpy(_state.header.data() + _state.header_size, p_src.data(), _size);
+  _state.header_size += _size;
+  if (_state.header_size < _state.header.size()) {
+    return _size;
+  }
+
+  std::memcpy(&_state.content_size, _state.header.data() + sizeof(Byte),
+              sizeof(_state.content_size));
+  boost::endian::little_to_native_inplace(_state.content_size);
+
+  const auto _prop = std::to_integer<Byte>(_state.header[0]);
+  const auto _res = Lzma2Dec_Allocate(&_state.dec, _prop, &_state.alloc.funcs);
+  if (_res != SZ_OK) {
+    _reset();
+    return W_FAILURE(_res == SZ_ERROR_MEM ? std::errc::not_enough_memory
+                                          : std::errc::illegal_byte_sequence,
+                     "could not allocate the lzma2 decoder for the stream properties");
+  }
+  Lzma2Dec_Init(&_state.dec);
+  return _size;
+}
+
+boost::leaf::result<w_compress_progress> w_lzma2_decoder::decode(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  if (this->_state == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the lzma2 decoder was not created");
+  }
+  auto &_state = *this->_state;
+  if (_state.done) {
+    return w_compress_progress{0, 0, true};
+  }
+
+  BOOST_LEAF_AUTO(_header_consumed, decode_header(p_src));
+  if (_state.header_size < _state.header.size()) {
+    return w_compress_progress{_header_consumed, 0, false};
+  }
+  const auto _src = p_src.subspan(_header_consumed);
+
+  // the end mark is only read once the destination may hold the rest
+  const auto _finish_mode = _state.decoded + p_dst.size() >= _state.content_size
+                                ? LZMA_FINISH_END
+                                : LZMA_FINISH_ANY;
+
+  auto _src_len = gsl::narrow_cast<SizeT>(_src.size());
+  auto _dst_len = gsl::narrow_cast<SizeT>(p_dst.size());
+  auto _status = LZMA_STATUS_NOT_SPECIFIED;
+  const auto _res = Lzma2Dec_DecodeToBuf(
+      &_state.dec, reinterpret_cast<Byte *>(p_dst.data()), &_dst_len,
+      reinterpret_cast<const Byte *>(_src.data()), &_src_len, _finish_mode, &_status);
+  _state.decoded += _dst_len;
+
+  if (_res != SZ_OK || _state.decoded > _state.content_size ||
+      (_status == LZMA_STATUS_FINISHED_WITH_MARK && _state.decoded != _state.content_size)) {
+    _reset();
+    return W_FAILURE(std::errc::illegal_byte_sequence, "the lzma2 stream is corrupted");
+  }
+
+  _state.done = _status == LZMA_STATUS_FINISHED_WITH_MARK;
+  return w_compress_progress{_header_consumed + _src_len, _dst_len, _state.done};
+}
+
+boost::leaf::result<w_compress_progress> w_lzma2_decoder::decode(
+    _In_ gsl::span<const std::byte> p_src, _In_ const w_sink &p_sink) noexcept {
+  if (this->_state == nullptr) {
+    return W_FAILURE(std::errc::invalid_argument, "the lzma2 decoder was not created");
+  }
+  auto &_state = *this->_state;
+  if (_state.done) {
+    return w_compress_progress{0, 0, true};
+  }
+
+  BOOST_LEAF_AUTO(_consumed, decode_header(p_src));
+  if (_state.header_size < _state.header.size()) {
+    return w_compress_progress{_consumed, 0, false};
+  }
+
+  size_t _produced = 0;
+  auto &_dic = _state.dec.decoder;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    // the dictionary is a ring, decode into it and hand each new range to
+    // the sink before it is overwritten
+    if (_dic.dicPos == _dic.dicBufSize) {
+      _dic.dicPos = 0;
+    }
+    const auto _dic_pos = _dic.dicPos;
+
+    auto _src_len = gsl::narrow_cast<SizeT>(p_src.size() - _consumed);
+    auto _status = LZMA_STATUS_NOT_SPECIFIED;
+    const auto _res = Lzma2Dec_DecodeToDic(
+        &_state.dec, _dic.dicBufSize, reinterpret_cast<const Byte *>(p_src.data() + _consumed),
+        &_src_len, LZMA_FINISH_ANY, &_status);
+    _consumed += _src_len;
+
+    const auto _out = _dic.dicPos - _dic_pos;
+    _state.decoded += _out;
+    if (_res != SZ_OK || _state.decoded > _state.content_size ||
+        (_status == LZMA_STATUS_FINISHED_WITH_MARK && _state.decoded != _state.content_size)) {
+      _reset();
+      return W_FAILURE(std::errc::illegal_byte_sequence, "the lzma2 stream is corrupted");
     }
 
-    Lzma2Dec_Free(&_dec, &s_alloc_funcs);
+    if (_out != 0) {
+      auto _ret = p_sink(gsl::span<const std::byte>(
+          reinterpret_cast<const std::byte *>(_dic.dic + _dic_pos), _out));
+      if (!_ret) {
+        _reset();
+        return _ret.error();
+      }
+      _produced += _out;
+    }
 
-    if (_out_pos == _size_from_header) {
-      return _dst;
+    if (_status == LZMA_STATUS_FINISHED_WITH_MARK) {
+      _state.done = true;
+      break;
+    }
+    if (_src_len == 0 && _out == 0) {
+      // it needs more input
+      break;
     }
   }
 
-  return W_FAILURE(std::errc::operation_canceled, "lzma2 decompress failed");
+  return w_compress_progress{_consumed, _produced, _state.done};
 }
 
-#endif // WOLF_SYSTEM_LZMA
\ No newline at end of file
+#endif // WOLF_SYSTEM_LZMA
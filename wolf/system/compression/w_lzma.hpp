@@ -8,43 +8,225 @@
 #ifdef WOLF_SYSTEM_LZMA
 
 #include <wolf/wolf.hpp>
+#include "w_compressor.hpp"
+
+#include <functional>
+#include <mutex>
+#include <vector>
 
 namespace wolf::system::compression {
 
+/*
+ * the allocator of lzma coders, it replaces the default malloc/free pair
+ * of the lzma sdk (ISzAlloc)
+ */
+class w_lzma_allocator {
+ public:
+  virtual ~w_lzma_allocator() noexcept = default;
+
+  /*
+   * allocate a block
+   * @param p_size, the size of block
+   * @returns the block or nullptr on failure
+   */
+  virtual void *allocate(_In_ size_t p_size) noexcept = 0;
+
+  /*
+   * release a block which was returned by allocate
+   * @param p_ptr, the block, it may be nullptr
+   */
+  virtual void deallocate(_In_ void *p_ptr) noexcept = 0;
+};
+
+/*
+ * the statistics of w_lzma_pooled_allocator
+ */
+struct w_lzma_pooled_allocator_stats {
+  // number of blocks which were allocated from the system
+  uint64_t allocations = 0;
+  // number of blocks which were reused from the pool
+  uint64_t reuses = 0;
+  // number of bytes which are cached in the pool
+  size_t cached_bytes = 0;
+};
+
+/*
+ * an allocator which keeps the released blocks and hands them out again for
+ * the same sizes. the coders of streams with the same properties allocate
+ * the same dictionaries and probabilities, so decoding many archives reuses
+ * them instead of going back to the system every time.
+ * it is thread safe.
+ */
+class w_lzma_pooled_allocator : public w_lzma_allocator {
+ public:
+  /*
+   * @param p_max_cached_bytes, the released blocks beyond this size are
+   * given back to the system
+   */
+  W_API explicit w_lzma_pooled_allocator(
+      _In_ size_t p_max_cached_bytes = 256 * 1024 * 1024) noexcept;
+
+  W_API ~w_lzma_pooled_allocator() noexcept override;
+
+  w_lzma_pooled_allocator(const w_lzma_pooled_allocator &) = delete;
+  w_lzma_pooled_allocator &operator=(const w_lzma_pooled_allocator &) = delete;
+  w_lzma_pooled_allocator(w_lzma_pooled_allocator &&) = delete;
+  w_lzma_pooled_allocator &operator=(w_lzma_pooled_allocator &&) = delete;
+
+  W_API void *allocate(_In_ size_t p_size) noexcept override;
+  W_API void deallocate(_In_ void *p_ptr) noexcept override;
+
+  // give all the cached blocks back to the system
+  W_API void trim() noexcept;
+
+  // returns the statistics of allocator
+  W_API w_lzma_pooled_allocator_stats get_stats() noexcept;
+
+ private:
+  struct w_block {
+    size_t size;
+    void *ptr;
+  };
+
+  size_t _max_cached_bytes;
+  std::mutex _mutex;
+  std::vector<w_block> _blocks;
+  w_lzma_pooled_allocator_stats _stats = {};
+};
+
 struct w_lzma {
   /*
    * compress a stream via lzma1 algorithm
    * @param p_src, the input source
    * @param p_level, the level of compression
+   * @param p_allocator, an optional allocator instead of malloc/free
    * @returns a vector of compressed stream
    */
   W_API static boost::leaf::result<std::vector<std::byte>> compress_lzma1(
-      _In_ const gsl::span<const std::byte> p_src, _In_ uint32_t p_level);
+      _In_ const gsl::span<const std::byte> p_src, _In_ uint32_t p_level,
+      _In_ w_lzma_allocator *p_allocator = nullptr);
 
   /*
    * compress a stream via lzma2 algorithm
    * @param p_src, the input source
    * @param p_level, the level of compression
+   * @param p_allocator, an optional allocator instead of malloc/free
    * @returns a vector of compressed stream
    */
   W_API static boost::leaf::result<std::vector<std::byte>> compress_lzma2(
-      _In_ const gsl::span<const std::byte> p_src, _In_ uint32_t p_level);
+      _In_ const gsl::span<const std::byte> p_src, _In_ uint32_t p_level,
+      _In_ w_lzma_allocator *p_allocator = nullptr);
 
   /*
    * decompress a stream via lzma1 algorithm
    * @param p_src, the input source
+   * @param p_allocator, an optional allocator instead of malloc/free
    * @returns a vector of decompressed stream
    */
   W_API static boost::leaf::result<std::vector<std::byte>> decompress_lzma1(
-      _In_ const gsl::span<const std::byte> p_src);
+      _In_ const gsl::span<const std::byte> p_src,
+      _In_ w_lzma_allocator *p_allocator = nullptr);
 
   /*
-   * decompress a stream via lzma2 algorithm
+   * decompress a stream via lzma2 algorithm, the streams bigger than 256 MB
+   * must be decoded with w_lzma2_decoder
    * @param p_src, the input source
+   * @param p_allocator, an optional allocator instead of malloc/free
    * @returns a vector of decompressed stream
    */
   W_API static boost::leaf::result<std::vector<std::byte>> decompress_lzma2(
-      _In_ gsl::span<const std::byte> p_src);
+      _In_ gsl::span<const std::byte> p_src,
+      _In_ w_lzma_allocator *p_allocator = nullptr);
+};
+
+/*
+ * an incremental decoder of the lzma2 streams which are written by
+ * w_lzma::compress_lzma2 (1 byte properties, 8 bytes content size, lzma2
+ * chunks). the input can be fed in chunks of any size and the output is
+ * either written into the caller's spans or handed to a sink straight from
+ * the dictionary of decoder, so the memory is bounded by the dictionary of
+ * stream instead of the size of content.
+ * a decoder must not be used by several threads at the same time.
+ */
+class w_lzma2_decoder {
+ public:
+  // receives each decoded chunk, which is only valid during the call
+  using w_sink = std::function<boost::leaf::result<void>(gsl::span<const std::byte>)>;
+
+  /*
+   * create a decoder
+   * @param p_allocator, an optional allocator instead of malloc/free, it
+   * must outlive the decoder
+   * @returns the decoder
+   */
+  W_API static boost::leaf::result<w_lzma2_decoder> make(
+      _In_ w_lzma_allocator *p_allocator = nullptr) noexcept;
+
+  // destructor
+  W_API virtual ~w_lzma2_decoder() noexcept { _release(); }
+
+  // move constructor.
+  W_API w_lzma2_decoder(w_lzma2_decoder &&p_other) noexcept {
+    _move(std::forward<w_lzma2_decoder &&>(p_other));
+  }
+  // move assignment operator.
+  W_API w_lzma2_decoder &operator=(w_lzma2_decoder &&p_other) noexcept {
+    _move(std::forward<w_lzma2_decoder &&>(p_other));
+    return *this;
+  }
+
+  /*
+   * decode the next chunk of stream into the destination, call it until
+   * done is true
+   * @param p_src, the next bytes of stream
+   * @param p_dst, the destination, any size
+   * @returns the progress
+   */
+  W_API boost::leaf::result<w_compress_progress> decode(
+      _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decode the next chunk of stream and hand the output to the sink without
+   * copying it, call it until done is true
+   * @param p_src, the next bytes of stream
+   * @param p_sink, the sink, its failure stops the decoding
+   * @returns the progress, produced is the number of bytes which were
+   * handed to the sink
+   */
+  W_API boost::leaf::result<w_compress_progress> decode(
+      _In_ gsl::span<const std::byte> p_src, _In_ const w_sink &p_sink) noexcept;
+
+  /*
+   * get the size of content
+   * @returns the size from the header of stream, zero until the header was
+   * decoded
+   */
+  W_API boost::leaf::result<uint64_t> get_content_size() const noexcept;
+
+  /*
+   * get ready for the next stream, the dictionary is kept if it fits
+   * @returns zero on success
+   */
+  W_API boost::leaf::result<int> reset() noexcept;
+
+ private:
+  struct w_state;
+
+  // default constructor
+  w_lzma2_decoder() noexcept = default;
+  // copy constructor.
+  w_lzma2_decoder(const w_lzma2_decoder &) = delete;
+  // copy assignment operator.
+  w_lzma2_decoder &operator=(const w_lzma2_decoder &) = delete;
+
+  W_API void _move(w_lzma2_decoder &&p_other) noexcept;
+  W_API void _release() noexcept;
+  void _reset() noexcept;
+
+  W_API boost::leaf::result<size_t> decode_header(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  w_state *_state = nullptr;
 };
 }  // namespace wolf::system::compression
 
@@ -0,0 +1,319 @@
+#include "w_zlib.hpp"
+
+#ifdef WOLF_SYSTEM_ZLIB
+
+#include <DISABLE_ANALYSIS_BEGIN>
+#include <zlib.h>
+#include <DISABLE_ANALYSIS_END>
+
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+#include <limits>
+
+using w_zlib = wolf::system::compression::w_zlib;
+using w_zlib_format = wolf::system::compression::w_zlib_format;
+using w_compress_progress = wolf::system::compression::w_compress_progress;
+
+// zlib counts the bytes of each call with 32 bits
+constexpr size_t s_max_chunk_size = std::numeric_limits<uInt>::max();
+
+static int s_window_bits(_In_ w_zlib_format p_format) noexcept {
+  switch (p_format) {
+    case w_zlib_format::deflate:
+      return -MAX_WBITS;
+    case w_zlib_format::zlib:
+      return MAX_WBITS;
+    default:
+      return MAX_WBITS + 16;
+  }
+}
+
+static std::string s_zlib_error(_In_ const char *p_func, _In_ int p_code,
+                                _In_ const z_stream *p_stream) {
+  return wolf::format("{} failed with code {} because: {}", p_func, p_code,
+                      p_stream->msg != nullptr ? p_stream->msg : "unknown");
+}
+
+// run one step of deflate or inflate over the spans
+template <typename F>
+static int s_step(_Inout_ z_stream *p_stream, _In_ gsl::span<const std::byte> p_src,
+                  _Inout_ gsl::span<std::byte> p_dst, _In_ F &&p_func,
+                  _Inout_ w_compress_progress &p_progress) noexcept {
+  const auto _src_size = std::min(p_src.size(), s_max_chunk_size);
+  const auto _dst_size = std::min(p_dst.size(), s_max_chunk_size);
+
+  p_stream->next_in = reinterpret_cast<Bytef *>(const_cast<std::byte *>(p_src.data()));
+  p_stream->avail_in = gsl::narrow_cast<uInt>(_src_size);
+  p_stream->next_out = reinterpret_cast<Bytef *>(p_dst.data());
+  p_stream->avail_out = gsl::narrow_cast<uInt>(_dst_size);
+
+  const auto _ret = p_func(p_stream);
+
+  p_progress.consumed = _src_size - p_stream->avail_in;
+  p_progress.produced = _dst_size - p_stream->avail_out;
+  p_progress.done = _ret == Z_STREAM_END;
+  return _ret;
+}
+
+boost::leaf::result<w_zlib> w_zlib::make(_In_ int p_level, _In_ w_zlib_format p_format) noexcept {
+  if (p_level < Z_DEFAULT_COMPRESSION || p_level > Z_BEST_COMPRESSION) {
+    return W_FAILURE(std::errc::invalid_argument, "the zlib level must be between -1 and 9");
+  }
+
+  auto _codec = w_zlib();
+  _codec._format = p_format;
+
+  _codec._deflate = new (std::nothrow) z_stream{};
+  _codec._inflate = new (std::nothrow) z_stream{};
+  if (_codec._deflate == nullptr || _codec._inflate == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the zlib streams");
+  }
+
+  const auto _window_bits = s_window_bits(p_format);
+  auto _ret = deflateInit2(_codec._deflate, p_level, Z_DEFLATED, _window_bits, 8,
+                           Z_DEFAULT_STRATEGY);
+  if (_ret != Z_OK) {
+    delete _codec._deflate;
+    _codec._deflate = nullptr;
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("deflateInit2 failed with code {}", _ret));
+  }
+
+  _ret = inflateInit2(_codec._inflate, _window_bits);
+  if (_ret != Z_OK) {
+    delete _codec._inflate;
+    _codec._inflate = nullptr;
+    return W_FAILURE(std::errc::not_enough_memory,
+                     wolf::format("inflateInit2 failed with code {}", _ret));
+  }
+
+  return _codec;
+}
+
+void w_zlib::_move(w_zlib &&p_other) noexcept {
+  if (this == &p_other) {
+    return;
+  }
+  _release();
+
+  this->_format = p_other._format;
+  this->_deflate = std::exchange(p_other._deflate, nullptr);
+  this->_inflate = std::exchange(p_other._inflate, nullptr);
+}
+
+void w_zlib::_release() noexcept {
+  if (this->_deflate != nullptr) {
+    deflateEnd(this->_deflate);
+    delete this->_deflate;
+    this->_deflate = nullptr;
+  }
+  if (this->_inflate != nullptr) {
+    inflateEnd(this->_inflate);
+    delete this->_inflate;
+    this->_inflate = nullptr;
+  }
+}
+
+size_t w_zlib::get_compress_bound(_In_ size_t p_src_size) const noexcept {
+  // the conservative bound of deflateBound which holds for every level,
+  // plus the largest wrapper (gzip) and the empty blocks of each chunk
+  constexpr size_t _wrapper_size = 18;
+  return p_src_size + ((p_src_size + 7) >> 3) + ((p_src_size + 63) >> 6) + 5 + _wrapper_size +
+         (p_src_size / s_max_chunk_size + 1) * 5;
+}
+
+boost::leaf::result<w_compress_progress> w_zlib::compress_update(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  w_compress_progress _progress = {};
+  const auto _ret = s_step(
+      this->_deflate, p_src, p_dst,
+      [](z_stream *p_stream) { return deflate(p_stream, Z_NO_FLUSH); }, _progress);
+  if (_ret != Z_OK && _ret != Z_BUF_ERROR) {
+    const auto _msg = s_zlib_error("deflate", _ret, this->_deflate);
+    deflateReset(this->_deflate);
+    return W_FAILURE(std::errc::operation_canceled, _msg);
+  }
+  return _progress;
+}
+
+boost::leaf::result<w_compress_progress> w_zlib::compress_end(
+    _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  w_compress_progress _progress = {};
+  const auto _ret = s_step(
+      this->_deflate, {}, p_dst,
+      [](z_stream *p_stream) { return deflate(p_stream, Z_FINISH); }, _progress);
+  if (_ret == Z_STREAM_END) {
+    // ready for the next stream
+    deflateReset(this->_deflate);
+  } else if (_ret != Z_OK && _ret != Z_BUF_ERROR) {
+    const auto _msg = s_zlib_error("deflate", _ret, this->_deflate);
+    deflateReset(this->_deflate);
+    return W_FAILURE(std::errc::operation_canceled, _msg);
+  }
+  return _progress;
+}
+
+boost::leaf::result<size_t> w_zlib::compress(_In_ gsl::span<const std::byte> p_src,
+                                             _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  deflateReset(this->_deflate);
+
+  size_t _consumed = 0;
+  size_t _produced = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    w_compress_progress _progress = {};
+    const auto _src = p_src.subspan(_consumed);
+    const auto _ret = s_step(
+        this->_deflate, _src, p_dst.subspan(_produced),
+        [&](z_stream *p_stream) {
+          // only finish with the last chunk of a huge source
+          return deflate(p_stream, _src.size() <= s_max_chunk_size ? Z_FINISH : Z_NO_FLUSH);
+        },
+        _progress);
+    _consumed += _progress.consumed;
+    _produced += _progress.produced;
+
+    if (_ret == Z_STREAM_END) {
+      deflateReset(this->_deflate);
+      return _produced;
+    }
+    if ((_ret != Z_OK && _ret != Z_BUF_ERROR) ||
+        (_progress.consumed == 0 && _progress.produced == 0)) {
+      const auto _msg = _ret == Z_OK || _ret == Z_BUF_ERROR
+                            ? std::string("the destination is smaller than the deflate stream")
+                            : s_zlib_error("deflate", _ret, this->_deflate);
+      deflateReset(this->_deflate);
+      return W_FAILURE(std::errc::no_buffer_space, _msg);
+    }
+  }
+}
+
+boost::leaf::result<std::vector<std::byte>> w_zlib::compress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  std::vector<std::byte> _dst;
+  try {
+    _dst.resize(get_compress_bound(p_src.size()));
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the deflate stream");
+  }
+
+  BOOST_LEAF_AUTO(_size, compress(p_src, _dst));
+  _dst.resize(_size);
+  return _dst;
+}
+
+boost::leaf::result<w_compress_progress> w_zlib::decompress_update(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  w_compress_progress _progress = {};
+  const auto _ret = s_step(
+      this->_inflate, p_src, p_dst,
+      [](z_stream *p_stream) { return inflate(p_stream, Z_NO_FLUSH); }, _progress);
+  if (_ret == Z_STREAM_END) {
+    // ready for the next stream
+    inflateReset(this->_inflate);
+  } else if (_ret != Z_OK && _ret != Z_BUF_ERROR) {
+    const auto _msg = s_zlib_error("inflate", _ret, this->_inflate);
+    inflateReset(this->_inflate);
+    return W_FAILURE(std::errc::illegal_byte_sequence, _msg);
+  }
+  return _progress;
+}
+
+boost::leaf::result<size_t> w_zlib::decompress(_In_ gsl::span<const std::byte> p_src,
+                                               _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  if (p_src.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  // start from a clean state even if the last stream was left unfinished
+  inflateReset(this->_inflate);
+
+  size_t _consumed = 0;
+  size_t _produced = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    BOOST_LEAF_AUTO(_progress, decompress_update(p_src.subspan(_consumed),
+                                                 p_dst.subspan(_produced)));
+    _consumed += _progress.consumed;
+    _produced += _progress.produced;
+
+    if (_progress.done) {
+      return _produced;
+    }
+    if (_progress.consumed == 0 && _progress.produced == 0) {
+      inflateReset(this->_inflate);
+      return W_FAILURE(_consumed == p_src.size() ? std::errc::invalid_argument
+                                                 : std::errc::no_buffer_space,
+                       _consumed == p_src.size() ? "the deflate stream is not complete"
+                                                 : "the destination is too small");
+    }
+  }
+}
+
+boost::leaf::result<std::vector<std::byte>> w_zlib::decompress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  if (p_src.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  // the output starts from a bounded hint and grows, a forged stream can't
+  // make it allocate more up front
+  const size_t _max_hint = std::max<size_t>(p_src.size() * 4, 64 * 1024);
+  size_t _hint = _max_hint;
+
+  // the gzip trailer ends with the size of content modulo 2^32, it's only a
+  // hint since deflate can't expand more than 1032 times
+  constexpr size_t _gzip_min_size = 18;
+  constexpr size_t _deflate_max_ratio = 1032;
+  if (this->_format == w_zlib_format::gzip && p_src.size() >= _gzip_min_size) {
+    uint32_t _size = 0;
+    std::memcpy(&_size, p_src.data() + p_src.size() - sizeof(_size), sizeof(_size));
+    _size = boost::endian::little_to_native(_size);
+    if (_size <= p_src.size() * _deflate_max_ratio) {
+      // one more byte lets a matched size end without growing
+      _hint = std::min(size_t(_size) + 1, _max_hint);
+    }
+  }
+
+  std::vector<std::byte> _dst;
+  try {
+    _dst.resize(_hint);
+    inflateReset(this->_inflate);
+
+    size_t _consumed = 0;
+    size_t _produced = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      BOOST_LEAF_AUTO(_progress,
+                      decompress_update(p_src.subspan(_consumed),
+                                        gsl::span(_dst).subspan(_produced)));
+      _consumed += _progress.consumed;
+      _produced += _progress.produced;
+
+      if (_progress.done) {
+        _dst.resize(_produced);
+        return _dst;
+      }
+      if (_produced == _dst.size()) {
+        _dst.resize(_dst.size() * 2);
+      } else if (_progress.consumed == 0 && _progress.produced == 0 &&
+                 _consumed == p_src.size()) {
+        inflateReset(this->_inflate);
+        return W_FAILURE(std::errc::invalid_argument, "the deflate stream is not complete");
+      }
+    }
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the deflate output");
+  }
+}
+
+#endif  // WOLF_SYSTEM_ZLIB
@@ -0,0 +1,147 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_ZLIB
+
+#include "wolf.hpp"
+#include "w_compressor.hpp"
+
+#include <cstddef>
+#include <vector>
+
+struct z_stream_s;
+
+namespace wolf::system::compression {
+
+/*
+ * the container of deflate streams
+ */
+enum class w_zlib_format {
+  // raw deflate without header and checksum
+  deflate = 0,
+  // zlib header and adler32 checksum
+  zlib,
+  // gzip header and crc32 checksum
+  gzip,
+};
+
+/*
+ * compress and decompress deflate, zlib and gzip streams with contexts
+ * which are created once and reused for every stream. it satisfies
+ * w_stream_compressor.
+ * an instance must not be used by several threads at the same time.
+ */
+class w_zlib {
+ public:
+  /*
+   * create the contexts of codec
+   * @param p_level, the level of compression between 0 (store) and 9 (best),
+   * -1 for the default level of zlib
+   * @param p_format, the container of streams
+   * @returns the codec
+   */
+  W_API static boost::leaf::result<w_zlib> make(
+      _In_ int p_level = -1, _In_ w_zlib_format p_format = w_zlib_format::gzip) noexcept;
+
+  // destructor
+  W_API virtual ~w_zlib() noexcept { _release(); }
+
+  // move constructor.
+  W_API w_zlib(w_zlib &&p_other) noexcept { _move(std::forward<w_zlib &&>(p_other)); }
+  // move assignment operator.
+  W_API w_zlib &operator=(w_zlib &&p_other) noexcept {
+    _move(std::forward<w_zlib &&>(p_other));
+    return *this;
+  }
+
+  /*
+   * get the maximum size of a stream which contains p_src_size bytes
+   * @param p_src_size, the input size
+   * @returns the size of bound
+   */
+  W_API size_t get_compress_bound(_In_ size_t p_src_size) const noexcept;
+
+  /*
+   * compress a whole stream into the destination
+   * @param p_src, the input source
+   * @param p_dst, the destination, at least get_compress_bound bytes
+   * @returns the size of stream
+   */
+  W_API boost::leaf::result<size_t> compress(_In_ gsl::span<const std::byte> p_src,
+                                             _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * compress a whole stream
+   * @param p_src, the input source
+   * @returns the vector of stream
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> compress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * compress the next chunk of a stream
+   * @param p_src, the chunk
+   * @param p_dst, the destination, any size
+   * @returns the progress, call it again with the rest of chunk if it was
+   * not consumed
+   */
+  W_API boost::leaf::result<w_compress_progress> compress_update(
+      _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * flush the buffered data and end the stream, call it until done is true
+   * @param p_dst, the destination, any size
+   * @returns the progress
+   */
+  W_API boost::leaf::result<w_compress_progress> compress_end(
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress the next chunk of a stream, call it until done is true
+   * @param p_src, the next bytes of stream
+   * @param p_dst, the destination, any size
+   * @returns the progress
+   */
+  W_API boost::leaf::result<w_compress_progress> decompress_update(
+      _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress a whole stream into the destination
+   * @param p_src, the stream
+   * @param p_dst, the destination, at least the size of content
+   * @returns number of decompressed bytes
+   */
+  W_API boost::leaf::result<size_t> decompress(_In_ gsl::span<const std::byte> p_src,
+                                               _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress a whole stream, the size of gzip content is read from its
+   * trailer, so it is allocated once
+   * @param p_src, the stream
+   * @returns the vector of decompressed stream
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> decompress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+ private:
+  // default constructor
+  w_zlib() noexcept = default;
+  // copy constructor.
+  w_zlib(const w_zlib &) = delete;
+  // copy assignment operator.
+  w_zlib &operator=(const w_zlib &) = delete;
+
+  W_API void _move(w_zlib &&p_other) noexcept;
+  W_API void _release() noexcept;
+
+  w_zlib_format _format = w_zlib_format::gzip;
+  z_stream_s *_deflate = nullptr;
+  z_stream_s *_inflate = nullptr;
+};
+}  // namespace wolf::system::compression
+
+#endif  // WOLF_SYSTEM_ZLIB
@@ -0,0 +1,309 @@
+#include "w_zstd.hpp"
+
+#ifdef WOLF_SYSTEM_ZSTD
+
+#include <DISABLE_ANALYSIS_BEGIN>
+#include <zdict.h>
+#include <zstd.h>
+#include <zstd_errors.h>
+#include <DISABLE_ANALYSIS_END>
+
+#include <cstring>
+#include <limits>
+
+using w_zstd = wolf::system::compression::w_zstd;
+using w_compress_progress = wolf::system::compression::w_compress_progress;
+
+static std::string s_zstd_error(_In_ const char *p_func, _In_ size_t p_code) {
+  return wolf::format("{} failed because: {}", p_func, ZSTD_getErrorName(p_code));
+}
+
+boost::leaf::result<w_zstd> w_zstd::make(_In_ int p_level,
+                                         _In_ gsl::span<const std::byte> p_dictionary) noexcept {
+  if (p_level < ZSTD_minCLevel() || p_level > ZSTD_maxCLevel()) {
+    return W_FAILURE(std::errc::invalid_argument, "the zstd level is out of range");
+  }
+
+  auto _codec = w_zstd();
+  _codec._cctx = ZSTD_createCCtx();
+  _codec._dctx = ZSTD_createDCtx();
+  if (_codec._cctx == nullptr || _codec._dctx == nullptr) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not create the zstd contexts");
+  }
+
+  const auto _ret = ZSTD_CCtx_setParameter(_codec._cctx, ZSTD_c_compressionLevel, p_level);
+  if (ZSTD_isError(_ret)) {
+    return W_FAILURE(std::errc::invalid_argument, s_zstd_error("ZSTD_CCtx_setParameter", _ret));
+  }
+
+  if (!p_dictionary.empty()) {
+    // digest the dictionary once for all the frames
+    _codec._cdict = ZSTD_createCDict(p_dictionary.data(), p_dictionary.size(), p_level);
+    _codec._ddict = ZSTD_createDDict(p_dictionary.data(), p_dictionary.size());
+    if (_codec._cdict == nullptr || _codec._ddict == nullptr) {
+      return W_FAILURE(std::errc::not_enough_memory, "could not create the zstd dictionaries");
+    }
+
+    auto _ref = ZSTD_CCtx_refCDict(_codec._cctx, _codec._cdict);
+    if (ZSTD_isError(_ref)) {
+      return W_FAILURE(std::errc::invalid_argument, s_zstd_error("ZSTD_CCtx_refCDict", _ref));
+    }
+    _ref = ZSTD_DCtx_refDDict(_codec._dctx, _codec._ddict);
+    if (ZSTD_isError(_ref)) {
+      return W_FAILURE(std::errc::invalid_argument, s_zstd_error("ZSTD_DCtx_refDDict", _ref));
+    }
+  }
+
+  return _codec;
+}
+
+boost::leaf::result<std::vector<std::byte>> w_zstd::train_dictionary(
+    _In_ gsl::span<const std::vector<std::byte>> p_samples, _In_ size_t p_capacity) noexcept {
+  if (p_samples.empty() || p_capacity == 0) {
+    return W_FAILURE(std::errc::invalid_argument, "there are no samples for the zstd dictionary");
+  }
+  if (p_samples.size() > std::numeric_limits<unsigned>::max()) {
+    return W_FAILURE(std::errc::invalid_argument, "there are too many samples");
+  }
+
+  std::vector<std::byte> _dictionary;
+  std::vector<std::byte> _samples;
+  std::vector<size_t> _sizes;
+  try {
+    // zdict takes the samples back to back
+    size_t _total_size = 0;
+    for (const auto &_sample : p_samples) {
+      _total_size += _sample.size();
+    }
+    _samples.reserve(_total_size);
+    _sizes.reserve(p_samples.size());
+    for (const auto &_sample : p_samples) {
+      _samples.insert(_samples.end(), _sample.begin(), _sample.end());
+      _sizes.push_back(_sample.size());
+    }
+    _dictionary.resize(p_capacity);
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the zstd samples");
+  }
+
+  const auto _size =
+      ZDICT_trainFromBuffer(_dictionary.data(), _dictionary.size(), _samples.data(),
+                            _sizes.data(), gsl::narrow_cast<unsigned>(_sizes.size()));
+  if (ZDICT_isError(_size)) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     wolf::format("ZDICT_trainFromBuffer failed because: {}",
+                                  ZDICT_getErrorName(_size)));
+  }
+
+  _dictionary.resize(_size);
+  return _dictionary;
+}
+
+void w_zstd::_move(w_zstd &&p_other) noexcept {
+  if (this == &p_other) {
+    return;
+  }
+  _release();
+
+  this->_cctx = std::exchange(p_other._cctx, nullptr);
+  this->_dctx = std::exchange(p_other._dctx, nullptr);
+  this->_cdict = std::exchange(p_other._cdict, nullptr);
+  this->_ddict = std::exchange(p_other._ddict, nullptr);
+}
+
+void w_zstd::_release() noexcept {
+  // the contexts must go before the dictionaries they refer to
+  if (this->_cctx != nullptr) {
+    ZSTD_freeCCtx(this->_cctx);
+    this->_cctx = nullptr;
+  }
+  if (this->_dctx != nullptr) {
+    ZSTD_freeDCtx(this->_dctx);
+    this->_dctx = nullptr;
+  }
+  if (this->_cdict != nullptr) {
+    ZSTD_freeCDict(this->_cdict);
+    this->_cdict = nullptr;
+  }
+  if (this->_ddict != nullptr) {
+    ZSTD_freeDDict(this->_ddict);
+    this->_ddict = nullptr;
+  }
+}
+
+size_t w_zstd::get_compress_bound(_In_ size_t p_src_size) const noexcept {
+  return ZSTD_compressBound(p_src_size);
+}
+
+boost::leaf::result<size_t> w_zstd::compress(_In_ gsl::span<const std::byte> p_src,
+                                             _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  // ZSTD_compress2 starts a new frame even if the last one was unfinished
+  const auto _ret =
+      ZSTD_compress2(this->_cctx, p_dst.data(), p_dst.size(), p_src.data(), p_src.size());
+  if (ZSTD_isError(_ret)) {
+    return W_FAILURE(ZSTD_getErrorCode(_ret) == ZSTD_error_dstSize_tooSmall
+                         ? std::errc::no_buffer_space
+                         : std::errc::operation_canceled,
+                     s_zstd_error("ZSTD_compress2", _ret));
+  }
+  return _ret;
+}
+
+boost::leaf::result<std::vector<std::byte>> w_zstd::compress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  std::vector<std::byte> _dst;
+  try {
+    _dst.resize(get_compress_bound(p_src.size()));
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the zstd frame");
+  }
+
+  BOOST_LEAF_AUTO(_size, compress(p_src, _dst));
+  // shrinking keeps the storage, so there is no second allocation
+  _dst.resize(_size);
+  return _dst;
+}
+
+boost::leaf::result<w_compress_progress> w_zstd::compress_update(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  auto _in = ZSTD_inBuffer{p_src.data(), p_src.size(), 0};
+  auto _out = ZSTD_outBuffer{p_dst.data(), p_dst.size(), 0};
+
+  const auto _ret = ZSTD_compressStream2(this->_cctx, &_out, &_in, ZSTD_e_continue);
+  if (ZSTD_isError(_ret)) {
+    ZSTD_CCtx_reset(this->_cctx, ZSTD_reset_session_only);
+    return W_FAILURE(std::errc::operation_canceled, s_zstd_error("ZSTD_compressStream2", _ret));
+  }
+  return w_compress_progress{_in.pos, _out.pos, false};
+}
+
+boost::leaf::result<w_compress_progress> w_zstd::compress_end(
+    _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  auto _in = ZSTD_inBuffer{nullptr, 0, 0};
+  auto _out = ZSTD_outBuffer{p_dst.data(), p_dst.size(), 0};
+
+  // it returns the number of bytes which are still buffered
+  const auto _ret = ZSTD_compressStream2(this->_cctx, &_out, &_in, ZSTD_e_end);
+  if (ZSTD_isError(_ret)) {
+    ZSTD_CCtx_reset(this->_cctx, ZSTD_reset_session_only);
+    return W_FAILURE(std::errc::operation_canceled, s_zstd_error("ZSTD_compressStream2", _ret));
+  }
+  return w_compress_progress{0, _out.pos, _ret == 0};
+}
+
+boost::leaf::result<size_t> w_zstd::get_content_size(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  const auto _size = ZSTD_getFrameContentSize(p_src.data(), p_src.size());
+  if (_size == ZSTD_CONTENTSIZE_ERROR) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is not a zstd frame");
+  }
+  if (_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return 0;
+  }
+  if (_size > std::numeric_limits<size_t>::max()) {
+    return W_FAILURE(std::errc::value_too_large, "the zstd frame is too big");
+  }
+  return gsl::narrow_cast<size_t>(_size);
+}
+
+boost::leaf::result<w_compress_progress> w_zstd::decompress_update(
+    _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  auto _in = ZSTD_inBuffer{p_src.data(), p_src.size(), 0};
+  auto _out = ZSTD_outBuffer{p_dst.data(), p_dst.size(), 0};
+
+  // it returns zero once a frame is completely decoded and flushed
+  const auto _ret = ZSTD_decompressStream(this->_dctx, &_out, &_in);
+  if (ZSTD_isError(_ret)) {
+    ZSTD_DCtx_reset(this->_dctx, ZSTD_reset_session_only);
+    return W_FAILURE(std::errc::illegal_byte_sequence,
+                     s_zstd_error("ZSTD_decompressStream", _ret));
+  }
+  return w_compress_progress{_in.pos, _out.pos, _ret == 0};
+}
+
+boost::leaf::result<size_t> w_zstd::decompress(_In_ gsl::span<const std::byte> p_src,
+                                               _Inout_ gsl::span<std::byte> p_dst) noexcept {
+  if (p_src.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  // start from a clean state even if the last frame was left unfinished
+  ZSTD_DCtx_reset(this->_dctx, ZSTD_reset_session_only);
+
+  const auto _ret =
+      ZSTD_decompressDCtx(this->_dctx, p_dst.data(), p_dst.size(), p_src.data(), p_src.size());
+  if (ZSTD_isError(_ret)) {
+    return W_FAILURE(ZSTD_getErrorCode(_ret) == ZSTD_error_dstSize_tooSmall
+                         ? std::errc::no_buffer_space
+                         : std::errc::illegal_byte_sequence,
+                     s_zstd_error("ZSTD_decompressDCtx", _ret));
+  }
+  return _ret;
+}
+
+boost::leaf::result<std::vector<std::byte>> w_zstd::decompress(
+    _In_ gsl::span<const std::byte> p_src) noexcept {
+  if (p_src.empty()) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is empty");
+  }
+
+  const auto _content_size = ZSTD_getFrameContentSize(p_src.data(), p_src.size());
+  if (_content_size == ZSTD_CONTENTSIZE_ERROR) {
+    return W_FAILURE(std::errc::invalid_argument, "the source is not a zstd frame");
+  }
+
+  // the output starts from a bounded hint and grows, a forged frame header
+  // can't make it allocate more up front
+  const size_t _max_hint = std::max<size_t>(p_src.size() * 4, ZSTD_DStreamOutSize());
+  // the content size is only trusted up to this ratio, a bigger one has to
+  // prove itself while growing
+  constexpr uint64_t _trusted_ratio = 256;
+
+  std::vector<std::byte> _dst;
+  try {
+    if (_content_size != ZSTD_CONTENTSIZE_UNKNOWN &&
+        _content_size <= std::max<uint64_t>(p_src.size() * _trusted_ratio, _max_hint)) {
+      // the frame tells the size, so allocate once
+      if (_content_size > std::numeric_limits<size_t>::max()) {
+        return W_FAILURE(std::errc::value_too_large, "the zstd frame is too big");
+      }
+      _dst.resize(gsl::narrow_cast<size_t>(_content_size));
+      BOOST_LEAF_AUTO(_size, decompress(p_src, _dst));
+      _dst.resize(_size);
+      return _dst;
+    }
+
+    // the frame does not carry a plausible size, grow the output while decoding
+    _dst.resize(_max_hint);
+    ZSTD_DCtx_reset(this->_dctx, ZSTD_reset_session_only);
+    size_t _consumed = 0;
+    size_t _produced = 0;
+
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      BOOST_LEAF_AUTO(_progress,
+                      decompress_update(p_src.subspan(_consumed),
+                                        gsl::span(_dst).subspan(_produced)));
+      _consumed += _progress.consumed;
+      _produced += _progress.produced;
+
+      if (_progress.done) {
+        _dst.resize(_produced);
+        return _dst;
+      }
+      if (_produced == _dst.size()) {
+        _dst.resize(_dst.size() * 2);
+      } else if (_progress.consumed == 0 && _progress.produced == 0 &&
+                 _consumed == p_src.size()) {
+        ZSTD_DCtx_reset(this->_dctx, ZSTD_reset_session_only);
+        return W_FAILURE(std::errc::invalid_argument, "the zstd frame is not complete");
+      }
+    }
+  } catch (...) {
+    return W_FAILURE(std::errc::not_enough_memory, "could not allocate the zstd output");
+  }
+}
+
+#endif  // WOLF_SYSTEM_ZSTD
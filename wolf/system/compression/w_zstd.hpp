@@ -0,0 +1,161 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_ZSTD
+
+#include "wolf.hpp"
+#include "w_compressor.hpp"
+
+#include <cstddef>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace wolf::system::compression {
+
+/*
+ * compress and decompress zstd frames with contexts which are created once
+ * and reused for every frame. the frames carry their content size, so
+ * decompression allocates the output once. an optional dictionary, which
+ * may be trained from sample messages, primes the compression of small
+ * messages, the same dictionary must be used for decompression. it
+ * satisfies w_stream_compressor.
+ * an instance must not be used by several threads at the same time.
+ */
+class w_zstd {
+ public:
+  /*
+   * create the contexts of codec
+   * @param p_level, the level of compression, from negative fast levels up
+   * to 22, zero for the default level of zstd
+   * @param p_dictionary, an optional dictionary, it will be copied
+   * @returns the codec
+   */
+  W_API static boost::leaf::result<w_zstd> make(
+      _In_ int p_level = 0, _In_ gsl::span<const std::byte> p_dictionary = {}) noexcept;
+
+  /*
+   * train a dictionary from sample messages which look like the ones that
+   * will be compressed
+   * @param p_samples, the samples, a few thousands of them work best
+   * @param p_capacity, the maximum size of dictionary, ~100 KB is typical
+   * @returns the dictionary
+   */
+  W_API static boost::leaf::result<std::vector<std::byte>> train_dictionary(
+      _In_ gsl::span<const std::vector<std::byte>> p_samples,
+      _In_ size_t p_capacity = 100 * 1024) noexcept;
+
+  // destructor
+  W_API virtual ~w_zstd() noexcept { _release(); }
+
+  // move constructor.
+  W_API w_zstd(w_zstd &&p_other) noexcept { _move(std::forward<w_zstd &&>(p_other)); }
+  // move assignment operator.
+  W_API w_zstd &operator=(w_zstd &&p_other) noexcept {
+    _move(std::forward<w_zstd &&>(p_other));
+    return *this;
+  }
+
+  /*
+   * get the maximum size of a frame which contains p_src_size bytes
+   * @param p_src_size, the input size
+   * @returns the size of bound
+   */
+  W_API size_t get_compress_bound(_In_ size_t p_src_size) const noexcept;
+
+  /*
+   * compress a whole frame into the destination
+   * @param p_src, the input source
+   * @param p_dst, the destination, at least get_compress_bound bytes
+   * @returns the size of frame
+   */
+  W_API boost::leaf::result<size_t> compress(_In_ gsl::span<const std::byte> p_src,
+                                             _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * compress a whole frame
+   * @param p_src, the input source
+   * @returns the vector of frame
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> compress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * compress the next chunk of a frame
+   * @param p_src, the chunk
+   * @param p_dst, the destination, any size
+   * @returns the progress, call it again with the rest of chunk if it was
+   * not consumed
+   */
+  W_API boost::leaf::result<w_compress_progress> compress_update(
+      _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * flush the buffered data and end the frame, call it until done is true
+   * @param p_dst, the destination, any size
+   * @returns the progress
+   */
+  W_API boost::leaf::result<w_compress_progress> compress_end(
+      _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * read the content size from the header of a frame
+   * @param p_src, the frame
+   * @returns the content size, zero if the frame does not carry it
+   */
+  W_API static boost::leaf::result<size_t> get_content_size(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+  /*
+   * decompress the next chunk of a frame, call it until done is true
+   * @param p_src, the next bytes of frame
+   * @param p_dst, the destination, any size
+   * @returns the progress
+   */
+  W_API boost::leaf::result<w_compress_progress> decompress_update(
+      _In_ gsl::span<const std::byte> p_src, _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress a whole frame into the destination
+   * @param p_src, the frame
+   * @param p_dst, the destination, at least the content size of frame
+   * @returns number of decompressed bytes
+   */
+  W_API boost::leaf::result<size_t> decompress(_In_ gsl::span<const std::byte> p_src,
+                                               _Inout_ gsl::span<std::byte> p_dst) noexcept;
+
+  /*
+   * decompress a whole frame, the output will be allocated once if the
+   * frame carries its content size
+   * @param p_src, the frame
+   * @returns the vector of decompressed stream
+   */
+  W_API boost::leaf::result<std::vector<std::byte>> decompress(
+      _In_ gsl::span<const std::byte> p_src) noexcept;
+
+ private:
+  // default constructor
+  w_zstd() noexcept = default;
+  // copy constructor.
+  w_zstd(const w_zstd &) = delete;
+  // copy assignment operator.
+  w_zstd &operator=(const w_zstd &) = delete;
+
+  W_API void _move(w_zstd &&p_other) noexcept;
+  W_API void _release() noexcept;
+
+  ZSTD_CCtx_s *_cctx = nullptr;
+  ZSTD_DCtx_s *_dctx = nullptr;
+  ZSTD_CDict_s *_cdict = nullptr;
+  ZSTD_DDict_s *_ddict = nullptr;
+};
+}  // namespace wolf::system::compression
+
+#endif  // WOLF_SYSTEM_ZSTD
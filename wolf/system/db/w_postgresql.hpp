@@ -4,13 +4,38 @@
 
 #include <libpq-fe.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <list>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <wolf.hpp>
 
 namespace wolf::system::db {
 
+/**
+ * @brief statistics of a connection's prepared statement cache.
+ */
+struct w_pgdb_statement_cache_stats {
+  std::size_t hits = 0;        //< executions of an already prepared statement.
+  std::size_t misses = 0;      //< executions which prepared their statement.
+  std::size_t evictions = 0;   //< statements deallocated by the capacity.
+  std::size_t reprepares = 0;  //< statements dropped behind the cache, like
+                               //< by `DISCARD ALL`, and prepared again.
+  std::size_t size = 0;        //< count of prepared statements.
+};
+
 namespace internal {
 
 /**
@@ -39,6 +64,7 @@ using c_type_raii = std::unique_ptr<T, c_type_deleter<T, DeleterFunc>>;
 using dbconn = c_type_raii<PGconn, PQfinish>;
 using dbresult = c_type_raii<PGresult, PQclear>;
 using dbcancel = c_type_raii<PGcancel, PQfreeCancel>;
+using dbbuffer = c_type_raii<char, PQfreemem>;
 
 /**
  * @brief check whether the given connection pointer is in error state.
@@ -121,10 +147,666 @@ inline auto from_string(std::string* p_ptr, const char* p_str)
   return {};
 }
 
+// the view is valid as long as the result which owns the record.
+inline auto from_string(std::string_view* p_ptr, const char* p_str)
+    -> boost::leaf::result<void> {
+  *p_ptr = std::string_view(p_str);
+  return {};
+}
+
+template <typename T>
+  requires std::is_floating_point_v<T>
+inline auto to_string(T p_value) -> std::string {
+  // shortest representation which reads back to the same value.
+  char buffer[32] = {0};
+  auto [endptr, errcode] = std::to_chars(buffer, buffer + sizeof(buffer), p_value);
+  return std::string(buffer, endptr);
+}
+
+template <typename T>
+  requires std::is_floating_point_v<T>
+inline auto from_string(T* p_ptr, const char* p_str)
+    -> boost::leaf::result<void> {
+  auto [errptr, errcode] =
+      std::from_chars(p_str, p_str + strlen(p_str), *p_ptr);
+  if (errcode != std::errc()) {
+    return W_FAILURE(errcode,
+                     "could not convert given string to given floating type.");
+  }
+
+  return {};
+}
+
+inline auto from_string(bool* p_ptr, const char* p_str)
+    -> boost::leaf::result<void> {
+  if (std::strcmp(p_str, "t") == 0 || std::strcmp(p_str, "true") == 0) {
+    *p_ptr = true;
+  } else if (std::strcmp(p_str, "f") == 0 || std::strcmp(p_str, "false") == 0) {
+    *p_ptr = false;
+  } else {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not convert given string to bool.");
+  }
+
+  return {};
+}
+
+/// binary format
+
+/**
+ * @brief oids of builtin types, as listed in server's `pg_type.dat`.
+ */
+namespace oid {
+constexpr Oid boolean = 16;
+constexpr Oid bytea = 17;
+constexpr Oid name = 19;
+constexpr Oid int8 = 20;
+constexpr Oid int2 = 21;
+constexpr Oid int4 = 23;
+constexpr Oid text = 25;
+constexpr Oid json = 114;
+constexpr Oid float4 = 700;
+constexpr Oid float8 = 701;
+constexpr Oid timestamp = 1114;
+constexpr Oid bpchar = 1042;
+constexpr Oid varchar = 1043;
+constexpr Oid timestamptz = 1184;
+
+/**
+ * @brief whether the binary format of the type is its raw text.
+ */
+constexpr auto is_text(Oid p_type) noexcept -> bool {
+  return p_type == text || p_type == varchar || p_type == bpchar ||
+         p_type == name || p_type == json;
+}
+}  // namespace oid
+
+// postgres counts timestamps in microseconds from 2000-01-01 00:00:00 utc.
+constexpr auto pg_epoch = std::chrono::sys_days{std::chrono::year{2000} /
+                                                std::chrono::January / 1};
+
+using pg_time_point = std::chrono::system_clock::time_point;
+
+template <typename T>
+struct is_optional : std::false_type {};
+
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_optional_v = is_optional<std::remove_cvref_t<T>>::value;
+
+/**
+ * @brief convert between host and network (big-endian) byte order.
+ */
+template <typename T>
+  requires std::is_integral_v<T>
+constexpr auto network_order(T p_value) noexcept -> T {
+  if constexpr (sizeof(T) == 1 || std::endian::native == std::endian::big) {
+    return p_value;
+  } else {
+    auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(p_value);
+    std::reverse(bytes.begin(), bytes.end());
+    return std::bit_cast<T>(bytes);
+  }
+}
+
+/**
+ * @brief read a big-endian integer from a binary field.
+ */
+template <typename T>
+  requires std::is_integral_v<T>
+inline auto read_network(const char* p_data) noexcept -> T {
+  T value;
+  std::memcpy(&value, p_data, sizeof(T));
+  return network_order(value);
+}
+
+/**
+ * @brief a parameter in binary format.
+ *
+ * fixed size values are encoded into the inline storage, strings and byte
+ * arrays point to the caller's memory which outlives the send call.
+ */
+struct binary_param {
+  Oid type = 0;
+  const char* data = nullptr;  //< nullptr means sql null.
+  int length = 0;
+  alignas(8) char storage[8] = {0};
+
+  template <typename T>
+    requires std::is_integral_v<T>
+  void store(Oid p_type, T p_value) noexcept {
+    const auto value = network_order(p_value);
+    std::memcpy(storage, &value, sizeof(T));
+    type = p_type;
+    data = storage;
+    length = static_cast<int>(sizeof(T));
+  }
+
+  void store_bytes(Oid p_type, const void* p_data, std::size_t p_size) noexcept {
+    type = p_type;
+    // a non-null pointer, so an empty value isn't sent as sql null.
+    data = p_size == 0 ? storage : static_cast<const char*>(p_data);
+    length = static_cast<int>(p_size);
+  }
+};
+
+template <typename T>
+  requires std::is_integral_v<T>
+inline void to_binary(binary_param& p_param, T p_value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    p_param.store(oid::boolean, static_cast<std::uint8_t>(p_value ? 1 : 0));
+  } else if constexpr (std::is_signed_v<T> && sizeof(T) <= 2) {
+    p_param.store(oid::int2, static_cast<std::int16_t>(p_value));
+  } else if constexpr (sizeof(T) <= 2 ||
+                       (std::is_signed_v<T> && sizeof(T) == 4)) {
+    p_param.store(oid::int4, static_cast<std::int32_t>(p_value));
+  } else if constexpr (sizeof(T) <= 4 || std::is_signed_v<T>) {
+    p_param.store(oid::int8, static_cast<std::int64_t>(p_value));
+  } else {
+    static_assert(sizeof(T) == 0,
+                  "unsigned 64-bit integers don't fit in any postgres integer "
+                  "type, convert it to a signed one.");
+  }
+}
+
+template <typename T>
+  requires std::is_floating_point_v<T>
+inline void to_binary(binary_param& p_param, T p_value) {
+  if constexpr (sizeof(T) == 4) {
+    p_param.store(oid::float4, std::bit_cast<std::uint32_t>(p_value));
+  } else {
+    p_param.store(oid::float8,
+                  std::bit_cast<std::uint64_t>(static_cast<double>(p_value)));
+  }
+}
+
+inline void to_binary(binary_param& p_param, std::string_view p_value) {
+  p_param.store_bytes(oid::text, p_value.data(), p_value.size());
+}
+
+inline void to_binary(binary_param& p_param, const std::string& p_value) {
+  p_param.store_bytes(oid::text, p_value.data(), p_value.size());
+}
+
+inline void to_binary(binary_param& p_param, const char* const p_value) {
+  to_binary(p_param, std::string_view(p_value));
+}
+
+inline void to_binary(binary_param& p_param,
+                      std::span<const std::byte> p_value) {
+  p_param.store_bytes(oid::bytea, p_value.data(), p_value.size());
+}
+
+inline void to_binary(binary_param& p_param,
+                      const std::vector<std::byte>& p_value) {
+  to_binary(p_param, std::span<const std::byte>(p_value));
+}
+
+template <typename Duration>
+inline void to_binary(
+    binary_param& p_param,
+    std::chrono::time_point<std::chrono::system_clock, Duration> p_value) {
+  const auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(p_value - pg_epoch);
+  p_param.store(oid::timestamptz, static_cast<std::int64_t>(micros.count()));
+}
+
+template <typename T>
+inline void to_binary(binary_param& p_param, const std::optional<T>& p_value) {
+  if (p_value) {
+    to_binary(p_param, *p_value);
+  } else {
+    // keep the type, so the server doesn't have to infer it.
+    to_binary(p_param, T{});
+    p_param.data = nullptr;
+    p_param.length = 0;
+  }
+}
+
+/**
+ * @brief read an integer column of any width into an integral type.
+ */
+template <typename T>
+  requires std::is_integral_v<T>
+inline auto from_binary(T* p_ptr, const char* p_data, int p_length,
+                        Oid p_type) -> boost::leaf::result<void> {
+  if constexpr (std::is_same_v<T, bool>) {
+    if (p_type != oid::boolean || p_length != 1) {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "could not read binary field of type {} as bool.",
+                       p_type);
+    }
+    *p_ptr = *p_data != 0;
+    return {};
+  } else {
+    std::int64_t value = 0;
+    if (p_type == oid::int8 && p_length == 8) {
+      value = read_network<std::int64_t>(p_data);
+    } else if (p_type == oid::int4 && p_length == 4) {
+      value = read_network<std::int32_t>(p_data);
+    } else if (p_type == oid::int2 && p_length == 2) {
+      value = read_network<std::int16_t>(p_data);
+    } else {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "could not read binary field of type {} as integer.",
+                       p_type);
+    }
+
+    if (!std::in_range<T>(value)) {
+      return W_FAILURE(std::errc::result_out_of_range,
+                       "binary field value {} doesn't fit in given integral type.",
+                       value);
+    }
+    *p_ptr = static_cast<T>(value);
+    return {};
+  }
+}
+
+template <typename T>
+  requires std::is_floating_point_v<T>
+inline auto from_binary(T* p_ptr, const char* p_data, int p_length,
+                        Oid p_type) -> boost::leaf::result<void> {
+  if (p_type == oid::float8 && p_length == 8 && sizeof(T) >= 8) {
+    *p_ptr = static_cast<T>(
+        std::bit_cast<double>(read_network<std::uint64_t>(p_data)));
+  } else if (p_type == oid::float4 && p_length == 4) {
+    *p_ptr = static_cast<T>(
+        std::bit_cast<float>(read_network<std::uint32_t>(p_data)));
+  } else {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not read binary field of type {} as given floating type.",
+                     p_type);
+  }
+
+  return {};
+}
+
+// the binary format of text types is the raw string.
+inline auto from_binary(std::string* p_ptr, const char* p_data, int p_length,
+                        Oid p_type) -> boost::leaf::result<void> {
+  if (!oid::is_text(p_type)) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not read binary field of type {} as string.",
+                     p_type);
+  }
+  p_ptr->assign(p_data, static_cast<std::size_t>(p_length));
+  return {};
+}
+
+// the view is valid as long as the result which owns the record.
+inline auto from_binary(std::string_view* p_ptr, const char* p_data,
+                        int p_length, Oid p_type) -> boost::leaf::result<void> {
+  if (!oid::is_text(p_type)) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not read binary field of type {} as string.",
+                     p_type);
+  }
+  *p_ptr = std::string_view(p_data, static_cast<std::size_t>(p_length));
+  return {};
+}
+
+// the span is valid as long as the result which owns the record.
+inline auto from_binary(std::span<const std::byte>* p_ptr, const char* p_data,
+                        int p_length, Oid p_type) -> boost::leaf::result<void> {
+  if (p_type != oid::bytea) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not read binary field of type {} as bytes.",
+                     p_type);
+  }
+  *p_ptr = std::span<const std::byte>(reinterpret_cast<const std::byte*>(p_data),
+                                      static_cast<std::size_t>(p_length));
+  return {};
+}
+
+inline auto from_binary(std::vector<std::byte>* p_ptr, const char* p_data,
+                        int p_length, Oid p_type) -> boost::leaf::result<void> {
+  if (p_type != oid::bytea) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not read binary field of type {} as bytes.",
+                     p_type);
+  }
+  const auto* bytes = reinterpret_cast<const std::byte*>(p_data);
+  p_ptr->assign(bytes, bytes + p_length);
+  return {};
+}
+
+inline auto from_binary(pg_time_point* p_ptr, const char* p_data, int p_length,
+                        Oid p_type) -> boost::leaf::result<void> {
+  if ((p_type != oid::timestamptz && p_type != oid::timestamp) ||
+      p_length != 8) {
+    return W_FAILURE(std::errc::invalid_argument,
+                     "could not read binary field of type {} as time point.",
+                     p_type);
+  }
+
+  const auto micros =
+      std::chrono::microseconds(read_network<std::int64_t>(p_data));
+  *p_ptr = std::chrono::time_point_cast<pg_time_point::duration>(pg_epoch + micros);
+  return {};
+}
+
+/// copy format
+
+/**
+ * @brief header of the binary copy format, the signature, flags and the
+ * length of the header extension.
+ */
+constexpr char copy_binary_header[] = "PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0";
+constexpr std::size_t copy_binary_header_size = sizeof(copy_binary_header) - 1;
+
+template <typename T>
+inline void append_network(std::string& p_out, T p_value) {
+  const auto value = network_order(p_value);
+  p_out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief append a field in the text copy format, where tabs, newlines and
+ * backslashes are escaped and `\N` is sql null.
+ */
+inline void append_copy_text(std::string& p_out, std::string_view p_value) {
+  for (const auto c : p_value) {
+    switch (c) {
+      case '\\': p_out.append("\\\\"); break;
+      case '\t': p_out.append("\\t"); break;
+      case '\n': p_out.append("\\n"); break;
+      case '\r': p_out.append("\\r"); break;
+      default: p_out.push_back(c); break;
+    }
+  }
+}
+
+inline void append_copy_text(std::string& p_out, const std::string& p_value) {
+  append_copy_text(p_out, std::string_view(p_value));
+}
+
+inline void append_copy_text(std::string& p_out, const char* const p_value) {
+  append_copy_text(p_out, std::string_view(p_value));
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+inline void append_copy_text(std::string& p_out, T p_value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    p_out.push_back(p_value ? 't' : 'f');
+  } else {
+    // numbers don't need escaping.
+    char buffer[32] = {0};
+    auto [endptr, errcode] =
+        std::to_chars(buffer, buffer + sizeof(buffer), p_value);
+    p_out.append(buffer, endptr);
+  }
+}
+
+// bytea in hex format, its backslash is escaped for the copy format.
+inline void append_copy_text(std::string& p_out,
+                             std::span<const std::byte> p_value) {
+  constexpr char digits[] = "0123456789abcdef";
+  p_out.append("\\\\x");
+  for (const auto byte : p_value) {
+    const auto value = std::to_integer<unsigned>(byte);
+    p_out.push_back(digits[value >> 4]);
+    p_out.push_back(digits[value & 0xf]);
+  }
+}
+
+inline void append_copy_text(std::string& p_out,
+                             const std::vector<std::byte>& p_value) {
+  append_copy_text(p_out, std::span<const std::byte>(p_value));
+}
+
+template <typename T>
+inline void append_copy_text(std::string& p_out,
+                             const std::optional<T>& p_value) {
+  if (p_value) {
+    append_copy_text(p_out, *p_value);
+  } else {
+    p_out.append("\\N");
+  }
+}
+
+/**
+ * @brief append a field in the binary copy format, its length and then its
+ * value in the same binary format as parameters.
+ */
+template <typename T>
+inline void append_copy_binary(std::string& p_out, const T& p_value) {
+  binary_param param;
+  to_binary(param, p_value);
+
+  if (!param.data) {
+    append_network(p_out, std::int32_t{-1});
+    return;
+  }
+
+  append_network(p_out, static_cast<std::int32_t>(param.length));
+  p_out.append(param.data, static_cast<std::size_t>(param.length));
+}
+
+/**
+ * @brief unescape a text copy field in place.
+ * @return one past the last unescaped character.
+ */
+inline auto unescape_copy_text(char* p_begin, char* p_end) -> char* {
+  const auto is_octal = [](char c) { return c >= '0' && c <= '7'; };
+  const auto hex_value = [](char c) -> int {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  };
+
+  auto* out = p_begin;
+  for (auto* in = p_begin; in < p_end; ++in) {
+    if (*in != '\\' || in + 1 == p_end) {
+      *out++ = *in;
+      continue;
+    }
+
+    const auto c = *++in;
+    switch (c) {
+      case 'b': *out++ = '\b'; break;
+      case 'f': *out++ = '\f'; break;
+      case 'n': *out++ = '\n'; break;
+      case 'r': *out++ = '\r'; break;
+      case 't': *out++ = '\t'; break;
+      case 'v': *out++ = '\v'; break;
+      case 'x': {
+        // one or two hex digits.
+        auto value = 0;
+        auto digits = 0;
+        while (digits < 2 && in + 1 < p_end && hex_value(in[1]) >= 0) {
+          value = value * 16 + hex_value(*++in);
+          ++digits;
+        }
+        *out++ = digits == 0 ? 'x' : static_cast<char>(value);
+        break;
+      }
+      default:
+        if (is_octal(c)) {
+          // one to three octal digits.
+          auto value = c - '0';
+          for (auto digits = 1; digits < 3 && in + 1 < p_end && is_octal(in[1]);
+               ++digits) {
+            value = value * 8 + (*++in - '0');
+          }
+          *out++ = static_cast<char>(value);
+        } else {
+          *out++ = c;
+        }
+        break;
+    }
+  }
+
+  return out;
+}
+
+/**
+ * @brief oid of a binary copy field, which isn't sent by the server, guessed
+ * from the type it's read into and its length.
+ */
+template <typename T>
+constexpr auto copy_binary_type(int p_length) noexcept -> Oid {
+  if constexpr (std::is_same_v<T, bool>) {
+    return oid::boolean;
+  } else if constexpr (std::is_integral_v<T>) {
+    return p_length == 2 ? oid::int2 : p_length == 4 ? oid::int4 : oid::int8;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return p_length == 4 ? oid::float4 : oid::float8;
+  } else if constexpr (std::is_same_v<T, pg_time_point>) {
+    return oid::timestamptz;
+  } else if constexpr (std::is_same_v<T, std::span<const std::byte>> ||
+                       std::is_same_v<T, std::vector<std::byte>>) {
+    return oid::bytea;
+  } else {
+    return oid::text;
+  }
+}
+
+/**
+ * @brief least recently used names of prepared statements keyed by their sql
+ * text and parameter types.
+ *
+ * it only does the bookkeeping, the connection prepares and deallocates.
+ */
+class statement_cache {
+ public:
+  explicit statement_cache(std::size_t p_capacity) noexcept
+      : _capacity(p_capacity) {}
+
+  /**
+   * @brief make the key of a statement, binary parameters are prepared with
+   * their types, so the types are part of the key.
+   */
+  static auto make_key(const char* p_sqlstr, int p_count, const Oid* p_types)
+      -> std::string {
+    auto key = std::string(p_sqlstr);
+    if (p_types) {
+      key.push_back('\0');
+      key.append(reinterpret_cast<const char*>(p_types),
+                 sizeof(Oid) * static_cast<std::size_t>(p_count));
+    }
+    return key;
+  }
+
+  /**
+   * @brief find the name of a prepared statement and mark it as recently used.
+   * @return name, or nullptr if the statement isn't prepared.
+   */
+  auto find(const std::string& p_key) -> const std::string* {
+    auto it = _index.find(p_key);
+    if (it == _index.end()) {
+      return nullptr;
+    }
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    ++_stats.hits;
+    return &it->second->name;
+  }
+
+  /**
+   * @brief keep a newly prepared statement.
+   * @return name of the statement.
+   */
+  auto insert(std::string p_key, std::string p_name) -> const std::string* {
+    ++_stats.misses;
+    _entries.push_front(entry{std::move(p_key), std::move(p_name)});
+    _index.emplace(_entries.front().key, _entries.begin());
+    return &_entries.front().name;
+  }
+
+  /**
+   * @brief forget a statement which doesn't exist on the server anymore.
+   */
+  void erase(const std::string& p_key) {
+    auto it = _index.find(p_key);
+    if (it == _index.end()) {
+      return;
+    }
+
+    _entries.erase(it->second);
+    _index.erase(it);
+    ++_stats.reprepares;
+  }
+
+  /**
+   * @brief remove the least recently used statements above the capacity.
+   * @return names of the removed statements, to deallocate on the server.
+   */
+  auto shrink() -> std::vector<std::string> {
+    auto evicted = std::vector<std::string>();
+    while (_entries.size() > _capacity) {
+      _index.erase(_entries.back().key);
+      evicted.push_back(std::move(_entries.back().name));
+      _entries.pop_back();
+      ++_stats.evictions;
+    }
+    return evicted;
+  }
+
+  /**
+   * @brief forget all statements, a new server session doesn't have them.
+   * @param p_backend_pid process id of the server session.
+   */
+  void clear(int p_backend_pid) noexcept {
+    _index.clear();
+    _entries.clear();
+    _backend_pid = p_backend_pid;
+  }
+
+  /**
+   * @brief generate a unique name for the next statement of the connection.
+   */
+  auto next_name() -> std::string {
+    return "wolf_stmt_" + std::to_string(_next_id++);
+  }
+
+  auto capacity() const noexcept -> std::size_t { return _capacity; }
+  void set_capacity(std::size_t p_capacity) noexcept { _capacity = p_capacity; }
+
+  auto backend_pid() const noexcept -> int { return _backend_pid; }
+
+  auto stats() const noexcept -> w_pgdb_statement_cache_stats {
+    auto stats = _stats;
+    stats.size = _entries.size();
+    return stats;
+  }
+
+ private:
+  struct entry {
+    std::string key;
+    std::string name;
+  };
+
+  std::size_t _capacity = 0;
+  std::list<entry> _entries;  //< the most recently used one is at the front.
+  std::unordered_map<std::string, std::list<entry>::iterator> _index;
+  std::size_t _next_id = 0;
+  int _backend_pid = 0;
+  w_pgdb_statement_cache_stats _stats;
+};
+
+/**
+ * @brief whether the result failed because the prepared statement is missing.
+ */
+inline auto is_missing_statement(const dbresult& p_res) noexcept -> bool {
+  if (!p_res || PQresultStatus(p_res.get()) != PGRES_FATAL_ERROR) {
+    return false;
+  }
+
+  // invalid_sql_statement_name
+  const auto* sqlstate = PQresultErrorField(p_res.get(), PG_DIAG_SQLSTATE);
+  return sqlstate && std::strcmp(sqlstate, "26000") == 0;
+}
+
 }  // namespace internal
 
 // forward declares mostly for friend statements.
+class w_pgdb_async_result;
 class w_pgdb_conection;
+class w_pgdb_copy_writer;
 class w_pgdb_execresult;
 class w_pgdb_queryresult;
 
@@ -132,6 +814,7 @@ class w_pgdb_queryresult;
  * @brief single convertible record/row.
  */
 class w_pgdb_record {
+  friend w_pgdb_async_result;
   friend w_pgdb_queryresult;
 
  public:
@@ -144,6 +827,27 @@ class w_pgdb_record {
                       static_cast<int>(p_field_index));
   }
 
+  /**
+   * @brief raw bytes at given field index, mostly for binary format results.
+   * @return bytes which are valid as long as the result of this record.
+   */
+  auto bytes_at(std::size_t p_field_index) const noexcept
+      -> std::span<const std::byte> {
+    const auto row = static_cast<int>(_record_index);
+    const auto field = static_cast<int>(p_field_index);
+    return {reinterpret_cast<const std::byte*>(
+                PQgetvalue(_res_ptr.get(), row, field)),
+            static_cast<std::size_t>(PQgetlength(_res_ptr.get(), row, field))};
+  }
+
+  /**
+   * @brief whether the field at given index is sql null.
+   */
+  auto is_null(std::size_t p_field_index) const noexcept -> bool {
+    return PQgetisnull(_res_ptr.get(), static_cast<int>(_record_index),
+                       static_cast<int>(p_field_index)) == 1;
+  }
+
   /**
    * @brief count of fields.
    */
@@ -153,6 +857,10 @@ class w_pgdb_record {
 
   /**
    * @brief convert fields into given types and store into pointed objects.
+   *
+   * text format fields are parsed, binary format fields are decoded straight
+   * into the native types. a `std::optional` is reset on sql null.
+   *
    * @param ptrs pointers to objects to read.
    */
   template <typename... Ts>
@@ -187,15 +895,48 @@ class w_pgdb_record {
   template <typename T>
   auto scan_field_into(std::size_t p_field_index, T* p_ptr)
       -> boost::leaf::result<void> {
-    auto str_value = PQgetvalue(_res_ptr.get(), _record_index, p_field_index);
-    if (!str_value) {
-      return W_FAILURE(std::errc::invalid_argument,
-                       "field could not be retrieved.");
-    }
+    if constexpr (internal::is_optional_v<T>) {
+      if (is_null(p_field_index)) {
+        p_ptr->reset();
+        return {};
+      }
 
-    BOOST_LEAF_CHECK(internal::from_string(p_ptr, str_value));
+      typename T::value_type value{};
+      BOOST_LEAF_CHECK(scan_field_into(p_field_index, &value));
+      *p_ptr = std::move(value);
 
-    return {};
+      return {};
+    } else {
+      const auto row = static_cast<int>(_record_index);
+      const auto field = static_cast<int>(p_field_index);
+
+      auto str_value = PQgetvalue(_res_ptr.get(), row, field);
+      if (!str_value) {
+        return W_FAILURE(std::errc::invalid_argument,
+                         "field could not be retrieved.");
+      }
+
+      if (PQfformat(_res_ptr.get(), field) == 1) {
+        if (PQgetisnull(_res_ptr.get(), row, field) == 1) {
+          return W_FAILURE(std::errc::invalid_argument,
+                           "field is null, scan it into a std::optional.");
+        }
+
+        return internal::from_binary(p_ptr, str_value,
+                                     PQgetlength(_res_ptr.get(), row, field),
+                                     PQftype(_res_ptr.get(), field));
+      }
+
+      if constexpr (requires { internal::from_string(p_ptr, str_value); }) {
+        BOOST_LEAF_CHECK(internal::from_string(p_ptr, str_value));
+      } else {
+        return W_FAILURE(std::errc::invalid_argument,
+                         "given type can only be scanned from binary format "
+                         "fields, use query_binary.");
+      }
+
+      return {};
+    }
   }
 
   w_pgdb_record(const internal::dbresult& p_res, std::size_t p_index) noexcept
@@ -341,79 +1082,409 @@ class w_pgdb_queryresult {
       return W_FAILURE(PQstatus(_conn_ptr.get()), std::string(errbuf));
     }
 
-    return {};
+    return {};
+  }
+
+  /**
+   * @brief consume the remaining of the result,
+   *        so new command/queries on the connection can be made.
+   */
+  void done() {
+    while (_res_ptr) {
+      _res_ptr.reset(PQgetResult(_conn_ptr.get()));
+    }
+  }
+
+ private:
+  explicit w_pgdb_queryresult(internal::dbconn& p_conn,
+                              internal::dbresult&& p_result)
+      : _conn_ptr(p_conn), _res_ptr(std::move(p_result)) {}
+
+  auto raw() noexcept -> internal::dbresult& { return _res_ptr; }
+  auto raw() const noexcept -> const internal::dbresult& { return _res_ptr; }
+
+  internal::dbconn& _conn_ptr;
+  internal::dbresult _res_ptr{nullptr};
+  std::size_t _row_index = 0;  //< count of so far read rows.
+};
+
+/**
+ * @brief sql execution result from sql command that doesn't yield back values.
+ */
+class w_pgdb_execresult {
+  friend w_pgdb_conection;
+  friend w_pgdb_copy_writer;
+
+ public:
+  ~w_pgdb_execresult() { done(); }
+
+  // move-only
+  w_pgdb_execresult(const w_pgdb_execresult&) = delete;
+  w_pgdb_execresult(w_pgdb_execresult&& p_other) noexcept
+      : _conn_ptr(p_other._conn_ptr), _res_ptr(p_other._res_ptr.release()) {}
+
+  w_pgdb_execresult& operator=(const w_pgdb_execresult&) = delete;
+  w_pgdb_execresult& operator=(w_pgdb_execresult&& p_other) noexcept {
+    std::swap(_conn_ptr, p_other._conn_ptr);
+    std::swap(_res_ptr, p_other._res_ptr);
+    return *this;
+  };
+
+  // since two internal::dbresult can't exist at the same time,
+  // create w_pgdb_queryresult and dispose *this.
+  auto as_query() && -> w_pgdb_queryresult {
+    return w_pgdb_queryresult(_conn_ptr, std::move(_res_ptr));
+  }
+
+  /**
+   * @brief consume the remaining of the result,
+   *        so new command/queries on the connection can be made.
+   */
+  void done() {
+    while (_res_ptr) {
+      _res_ptr.reset(PQgetResult(_conn_ptr.get()));
+    }
+  }
+
+ private:
+  explicit w_pgdb_execresult(internal::dbconn& p_conn,
+                             internal::dbresult&& p_res)
+      : _conn_ptr(p_conn), _res_ptr(std::move(p_res)) {}
+
+  auto raw() noexcept -> internal::dbresult& { return _res_ptr; }
+  auto raw() const noexcept -> const internal::dbresult& { return _res_ptr; }
+
+  internal::dbconn& _conn_ptr;
+  internal::dbresult _res_ptr{nullptr};
+};
+
+/**
+ * @brief writer of a `COPY ... FROM STDIN` command, rows are buffered and sent
+ * in batches.
+ *
+ * the format is the one of the command, like `WITH (FORMAT binary)`. binary
+ * fields must have the exact type of their columns, like `std::int32_t` for
+ * an `INT4` column, since the server doesn't convert them.
+ *
+ * @note the connection can't run other commands until the writer finishes,
+ * a writer which is destroyed before `finish` aborts the copy.
+ * @note create one by calling `w_pgdb_conection::copy_from`.
+ */
+class w_pgdb_copy_writer {
+  friend w_pgdb_conection;
+
+ public:
+  ~w_pgdb_copy_writer() { abort(); }
+
+  // move-only
+  w_pgdb_copy_writer(const w_pgdb_copy_writer&) = delete;
+  w_pgdb_copy_writer(w_pgdb_copy_writer&& p_other) noexcept
+      : _conn_ptr(p_other._conn_ptr),
+        _buffer(std::move(p_other._buffer)),
+        _batch_size(p_other._batch_size),
+        _rows(p_other._rows),
+        _binary(p_other._binary),
+        _active(std::exchange(p_other._active, false)) {}
+
+  w_pgdb_copy_writer& operator=(const w_pgdb_copy_writer&) = delete;
+  w_pgdb_copy_writer& operator=(w_pgdb_copy_writer&&) = delete;
+
+  /**
+   * @brief write a row, each param is a field in order of the command's
+   * columns.
+   *
+   * @note see `w_pgdb_conection::execute_binary` for the supported types of
+   * binary format. text format supports the same types except time points,
+   * and `std::optional` of them for sql null.
+   *
+   * @param p_fields fields of the row.
+   * @return error or nothing.
+   */
+  template <typename... Args>
+  auto write_row(const Args&... p_fields) -> boost::leaf::result<void> {
+    if (!_active) {
+      return W_FAILURE(std::errc::operation_canceled,
+                       "copy has been finished already.");
+    }
+
+    if (_binary) {
+      internal::append_network(_buffer,
+                               static_cast<std::int16_t>(sizeof...(Args)));
+      (internal::append_copy_binary(_buffer, p_fields), ...);
+    } else {
+      auto first = true;
+      const auto append = [&](const auto& p_field) {
+        if (!std::exchange(first, false)) {
+          _buffer.push_back('\t');
+        }
+        internal::append_copy_text(_buffer, p_field);
+      };
+      (append(p_fields), ...);
+      _buffer.push_back('\n');
+    }
+    ++_rows;
+
+    if (_buffer.size() >= _batch_size) {
+      return flush();
+    }
+    return {};
+  }
+
+  /**
+   * @brief write data which is already in the format of the copy, like lines
+   * of a csv file.
+   * @param p_data data of one or more rows.
+   * @return error or nothing.
+   */
+  auto write(std::string_view p_data) -> boost::leaf::result<void> {
+    if (!_active) {
+      return W_FAILURE(std::errc::operation_canceled,
+                       "copy has been finished already.");
+    }
+
+    _buffer.append(p_data);
+    if (_buffer.size() >= _batch_size) {
+      return flush();
+    }
+    return {};
+  }
+
+  /**
+   * @brief send the remaining rows and end the copy.
+   * @return count of rows copied by the server or error.
+   */
+  auto finish() -> boost::leaf::result<std::size_t> {
+    if (!_active) {
+      return W_FAILURE(std::errc::operation_canceled,
+                       "copy has been finished already.");
+    }
+
+    if (_binary) {
+      internal::append_network(_buffer, std::int16_t{-1});
+    }
+    BOOST_LEAF_CHECK(flush());
+
+    _active = false;
+    if (PQputCopyEnd(_conn_ptr.get(), nullptr) != 1) {
+      return W_FAILURE(PQstatus(_conn_ptr.get()),
+                       PQerrorMessage(_conn_ptr.get()));
+    }
+
+    auto res = w_pgdb_execresult(
+        _conn_ptr, internal::dbresult(PQgetResult(_conn_ptr.get())));
+    BOOST_LEAF_CHECK(internal::dbresult_error_check(res.raw()));
+
+    const auto* tuples = PQcmdTuples(res.raw().get());
+    auto rows = _rows;
+    std::from_chars(tuples, tuples + std::strlen(tuples), rows);
+
+    return rows;
   }
 
   /**
-   * @brief consume the remaining of the result,
-   *        so new command/queries on the connection can be made.
+   * @brief count of rows written so far.
    */
-  void done() {
-    while (_res_ptr) {
-      _res_ptr.reset(PQgetResult(_conn_ptr.get()));
+  auto rows_written() const noexcept -> std::size_t { return _rows; }
+
+ private:
+  w_pgdb_copy_writer(internal::dbconn& p_conn, bool p_binary,
+                     std::size_t p_batch_size)
+      : _conn_ptr(p_conn), _batch_size(p_batch_size), _binary(p_binary) {
+    _buffer.reserve(p_batch_size);
+    if (_binary) {
+      _buffer.append(internal::copy_binary_header,
+                     internal::copy_binary_header_size);
     }
   }
 
- private:
-  explicit w_pgdb_queryresult(internal::dbconn& p_conn,
-                              internal::dbresult&& p_result)
-      : _conn_ptr(p_conn), _res_ptr(std::move(p_result)) {}
+  auto flush() -> boost::leaf::result<void> {
+    if (_buffer.empty()) {
+      return {};
+    }
 
-  auto raw() noexcept -> internal::dbresult& { return _res_ptr; }
-  auto raw() const noexcept -> const internal::dbresult& { return _res_ptr; }
+    // the connection is blocking, so libpq sends the data before it returns.
+    if (PQputCopyData(_conn_ptr.get(), _buffer.data(),
+                      static_cast<int>(_buffer.size())) != 1) {
+      return W_FAILURE(PQstatus(_conn_ptr.get()),
+                       PQerrorMessage(_conn_ptr.get()));
+    }
+    _buffer.clear();
+
+    return {};
+  }
+
+  void abort() {
+    if (!std::exchange(_active, false)) {
+      return;
+    }
+
+    // the server rolls back the rows which are sent so far.
+    PQputCopyEnd(_conn_ptr.get(), "copy is aborted by the client.");
+    w_pgdb_execresult(_conn_ptr,
+                      internal::dbresult(PQgetResult(_conn_ptr.get())));
+  }
 
   internal::dbconn& _conn_ptr;
-  internal::dbresult _res_ptr{nullptr};
-  std::size_t _row_index = 0;  //< count of so far read rows.
+  std::string _buffer;
+  std::size_t _batch_size = 0;
+  std::size_t _rows = 0;  //< count of so far written rows.
+  bool _binary = false;
+  bool _active = true;
 };
 
 /**
- * @brief sql execution result from sql command that doesn't yield back values.
+ * @brief a row of a `COPY ... TO STDOUT` command.
+ *
+ * it's only valid in the handler which it's passed to.
  */
-class w_pgdb_execresult {
+class w_pgdb_copy_row {
   friend w_pgdb_conection;
 
  public:
-  ~w_pgdb_execresult() { done(); }
-
-  // move-only
-  w_pgdb_execresult(const w_pgdb_execresult&) = delete;
-  w_pgdb_execresult(w_pgdb_execresult&& p_other) noexcept
-      : _conn_ptr(p_other._conn_ptr), _res_ptr(p_other._res_ptr.release()) {}
-
-  w_pgdb_execresult& operator=(const w_pgdb_execresult&) = delete;
-  w_pgdb_execresult& operator=(w_pgdb_execresult&& p_other) noexcept {
-    std::swap(_conn_ptr, p_other._conn_ptr);
-    std::swap(_res_ptr, p_other._res_ptr);
-    return *this;
-  };
+  /**
+   * @brief data of the row, a line without its newline in text format, or a
+   * tuple in binary format.
+   */
+  auto raw() const noexcept -> std::string_view { return _data; }
 
-  // since two internal::dbresult can't exist at the same time,
-  // create w_pgdb_queryresult and dispose *this.
-  auto as_query() && -> w_pgdb_queryresult {
-    return w_pgdb_queryresult(_conn_ptr, std::move(_res_ptr));
-  }
+  /**
+   * @brief whether the copy is in binary format.
+   */
+  auto is_binary() const noexcept -> bool { return _binary; }
 
   /**
-   * @brief consume the remaining of the result,
-   *        so new command/queries on the connection can be made.
+   * @brief scan the fields of the row in order.
+   *
+   * @note binary fields don't have their type, it's guessed by the length of
+   * the field, like `INT4` for a 4-byte field scanned into an integral type.
+   * @note views into text fields are valid as long as the row.
+   *
+   * @param p_ptrs pointers to variables for each field.
+   * @return error or nothing.
    */
-  void done() {
-    while (_res_ptr) {
-      _res_ptr.reset(PQgetResult(_conn_ptr.get()));
+  template <typename... Ts>
+  auto scan(Ts*... p_ptrs) -> boost::leaf::result<void> {
+    if (_binary) {
+      return scan_binary(p_ptrs...);
     }
+    return scan_text(p_ptrs...);
   }
 
  private:
-  explicit w_pgdb_execresult(internal::dbconn& p_conn,
-                             internal::dbresult&& p_res)
-      : _conn_ptr(p_conn), _res_ptr(std::move(p_res)) {}
+  w_pgdb_copy_row(std::string_view p_data, bool p_binary,
+                  std::string& p_scratch) noexcept
+      : _data(p_data), _binary(p_binary), _scratch(p_scratch) {}
 
-  auto raw() noexcept -> internal::dbresult& { return _res_ptr; }
-  auto raw() const noexcept -> const internal::dbresult& { return _res_ptr; }
+  template <typename... Ts>
+  auto scan_binary(Ts*... p_ptrs) -> boost::leaf::result<void> {
+    constexpr auto field_count = static_cast<std::int16_t>(sizeof...(Ts));
 
-  internal::dbconn& _conn_ptr;
-  internal::dbresult _res_ptr{nullptr};
+    auto* pos = _data.data();
+    const auto* end = pos + _data.size();
+
+    if (end - pos < 2 ||
+        internal::read_network<std::int16_t>(pos) < field_count) {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "row has fewer fields than given pointers.");
+    }
+    pos += 2;
+
+    auto result = boost::leaf::result<void>();
+    const auto scan_one = [&](auto* p_ptr) {
+      if (!result) {
+        return;
+      }
+      if (end - pos < 4) {
+        result = W_FAILURE(std::errc::invalid_argument, "row is truncated.");
+        return;
+      }
+      const auto length = internal::read_network<std::int32_t>(pos);
+      pos += 4;
+      if (end - pos < std::max(length, 0)) {
+        result = W_FAILURE(std::errc::invalid_argument, "row is truncated.");
+        return;
+      }
+      result = scan_field(pos, length, p_ptr);
+      pos += std::max(length, 0);
+    };
+    (scan_one(p_ptrs), ...);
+
+    return result;
+  }
+
+  template <typename... Ts>
+  auto scan_text(Ts*... p_ptrs) -> boost::leaf::result<void> {
+    // unescaped in place, and each field is nul-terminated for the parsers.
+    _scratch.assign(_data);
+    _scratch.push_back('\t');
+
+    auto* pos = _scratch.data();
+    auto* end = pos + _scratch.size();
+
+    auto result = boost::leaf::result<void>();
+    const auto scan_one = [&](auto* p_ptr) {
+      if (!result) {
+        return;
+      }
+      if (pos == end) {
+        result = W_FAILURE(std::errc::invalid_argument,
+                           "row has fewer fields than given pointers.");
+        return;
+      }
+
+      auto* field_end = std::find(pos, end, '\t');
+      const auto is_null = std::string_view(pos, field_end) == "\\N";
+      auto* value_end = internal::unescape_copy_text(pos, field_end);
+      *value_end = '\0';
+
+      result = scan_field(pos, is_null ? -1 : static_cast<int>(value_end - pos),
+                          p_ptr);
+      pos = field_end + 1;
+    };
+    (scan_one(p_ptrs), ...);
+
+    return result;
+  }
+
+  // a negative length means sql null.
+  template <typename T>
+  auto scan_field(const char* p_data, int p_length, T* p_ptr)
+      -> boost::leaf::result<void> {
+    if constexpr (internal::is_optional_v<T>) {
+      if (p_length < 0) {
+        p_ptr->reset();
+        return {};
+      }
+
+      typename T::value_type value{};
+      BOOST_LEAF_CHECK(scan_field(p_data, p_length, &value));
+      *p_ptr = std::move(value);
+
+      return {};
+    } else {
+      if (p_length < 0) {
+        return W_FAILURE(std::errc::invalid_argument,
+                         "field is null, scan it into a std::optional.");
+      }
+
+      if (_binary) {
+        return internal::from_binary(
+            p_ptr, p_data, p_length, internal::copy_binary_type<T>(p_length));
+      }
+
+      if constexpr (requires { internal::from_string(p_ptr, p_data); }) {
+        return internal::from_string(p_ptr, p_data);
+      } else {
+        return W_FAILURE(std::errc::invalid_argument,
+                         "given type can only be scanned from binary format "
+                         "fields, use a binary copy.");
+      }
+    }
+  }
+
+  std::string_view _data;
+  bool _binary = false;
+  std::string& _scratch;
 };
 
 /**
@@ -425,11 +1496,13 @@ class w_pgdb_conection {
  public:
   w_pgdb_conection(const w_pgdb_conection&) = delete;
   w_pgdb_conection(w_pgdb_conection&& other) noexcept
-      : _conn_ptr(other._conn_ptr.release()) {}
+      : _conn_ptr(other._conn_ptr.release()),
+        _statements(std::move(other._statements)) {}
 
   w_pgdb_conection& operator=(const w_pgdb_conection&) = delete;
   w_pgdb_conection& operator=(w_pgdb_conection&& other) noexcept {
     std::swap(_conn_ptr, other._conn_ptr);
+    std::swap(_statements, other._statements);
     return *this;
   };
 
@@ -486,6 +1559,9 @@ class w_pgdb_conection {
    * @note params will be converted to string by an internal converter for
    * simple types. if your type isn't supported, convert to string then pass it
    * to this method.
+   * @note a command with params is prepared on first use and executed by name
+   * afterwards, see `set_statement_cache_capacity`. a command without params
+   * is sent as a simple query, so it may contain several commands.
    *
    * @param p_sqlstr sql command.
    * @param p_params sql command's parameters. (if there are any)
@@ -503,38 +1579,75 @@ class w_pgdb_conection {
                          PQerrorMessage(_conn_ptr.get()));
       }
     } else {
-      // currently raw data isn't supported, and it's only text/string.
+      // text parameters, use execute_binary for binary ones.
       // IIFE for compile-time stack array allocation and loop-free
       // initialization.
-      int res = [&](std::same_as<std::string> auto&&... p_str_params) {
+      return [&](std::same_as<std::string> auto&&... p_str_params) {
         const char* string_array[arg_count] = {(p_str_params.c_str())...};
 
         int length_array[arg_count] = {
             static_cast<int>(p_str_params.size())...};
 
-        return PQsendQueryParams(
-            _conn_ptr.get(), p_sqlstr, arg_count,
+        return execute_params(
+            p_sqlstr, arg_count,
             nullptr,  // infer types, they're not determined.
             string_array, length_array,
-            nullptr,  // only nul-terminated c strings (text), binary isn't
-                      // supported.
+            nullptr,  // only nul-terminated c strings (text).
             0);
       }(internal::to_string(std::forward<Args>(p_params))...);
-
-      if (res <= 0) {
-        return W_FAILURE(PQstatus(_conn_ptr.get()),
-                         PQerrorMessage(_conn_ptr.get()));
-      }
     }
 
-    // to make sure the result will be terminated/disposed correctly on error,
-    // otherwise the connection will still hold the result and next execute
-    // won't work.
-    auto dbres = w_pgdb_execresult(
-        _conn_ptr, internal::dbresult(PQgetResult(_conn_ptr.get())));
-    BOOST_LEAF_CHECK(internal::dbresult_error_check(dbres.raw()));
+    return get_execresult();
+  }
 
-    return dbres;
+  /**
+   * @brief execute the given sql command with given sql parameters in binary
+   * format.
+   *
+   * parameters are sent with their type oids in binary format, and the result
+   * is requested in binary format, so `w_pgdb_record::scan` decodes fields
+   * straight into native types instead of formatting and parsing text.
+   *
+   * @note supported types are bool, integers, floating points, strings,
+   * bytea as `std::span<const std::byte>` or `std::vector<std::byte>`,
+   * `std::chrono::system_clock` time points as timestamptz, and `std::optional`
+   * of them for sql null.
+   * @note the command is prepared on first use and executed by name
+   * afterwards, see `set_statement_cache_capacity`.
+   *
+   * @param p_sqlstr sql command, only a single command is allowed.
+   * @param p_params sql command's parameters. (if there are any)
+   * @return command result or error.
+   */
+  template <typename... Args>
+  auto execute_binary(const char* p_sqlstr, Args&&... p_params)
+      -> boost::leaf::result<w_pgdb_execresult> {
+    constexpr std::size_t arg_count = sizeof...(Args);
+    constexpr int binary_format = 1;
+
+    if constexpr (arg_count == 0) {
+      return execute_params(p_sqlstr, 0, nullptr, nullptr, nullptr, nullptr,
+                            binary_format);
+    } else {
+      // encoded in place, the values may point into the inline storages.
+      internal::binary_param params[arg_count];
+      std::size_t index = 0;
+      (internal::to_binary(params[index++], p_params), ...);
+
+      Oid type_array[arg_count];
+      const char* value_array[arg_count];
+      int length_array[arg_count];
+      int format_array[arg_count];
+      for (std::size_t i = 0; i < arg_count; ++i) {
+        type_array[i] = params[i].type;
+        value_array[i] = params[i].data;
+        length_array[i] = params[i].length;
+        format_array[i] = binary_format;
+      }
+
+      return execute_params(p_sqlstr, arg_count, type_array, value_array,
+                            length_array, format_array, binary_format);
+    }
   }
 
   /**
@@ -555,6 +1668,24 @@ class w_pgdb_conection {
     return std::move(res).as_query();
   }
 
+  /**
+   * @brief execute the given sql query with given sql parameters in binary
+   * format.
+   *
+   * @note see `execute_binary` for the supported types.
+   *
+   * @param p_sqlstr sql query.
+   * @param p_params sql query's parameters. (if there are any)
+   * @return query result or error.
+   */
+  template <typename... Args>
+  auto query_binary(const char* p_sqlstr, Args&&... p_args)
+      -> boost::leaf::result<w_pgdb_queryresult> {
+    BOOST_LEAF_AUTO(res,
+                    execute_binary(p_sqlstr, std::forward<Args>(p_args)...));
+    return std::move(res).as_query();
+  }
+
   /**
    * @brief execute the given sql query with given sql parameters in streaming
    * mode.
@@ -583,14 +1714,284 @@ class w_pgdb_conection {
     return std::move(res).as_query();
   }
 
+  /**
+   * @brief start a `COPY ... FROM STDIN` command, its rows are sent by the
+   * returned writer.
+   *
+   * for example: COPY metrics (id, value) FROM STDIN WITH (FORMAT binary)
+   *
+   * @param p_sqlstr copy command, in text, csv or binary format.
+   * @param p_batch_size bytes which are buffered before they are sent.
+   * @return copy writer or error.
+   */
+  auto copy_from(const char* p_sqlstr, std::size_t p_batch_size = 64 * 1024)
+      -> boost::leaf::result<w_pgdb_copy_writer> {
+    auto dbres = internal::dbresult(PQexec(_conn_ptr.get(), p_sqlstr));
+    BOOST_LEAF_CHECK(internal::dbresult_error_check(dbres));
+
+    if (PQresultStatus(dbres.get()) != PGRES_COPY_IN) {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "command is not a COPY FROM STDIN.");
+    }
+
+    return w_pgdb_copy_writer(_conn_ptr, PQbinaryTuples(dbres.get()) == 1,
+                              p_batch_size);
+  }
+
+  /**
+   * @brief run a `COPY ... TO STDOUT` command and process each row by given
+   * handler as it arrives.
+   *
+   * rows are streamed like `stream_query`, but without a result per row.
+   * after the handler returns error, the remaining rows are consumed and
+   * dropped, so the connection stays usable.
+   *
+   * for example: COPY (SELECT id, value FROM metrics) TO STDOUT
+   *
+   * @param p_sqlstr copy command, in text, csv or binary format.
+   * @param p_handler callable to pass each `w_pgdb_copy_row` to and returns a
+   * boost leaf result.
+   * @return count of processed rows.
+   */
+  template <typename F>
+  auto copy_to(const char* p_sqlstr, F&& p_handler)
+      -> boost::leaf::result<std::size_t> {
+    auto dbres = internal::dbresult(PQexec(_conn_ptr.get(), p_sqlstr));
+    BOOST_LEAF_CHECK(internal::dbresult_error_check(dbres));
+
+    if (PQresultStatus(dbres.get()) != PGRES_COPY_OUT) {
+      return W_FAILURE(std::errc::invalid_argument,
+                       "command is not a COPY TO STDOUT.");
+    }
+
+    const auto binary = PQbinaryTuples(dbres.get()) == 1;
+    auto skip_header = binary;
+    auto scratch = std::string();
+    auto handled = boost::leaf::result<void>();
+    std::size_t count = 0;
+
+    for (;;) {
+      char* buffer = nullptr;
+      const auto length = PQgetCopyData(_conn_ptr.get(), &buffer, 0);
+      if (length < 0) {
+        break;
+      }
+
+      auto data = internal::dbbuffer(buffer);
+      auto row = std::string_view(buffer, static_cast<std::size_t>(length));
+
+      if (skip_header) {
+        // the header may come alone or with the first row.
+        skip_header = false;
+        if (row.size() >= internal::copy_binary_header_size) {
+          const auto extension = internal::read_network<std::int32_t>(
+              row.data() + internal::copy_binary_header_size - 4);
+          row.remove_prefix(std::min(
+              row.size(), internal::copy_binary_header_size +
+                              static_cast<std::size_t>(std::max(extension, 0))));
+        }
+      }
+
+      if (!handled || row.empty()) {
+        continue;
+      }
+
+      if (binary) {
+        // the trailer.
+        if (row.size() == 2 && internal::read_network<std::int16_t>(row.data()) == -1) {
+          continue;
+        }
+      } else if (row.back() == '\n') {
+        row.remove_suffix(1);
+      }
+
+      handled = p_handler(w_pgdb_copy_row(row, binary, scratch));
+      count += handled ? 1 : 0;
+    }
+
+    auto res = w_pgdb_execresult(
+        _conn_ptr, internal::dbresult(PQgetResult(_conn_ptr.get())));
+    BOOST_LEAF_CHECK(internal::dbresult_error_check(res.raw()));
+    BOOST_LEAF_CHECK(handled);
+
+    return count;
+  }
+
+  /**
+   * @brief set the count of prepared statements which are kept per connection.
+   *
+   * the least recently used statements above the capacity are deallocated.
+   * set it to zero to send every command with its sql text, like behind a
+   * pooler which doesn't keep server sessions.
+   *
+   * @param p_capacity count of statements, 64 by default.
+   */
+  void set_statement_cache_capacity(std::size_t p_capacity) {
+    _statements.set_capacity(p_capacity);
+    deallocate(_statements.shrink());
+  }
+
+  /**
+   * @brief statistics of the prepared statement cache.
+   */
+  auto statement_cache_stats() const noexcept -> w_pgdb_statement_cache_stats {
+    return _statements.stats();
+  }
+
+  /**
+   * @brief reset the connection to the server, like after a network failure.
+   *
+   * the prepared statements are gone with the old server session, they will be
+   * prepared again on their next use.
+   *
+   * @return error or nothing.
+   */
+  auto reset() -> boost::leaf::result<void> {
+    PQreset(_conn_ptr.get());
+    BOOST_LEAF_CHECK(internal::dbconn_error_check(_conn_ptr));
+
+    _statements.clear(PQbackendPID(_conn_ptr.get()));
+    return {};
+  }
+
+  /**
+   * @brief whether the connection to the server is still good, without a
+   * round trip, so a dropped connection is only noticed after a failed command.
+   */
+  auto is_connected() const noexcept -> bool {
+    return PQstatus(_conn_ptr.get()) == CONNECTION_OK;
+  }
+
+  /**
+   * @brief whether the connection is inside a transaction block, including a
+   * failed one which waits for a rollback.
+   */
+  auto in_transaction() const noexcept -> bool {
+    const auto status = PQtransactionStatus(_conn_ptr.get());
+    return status == PQTRANS_INTRANS || status == PQTRANS_INERROR;
+  }
+
  private:
+  static constexpr std::size_t default_statement_cache_capacity = 64;
+
   explicit w_pgdb_conection(internal::dbconn&& p_conn)
-      : _conn_ptr(std::move(p_conn)) {}
+      : _conn_ptr(std::move(p_conn)) {
+    _statements.clear(PQbackendPID(_conn_ptr.get()));
+  }
+
+  /**
+   * @brief send a single command with params, through a prepared statement
+   * when the cache is enabled, and get its first result.
+   */
+  auto execute_params(const char* p_sqlstr, int p_count, const Oid* p_types,
+                      const char* const* p_values, const int* p_lengths,
+                      const int* p_formats, int p_result_format)
+      -> boost::leaf::result<w_pgdb_execresult> {
+    if (_statements.capacity() == 0) {
+      if (PQsendQueryParams(_conn_ptr.get(), p_sqlstr, p_count, p_types,
+                            p_values, p_lengths, p_formats,
+                            p_result_format) <= 0) {
+        return W_FAILURE(PQstatus(_conn_ptr.get()),
+                         PQerrorMessage(_conn_ptr.get()));
+      }
+      return get_execresult();
+    }
+
+    // a reset connection talks to a new server session without the statements.
+    const auto backend_pid = PQbackendPID(_conn_ptr.get());
+    if (backend_pid != _statements.backend_pid()) {
+      _statements.clear(backend_pid);
+    }
+
+    auto key = internal::statement_cache::make_key(p_sqlstr, p_count, p_types);
+
+    for (auto retried = false;; retried = true) {
+      const auto* name = _statements.find(key);
+      if (!name) {
+        BOOST_LEAF_AUTO(prepared, prepare(key, p_sqlstr, p_count, p_types));
+        name = prepared;
+      }
+
+      if (PQsendQueryPrepared(_conn_ptr.get(), name->c_str(), p_count,
+                              p_values, p_lengths, p_formats,
+                              p_result_format) <= 0) {
+        return W_FAILURE(PQstatus(_conn_ptr.get()),
+                         PQerrorMessage(_conn_ptr.get()));
+      }
+
+      auto dbres = internal::dbresult(PQgetResult(_conn_ptr.get()));
+
+      // dropped behind the cache, like by `DEALLOCATE ALL` or `DISCARD ALL`.
+      if (!retried && internal::is_missing_statement(dbres)) {
+        _statements.erase(key);
+
+        // the status is only known once the command is done.
+        auto rest = internal::dbresult(PQgetResult(_conn_ptr.get()));
+        while (rest) {
+          rest.reset(PQgetResult(_conn_ptr.get()));
+        }
+
+        // inside a transaction block the failure has aborted it, and a retry
+        // would only fail again, so the original error is returned.
+        if (PQtransactionStatus(_conn_ptr.get()) == PQTRANS_IDLE) {
+          continue;
+        }
+      }
+
+      auto res = w_pgdb_execresult(_conn_ptr, std::move(dbres));
+      BOOST_LEAF_CHECK(internal::dbresult_error_check(res.raw()));
+
+      return res;
+    }
+  }
+
+  /**
+   * @brief prepare a statement and keep it in the cache.
+   * @return name of the statement.
+   */
+  auto prepare(const std::string& p_key, const char* p_sqlstr, int p_count,
+               const Oid* p_types) -> boost::leaf::result<const std::string*> {
+    auto name = _statements.next_name();
+
+    auto dbres = internal::dbresult(
+        PQprepare(_conn_ptr.get(), name.c_str(), p_sqlstr, p_count, p_types));
+    BOOST_LEAF_CHECK(internal::dbresult_error_check(dbres));
+
+    const auto* inserted = _statements.insert(p_key, std::move(name));
+    deallocate(_statements.shrink());
+
+    return inserted;
+  }
+
+  /**
+   * @brief deallocate evicted statements on the server.
+   *
+   * failures are ignored, like in an aborted transaction, the statement stays
+   * on the server until the session ends.
+   */
+  void deallocate(const std::vector<std::string>& p_names) {
+    for (const auto& name : p_names) {
+      const auto sqlstr = "DEALLOCATE " + name;
+      internal::dbresult(PQexec(_conn_ptr.get(), sqlstr.c_str()));
+    }
+  }
+
+  auto get_execresult() -> boost::leaf::result<w_pgdb_execresult> {
+    // to make sure the result will be terminated/disposed correctly on error,
+    // otherwise the connection will still hold the result and next execute
+    // won't work.
+    auto dbres = w_pgdb_execresult(
+        _conn_ptr, internal::dbresult(PQgetResult(_conn_ptr.get())));
+    BOOST_LEAF_CHECK(internal::dbresult_error_check(dbres.raw()));
+
+    return dbres;
+  }
 
   auto raw() noexcept -> internal::dbconn& { return _conn_ptr; }
   auto raw() const noexcept -> const internal::dbconn& { return _conn_ptr; }
 
   internal::dbconn _conn_ptr;
+  internal::statement_cache _statements{default_statement_cache_capacity};
 };
 
 }  // namespace wolf::system::db
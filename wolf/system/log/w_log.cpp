@@ -4,6 +4,7 @@
 
 using w_log = wolf::system::log::w_log;
 using w_log_config = wolf::system::log::w_log_config;
+using w_log_deferred = wolf::system::log::w_log_deferred;
 
 w_log::w_log(_In_ w_log_config &&p_config) noexcept
     : _config(std::move(p_config)) {}
@@ -11,6 +12,8 @@ w_log::w_log(_In_ w_log_config &&p_config) noexcept
 w_log::~w_log() noexcept {
   try {
     flush();
+    // stop the background thread before the sinks
+    this->_deferred.reset();
   } catch (...) {
   }
 }
@@ -23,6 +26,7 @@ void w_log::_move(_Inout_ w_log &&p_other) noexcept {
   this->_config = std::move(p_other._config);
   this->_logger = std::move(p_other._logger);
   this->_async_file_logger = std::move(p_other._async_file_logger);
+  this->_deferred = std::move(p_other._deferred);
 }
 
 boost::leaf::result<int> w_log::init() {
@@ -69,7 +73,20 @@ boost::leaf::result<int> w_log::init() {
   const auto _filename = this->_config.path.filename().string();
   const auto _path = this->_config.path.string();
 
-  if (this->_config.type & w_log_sink::ASYNC_FILE) {
+  if (this->_config.deferred) {
+    // the background thread of deferred logs writes to the file sinks
+    // directly, instead of queueing the formatted logs for another thread
+    if (this->_config.type & w_log_sink::ASYNC_FILE) {
+      _sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+          _path, this->_config.max_file_size_in_mb, this->_config.max_files,
+          this->_config.rotate_on_open));
+    } else if (this->_config.type & w_log_sink::ASYNC_DAILY_FILE) {
+      _sinks.push_back(std::make_shared<spdlog::sinks::daily_file_sink_mt>(
+          _path, this->_config.hour, this->_config.minute,
+          false,  // truncate
+          gsl::narrow_cast<uint16_t>(this->_config.max_files)));
+    }
+  } else if (this->_config.type & w_log_sink::ASYNC_FILE) {
     // async file sink
     this->_async_file_logger =
         spdlog::create_async_nb<spdlog::sinks::rotating_file_sink_mt>(
@@ -108,6 +125,11 @@ boost::leaf::result<int> w_log::init() {
   this->_logger->set_level(_level);
   this->_logger->flush_on(_flush_level);
 
+  if (this->_config.deferred) {
+    this->_deferred = std::make_unique<w_log_deferred>(
+        this->_logger, this->_config.deferred_ring_size, this->_config.deferred_poll_interval);
+  }
+
   return 0;
 }
 
@@ -117,6 +139,12 @@ void w_log::write(_In_ const std::string_view &p_fmt) {
 
 void w_log::write(_In_ const spdlog::level::level_enum &p_level,
                   _In_ const std::string_view &p_fmt) {
+  if (this->_deferred != nullptr) {
+    if (this->_logger->should_log(p_level)) {
+      this->_deferred->push(p_level, "{}", p_fmt);
+    }
+    return;
+  }
   if (this->_logger != nullptr) {
     this->_logger->log(p_level, p_fmt);
   }
@@ -126,6 +154,9 @@ void w_log::write(_In_ const spdlog::level::level_enum &p_level,
 }
 
 boost::leaf::result<int> w_log::flush() {
+  if (this->_deferred != nullptr) {
+    this->_deferred->flush();
+  }
   if (this->_logger != nullptr) {
     this->_logger->flush();
   }
@@ -137,4 +168,8 @@ boost::leaf::result<int> w_log::flush() {
 
 w_log_config w_log::get_config() const { return this->_config; }
 
+uint64_t w_log::get_dropped() const {
+  return this->_deferred != nullptr ? this->_deferred->get_dropped() : 0;
+}
+
 #endif
\ No newline at end of file
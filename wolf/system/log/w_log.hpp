@@ -17,6 +17,7 @@
 #include <wolf/wolf.hpp>
 
 #include "w_log_config.hpp"
+#include "w_log_deferred.hpp"
 
 #ifdef _MSC_VER
 #include <spdlog/sinks/msvc_sink.h>
@@ -54,13 +55,14 @@ class w_log {
 
   template <class... Args>
   W_API void write(_In_ const std::string_view p_fmt, _In_ Args &&...p_args) {
-    const auto _str = std::vformat(p_fmt, std::make_format_args(p_args...));
-    write(_str);
+    write(spdlog::level::level_enum::info, p_fmt, std::forward<Args>(p_args)...);
   }
 
   template <class... Args>
   W_API void write(_In_ const spdlog::level::level_enum &p_level,
                    _In_ const std::string_view p_fmt, _In_ Args &&...p_args) {
+    // the format string is not known at compile time and may not outlive the
+    // call, so it is formatted here and only the writing is deferred
     const auto _str = std::vformat(p_fmt, std::make_format_args(p_args...));
     write(p_level, _str);
   }
@@ -69,15 +71,26 @@ class w_log {
   template <class... Args>
   W_API void write(_In_ const fmt::format_string<Args...> p_fmt,
                    _In_ Args &&...p_args) {
-    const auto _str =
-        fmt::vformat(p_fmt, fmt::make_format_args(p_args...));
-    write(_str);
+    write(spdlog::level::level_enum::info, p_fmt, std::forward<Args>(p_args)...);
   }
 
   template <class... Args>
   W_API void write(_In_ const spdlog::level::level_enum &p_level,
                    _In_ const fmt::format_string<Args...> p_fmt,
                    _In_ Args &&...p_args) {
+    if (this->_deferred != nullptr) {
+      if (!this->_logger->should_log(p_level)) {
+        return;
+      }
+      if constexpr (w_log_deferred::is_deferrable<Args...>) {
+        this->_deferred->push(p_level, fmt::string_view(p_fmt), p_args...);
+      } else {
+        // e.g. std::filesystem::path or containers, they are formatted here
+        const auto _str = fmt::vformat(p_fmt, fmt::make_format_args(p_args...));
+        this->_deferred->push(p_level, "{}", std::string_view(_str));
+      }
+      return;
+    }
     const auto _str =
         fmt::vformat(p_fmt, fmt::make_format_args(p_args...));
     write(p_level, _str);
@@ -89,6 +102,10 @@ class w_log {
 
   W_API w_log_config get_config() const;
 
+  // returns the number of deferred logs which were dropped because the ring
+  // of their thread was full
+  W_API uint64_t get_dropped() const;
+
  private:
   // disable copy constructor
   w_log(const w_log &) = delete;
@@ -100,6 +117,7 @@ class w_log {
   w_log_config _config = {};
   std::shared_ptr<spdlog::logger> _logger = nullptr;
   std::shared_ptr<spdlog::logger> _async_file_logger = nullptr;
+  std::unique_ptr<w_log_deferred> _deferred = nullptr;
 };
 }  // namespace wolf::system::log
 
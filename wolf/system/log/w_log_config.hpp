@@ -9,6 +9,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <chrono>
 #include <filesystem>
 #include <wolf/wolf.hpp>
 
@@ -56,6 +57,15 @@ struct w_log_config {
   int hour = 0;
   // start creation time for daily log
   int minute = 0;
+  // format the logs on a background thread, producers only copy the format
+  // string pointer and the binary arguments into a lock-free ring of their
+  // thread, the format strings must be string literals
+  bool deferred = false;
+  // the size of ring of each producer thread in bytes, logs are dropped when
+  // it is full
+  size_t deferred_ring_size = 1024 * 1024;
+  // how long the background thread of deferred logs sleeps when it is idle
+  std::chrono::microseconds deferred_poll_interval = std::chrono::microseconds(500);
 };
 }  // namespace wolf::system::log
 
@@ -0,0 +1,204 @@
+#ifdef WOLF_SYSTEM_LOG
+
+#include "w_log_deferred.hpp"
+
+#include <spdlog/sinks/sink.h>
+
+#include <algorithm>
+
+using w_log_deferred = wolf::system::log::w_log_deferred;
+using w_log_record = wolf::system::log::w_log_record;
+using w_log_ring = wolf::system::log::w_log_ring;
+
+static std::atomic<uint64_t> s_next_id = 1;
+
+struct w_log_deferred::w_thread_rings {
+  struct w_entry {
+    uint64_t id;
+    std::shared_ptr<w_log_ring> ring;
+  };
+
+  ~w_thread_rings() noexcept {
+    for (auto &_entry : this->entries) {
+      _entry.ring->close();
+    }
+    w_log_deferred::s_cache = {0, nullptr};
+  }
+
+  std::vector<w_entry> entries;
+};
+
+w_log_deferred::w_log_deferred(_In_ std::shared_ptr<spdlog::logger> p_logger,
+                               _In_ size_t p_ring_size,
+                               _In_ std::chrono::microseconds p_poll_interval)
+    : _id(s_next_id.fetch_add(1, std::memory_order_relaxed)),
+      _ring_size(p_ring_size),
+      _poll_interval(p_poll_interval),
+      _logger(std::move(p_logger)) {
+  this->_thread = std::thread([this]() { _run(); });
+}
+
+w_log_deferred::~w_log_deferred() noexcept {
+  {
+    std::scoped_lock _lock(this->_mutex);
+    this->_stop = true;
+  }
+  this->_cv.notify_one();
+  if (this->_thread.joinable()) {
+    this->_thread.join();
+  }
+}
+
+w_log_ring *w_log_deferred::_register_thread() noexcept {
+  static thread_local w_thread_rings s_thread_rings;
+
+  try {
+    auto &_entries = s_thread_rings.entries;
+
+    // release the rings of loggers which were destroyed
+    std::erase_if(_entries, [](const w_thread_rings::w_entry &p_entry) {
+      return p_entry.ring.use_count() == 1;
+    });
+
+    auto _iter = std::find_if(
+        _entries.begin(), _entries.end(),
+        [this](const w_thread_rings::w_entry &p_entry) { return p_entry.id == this->_id; });
+    if (_iter == _entries.end()) {
+      auto _ring = std::make_shared<w_log_ring>(this->_ring_size);
+      {
+        std::scoped_lock _lock(this->_rings_mutex);
+        this->_rings.push_back(_ring);
+      }
+      _entries.push_back({this->_id, std::move(_ring)});
+      _iter = std::prev(_entries.end());
+    }
+
+    s_cache = {this->_id, _iter->ring.get()};
+    return s_cache.ring;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+size_t w_log_deferred::_drain(_Inout_ spdlog::memory_buf_t &p_buffer) {
+  {
+    std::scoped_lock _lock(this->_rings_mutex);
+    this->_snapshot.assign(this->_rings.begin(), this->_rings.end());
+  }
+
+  const auto &_sinks = this->_logger->sinks();
+  const auto _flush_level = this->_logger->flush_level();
+
+  size_t _count = 0;
+  for (const auto &_ring : this->_snapshot) {
+    _count += _ring->consume([&](const w_log_record &p_record, const std::byte *p_args) {
+      const auto _level = static_cast<spdlog::level::level_enum>(p_record.level);
+
+      p_buffer.clear();
+      try {
+        p_record.decode(spdlog::string_view_t(p_record.fmt, p_record.fmt_size), p_args,
+                        p_buffer);
+      } catch (const std::exception &p_ex) {
+        p_buffer.clear();
+        const auto _what = spdlog::string_view_t(p_ex.what());
+        p_buffer.append(_what.data(), _what.data() + _what.size());
+      }
+
+      auto _msg = spdlog::details::log_msg(
+          spdlog::log_clock::time_point(spdlog::log_clock::duration(p_record.time)),
+          spdlog::source_loc{}, this->_logger->name(), _level,
+          spdlog::string_view_t(p_buffer.data(), p_buffer.size()));
+      _msg.thread_id = _ring->get_thread_id();
+
+      for (const auto &_sink : _sinks) {
+        try {
+          if (_sink->should_log(_level)) {
+            _sink->log(_msg);
+            if (_level >= _flush_level && _level != spdlog::level::off) {
+              _sink->flush();
+            }
+          }
+        } catch (...) {
+        }
+      }
+    });
+  }
+  this->_snapshot.clear();
+
+  // release the rings of threads which exited
+  std::scoped_lock _lock(this->_rings_mutex);
+  std::erase_if(this->_rings, [this](const std::shared_ptr<w_log_ring> &p_ring) {
+    if (!p_ring->is_finished()) {
+      return false;
+    }
+    this->_finished_dropped += p_ring->get_dropped();
+    return true;
+  });
+
+  return _count;
+}
+
+void w_log_deferred::_run() {
+  spdlog::memory_buf_t _buffer;
+
+  for (;;) {
+    uint64_t _flush_requested = 0;
+    bool _stop = false;
+    {
+      std::scoped_lock _lock(this->_mutex);
+      _flush_requested = this->_flush_requested;
+      _stop = this->_stop;
+    }
+
+    size_t _count = 0;
+    try {
+      _count = _drain(_buffer);
+    } catch (...) {
+    }
+
+    if (_stop || _flush_requested != this->_flushed) {
+      for (const auto &_sink : this->_logger->sinks()) {
+        try {
+          _sink->flush();
+        } catch (...) {
+        }
+      }
+      {
+        std::scoped_lock _lock(this->_mutex);
+        this->_flushed = _flush_requested;
+      }
+      this->_flushed_cv.notify_all();
+    }
+    if (_stop) {
+      break;
+    }
+
+    if (_count == 0) {
+      std::unique_lock _lock(this->_mutex);
+      this->_cv.wait_for(_lock, this->_poll_interval, [&]() {
+        return this->_stop || this->_flush_requested != this->_flushed;
+      });
+    }
+  }
+}
+
+void w_log_deferred::flush() {
+  std::unique_lock _lock(this->_mutex);
+  if (this->_stop) {
+    return;
+  }
+  const auto _target = ++this->_flush_requested;
+  this->_cv.notify_one();
+  this->_flushed_cv.wait(_lock, [&]() { return this->_flushed >= _target; });
+}
+
+uint64_t w_log_deferred::get_dropped() const {
+  std::scoped_lock _lock(this->_rings_mutex);
+  auto _dropped = this->_finished_dropped;
+  for (const auto &_ring : this->_rings) {
+    _dropped += _ring->get_dropped();
+  }
+  return _dropped;
+}
+
+#endif  // WOLF_SYSTEM_LOG
@@ -0,0 +1,366 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_LOG
+
+#include <spdlog/details/os.h>
+#include <spdlog/spdlog.h>
+
+#include <DISABLE_ANALYSIS_BEGIN>
+#include <wolf/wolf.hpp>
+#include <DISABLE_ANALYSIS_END>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace wolf::system::log {
+
+/*
+ * the header of a record in w_log_ring, the serialized arguments follow it
+ */
+struct w_log_record {
+  using w_decode = void (*)(_In_ spdlog::string_view_t p_fmt, _In_ const std::byte *p_args,
+                            _Inout_ spdlog::memory_buf_t &p_out);
+
+  // formats the arguments, nullptr for the padding before the ring wraps
+  w_decode decode;
+  // the static format string
+  const char *fmt;
+  // the time of log in ticks of spdlog::log_clock
+  int64_t time;
+  // the size of record with its arguments, a multiple of 8
+  uint32_t size;
+  uint16_t fmt_size;
+  uint8_t level;
+  uint8_t reserved;
+};
+
+/*
+ * a bounded, lock-free, single-producer/single-consumer ring of variable
+ * sized records. the producer never blocks or allocates, a record which
+ * does not fit is dropped and counted.
+ */
+class w_log_ring {
+ public:
+  /*
+   * @param p_capacity, the capacity in bytes, it will be rounded up to the
+   * next power of two
+   */
+  explicit w_log_ring(_In_ size_t p_capacity)
+      : _capacity(std::bit_ceil(std::max<size_t>(p_capacity, 4096))),
+        _mask(_capacity - 1),
+        _data(std::make_unique<uint64_t[]>(_capacity / sizeof(uint64_t))),
+        _thread_id(spdlog::details::os::thread_id()) {}
+
+  w_log_ring(const w_log_ring &) = delete;
+  w_log_ring &operator=(const w_log_ring &) = delete;
+  w_log_ring(w_log_ring &&) = delete;
+  w_log_ring &operator=(w_log_ring &&) = delete;
+  ~w_log_ring() noexcept = default;
+
+  /*
+   * reserve a contiguous record, only call it from the producer
+   * @param p_size, the size of record, a multiple of 8
+   * @returns the record or nullptr if the ring is full
+   */
+  std::byte *try_reserve(_In_ size_t p_size) noexcept {
+    const auto _tail = this->_tail.load(std::memory_order_relaxed);
+    const auto _offset = _tail & this->_mask;
+    const auto _contiguous = this->_capacity - _offset;
+    const auto _wrap = _contiguous < p_size ? _contiguous : 0;
+
+    if (p_size > this->_capacity / 4) {
+      this->_dropped.store(this->_dropped.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+      return nullptr;
+    }
+    if (_tail + _wrap + p_size - this->_head_cache > this->_capacity) {
+      this->_head_cache = this->_head.load(std::memory_order_acquire);
+      if (_tail + _wrap + p_size - this->_head_cache > this->_capacity) {
+        this->_dropped.store(this->_dropped.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        return nullptr;
+      }
+    }
+
+    auto _base = reinterpret_cast<std::byte *>(this->_data.get());
+    if (_wrap != 0 && _wrap >= sizeof(w_log_record)) {
+      // mark the end of ring as padding, shorter ends are skipped implicitly
+      auto _padding = w_log_record{};
+      _padding.size = gsl::narrow_cast<uint32_t>(_wrap);
+      std::memcpy(_base + _offset, &_padding, sizeof(_padding));
+    }
+    this->_reserved = _wrap + p_size;
+    return _base + (_wrap != 0 ? 0 : _offset);
+  }
+
+  // publish the record of the last try_reserve, only call it from the producer
+  void commit() noexcept {
+    this->_tail.store(this->_tail.load(std::memory_order_relaxed) + this->_reserved,
+                      std::memory_order_release);
+  }
+
+  /*
+   * consume all published records, only call it from the consumer
+   * @param p_func, called for each record, the record is valid during the call
+   * @returns number of records
+   */
+  template <typename F>
+  size_t consume(_In_ F &&p_func) {
+    const auto _tail = this->_tail.load(std::memory_order_acquire);
+    auto _head = this->_head.load(std::memory_order_relaxed);
+    const auto _base = reinterpret_cast<const std::byte *>(this->_data.get());
+
+    size_t _count = 0;
+    while (_head != _tail) {
+      const auto _offset = _head & this->_mask;
+      if (this->_capacity - _offset < sizeof(w_log_record)) {
+        _head += this->_capacity - _offset;
+        continue;
+      }
+
+      auto _record = w_log_record{};
+      std::memcpy(&_record, _base + _offset, sizeof(_record));
+      if (_record.decode != nullptr) {
+        p_func(_record, _base + _offset + sizeof(w_log_record));
+        _count++;
+      }
+      _head += _record.size;
+    }
+    this->_head.store(_head, std::memory_order_release);
+    return _count;
+  }
+
+  // mark the ring as closed, its thread will not push anymore
+  void close() noexcept { this->_closed.store(true, std::memory_order_release); }
+
+  // returns true if the ring is closed and all of its records were consumed
+  bool is_finished() const noexcept {
+    return this->_closed.load(std::memory_order_acquire) &&
+           this->_head.load(std::memory_order_relaxed) ==
+               this->_tail.load(std::memory_order_acquire);
+  }
+
+  // returns the number of dropped records
+  uint64_t get_dropped() const noexcept {
+    return this->_dropped.load(std::memory_order_relaxed);
+  }
+
+  // returns the os thread id of producer
+  size_t get_thread_id() const noexcept { return this->_thread_id; }
+
+ private:
+  const size_t _capacity;
+  const size_t _mask;
+  std::unique_ptr<uint64_t[]> _data;
+  const size_t _thread_id;
+  std::atomic<bool> _closed = false;
+
+  // the producer side
+  alignas(64) std::atomic<uint64_t> _tail = 0;
+  uint64_t _head_cache = 0;
+  size_t _reserved = 0;
+  std::atomic<uint64_t> _dropped = 0;
+
+  // the consumer side
+  alignas(64) std::atomic<uint64_t> _head = 0;
+};
+
+/*
+ * a low latency front-end for the sinks of a spdlog logger. producers write
+ * a pointer to the static format string and the binary arguments into
+ * their own w_log_ring, a background thread formats the records and fans
+ * them out to the sinks. numbers, enums and other trivially copyable types
+ * are copied as they are, strings are copied into the record.
+ */
+class w_log_deferred {
+ public:
+  /*
+   * start the background thread
+   * @param p_logger, the logger whose sinks receive the records
+   * @param p_ring_size, the size of the ring of each producer thread in bytes
+   * @param p_poll_interval, how long the background thread sleeps when all
+   * rings are empty
+   */
+  W_API w_log_deferred(_In_ std::shared_ptr<spdlog::logger> p_logger,
+                       _In_ size_t p_ring_size,
+                       _In_ std::chrono::microseconds p_poll_interval);
+
+  // stop the background thread, all pushed records are written before
+  W_API ~w_log_deferred() noexcept;
+
+  w_log_deferred(const w_log_deferred &) = delete;
+  w_log_deferred &operator=(const w_log_deferred &) = delete;
+  w_log_deferred(w_log_deferred &&) = delete;
+  w_log_deferred &operator=(w_log_deferred &&) = delete;
+
+  template <typename T>
+  static constexpr bool s_is_string = std::is_convertible_v<const T &, spdlog::string_view_t>;
+
+  // whether the arguments can be copied into a record, the others must be
+  // formatted into a string first
+  template <class... Args>
+  static constexpr bool is_deferrable =
+      ((s_is_string<std::remove_cvref_t<Args>> ||
+        std::is_trivially_copyable_v<std::remove_cvref_t<Args>>) &&
+       ...);
+
+  /*
+   * push a record into the ring of the calling thread
+   * @param p_level, the level of log
+   * @param p_fmt, the format string, it must outlive the logger, e.g. a
+   * string literal
+   * @param p_args, the arguments
+   * @returns false if the record was dropped because the ring was full
+   */
+  template <class... Args>
+  bool push(_In_ spdlog::level::level_enum p_level, _In_ spdlog::string_view_t p_fmt,
+            _In_ const Args &...p_args) noexcept {
+    auto _ring = _get_ring();
+    if (_ring == nullptr) {
+      return false;
+    }
+
+    const auto _size = (sizeof(w_log_record) + (s_arg_size(p_args) + ... + 0) + 7) & ~size_t(7);
+    auto _ptr = _ring->try_reserve(_size);
+    if (_ptr == nullptr) {
+      return false;
+    }
+
+    auto _record = w_log_record{};
+    _record.decode = &s_decode<Args...>;
+    _record.fmt = p_fmt.data();
+    _record.fmt_size = gsl::narrow_cast<uint16_t>(std::min<size_t>(p_fmt.size(), UINT16_MAX));
+    _record.time = spdlog::log_clock::now().time_since_epoch().count();
+    _record.size = gsl::narrow_cast<uint32_t>(_size);
+    _record.level = gsl::narrow_cast<uint8_t>(p_level);
+    std::memcpy(_ptr, &_record, sizeof(_record));
+
+    _ptr += sizeof(w_log_record);
+    (s_write_arg(_ptr, p_args), ...);
+
+    _ring->commit();
+    return true;
+  }
+
+  // write all records which were pushed before the call and flush the sinks
+  W_API void flush();
+
+  // returns the number of records which were dropped because a ring was full
+  W_API uint64_t get_dropped() const;
+
+ private:
+  template <typename T>
+  static size_t s_arg_size(_In_ const T &p_arg) noexcept {
+    if constexpr (s_is_string<T>) {
+      return sizeof(uint32_t) + spdlog::string_view_t(p_arg).size();
+    } else {
+      static_assert(std::is_trivially_copyable_v<T>,
+                    "the arguments of deferred log must be strings or trivially copyable, "
+                    "format others into a string first");
+      return sizeof(T);
+    }
+  }
+
+  template <typename T>
+  static void s_write_arg(_Inout_ std::byte *&p_ptr, _In_ const T &p_arg) noexcept {
+    if constexpr (s_is_string<T>) {
+      const auto _str = spdlog::string_view_t(p_arg);
+      const auto _size = gsl::narrow_cast<uint32_t>(_str.size());
+      std::memcpy(p_ptr, &_size, sizeof(_size));
+      std::memcpy(p_ptr + sizeof(_size), _str.data(), _size);
+      p_ptr += sizeof(_size) + _size;
+    } else {
+      std::memcpy(p_ptr, &p_arg, sizeof(T));
+      p_ptr += sizeof(T);
+    }
+  }
+
+  template <typename T>
+  static auto s_read_arg(_Inout_ const std::byte *&p_ptr) noexcept {
+    if constexpr (s_is_string<T>) {
+      uint32_t _size = 0;
+      std::memcpy(&_size, p_ptr, sizeof(_size));
+      const auto _str =
+          spdlog::string_view_t(reinterpret_cast<const char *>(p_ptr + sizeof(_size)), _size);
+      p_ptr += sizeof(_size) + _size;
+      return _str;
+    } else {
+      std::array<std::byte, sizeof(T)> _bytes;
+      std::memcpy(_bytes.data(), p_ptr, sizeof(T));
+      p_ptr += sizeof(T);
+      return std::bit_cast<T>(_bytes);
+    }
+  }
+
+  template <class... Args>
+  static void s_decode(_In_ spdlog::string_view_t p_fmt, _In_ const std::byte *p_args,
+                       _Inout_ spdlog::memory_buf_t &p_out) {
+    // a braced initializer reads the arguments from left to right
+    auto _values = std::tuple<decltype(s_read_arg<Args>(p_args))...>{s_read_arg<Args>(p_args)...};
+    std::apply(
+        [&](auto &...p_values) {
+          spdlog::fmt_lib::vformat_to(std::back_inserter(p_out), p_fmt,
+                                      spdlog::fmt_lib::make_format_args(p_values...));
+        },
+        _values);
+  }
+
+  w_log_ring *_get_ring() noexcept {
+    if (s_cache.id == this->_id) {
+      return s_cache.ring;
+    }
+    return _register_thread();
+  }
+
+  W_API w_log_ring *_register_thread() noexcept;
+  void _run();
+  size_t _drain(_Inout_ spdlog::memory_buf_t &p_buffer);
+
+  // the rings of a thread, they are closed when the thread exits
+  struct w_thread_rings;
+
+  struct w_cache {
+    uint64_t id;
+    w_log_ring *ring;
+  };
+  // the ring of the last logger which was used by this thread
+  static inline thread_local w_cache s_cache = {0, nullptr};
+
+  const uint64_t _id;
+  const size_t _ring_size;
+  const std::chrono::microseconds _poll_interval;
+  std::shared_ptr<spdlog::logger> _logger;
+
+  mutable std::mutex _rings_mutex;
+  std::vector<std::shared_ptr<w_log_ring>> _rings;
+  uint64_t _finished_dropped = 0;
+  // the rings which the background thread is draining
+  std::vector<std::shared_ptr<w_log_ring>> _snapshot;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::condition_variable _flushed_cv;
+  uint64_t _flush_requested = 0;
+  uint64_t _flushed = 0;
+  bool _stop = false;
+
+  std::thread _thread;
+};
+}  // namespace wolf::system::log
+
+#endif  // WOLF_SYSTEM_LOG
@@ -0,0 +1,226 @@
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include "w_frame_codec.hpp"
+
+#include <cstring>
+#include <limits>
+
+using w_frame_codec = wolf::system::socket::w_frame_codec;
+using w_frame_prefix = wolf::system::socket::w_frame_prefix;
+using w_frame_reader = wolf::system::socket::w_frame_reader;
+using w_frame_writer = wolf::system::socket::w_frame_writer;
+using w_pooled_buffer = wolf::system::w_pooled_buffer;
+
+constexpr auto MAX_HEADER_SIZE = w_frame_codec::MAX_HEADER_SIZE;
+
+// returns the size of prefix, or zero if the prefix can not be encoded
+static size_t s_encode_header(_In_ w_frame_prefix p_prefix, _In_ size_t p_payload_size,
+                              _Inout_ std::array<uint8_t, MAX_HEADER_SIZE> &p_header) noexcept {
+  switch (p_prefix) {
+    default:
+      return 0;
+    case w_frame_prefix::fixed32: {
+      if (p_payload_size > std::numeric_limits<uint32_t>::max()) {
+        return 0;
+      }
+      const auto _size = gsl::narrow_cast<uint32_t>(p_payload_size);
+      p_header[0] = gsl::narrow_cast<uint8_t>(_size >> 24);
+      p_header[1] = gsl::narrow_cast<uint8_t>(_size >> 16);
+      p_header[2] = gsl::narrow_cast<uint8_t>(_size >> 8);
+      p_header[3] = gsl::narrow_cast<uint8_t>(_size);
+      return 4;
+    }
+    case w_frame_prefix::varint: {
+      size_t _index = 0;
+      auto _size = static_cast<uint64_t>(p_payload_size);
+      while (_size >= 0x80) {
+        gsl::at(p_header, _index++) = gsl::narrow_cast<uint8_t>(_size | 0x80);
+        _size >>= 7;
+      }
+      gsl::at(p_header, _index++) = gsl::narrow_cast<uint8_t>(_size);
+      return _index;
+    }
+  }
+}
+
+// returns the size of prefix, zero if the prefix is not complete yet or
+// -1 if the prefix is malformed
+static int s_decode_header(_In_ w_frame_prefix p_prefix, _In_ gsl::span<const uint8_t> p_data,
+                           _Out_ size_t &p_payload_size) noexcept {
+  p_payload_size = 0;
+
+  switch (p_prefix) {
+    default:
+      return -1;
+    case w_frame_prefix::fixed32: {
+      if (p_data.size() < 4) {
+        return 0;
+      }
+      p_payload_size = (static_cast<size_t>(p_data[0]) << 24) |
+                       (static_cast<size_t>(p_data[1]) << 16) |
+                       (static_cast<size_t>(p_data[2]) << 8) | static_cast<size_t>(p_data[3]);
+      return 4;
+    }
+    case w_frame_prefix::varint: {
+      uint64_t _size = 0;
+      const auto _max = std::min(p_data.size(), MAX_HEADER_SIZE);
+      for (size_t i = 0; i < _max; ++i) {
+        const auto _byte = p_data[i];
+        // the tenth byte may only carry the last bit of a 64 bits size
+        if (i == MAX_HEADER_SIZE - 1 && _byte > 1) {
+          return -1;
+        }
+        _size |= static_cast<uint64_t>(_byte & 0x7F) << (7 * i);
+        if ((_byte & 0x80) == 0) {
+          if (_size > std::numeric_limits<size_t>::max()) {
+            return -1;
+          }
+          p_payload_size = gsl::narrow_cast<size_t>(_size);
+          return gsl::narrow_cast<int>(i + 1);
+        }
+      }
+      return 0;
+    }
+  }
+}
+
+boost::leaf::result<size_t> w_frame_codec::encode_header(
+    _In_ w_frame_prefix p_prefix, _In_ size_t p_payload_size,
+    _Inout_ std::array<uint8_t, MAX_HEADER_SIZE> &p_header) noexcept {
+  const auto _size = s_encode_header(p_prefix, p_payload_size, p_header);
+  if (_size == 0) {
+    return W_FAILURE(std::errc::message_size,
+                     "could not encode the prefix of a frame with {} bytes", p_payload_size);
+  }
+  return _size;
+}
+
+boost::leaf::result<size_t> w_frame_codec::decode_header(
+    _In_ w_frame_prefix p_prefix, _In_ gsl::span<const uint8_t> p_data,
+    _Out_ size_t &p_payload_size) noexcept {
+  const auto _size = s_decode_header(p_prefix, p_data, p_payload_size);
+  if (_size < 0) {
+    return W_FAILURE(std::errc::illegal_byte_sequence, "malformed frame prefix");
+  }
+  return gsl::narrow_cast<size_t>(_size);
+}
+
+w_frame_reader::w_frame_reader(_In_ w_frame_prefix p_prefix, _In_ size_t p_max_frame_size,
+                               _In_ size_t p_staging_size)
+    : _prefix(p_prefix), _max_frame_size(p_max_frame_size),
+      _staging(std::max(p_staging_size, w_frame_codec::MAX_HEADER_SIZE)) {}
+
+size_t w_frame_reader::decode(_Out_ size_t &p_payload_size) {
+  const auto _pending = gsl::span<const uint8_t>(this->_staging.data() + this->_begin,
+                                                 this->_end - this->_begin);
+
+  const auto _header_size = s_decode_header(this->_prefix, _pending, p_payload_size);
+  if (_header_size < 0) {
+    throw boost::system::system_error(
+        make_error_code(boost::system::errc::illegal_byte_sequence));
+  }
+  if (_header_size != 0 && p_payload_size > this->_max_frame_size) {
+    throw boost::system::system_error(make_error_code(boost::system::errc::message_size));
+  }
+  return gsl::narrow_cast<size_t>(_header_size);
+}
+
+bool w_frame_reader::try_decode(_Inout_ w_pooled_buffer &p_mut_frame) {
+  size_t _payload_size = 0;
+  const auto _header_size = decode(_payload_size);
+  if (_header_size == 0 || this->_end - this->_begin - _header_size < _payload_size) {
+    return false;
+  }
+  this->_begin += _header_size;
+
+  prepare(p_mut_frame, _payload_size);
+  take(p_mut_frame, _payload_size);
+  return true;
+}
+
+void w_frame_reader::prepare(_Inout_ w_pooled_buffer &p_mut_frame, _In_ size_t p_payload_size) {
+  // reuse the storage of the last frame if nobody else owns it
+  if (p_mut_frame.unique() && p_mut_frame.capacity() >= p_payload_size) {
+    p_mut_frame.resize(p_payload_size);
+  } else {
+    p_mut_frame = w_pooled_buffer(p_payload_size);
+  }
+}
+
+size_t w_frame_reader::take(_Inout_ w_pooled_buffer &p_mut_frame,
+                            _In_ size_t p_payload_size) noexcept {
+  const auto _size = std::min(p_payload_size, this->_end - this->_begin);
+  if (_size != 0) {
+    std::memcpy(p_mut_frame.data(), this->_staging.data() + this->_begin, _size);
+    this->_begin += _size;
+  }
+  if (this->_begin == this->_end) {
+    this->_begin = this->_end = 0;
+  }
+  return _size;
+}
+
+void w_frame_reader::compact() noexcept {
+  if (this->_begin == 0) {
+    return;
+  }
+  const auto _pending = this->_end - this->_begin;
+  if (_pending != 0) {
+    std::memmove(this->_staging.data(), this->_staging.data() + this->_begin, _pending);
+  }
+  this->_begin = 0;
+  this->_end = _pending;
+}
+
+w_frame_writer::w_frame_writer(_In_ w_frame_prefix p_prefix) noexcept : _prefix(p_prefix) {}
+
+const std::vector<boost::asio::const_buffer> &w_frame_writer::prepare(
+    _In_ gsl::span<const w_pooled_buffer> p_frames) {
+  // the prefixes and the small payloads are packed into the scratch, so a
+  // batch of small frames becomes one buffer instead of two per frame. the
+  // scratch must not grow once the buffers point to it.
+  size_t _scratch_size = 0;
+  for (const auto &_frame : p_frames) {
+    _scratch_size += w_frame_codec::MAX_HEADER_SIZE;
+    if (_frame.size() <= INLINE_PAYLOAD_SIZE) {
+      _scratch_size += _frame.size();
+    }
+  }
+  if (this->_scratch.size() < _scratch_size) {
+    this->_scratch.resize(_scratch_size);
+  }
+  this->_buffers.clear();
+
+  auto _header = std::array<uint8_t, w_frame_codec::MAX_HEADER_SIZE>{};
+  auto *_run_begin = this->_scratch.data();
+  auto *_run_end = _run_begin;
+
+  for (const auto &_frame : p_frames) {
+    const auto _header_size = s_encode_header(this->_prefix, _frame.size(), _header);
+    if (_header_size == 0) {
+      throw boost::system::system_error(make_error_code(boost::system::errc::message_size));
+    }
+    std::memcpy(_run_end, _header.data(), _header_size);
+    _run_end += _header_size;
+
+    if (_frame.size() <= INLINE_PAYLOAD_SIZE) {
+      if (!_frame.empty()) {
+        std::memcpy(_run_end, _frame.data(), _frame.size());
+        _run_end += _frame.size();
+      }
+      continue;
+    }
+
+    // a big payload is sent from its own storage
+    this->_buffers.emplace_back(_run_begin, gsl::narrow_cast<size_t>(_run_end - _run_begin));
+    this->_buffers.emplace_back(_frame.data(), _frame.size());
+    _run_begin = _run_end;
+  }
+
+  if (_run_end != _run_begin) {
+    this->_buffers.emplace_back(_run_begin, gsl::narrow_cast<size_t>(_run_end - _run_begin));
+  }
+  return this->_buffers;
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -0,0 +1,201 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+#include <boost/asio.hpp>
+#include <wolf/system/w_pooled_buffer.hpp>
+#include <wolf/wolf.hpp>
+
+#include <array>
+#include <vector>
+
+namespace wolf::system::socket {
+
+/*
+ * the length prefix of a frame
+ */
+enum class w_frame_prefix {
+  // no framing, raw chunks of the stream
+  none = 0,
+  // unsigned LEB128 varint, 1 to 10 bytes
+  varint,
+  // fixed 4 bytes in network byte order
+  fixed32,
+};
+
+/*
+ * encode and decode the length prefix of frames
+ */
+struct w_frame_codec {
+  // the maximum size of a length prefix in bytes
+  static constexpr size_t MAX_HEADER_SIZE = 10;
+
+  /*
+   * encode the length prefix of a frame
+   * @param p_prefix, the type of prefix
+   * @param p_payload_size, the size of payload
+   * @param p_header, the destination of prefix
+   * @returns the size of encoded prefix in bytes
+   */
+  W_API static boost::leaf::result<size_t> encode_header(
+      _In_ w_frame_prefix p_prefix, _In_ size_t p_payload_size,
+      _Inout_ std::array<uint8_t, MAX_HEADER_SIZE> &p_header) noexcept;
+
+  /*
+   * decode the length prefix of a frame
+   * @param p_prefix, the type of prefix
+   * @param p_data, the received bytes which start with a prefix
+   * @param p_payload_size, the decoded size of payload
+   * @returns the size of prefix in bytes, or zero if the prefix is not
+   * complete yet
+   */
+  W_API static boost::leaf::result<size_t> decode_header(
+      _In_ w_frame_prefix p_prefix, _In_ gsl::span<const uint8_t> p_data,
+      _Out_ size_t &p_payload_size) noexcept;
+};
+
+/*
+ * read length-prefixed frames from a stream. the bytes are read into a
+ * staging buffer which holds the prefixes and the frames which fit in it,
+ * the rest of a bigger payload is read directly into its frame. each frame
+ * is a pooled buffer with exactly the size of its payload.
+ */
+class w_frame_reader {
+ public:
+  /*
+   * @param p_prefix, the type of prefix
+   * @param p_max_frame_size, the frames bigger than this will be rejected
+   * @param p_staging_size, the size of staging buffer
+   */
+  W_API explicit w_frame_reader(_In_ w_frame_prefix p_prefix,
+                                _In_ size_t p_max_frame_size = 16 * 1024 * 1024,
+                                _In_ size_t p_staging_size = 4096);
+
+  /*
+   * decode the next frame from the received bytes without any io, this is
+   * cheaper than async_read for the frames which are already received
+   * @param p_mut_frame, the destination frame
+   * @returns true if a whole frame was decoded
+   */
+  W_API bool try_decode(_Inout_ w_pooled_buffer &p_mut_frame);
+
+  /*
+   * read the next frame from the stream
+   * @param p_stream, the stream
+   * @param p_mut_frame, the destination frame
+   * @returns the size of payload, throws boost::system::system_error on
+   * failure
+   */
+  template <typename T>
+  boost::asio::awaitable<size_t> async_read(_Inout_ T &p_stream,
+                                            _Inout_ w_pooled_buffer &p_mut_frame) {
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      if (try_decode(p_mut_frame)) {
+        co_return p_mut_frame.size();
+      }
+
+      size_t _payload_size = 0;
+      const auto _header_size = decode(_payload_size);
+      if (_header_size == 0 || _header_size + _payload_size <= this->_staging.size()) {
+        // the prefix or a small frame is not complete, receive more bytes
+        // into the staging buffer
+        compact();
+        const auto _read_bytes = co_await p_stream.async_read_some(
+            boost::asio::buffer(this->_staging.data() + this->_end,
+                                this->_staging.size() - this->_end),
+            boost::asio::use_awaitable);
+        this->_end += _read_bytes;
+        continue;
+      }
+      this->_begin += _header_size;
+
+      // take the received part of payload, then read the rest directly
+      // into the frame
+      prepare(p_mut_frame, _payload_size);
+      const auto _received = take(p_mut_frame, _payload_size);
+      co_await boost::asio::async_read(
+          p_stream,
+          boost::asio::buffer(p_mut_frame.data() + _received, _payload_size - _received),
+          boost::asio::use_awaitable);
+      co_return _payload_size;
+    }
+  }
+
+  // returns the number of bytes which were received but not decoded yet
+  [[nodiscard]] size_t get_pending_bytes() const noexcept {
+    return this->_end - this->_begin;
+  }
+
+  // returns the type of prefix
+  [[nodiscard]] w_frame_prefix get_prefix() const noexcept { return this->_prefix; }
+
+ private:
+  W_API size_t decode(_Out_ size_t &p_payload_size);
+  W_API void prepare(_Inout_ w_pooled_buffer &p_mut_frame, _In_ size_t p_payload_size);
+  W_API size_t take(_Inout_ w_pooled_buffer &p_mut_frame, _In_ size_t p_payload_size) noexcept;
+  W_API void compact() noexcept;
+
+  w_frame_prefix _prefix;
+  size_t _max_frame_size;
+  std::vector<uint8_t> _staging;
+  size_t _begin = 0;
+  size_t _end = 0;
+};
+
+/*
+ * write batches of length-prefixed frames with one gathered send
+ */
+class w_frame_writer {
+ public:
+  // the payloads up to this size are copied next to their prefixes
+  static constexpr size_t INLINE_PAYLOAD_SIZE = 256;
+
+  /*
+   * @param p_prefix, the type of prefix
+   */
+  W_API explicit w_frame_writer(_In_ w_frame_prefix p_prefix) noexcept;
+
+  /*
+   * build the buffer sequence of prefixes and payloads, the big payloads
+   * are not copied, so the frames must outlive the write
+   * @param p_frames, the frames
+   * @returns the buffer sequence which is valid until the next call
+   */
+  W_API const std::vector<boost::asio::const_buffer> &prepare(
+      _In_ gsl::span<const w_pooled_buffer> p_frames);
+
+  /*
+   * write a batch of frames into the stream
+   * @param p_stream, the stream
+   * @param p_frames, the frames
+   * @returns number of the written bytes, throws boost::system::system_error
+   * on failure
+   */
+  template <typename T>
+  boost::asio::awaitable<size_t> async_write(_Inout_ T &p_stream,
+                                             _In_ gsl::span<const w_pooled_buffer> p_frames) {
+    const auto &_buffers = prepare(p_frames);
+    co_return co_await boost::asio::async_write(p_stream, _buffers,
+                                                boost::asio::use_awaitable);
+  }
+
+  // returns the type of prefix
+  [[nodiscard]] w_frame_prefix get_prefix() const noexcept { return this->_prefix; }
+
+ private:
+  w_frame_prefix _prefix;
+  std::vector<uint8_t> _scratch;
+  std::vector<boost::asio::const_buffer> _buffers;
+};
+
+}  // namespace wolf::system::socket
+
+#endif  // WOLF_SYSTEM_SOCKET
@@ -9,9 +9,16 @@
 
 #include <boost/asio.hpp>
 #include <boost/system/errc.hpp>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <random>
+#include <stdexcept>
+#include <vector>
 #include <wolf/wolf.hpp>
+#include <wolf/system/w_pooled_buffer.hpp>
+
+#include "w_frame_codec.hpp"
 
 #include "DISABLE_ANALYSIS_BEGIN"
 #ifdef WOLF_SYSTEM_HTTP_WS
@@ -37,7 +44,23 @@ struct w_socket_options {
   bool keep_alive = true;
   bool no_delay = true;
   bool reuse_address = true;
+  // let several acceptors bind to the same endpoint, so the kernel
+  // load-balances the incoming connections between them
+  bool reuse_port = false;
   int max_connections = boost::asio::socket_base::max_listen_connections;
+  // the initial size of the pooled receive buffer of each session
+  size_t recv_buffer_size = 4096;
+  // the capacity of the send queue of a pipelined session, the reader of
+  // session waits while the queue is full
+  size_t send_queue_capacity = 256;
+  // the maximum number of queued frames which a pipelined session gathers
+  // into one write
+  size_t max_gather_frames = 64;
+  // the length prefix of messages, with a prefix the sessions call the
+  // data callback once per whole frame and prefix the outbound frames
+  w_frame_prefix framing = w_frame_prefix::none;
+  // the frames bigger than this will close the session
+  size_t max_frame_size = 16 * 1024 * 1024;
 
   void set_to_socket(_Inout_ boost::asio::ip::tcp::socket &p_socket) {
     // set acceptor's options
@@ -64,9 +87,82 @@ struct w_socket_options {
     const auto _reuse_address_option =
         boost::asio::socket_base::reuse_address(this->reuse_address);
     p_acceptor.set_option(_reuse_address_option);
+
+#ifdef SO_REUSEPORT
+    if (this->reuse_port) {
+      using reuse_port_option =
+          boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+      p_acceptor.set_option(reuse_port_option(true));
+    }
+#endif
   }
 };
 
+/*
+ * a DynamicBuffer over w_pooled_buffer, so asio and beast read operations
+ * write straight into the pooled storage without an intermediate copy
+ */
+class w_pooled_dynamic_buffer {
+ public:
+  using const_buffers_type = boost::asio::const_buffer;
+  using mutable_buffers_type = boost::asio::mutable_buffer;
+
+  /*
+   * @param p_buffer, the pooled buffer which will hold the committed bytes
+   * @param p_max_size, the maximum size of the pooled buffer
+   */
+  explicit w_pooled_dynamic_buffer(
+      _Inout_ w_pooled_buffer &p_buffer,
+      _In_ size_t p_max_size = std::numeric_limits<size_t>::max()) noexcept
+      : _buffer(p_buffer), _max_size(p_max_size) {}
+
+  [[nodiscard]] size_t size() const noexcept { return this->_buffer.size(); }
+
+  [[nodiscard]] size_t max_size() const noexcept { return this->_max_size; }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return this->_buffer.capacity();
+  }
+
+  [[nodiscard]] const_buffers_type data() const noexcept {
+    return {this->_buffer.data(), this->_buffer.size()};
+  }
+
+  [[nodiscard]] mutable_buffers_type data() noexcept {
+    return {this->_buffer.data(), this->_buffer.size()};
+  }
+
+  mutable_buffers_type prepare(_In_ size_t p_size) {
+    const auto _size = this->_buffer.size();
+    if (p_size > this->_max_size - _size) {
+      throw std::length_error("w_pooled_dynamic_buffer overflow");
+    }
+    this->_buffer.reserve(_size + p_size);
+    return {this->_buffer.data() + _size, p_size};
+  }
+
+  void commit(_In_ size_t p_size) noexcept {
+    const auto _size = this->_buffer.size();
+    this->_buffer.resize(
+        _size + std::min(p_size, this->_buffer.capacity() - _size));
+  }
+
+  void consume(_In_ size_t p_size) noexcept {
+    const auto _size = this->_buffer.size();
+    if (p_size >= _size) {
+      this->_buffer.resize(0);
+      return;
+    }
+    std::memmove(this->_buffer.data(), this->_buffer.data() + p_size,
+                 _size - p_size);
+    this->_buffer.resize(_size - p_size);
+  }
+
+ private:
+  w_pooled_buffer &_buffer;
+  size_t _max_size;
+};
+
 #ifdef WOLF_SYSTEM_HTTP_WS
 using w_ws_stream = boost::beast::websocket::stream<
     typename boost::beast::tcp_stream::rebind_executor<
@@ -74,15 +170,28 @@ using w_ws_stream = boost::beast::websocket::stream<
             boost::asio::any_io_executor>>::other>;
 
 typedef std::function<boost::beast::websocket::close_code(
-    _In_ const std::string &p_conn_id, _Inout_ w_buffer &p_mut_data,
+    _In_ const std::string &p_conn_id,
+    _Inout_ wolf::system::w_pooled_buffer &p_mut_data,
     _Inout_ bool &p_is_binary)>
     w_session_ws_on_data_callback;
 #endif
 
 typedef std::function<boost::system::errc::errc_t(
-    _In_ const std::string &p_conn_id, _Inout_ w_buffer &p_mut_data)>
+    _In_ const std::string &p_conn_id,
+    _Inout_ wolf::system::w_pooled_buffer &p_mut_data)>
     w_session_on_data_callback;
 
+/*
+ * the data callback of a pipelined session, p_data is the received chunk
+ * and the callback appends zero, one or many outbound frames to
+ * p_mut_frames which will be sent in order
+ */
+typedef std::function<boost::system::errc::errc_t(
+    _In_ const std::string &p_conn_id,
+    _In_ const wolf::system::w_pooled_buffer &p_data,
+    _Inout_ std::vector<wolf::system::w_pooled_buffer> &p_mut_frames)>
+    w_session_on_pipelined_data_callback;
+
 typedef std::function<void(_In_ const std::string &p_conn_id,
                            _In_ const boost::system::system_error &p_error)>
     w_session_on_error_callback;
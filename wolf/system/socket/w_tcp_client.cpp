@@ -10,6 +10,10 @@
 
 using namespace boost::asio::experimental::awaitable_operators;
 using w_tcp_client = wolf::system::socket::w_tcp_client;
+using w_pooled_buffer = wolf::system::w_pooled_buffer;
+using w_socket_options = wolf::system::socket::w_socket_options;
+using w_frame_reader = wolf::system::socket::w_frame_reader;
+using w_frame_writer = wolf::system::socket::w_frame_writer;
 using tcp = boost::asio::ip::tcp;
 
 w_tcp_client::w_tcp_client(boost::asio::io_context &p_io_context) noexcept
@@ -71,20 +75,45 @@ w_tcp_client::async_connect(_In_ const tcp::endpoint &p_endpoint,
 }
 
 boost::asio::awaitable<size_t> w_tcp_client::async_write(
-    _In_ const w_buffer &p_buffer) {
+    _In_ const w_pooled_buffer &p_buffer) {
   const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
 
-  return _socket_nn->async_send(
-      boost::asio::buffer(p_buffer.buf, p_buffer.used_bytes),
+  return boost::asio::async_write(
+      *_socket_nn, boost::asio::buffer(p_buffer.data(), p_buffer.size()),
       boost::asio::use_awaitable);
 }
 
 boost::asio::awaitable<size_t> w_tcp_client::async_read(
-    _Inout_ w_buffer &p_mut_buffer) {
+    _Inout_ w_pooled_buffer &p_mut_buffer) {
   const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
 
-  return _socket_nn->async_receive(boost::asio::buffer(p_mut_buffer.buf),
-                                   boost::asio::use_awaitable);
+  // never overwrite a storage which is shared with other owners
+  if (!p_mut_buffer.unique()) {
+    p_mut_buffer.reset();
+  }
+  if (p_mut_buffer.capacity() == 0) {
+    p_mut_buffer.reserve(w_socket_options{}.recv_buffer_size);
+  }
+  p_mut_buffer.resize(p_mut_buffer.capacity());
+
+  const auto _size = co_await _socket_nn->async_receive(
+      boost::asio::buffer(p_mut_buffer.data(), p_mut_buffer.size()),
+      boost::asio::use_awaitable);
+  p_mut_buffer.resize(_size);
+
+  co_return _size;
+}
+
+boost::asio::awaitable<size_t> w_tcp_client::async_write(
+    _Inout_ w_frame_writer &p_writer, _In_ gsl::span<const w_pooled_buffer> p_frames) {
+  const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
+  return p_writer.async_write(*_socket_nn, p_frames);
+}
+
+boost::asio::awaitable<size_t> w_tcp_client::async_read(
+    _Inout_ w_frame_reader &p_reader, _Inout_ w_pooled_buffer &p_mut_frame) {
+  const gsl::not_null<tcp::socket *> _socket_nn(this->_socket.get());
+  return p_reader.async_read(*_socket_nn, p_mut_frame);
 }
 
 bool w_tcp_client::get_is_open() const {
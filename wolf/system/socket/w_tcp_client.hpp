@@ -67,15 +67,43 @@ class w_tcp_client {
    * @returns number of the written bytes
    */
   W_API
-  boost::asio::awaitable<size_t> async_write(_In_ const w_buffer &p_buffer);
+  boost::asio::awaitable<size_t> async_write(
+      _In_ const wolf::system::w_pooled_buffer &p_buffer);
 
   /*
-   * read from the socket into the buffer
-   * @param p_mut_buffer, the destination buffer which will contain bytes
+   * read from the socket into the buffer, the size of buffer will be set
+   * to the number of read bytes
+   * @param p_mut_buffer, the destination buffer which will contain bytes, an
+   * empty buffer will be reserved with the default receive size
    * @returns number of read bytes
    */
   W_API
-  boost::asio::awaitable<size_t> async_read(_Inout_ w_buffer &p_mut_buffer);
+  boost::asio::awaitable<size_t> async_read(
+      _Inout_ wolf::system::w_pooled_buffer &p_mut_buffer);
+
+  /*
+   * write a batch of frames into the socket with one gathered send
+   * @param p_writer, the frame writer which prefixes the frames
+   * @param p_frames, the frames
+   * @returns number of the written bytes
+   */
+  W_API
+  boost::asio::awaitable<size_t> async_write(
+      _Inout_ w_frame_writer &p_writer,
+      _In_ gsl::span<const wolf::system::w_pooled_buffer> p_frames);
+
+  /*
+   * read a whole frame from the socket, the frame will have exactly the
+   * size of its payload
+   * @param p_reader, the frame reader which keeps the received bytes of
+   * the next frames
+   * @param p_mut_frame, the destination frame
+   * @returns the size of payload
+   */
+  W_API
+  boost::asio::awaitable<size_t> async_read(
+      _Inout_ w_frame_reader &p_reader,
+      _Inout_ wolf::system::w_pooled_buffer &p_mut_frame);
 
   /*
    * get whether socket is open
@@ -1,7 +1,13 @@
 #ifdef WOLF_SYSTEM_SOCKET
 
 #include "w_tcp_server.hpp"
+#include <optional>
 #include <random>
+#include <wolf/system/w_spsc_queue.hpp>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 #include "DISABLE_ANALYSIS_BEGIN"
 #ifdef WOLF_SYSTEM_SSL
@@ -12,8 +18,14 @@
 
 using w_tcp_server = wolf::system::socket::w_tcp_server;
 using w_session_on_data_callback = wolf::system::socket::w_session_on_data_callback;
+using w_session_on_pipelined_data_callback =
+    wolf::system::socket::w_session_on_pipelined_data_callback;
 using w_session_on_error_callback = wolf::system::socket::w_session_on_error_callback;
 using w_socket_options = wolf::system::socket::w_socket_options;
+using w_frame_prefix = wolf::system::socket::w_frame_prefix;
+using w_frame_reader = wolf::system::socket::w_frame_reader;
+using w_frame_writer = wolf::system::socket::w_frame_writer;
+using w_pooled_buffer = wolf::system::w_pooled_buffer;
 using steady_clock = std::chrono::steady_clock;
 using steady_timer = boost::asio::steady_timer;
 using io_context = boost::asio::io_context;
@@ -40,10 +52,19 @@ watchdog(_Inout_ const time_point &p_deadline) noexcept {
 static boost::asio::awaitable<void> on_handle_session(
     const boost::asio::io_context &p_io_context, tcp::socket &p_socket,
     const std::string &p_conn_id, time_point &p_deadline,
-    steady_clock::duration p_timeout,
+    steady_clock::duration p_timeout, const w_socket_options &p_socket_options,
     const w_session_on_data_callback p_on_data_callback,
     const w_session_on_error_callback p_on_error_callback) noexcept {
-  w_buffer _buffer = {};
+  const auto _recv_buffer_size = p_socket_options.recv_buffer_size;
+  auto _buffer = w_pooled_buffer(_recv_buffer_size);
+
+  auto _frame_reader = std::optional<w_frame_reader>();
+  auto _frame_writer = std::optional<w_frame_writer>();
+  if (p_socket_options.framing != w_frame_prefix::none) {
+    _frame_reader.emplace(p_socket_options.framing, p_socket_options.max_frame_size,
+                          _recv_buffer_size);
+    _frame_writer.emplace(p_socket_options.framing);
+  }
 
 #ifdef __clang__
 #pragma unroll
@@ -52,17 +73,51 @@ static boost::asio::awaitable<void> on_handle_session(
     p_deadline = steady_clock::now() + p_timeout;
 
     try {
-      _buffer.used_bytes = co_await p_socket.async_receive(
-          boost::asio::buffer(_buffer.buf), boost::asio::use_awaitable);
+      if (_frame_reader.has_value()) {
+        // read a whole frame into a buffer of its exact size, the frames
+        // which were already received are decoded without any io
+        if (!_frame_reader->try_decode(_buffer)) {
+          co_await _frame_reader->async_read(p_socket, _buffer);
+        }
+      } else {
+        // the callback may still own the last buffer, so take a new one
+        // from the pool instead of overwriting it
+        if (!_buffer.unique()) {
+          _buffer = w_pooled_buffer(_recv_buffer_size);
+        }
+        _buffer.resize(_buffer.capacity());
+
+        auto _used_bytes = co_await p_socket.async_receive(
+            boost::asio::buffer(_buffer.data(), _buffer.size()),
+            boost::asio::use_awaitable);
+
+        // the message did not fit, grow the buffer and drain the rest of
+        // the pending bytes instead of handing them over in chunks
+        const auto _available = p_socket.available();
+        if (_used_bytes == _buffer.size() && _available != 0) {
+          _buffer.resize(_used_bytes + _available);
+          _used_bytes += co_await boost::asio::async_read(
+              p_socket,
+              boost::asio::buffer(_buffer.data() + _used_bytes, _available),
+              boost::asio::use_awaitable);
+        }
+        _buffer.resize(_used_bytes);
+      }
 
       // call callback
       const auto _res = p_on_data_callback(p_conn_id, _buffer);
       if (_res == boost::system::errc::connection_aborted) {
         break;
       }
-      co_await p_socket.async_send(
-          boost::asio::buffer(_buffer.buf, _buffer.used_bytes),
-          boost::asio::use_awaitable);
+
+      if (_frame_writer.has_value()) {
+        co_await _frame_writer->async_write(p_socket,
+                                            gsl::span<const w_pooled_buffer>(&_buffer, 1));
+      } else {
+        co_await boost::asio::async_write(
+            p_socket, boost::asio::buffer(_buffer.data(), _buffer.size()),
+            boost::asio::use_awaitable);
+      }
     } catch (const boost::system::system_error &p_ex) {
       p_on_error_callback(p_conn_id, p_ex);
       break;
@@ -72,7 +127,7 @@ static boost::asio::awaitable<void> on_handle_session(
 
 static boost::asio::awaitable<void>
 s_session(const boost::asio::io_context &p_io_context, tcp::socket p_socket,
-          steady_clock::duration p_timeout,
+          steady_clock::duration p_timeout, const w_socket_options p_socket_options,
           w_session_on_data_callback p_on_data_callback,
           w_session_on_error_callback p_on_error_callback) noexcept {
 
@@ -81,7 +136,7 @@ s_session(const boost::asio::io_context &p_io_context, tcp::socket p_socket,
   time_point _deadline = {};
   const auto _ret = co_await (
       on_handle_session(p_io_context, p_socket, _conn_id, _deadline, p_timeout,
-                        p_on_data_callback, p_on_error_callback) ||
+                        p_socket_options, p_on_data_callback, p_on_error_callback) ||
       watchdog(_deadline));
   if (std::get<1>(_ret) == std::errc::timed_out) {
     const auto _error = boost::system::system_error(
@@ -92,42 +147,293 @@ s_session(const boost::asio::io_context &p_io_context, tcp::socket p_socket,
   co_return;
 }
 
-static boost::asio::awaitable<void> s_listen(
-    _In_ const boost::asio::io_context &p_io_context, _In_ tcp::endpoint &p_endpoint,
-    _In_ const steady_clock::duration &p_timeout, _In_ w_socket_options &p_socket_options,
-    _In_ w_session_on_data_callback p_on_data_callback,
-    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
-  // create acceptor from this coroutine
-  auto _executor = co_await boost::asio::this_coro::executor;
-  tcp::acceptor _acceptor(_executor, p_endpoint);
+// the state of a pipelined session which is shared between its reader and
+// its writer, both of them run on the strand of session
+struct w_pipelined_session {
+  w_pipelined_session(_In_ tcp::socket &&p_socket, _In_ size_t p_send_queue_capacity)
+      : socket(std::move(p_socket)), send_queue(p_send_queue_capacity),
+        writer_signal(this->socket.get_executor()),
+        reader_signal(this->socket.get_executor()) {}
+
+  tcp::socket socket;
+  wolf::system::w_spsc_queue<w_pooled_buffer> send_queue;
+  // wakes up the writer once a frame was queued or the reader was done
+  steady_timer writer_signal;
+  // wakes up the reader once the writer made room in the send queue
+  steady_timer reader_signal;
+  bool reader_done = false;
+  bool writer_failed = false;
+  time_point deadline = {};
+};
+
+static boost::asio::awaitable<void> s_wait_for_signal(_Inout_ steady_timer &p_signal) {
+  p_signal.expires_at(time_point::max());
+  boost::system::error_code _error_code;
+  co_await p_signal.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, _error_code));
+}
+
+static boost::asio::awaitable<void> s_pipelined_reader(
+    const boost::asio::io_context &p_io_context, w_pipelined_session &p_session,
+    const std::string &p_conn_id, steady_clock::duration p_timeout,
+    const w_socket_options &p_socket_options,
+    const w_session_on_pipelined_data_callback &p_on_data_callback,
+    const w_session_on_error_callback &p_on_error_callback) noexcept {
+  auto _buffer = w_pooled_buffer(p_socket_options.recv_buffer_size);
+  auto _frames = std::vector<w_pooled_buffer>();
+  _frames.reserve(p_socket_options.max_gather_frames);
+
+  auto _frame_reader = std::optional<w_frame_reader>();
+  if (p_socket_options.framing != w_frame_prefix::none) {
+    _frame_reader.emplace(p_socket_options.framing, p_socket_options.max_frame_size,
+                          p_socket_options.recv_buffer_size);
+  }
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  while (!p_io_context.stopped() && !p_session.writer_failed) {
+    p_session.deadline = steady_clock::now() + p_timeout;
+
+    try {
+      if (_frame_reader.has_value()) {
+        // read a whole frame into a buffer of its exact size, the frames
+        // which were already received are decoded without any io
+        if (!_frame_reader->try_decode(_buffer)) {
+          co_await _frame_reader->async_read(p_session.socket, _buffer);
+        }
+      } else {
+        // the callback may keep the last buffer, e.g. as an outbound frame
+        if (!_buffer.unique()) {
+          _buffer = w_pooled_buffer(p_socket_options.recv_buffer_size);
+        }
+        _buffer.resize(_buffer.capacity());
+
+        auto _used_bytes = co_await p_session.socket.async_receive(
+            boost::asio::buffer(_buffer.data(), _buffer.size()), boost::asio::use_awaitable);
+
+        // hand over all the pending bytes in one chunk
+        const auto _available = p_session.socket.available();
+        if (_used_bytes == _buffer.size() && _available != 0) {
+          _buffer.resize(_used_bytes + _available);
+          _used_bytes += co_await boost::asio::async_read(
+              p_session.socket, boost::asio::buffer(_buffer.data() + _used_bytes, _available),
+              boost::asio::use_awaitable);
+        }
+        _buffer.resize(_used_bytes);
+      }
+
+      const auto _res = p_on_data_callback(p_conn_id, _buffer, _frames);
+
+      for (auto &_frame : _frames) {
+        // the peer does not read as fast as it writes, so stop reading
+        // until the writer made room
+        while (!p_session.send_queue.try_push(_frame) && !p_session.writer_failed) {
+          co_await s_wait_for_signal(p_session.reader_signal);
+        }
+        p_session.writer_signal.cancel();
+      }
+      _frames.clear();
+
+      if (_res == boost::system::errc::connection_aborted) {
+        break;
+      }
+    } catch (const boost::system::system_error &p_ex) {
+      // the writer has already reported its own failure
+      if (!p_session.writer_failed) {
+        p_on_error_callback(p_conn_id, p_ex);
+      }
+      break;
+    }
+  }
+
+  // let the writer flush the queued frames and exit
+  p_session.reader_done = true;
+  p_session.writer_signal.cancel();
+}
+
+static boost::asio::awaitable<void> s_pipelined_writer(
+    w_pipelined_session &p_session, const std::string &p_conn_id,
+    steady_clock::duration p_timeout, const w_socket_options &p_socket_options,
+    const w_session_on_error_callback &p_on_error_callback) noexcept {
+  const auto _max_frames = std::max<size_t>(p_socket_options.max_gather_frames, 1);
+  auto _frame_writer = w_frame_writer(p_socket_options.framing);
+
+  auto _frames = std::vector<w_pooled_buffer>();
+  auto _buffers = std::vector<boost::asio::const_buffer>();
+  _frames.reserve(_max_frames);
+  _buffers.reserve(_max_frames);
+
+#ifdef __clang__
+#pragma unroll
+#endif
+  for (;;) {
+    while (_frames.size() < _max_frames) {
+      auto _frame = p_session.send_queue.try_pop();
+      if (!_frame.has_value()) {
+        break;
+      }
+      _frames.push_back(std::move(*_frame));
+    }
+
+    if (_frames.empty()) {
+      if (p_session.reader_done) {
+        break;
+      }
+      co_await s_wait_for_signal(p_session.writer_signal);
+      continue;
+    }
+
+    // there is room in the queue again
+    p_session.reader_signal.cancel();
 
-  // set acceptor's options
+    try {
+      p_session.deadline = steady_clock::now() + p_timeout;
+
+      // coalesce the frames into one gathered write
+      if (p_socket_options.framing != w_frame_prefix::none) {
+        co_await _frame_writer.async_write(p_session.socket,
+                                           gsl::span<const w_pooled_buffer>(_frames));
+      } else {
+        _buffers.clear();
+        for (const auto &_frame : _frames) {
+          _buffers.emplace_back(_frame.data(), _frame.size());
+        }
+        co_await boost::asio::async_write(p_session.socket, _buffers,
+                                          boost::asio::use_awaitable);
+      }
+    } catch (const boost::system::system_error &p_ex) {
+      p_session.writer_failed = true;
+      p_on_error_callback(p_conn_id, p_ex);
+
+      // wake up the reader from either the socket or the full queue
+      boost::system::error_code _error_code;
+      std::ignore = p_session.socket.cancel(_error_code);
+      p_session.reader_signal.cancel();
+      break;
+    }
+
+    // give the frames back to the pool
+    _frames.clear();
+  }
+}
+
+static boost::asio::awaitable<void>
+s_session(const boost::asio::io_context &p_io_context, tcp::socket p_socket,
+          steady_clock::duration p_timeout, const w_socket_options p_socket_options,
+          w_session_on_pipelined_data_callback p_on_data_callback,
+          w_session_on_error_callback p_on_error_callback) noexcept {
+  const auto _conn_id = wolf::system::socket::make_connection_id();
+
+  auto _session = w_pipelined_session(std::move(p_socket), p_socket_options.send_queue_capacity);
+
+  const auto _ret = co_await (
+      (s_pipelined_reader(p_io_context, _session, _conn_id, p_timeout, p_socket_options,
+                          p_on_data_callback, p_on_error_callback) &&
+       s_pipelined_writer(_session, _conn_id, p_timeout, p_socket_options,
+                          p_on_error_callback)) ||
+      watchdog(_session.deadline));
+  if (_ret.index() == 1) {
+    const auto _error = boost::system::system_error(
+        make_error_code(boost::system::errc::timed_out));
+    p_on_error_callback(_conn_id, _error);
+  }
+
+  co_return;
+}
+
+static tcp::acceptor s_make_acceptor(_In_ const boost::asio::any_io_executor &p_executor,
+                                     _In_ const tcp::endpoint &p_endpoint,
+                                     _In_ w_socket_options &p_socket_options) {
+  tcp::acceptor _acceptor(p_executor);
+  _acceptor.open(p_endpoint.protocol());
+
+  // set acceptor's options, they must be set before binding
   p_socket_options.set_to_acceptor(_acceptor);
 
+  _acceptor.bind(p_endpoint);
+
   // start listening for connections
   _acceptor.listen(p_socket_options.max_connections);
 
+  return _acceptor;
+}
+
+template <typename T>
+static boost::asio::awaitable<void> s_accept(
+    _In_ const boost::asio::io_context &p_io_context, _In_ tcp::acceptor p_acceptor,
+    _In_ steady_clock::duration p_timeout, _In_ w_socket_options p_socket_options,
+    _In_ T p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  auto _executor = co_await boost::asio::this_coro::executor;
+
 #ifdef __clang__
 #pragma unroll
 #endif
   while (!p_io_context.stopped()) {
-    tcp::socket _socket = co_await _acceptor.async_accept(boost::asio::use_awaitable);
+    tcp::socket _socket = co_await p_acceptor.async_accept(boost::asio::use_awaitable);
     p_socket_options.set_to_socket(_socket);
 
     //auto _ssl_session = boost::asio::ssl::stream<tcp::socket>(std::move(_socket), _ssl_context);
 
-    // spawn a coroutinue for handling session
-    co_spawn(_executor,
-             s_session(p_io_context, std::move(_socket), p_timeout, p_on_data_callback,
-                       p_on_error_callback),
+    // spawn a coroutinue for handling session, on its own strand since the
+    // io context may be run by several threads
+    co_spawn(boost::asio::make_strand(_executor),
+             s_session(p_io_context, std::move(_socket), p_timeout, p_socket_options,
+                       p_on_data_callback, p_on_error_callback),
              boost::asio::detached);
   }
 }
 
-boost::leaf::result<int> w_tcp_server::run(
+// the arguments are taken by value, since this coroutine outlives the
+// caller of w_tcp_server::run
+template <typename T>
+static boost::asio::awaitable<void> s_listen(
+    _In_ const boost::asio::io_context &p_io_context, _In_ tcp::endpoint p_endpoint,
+    _In_ steady_clock::duration p_timeout, _In_ w_socket_options p_socket_options,
+    _In_ T p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  // create acceptor from this coroutine
+  auto _executor = co_await boost::asio::this_coro::executor;
+  auto _acceptor = s_make_acceptor(_executor, p_endpoint, p_socket_options);
+
+  co_await s_accept(p_io_context, std::move(_acceptor), p_timeout,
+                    std::move(p_socket_options), std::move(p_on_data_callback),
+                    std::move(p_on_error_callback));
+}
+
+static void s_pin_current_thread(_In_ size_t p_core) noexcept {
+#if defined(__linux__)
+  cpu_set_t _cpu_set;
+  CPU_ZERO(&_cpu_set);
+  CPU_SET(p_core, &_cpu_set);
+  std::ignore = sched_setaffinity(0, sizeof(_cpu_set), &_cpu_set);
+#elif defined(WIN32)
+  // a mask only covers 64 cores, so find the processor group of the core
+  auto _core = p_core;
+  const auto _groups = GetActiveProcessorGroupCount();
+  for (WORD _group = 0; _group < _groups; ++_group) {
+    const auto _count = size_t(GetActiveProcessorCount(_group));
+    if (_core < _count) {
+      auto _affinity = GROUP_AFFINITY{};
+      _affinity.Mask = KAFFINITY(1) << _core;
+      _affinity.Group = _group;
+      std::ignore = SetThreadGroupAffinity(GetCurrentThread(), &_affinity, nullptr);
+      return;
+    }
+    _core -= _count;
+  }
+  // the core does not exist, leave it to the scheduler
+#else
+  // thread affinity is not supported, leave it to the scheduler
+  std::ignore = p_core;
+#endif
+}
+
+template <typename T>
+static boost::leaf::result<int> s_run(
     _In_ boost::asio::io_context &p_io_context, _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
     _In_ std::chrono::steady_clock::duration &&p_timeout, _In_ w_socket_options &&p_socket_options,
-    _In_ w_session_on_data_callback p_on_data_callback,
+    _In_ T p_on_data_callback,
     _In_ w_session_on_error_callback p_on_error_callback) noexcept {
   try {
 #ifdef WOLF_SYSTEM_SSL
@@ -140,8 +446,9 @@ boost::leaf::result<int> w_tcp_server::run(
 
     // server with coroutines
     boost::asio::co_spawn(p_io_context,
-                          s_listen(p_io_context, p_endpoint, p_timeout, p_socket_options,
-                                   p_on_data_callback, p_on_error_callback),
+                          s_listen<T>(p_io_context, std::move(p_endpoint), p_timeout,
+                                   std::move(p_socket_options), p_on_data_callback,
+                                   p_on_error_callback),
                           boost::asio::detached);
     return 0;
 
@@ -151,4 +458,112 @@ boost::leaf::result<int> w_tcp_server::run(
   }
 }
 
+boost::leaf::result<int> w_tcp_server::run(
+    _In_ boost::asio::io_context &p_io_context, _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout, _In_ w_socket_options &&p_socket_options,
+    _In_ w_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return s_run(p_io_context, std::move(p_endpoint), std::move(p_timeout),
+               std::move(p_socket_options), std::move(p_on_data_callback),
+               std::move(p_on_error_callback));
+}
+
+boost::leaf::result<int> w_tcp_server::run(
+    _In_ boost::asio::io_context &p_io_context, _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+    _In_ std::chrono::steady_clock::duration &&p_timeout, _In_ w_socket_options &&p_socket_options,
+    _In_ w_session_on_pipelined_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return s_run(p_io_context, std::move(p_endpoint), std::move(p_timeout),
+               std::move(p_socket_options), std::move(p_on_data_callback),
+               std::move(p_on_error_callback));
+}
+
+using w_tcp_server_shards = wolf::system::socket::w_tcp_server_shards;
+
+template <typename T>
+boost::leaf::result<std::unique_ptr<w_tcp_server_shards>> w_tcp_server_shards::make_shards(
+    _In_ size_t p_shards, _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
+    _In_ std::chrono::steady_clock::duration p_timeout, _In_ w_socket_options p_socket_options,
+    _In_ T p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  const auto _cores = std::max(std::thread::hardware_concurrency(), 1U);
+  if (p_shards == 0) {
+    p_shards = _cores;
+  }
+
+#ifndef SO_REUSEPORT
+  if (p_shards > 1) {
+    return W_FAILURE(std::errc::operation_not_supported,
+                     "SO_REUSEPORT is not supported on this platform");
+  }
+#endif
+  p_socket_options.reuse_port = true;
+
+  try {
+    auto _shards = std::unique_ptr<w_tcp_server_shards>(new w_tcp_server_shards());
+    _shards->_contexts.reserve(p_shards);
+    _shards->_threads.reserve(p_shards);
+
+    // bind all acceptors before starting any thread, so a failure
+    // leaves nothing running behind
+    for (size_t i = 0; i < p_shards; ++i) {
+      // each io context is only run by one thread
+      auto _io = std::make_unique<io_context>(1);
+      auto _acceptor = s_make_acceptor(_io->get_executor(), p_endpoint, p_socket_options);
+
+      boost::asio::co_spawn(*_io,
+                            s_accept<T>(*_io, std::move(_acceptor), p_timeout, p_socket_options,
+                                     p_on_data_callback, p_on_error_callback),
+                            boost::asio::detached);
+      _shards->_contexts.push_back(std::move(_io));
+    }
+
+    for (size_t i = 0; i < p_shards; ++i) {
+      _shards->_threads.emplace_back([_io = _shards->_contexts[i].get(), _core = i % _cores]() {
+        s_pin_current_thread(_core);
+        _io->run();
+      });
+    }
+
+    return _shards;
+  } catch (_In_ const std::exception &p_ex) {
+    return W_FAILURE(std::errc::operation_canceled,
+                     "tcp server shards caught an exception : " + std::string(p_ex.what()));
+  }
+}
+
+boost::leaf::result<std::unique_ptr<w_tcp_server_shards>> w_tcp_server_shards::make(
+    _In_ size_t p_shards, _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
+    _In_ std::chrono::steady_clock::duration p_timeout, _In_ w_socket_options p_socket_options,
+    _In_ w_session_on_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return make_shards(p_shards, p_endpoint, p_timeout, std::move(p_socket_options),
+                     std::move(p_on_data_callback), std::move(p_on_error_callback));
+}
+
+boost::leaf::result<std::unique_ptr<w_tcp_server_shards>> w_tcp_server_shards::make(
+    _In_ size_t p_shards, _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
+    _In_ std::chrono::steady_clock::duration p_timeout, _In_ w_socket_options p_socket_options,
+    _In_ w_session_on_pipelined_data_callback p_on_data_callback,
+    _In_ w_session_on_error_callback p_on_error_callback) noexcept {
+  return make_shards(p_shards, p_endpoint, p_timeout, std::move(p_socket_options),
+                     std::move(p_on_data_callback), std::move(p_on_error_callback));
+}
+
+w_tcp_server_shards::~w_tcp_server_shards() noexcept {
+  stop();
+  // join the threads before their io contexts go away
+  this->_threads.clear();
+}
+
+void w_tcp_server_shards::stop() noexcept {
+  for (auto &_io : this->_contexts) {
+    _io->stop();
+  }
+}
+
+size_t w_tcp_server_shards::get_shards_count() const noexcept {
+  return this->_contexts.size();
+}
+
 #endif // WOLF_SYSTEM_SOCKET
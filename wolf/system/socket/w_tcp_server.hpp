@@ -8,6 +8,9 @@
 
 #include <wolf/wolf.hpp>
 
+#include <thread>
+#include <vector>
+
 #include "w_socket_options.hpp"
 
 namespace wolf::system::socket {
@@ -29,6 +32,102 @@ class w_tcp_server {
       _In_ w_socket_options &&p_socket_options,
       _In_ w_session_on_data_callback p_on_data_callback,
       _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * run the server with pipelined sessions, each session reads and writes
+   * concurrently, the outbound frames of data callback are queued and sent
+   * with gathered writes
+   * @param p_io_context, the boost io context
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the timeout for connection
+   * @param p_socket_options, the socket options
+   * @param p_on_data_callback, on data callback for pipelined session
+   * @param p_on_error_callback, on error callback for session
+   * @returns void
+   */
+  W_API static boost::leaf::result<int> run(
+      _In_ boost::asio::io_context &p_io_context,
+      _In_ boost::asio::ip::tcp::endpoint &&p_endpoint,
+      _In_ std::chrono::steady_clock::duration &&p_timeout,
+      _In_ w_socket_options &&p_socket_options,
+      _In_ w_session_on_pipelined_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+};
+
+/*
+ * a tcp server which runs on several io contexts. each io context runs on
+ * its own thread which is pinned to a core and owns an acceptor with
+ * SO_REUSEPORT, so the kernel load-balances the incoming connections and a
+ * session never leaves the thread which accepted it.
+ * the callbacks are copied into each shard and will be called from the
+ * threads of shards concurrently.
+ */
+class w_tcp_server_shards {
+ public:
+  /*
+   * bind the acceptors and start the threads of shards
+   * @param p_shards, number of shards, zero means one shard per core
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the timeout for connection
+   * @param p_socket_options, the socket options
+   * @param p_on_data_callback, on data callback for session
+   * @param p_on_error_callback, on error callback for session
+   * @returns the running shards
+   */
+  W_API static boost::leaf::result<std::unique_ptr<w_tcp_server_shards>> make(
+      _In_ size_t p_shards, _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
+      _In_ std::chrono::steady_clock::duration p_timeout,
+      _In_ w_socket_options p_socket_options,
+      _In_ w_session_on_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  /*
+   * bind the acceptors and start the threads of shards with pipelined sessions
+   * @param p_shards, number of shards, zero means one shard per core
+   * @param p_endpoint, the endpoint of the server
+   * @param p_timeout, the timeout for connection
+   * @param p_socket_options, the socket options
+   * @param p_on_data_callback, on data callback for pipelined session
+   * @param p_on_error_callback, on error callback for session
+   * @returns the running shards
+   */
+  W_API static boost::leaf::result<std::unique_ptr<w_tcp_server_shards>> make(
+      _In_ size_t p_shards, _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
+      _In_ std::chrono::steady_clock::duration p_timeout,
+      _In_ w_socket_options p_socket_options,
+      _In_ w_session_on_pipelined_data_callback p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  // destructor, stops the shards and joins their threads
+  W_API virtual ~w_tcp_server_shards() noexcept;
+
+  // stop all io contexts of shards
+  W_API void stop() noexcept;
+
+  // returns number of shards
+  [[nodiscard]] W_API size_t get_shards_count() const noexcept;
+
+ private:
+  // default constructor
+  w_tcp_server_shards() noexcept = default;
+  // copy constructor
+  w_tcp_server_shards(const w_tcp_server_shards &) = delete;
+  // copy operator
+  w_tcp_server_shards &operator=(const w_tcp_server_shards &) = delete;
+  // move constructor
+  w_tcp_server_shards(w_tcp_server_shards &&) = delete;
+  // move operator
+  w_tcp_server_shards &operator=(w_tcp_server_shards &&) = delete;
+
+  template <typename T>
+  static boost::leaf::result<std::unique_ptr<w_tcp_server_shards>> make_shards(
+      _In_ size_t p_shards, _In_ const boost::asio::ip::tcp::endpoint &p_endpoint,
+      _In_ std::chrono::steady_clock::duration p_timeout,
+      _In_ w_socket_options p_socket_options, _In_ T p_on_data_callback,
+      _In_ w_session_on_error_callback p_on_error_callback) noexcept;
+
+  std::vector<std::unique_ptr<boost::asio::io_context>> _contexts;
+  std::vector<std::jthread> _threads;
 };
 }  // namespace wolf::system::socket
 #endif  // WOLF_SYSTEM_SOCKET
\ No newline at end of file
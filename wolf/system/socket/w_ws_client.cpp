@@ -3,6 +3,8 @@
 #include "w_ws_client.hpp"
 
 using w_ws_client = wolf::system::socket::w_ws_client;
+using w_pooled_buffer = wolf::system::w_pooled_buffer;
+using w_pooled_dynamic_buffer = wolf::system::socket::w_pooled_dynamic_buffer;
 using tcp = boost::asio::ip::tcp;
 
 w_ws_client::w_ws_client(boost::asio::io_context &p_io_context) noexcept
@@ -72,26 +74,27 @@ boost::asio::awaitable<void> w_ws_client::async_connect(
 }
 
 boost::asio::awaitable<size_t>
-w_ws_client::async_write(_In_ const w_buffer &p_buffer, _In_ bool p_is_binary) {
+w_ws_client::async_write(_In_ const w_pooled_buffer &p_buffer,
+                         _In_ bool p_is_binary) {
   if (p_is_binary) {
     this->_ws->binary(true);
   } else {
     this->_ws->text(true);
   }
-  co_await this->_ws->async_write(
-      boost::asio::const_buffer(p_buffer.buf.data(), p_buffer.used_bytes));
+  co_return co_await this->_ws->async_write(
+      boost::asio::const_buffer(p_buffer.data(), p_buffer.size()));
 }
 
 boost::asio::awaitable<size_t>
-w_ws_client::async_read(_Inout_ w_buffer &p_mut_buffer) {
-  boost::beast::flat_buffer _buffer = {};
-  co_await this->_ws->async_read(_buffer);
-
-  // an extra copy just for having a stable ABI
-  const auto _size = std::min(_buffer.cdata().size(), p_mut_buffer.buf.size());
-  std::memcpy(p_mut_buffer.buf.data(),
-              static_cast<char const *>(_buffer.cdata().data()), _size);
-  co_return _size;
+w_ws_client::async_read(_Inout_ w_pooled_buffer &p_mut_buffer) {
+  // never overwrite a storage which is shared with other owners
+  if (!p_mut_buffer.unique()) {
+    p_mut_buffer.reset();
+  }
+  p_mut_buffer.resize(0);
+
+  auto _dynamic_buffer = w_pooled_dynamic_buffer(p_mut_buffer);
+  co_return co_await this->_ws->async_read(_dynamic_buffer);
 }
 
 boost::asio::awaitable<size_t>
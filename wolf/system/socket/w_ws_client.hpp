@@ -57,16 +57,18 @@ public:
    * @returns a number of the written bytes
    */
   W_API
-  boost::asio::awaitable<size_t> async_write(_In_ const w_buffer &p_buffer,
-                                             _In_ bool p_is_binary);
+  boost::asio::awaitable<size_t>
+  async_write(_In_ const wolf::system::w_pooled_buffer &p_buffer,
+              _In_ bool p_is_binary);
 
   /*
-   * read from the websocket into the buffer
+   * read a message from the websocket straight into the buffer
    * @param p_mut_buffer, the destination buffer which will contain bytes
    * @returns a coroutine with number of read bytes
    */
   W_API
-  boost::asio::awaitable<size_t> async_read(_Inout_ w_buffer &p_mut_buffer);
+  boost::asio::awaitable<size_t>
+  async_read(_Inout_ wolf::system::w_pooled_buffer &p_mut_buffer);
 
   /*
    * read from the websocket into the buffer
@@ -6,6 +6,8 @@ using w_ws_server = wolf::system::socket::w_ws_server;
 using w_session_ws_on_data_callback = wolf::system::socket::w_session_ws_on_data_callback;
 using w_session_on_error_callback = wolf::system::socket::w_session_on_error_callback;
 using w_socket_options = wolf::system::socket::w_socket_options;
+using w_pooled_buffer = wolf::system::w_pooled_buffer;
+using w_pooled_dynamic_buffer = wolf::system::socket::w_pooled_dynamic_buffer;
 using io_context = boost::asio::io_context;
 using w_ws_stream = wolf::system::socket::w_ws_stream;
 using tcp = boost::asio::ip::tcp;
@@ -20,25 +22,25 @@ s_session(_In_ const boost::asio::io_context &p_io_context,
   // accept the websocket handshake
   co_await p_ws.async_accept();
 
-  w_buffer _mut_buffer = {};
-  // incoming message
-  boost::beast::flat_buffer _buffer;
+  // incoming message, read straight into the pooled storage
+  auto _buffer = w_pooled_buffer{};
 
   while (!p_io_context.stopped()) {
     try {
-      // This buffer will hold the incoming message
-      
-      // Read a message
-      _mut_buffer.used_bytes = co_await p_ws.async_read(_buffer);
+      // the callback may still own the last message, so take a new one
+      // from the pool instead of overwriting it
+      if (!_buffer.unique()) {
+        _buffer = w_pooled_buffer{};
+      }
+      _buffer.resize(0);
 
-      // an extra copy just for having stable ABI
-      const auto _size = std::min(_mut_buffer.buf.size(), _mut_buffer.used_bytes);
-      std::memcpy(_mut_buffer.buf.data(),
-                  static_cast<char const *>(_buffer.cdata().data()), _size);
+      // Read a message
+      auto _dynamic_buffer = w_pooled_dynamic_buffer(_buffer);
+      co_await p_ws.async_read(_dynamic_buffer);
 
       // call callback
       auto _is_binary = p_ws.got_binary();
-      const auto _code = p_on_data_callback(p_conn_id, _mut_buffer, _is_binary);
+      const auto _code = p_on_data_callback(p_conn_id, _buffer, _is_binary);
       if (_code != boost::beast::websocket::close_code::none) {
         break;
       }
@@ -50,7 +52,7 @@ s_session(_In_ const boost::asio::io_context &p_io_context,
         p_ws.text(true);
       }
       co_await p_ws.async_write(
-          boost::asio::buffer(_mut_buffer.buf, _mut_buffer.used_bytes));
+          boost::asio::buffer(_buffer.data(), _buffer.size()));
 
     } catch (const boost::system::system_error &p_exc) {
       if (p_exc.code() != boost::beast::websocket::error::closed) {
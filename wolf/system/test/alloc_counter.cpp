@@ -0,0 +1,98 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// every heap allocation of c++ code is counted, the allocations of c libraries
+// like av_malloc of ffmpeg are not
+
+static std::atomic<uint64_t> s_alloc_count = 0;
+static std::atomic<uint64_t> s_alloc_bytes = 0;
+
+uint64_t get_test_alloc_count() noexcept { return s_alloc_count.load(std::memory_order_relaxed); }
+
+uint64_t get_test_alloc_bytes() noexcept { return s_alloc_bytes.load(std::memory_order_relaxed); }
+
+static void *s_alloc(size_t p_size) noexcept {
+  s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  s_alloc_bytes.fetch_add(p_size, std::memory_order_relaxed);
+  return std::malloc(p_size == 0 ? 1 : p_size);
+}
+
+static void *s_alloc_aligned(size_t p_size, std::align_val_t p_align) noexcept {
+  s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  s_alloc_bytes.fetch_add(p_size, std::memory_order_relaxed);
+
+  const auto _align = static_cast<size_t>(p_align);
+#ifdef _WIN32
+  return _aligned_malloc(p_size == 0 ? 1 : p_size, _align);
+#else
+  // aligned_alloc needs a size which is a multiple of the alignment
+  const auto _size = (p_size + _align - 1) / _align * _align;
+  return std::aligned_alloc(_align, _size == 0 ? _align : _size);
+#endif
+}
+
+static void s_free_aligned(void *p_ptr) noexcept {
+#ifdef _WIN32
+  _aligned_free(p_ptr);
+#else
+  std::free(p_ptr);
+#endif
+}
+
+void *operator new(size_t p_size) {
+  if (auto *_ptr = s_alloc(p_size)) {
+    return _ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t p_size) { return ::operator new(p_size); }
+
+void *operator new(size_t p_size, const std::nothrow_t &) noexcept { return s_alloc(p_size); }
+
+void *operator new[](size_t p_size, const std::nothrow_t &) noexcept { return s_alloc(p_size); }
+
+void *operator new(size_t p_size, std::align_val_t p_align) {
+  if (auto *_ptr = s_alloc_aligned(p_size, p_align)) {
+    return _ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t p_size, std::align_val_t p_align) {
+  return ::operator new(p_size, p_align);
+}
+
+void *operator new(size_t p_size, std::align_val_t p_align, const std::nothrow_t &) noexcept {
+  return s_alloc_aligned(p_size, p_align);
+}
+
+void *operator new[](size_t p_size, std::align_val_t p_align, const std::nothrow_t &) noexcept {
+  return s_alloc_aligned(p_size, p_align);
+}
+
+void operator delete(void *p_ptr) noexcept { std::free(p_ptr); }
+void operator delete[](void *p_ptr) noexcept { std::free(p_ptr); }
+void operator delete(void *p_ptr, size_t) noexcept { std::free(p_ptr); }
+void operator delete[](void *p_ptr, size_t) noexcept { std::free(p_ptr); }
+void operator delete(void *p_ptr, const std::nothrow_t &) noexcept { std::free(p_ptr); }
+void operator delete[](void *p_ptr, const std::nothrow_t &) noexcept { std::free(p_ptr); }
+
+void operator delete(void *p_ptr, std::align_val_t) noexcept { s_free_aligned(p_ptr); }
+void operator delete[](void *p_ptr, std::align_val_t) noexcept { s_free_aligned(p_ptr); }
+void operator delete(void *p_ptr, size_t, std::align_val_t) noexcept { s_free_aligned(p_ptr); }
+void operator delete[](void *p_ptr, size_t, std::align_val_t) noexcept { s_free_aligned(p_ptr); }
+void operator delete(void *p_ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  s_free_aligned(p_ptr);
+}
+void operator delete[](void *p_ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  s_free_aligned(p_ptr);
+}
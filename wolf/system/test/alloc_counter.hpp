@@ -0,0 +1,19 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#include <cstdint>
+
+// counts the heap allocations of the test and bench executables, they read it
+// before and after a run to report allocations per operation. the global
+// operator new/delete replacements live in alloc_counter.cpp, which is only
+// linked into those executables.
+
+// returns the number of heap allocations so far
+uint64_t get_test_alloc_count() noexcept;
+
+// returns the number of bytes requested by heap allocations so far
+uint64_t get_test_alloc_bytes() noexcept;
@@ -8,9 +8,142 @@
 #include <boost/test/included/unit_test.hpp>
 #include <system/compression/w_lz4.hpp>
 #include <system/compression/w_lzma.hpp>
+#include <system/compression/w_zlib.hpp>
+#include <system/compression/w_zstd.hpp>
 #include <system/w_leak_detector.hpp>
 #include <wolf/wolf.hpp>
 
+#include <cmath>
+#include <random>
+#include <thread>
+
+#include "alloc_counter.hpp"
+
+// a text corpus which compresses like logs and configs
+static std::vector<std::byte> s_make_text_corpus(_In_ size_t p_size) {
+  constexpr std::array<std::string_view, 8> _words = {
+      "wolf", "engine", "frame", "packet", "stream", "render", "audio", "video"};
+
+  std::vector<std::byte> _corpus;
+  _corpus.reserve(p_size);
+  auto _rand = std::minstd_rand(7);
+  while (_corpus.size() < p_size) {
+    const auto _line = wolf::format("{{\"id\":{},\"name\":\"{}\",\"value\":{}}}\n",
+                                    _rand() % 100000, _words.at(_rand() % _words.size()),
+                                    _rand() % 1000);
+    for (const auto _char : _line) {
+      _corpus.push_back(static_cast<std::byte>(_char));
+    }
+  }
+  _corpus.resize(p_size);
+  return _corpus;
+}
+
+// a binary corpus which compresses like game assets: the vertices and
+// indices of a terrain mesh followed by a noisy texture
+static std::vector<std::byte> s_make_asset_corpus(_In_ size_t p_size) {
+  std::vector<std::byte> _corpus;
+  _corpus.reserve(p_size);
+  const auto _append = [&](const auto &p_value) {
+    const auto *_ptr = reinterpret_cast<const std::byte *>(&p_value);
+    _corpus.insert(_corpus.end(), _ptr, _ptr + sizeof(p_value));
+  };
+
+  auto _rand = std::minstd_rand(13);
+  constexpr uint16_t _grid = 128;
+  while (_corpus.size() < p_size) {
+    // position, normal and uv of each vertex
+    for (uint16_t y = 0; y < _grid && _corpus.size() < p_size / 2; ++y) {
+      for (uint16_t x = 0; x < _grid; ++x) {
+        const auto _height = std::sin(x * 0.05F) * std::cos(y * 0.05F) * 10.0F;
+        _append(std::array<float, 8>{float(x), _height, float(y), 0.0F, 1.0F, 0.0F,
+                                     float(x) / _grid, float(y) / _grid});
+      }
+    }
+    // the triangles
+    for (uint16_t i = 0; i + _grid + 1 < _grid * 8; ++i) {
+      _append(std::array<uint16_t, 6>{i, uint16_t(i + _grid), uint16_t(i + 1), uint16_t(i + 1),
+                                      uint16_t(i + _grid), uint16_t(i + _grid + 1)});
+    }
+    // an rgba texture with a gradient and noise
+    for (uint32_t i = 0; i < 64 * 1024 && _corpus.size() < p_size; ++i) {
+      const auto _noise = static_cast<uint8_t>(_rand() & 0x0F);
+      _append(std::array<uint8_t, 4>{uint8_t((i & 0xFF) + _noise), uint8_t((i >> 8) + _noise),
+                                     _noise, 0xFF});
+    }
+  }
+  _corpus.resize(p_size);
+  return _corpus;
+}
+
+// a binary corpus which compresses like the side data of video frames:
+// timestamps, sizes, flags and quantizers of each frame
+static std::vector<std::byte> s_make_side_data_corpus(_In_ size_t p_size) {
+  struct w_side_data {
+    uint64_t pts;
+    uint64_t dts;
+    uint32_t size;
+    uint16_t flags;
+    uint8_t qp;
+    uint8_t slices;
+    std::array<int16_t, 8> motion;
+  };
+
+  std::vector<std::byte> _corpus;
+  _corpus.reserve(p_size);
+  auto _rand = std::minstd_rand(17);
+  for (uint64_t _frame = 0; _corpus.size() < p_size; ++_frame) {
+    w_side_data _data = {};
+    _data.pts = _frame * 3000;
+    _data.dts = _data.pts > 6000 ? _data.pts - 6000 : 0;
+    _data.size = _frame % 60 == 0 ? 90000 + _rand() % 10000 : 12000 + _rand() % 4000;
+    _data.flags = _frame % 60 == 0 ? 1 : 0;
+    _data.qp = static_cast<uint8_t>(22 + _rand() % 6);
+    _data.slices = 4;
+    for (auto &_motion : _data.motion) {
+      _motion = static_cast<int16_t>(static_cast<int>(_rand() % 9) - 4);
+    }
+    const auto *_ptr = reinterpret_cast<const std::byte *>(&_data);
+    _corpus.insert(_corpus.end(), _ptr, _ptr + sizeof(_data));
+  }
+  _corpus.resize(p_size);
+  return _corpus;
+}
+
+// compress in chunks and decompress in chunks with a streaming codec
+template <wolf::system::compression::w_stream_compressor T>
+static boost::leaf::result<std::vector<std::byte>> s_stream_round_trip(
+    _Inout_ T &p_codec, _In_ gsl::span<const std::byte> p_src, _In_ size_t p_chunk_size) {
+  std::vector<std::byte> _frame;
+  auto _out = std::array<std::byte, 4096>{};
+
+  for (size_t _offset = 0; _offset < p_src.size();) {
+    const auto _chunk =
+        p_src.subspan(_offset, std::min(p_chunk_size, p_src.size() - _offset));
+    BOOST_LEAF_AUTO(_progress, p_codec.compress_update(_chunk, _out));
+    _frame.insert(_frame.end(), _out.begin(), _out.begin() + _progress.produced);
+    _offset += _progress.consumed;
+  }
+  for (bool _done = false; !_done;) {
+    BOOST_LEAF_AUTO(_progress, p_codec.compress_end(_out));
+    _frame.insert(_frame.end(), _out.begin(), _out.begin() + _progress.produced);
+    _done = _progress.done;
+  }
+
+  std::vector<std::byte> _dst;
+  size_t _consumed = 0;
+  for (bool _done = false; !_done;) {
+    const auto _in = gsl::span<const std::byte>(_frame).subspan(
+        _consumed, std::min(p_chunk_size, _frame.size() - _consumed));
+    BOOST_LEAF_AUTO(_progress, p_codec.decompress_update(_in, _out));
+    _consumed += _progress.consumed;
+    _dst.insert(_dst.end(), _out.begin(), _out.begin() + _progress.produced);
+    _done = _progress.done;
+  }
+  BOOST_REQUIRE(_consumed == _frame.size());
+  return _dst;
+}
+
 #ifdef WOLF_SYSTEM_LZ4
 
 BOOST_AUTO_TEST_CASE(compress_lz4_test) {
@@ -58,6 +191,424 @@ BOOST_AUTO_TEST_CASE(compress_lz4_test) {
   std::cout << "leaving test case 'compress_lz4_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(compress_lz4_stream_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_lz4_stream_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4_stream = wolf::system::compression::w_lz4_stream;
+
+        const auto _src = s_make_text_corpus(300 * 1024);
+
+        for (const auto _level : {0, 9}) {
+          BOOST_LEAF_AUTO(_stream, w_lz4_stream::make(_level));
+
+          // whole frames, the same contexts are used twice
+          for (auto i = 0; i < 2; ++i) {
+            BOOST_LEAF_AUTO(_frame, _stream.compress(_src));
+            BOOST_LEAF_AUTO(_content_size, _stream.get_content_size(_frame));
+            BOOST_REQUIRE(_content_size == _src.size());
+
+            BOOST_LEAF_AUTO(_dst, _stream.decompress(_frame));
+            BOOST_REQUIRE(_dst == _src);
+          }
+
+          // chunked compression without content size, into one span
+          auto _frame = std::vector<std::byte>(_stream.get_compress_bound(_src.size()) +
+                                               _src.size() / 1000 * 64);
+          BOOST_LEAF_AUTO(_frame_size, _stream.compress_begin(_frame));
+          for (size_t _offset = 0; _offset < _src.size(); _offset += 1000) {
+            const auto _chunk = gsl::span(_src).subspan(
+                _offset, std::min<size_t>(1000, _src.size() - _offset));
+            BOOST_LEAF_AUTO(_size, _stream.compress_update(
+                                       _chunk, gsl::span(_frame).subspan(_frame_size)));
+            _frame_size += _size;
+          }
+          BOOST_LEAF_AUTO(_end_size, _stream.compress_end(gsl::span(_frame).subspan(_frame_size)));
+          _frame_size += _end_size;
+          _frame.resize(_frame_size);
+
+          BOOST_LEAF_AUTO(_content_size, _stream.get_content_size(_frame));
+          BOOST_REQUIRE(_content_size == 0);
+
+          // chunked decompression into a small output span
+          auto _dst = std::vector<std::byte>();
+          auto _out = std::array<std::byte, 4096>{};
+          size_t _consumed = 0;
+          for (bool _done = false; !_done;) {
+            const auto _in = gsl::span(_frame).subspan(
+                _consumed, std::min<size_t>(777, _frame.size() - _consumed));
+            BOOST_LEAF_AUTO(_progress, _stream.decompress_update(_in, _out));
+            _consumed += _progress.consumed;
+            _dst.insert(_dst.end(), _out.begin(), _out.begin() + _progress.produced);
+            _done = _progress.done;
+          }
+          BOOST_REQUIRE(_consumed == _frame.size());
+          BOOST_REQUIRE(_dst == _src);
+        }
+
+        // a corrupted frame must fail and must not break the next one
+        BOOST_LEAF_AUTO(_stream, w_lz4_stream::make());
+        BOOST_LEAF_AUTO(_frame, _stream.compress(_src));
+        auto _corrupted = _frame;
+        _corrupted.resize(_corrupted.size() / 2);
+        auto _dst = std::vector<std::byte>(_src.size());
+        BOOST_REQUIRE(!_stream.decompress(_corrupted, _dst));
+        BOOST_LEAF_AUTO(_size, _stream.decompress(_frame, _dst));
+        BOOST_REQUIRE(_size == _src.size());
+
+        // a forged content size must not make the output allocate it
+        {
+          const auto _tiny = std::array{std::byte{'w'}, std::byte{'o'}, std::byte{'l'},
+                                        std::byte{'f'}};
+          BOOST_LEAF_AUTO(_forged, _stream.compress(_tiny));
+          // the content size follows the magic number, FLG and BD
+          std::fill(_forged.begin() + 6, _forged.begin() + 14, std::byte{0});
+          _forged[10] = std::byte{0x01};
+          BOOST_LEAF_AUTO(_forged_size, _stream.get_content_size(_forged));
+          BOOST_REQUIRE(_forged_size == 4ull * 1024 * 1024 * 1024);
+
+          const auto _bytes = get_test_alloc_bytes();
+          BOOST_REQUIRE(!_stream.decompress(_forged));
+          BOOST_REQUIRE(get_test_alloc_bytes() - _bytes < 1024 * 1024);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_lz4_stream_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_stream_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_stream_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_lz4_stream_dictionary_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_lz4_stream_dictionary_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4_stream = wolf::system::compression::w_lz4_stream;
+
+        // the dictionary is a sample of the messages
+        const auto _dictionary = s_make_text_corpus(16 * 1024);
+
+        if (!w_lz4_stream::has_dictionary_support()) {
+          BOOST_REQUIRE(!w_lz4_stream::make(0, _dictionary));
+          std::cout << "lz4 dictionaries are not supported by the linked lz4" << std::endl;
+          return {};
+        }
+        const auto _messages = s_make_text_corpus(64 * 1024);
+
+        BOOST_LEAF_AUTO(_plain, w_lz4_stream::make());
+        BOOST_LEAF_AUTO(_primed, w_lz4_stream::make(0, _dictionary));
+
+        size_t _plain_size = 0;
+        size_t _primed_size = 0;
+        for (size_t _offset = 0; _offset + 256 <= _messages.size(); _offset += 256) {
+          const auto _msg = gsl::span(_messages).subspan(_offset, 256);
+
+          BOOST_LEAF_AUTO(_plain_frame, _plain.compress(_msg));
+          BOOST_LEAF_AUTO(_primed_frame, _primed.compress(_msg));
+          _plain_size += _plain_frame.size();
+          _primed_size += _primed_frame.size();
+
+          BOOST_LEAF_AUTO(_dst, _primed.decompress(_primed_frame));
+          BOOST_REQUIRE(std::equal(_dst.begin(), _dst.end(), _msg.begin(), _msg.end()));
+        }
+
+        std::cout << wolf::format("256 bytes messages: {} bytes without, {} bytes with dictionary",
+                                  _plain_size, _primed_size)
+                  << std::endl;
+        BOOST_REQUIRE(_primed_size < _plain_size);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_lz4_stream_dictionary_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_stream_dictionary_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_stream_dictionary_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_lz4_stream_benchmark) {
+  std::cout << "entering test case 'compress_lz4_stream_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4 = wolf::system::compression::w_lz4;
+        using w_lz4_stream = wolf::system::compression::w_lz4_stream;
+        using clock = std::chrono::steady_clock;
+
+        BOOST_LEAF_AUTO(_stream, w_lz4_stream::make());
+
+        for (const size_t _size : {1024, 64 * 1024, 4 * 1024 * 1024}) {
+          const auto _src = s_make_text_corpus(_size);
+          const auto _iterations = std::max<size_t>(4, 64 * 1024 * 1024 / _size);
+
+          const auto _report = [&](const char *p_name, clock::duration p_compress,
+                                   clock::duration p_decompress, uint64_t p_allocs) {
+            const auto _mb = static_cast<double>(_size * _iterations) / (1024.0 * 1024.0);
+            std::cout << wolf::format(
+                             "{:<12} | {:>8} bytes | compress {:>8.1f} MB/s | decompress "
+                             "{:>8.1f} MB/s | {:>5.2f} allocs/op",
+                             p_name, _size,
+                             _mb / std::chrono::duration<double>(p_compress).count(),
+                             _mb / std::chrono::duration<double>(p_decompress).count(),
+                             static_cast<double>(p_allocs) / (2.0 * _iterations))
+                      << std::endl;
+          };
+
+          // the one-shot functions
+          {
+            auto _allocs = get_test_alloc_count();
+            auto _start = clock::now();
+            std::vector<std::byte> _compressed;
+            for (size_t i = 0; i < _iterations; ++i) {
+              BOOST_LEAF_ASSIGN(_compressed, w_lz4::compress_default(_src));
+            }
+            const auto _compress = clock::now() - _start;
+
+            _start = clock::now();
+            for (size_t i = 0; i < _iterations; ++i) {
+              BOOST_LEAF_AUTO(_dst, w_lz4::decompress(_compressed, 16));
+              BOOST_REQUIRE(_dst.size() == _src.size());
+            }
+            const auto _decompress = clock::now() - _start;
+            _report("w_lz4", _compress, _decompress, get_test_alloc_count() - _allocs);
+          }
+
+          // the stream with vectors
+          {
+            auto _allocs = get_test_alloc_count();
+            auto _start = clock::now();
+            std::vector<std::byte> _compressed;
+            for (size_t i = 0; i < _iterations; ++i) {
+              BOOST_LEAF_ASSIGN(_compressed, _stream.compress(_src));
+            }
+            const auto _compress = clock::now() - _start;
+
+            _start = clock::now();
+            for (size_t i = 0; i < _iterations; ++i) {
+              BOOST_LEAF_AUTO(_dst, _stream.decompress(_compressed));
+              BOOST_REQUIRE(_dst.size() == _src.size());
+            }
+            const auto _decompress = clock::now() - _start;
+            _report("w_lz4_stream", _compress, _decompress, get_test_alloc_count() - _allocs);
+          }
+
+          // the stream with the caller's spans
+          {
+            auto _compressed = std::vector<std::byte>(_stream.get_compress_bound(_size));
+            auto _dst = std::vector<std::byte>(_size);
+
+            auto _allocs = get_test_alloc_count();
+            auto _start = clock::now();
+            size_t _compressed_size = 0;
+            for (size_t i = 0; i < _iterations; ++i) {
+              BOOST_LEAF_ASSIGN(_compressed_size, _stream.compress(_src, _compressed));
+            }
+            const auto _compress = clock::now() - _start;
+
+            _start = clock::now();
+            for (size_t i = 0; i < _iterations; ++i) {
+              BOOST_LEAF_AUTO(_dst_size, _stream.decompress(
+                                             gsl::span(_compressed).first(_compressed_size),
+                                             _dst));
+              BOOST_REQUIRE(_dst_size == _src.size());
+            }
+            const auto _decompress = clock::now() - _start;
+            _report("spans", _compress, _decompress, get_test_alloc_count() - _allocs);
+          }
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_lz4_stream_benchmark got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_stream_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_stream_benchmark'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_lz4_blocks_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_lz4_blocks_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4_blocks = wolf::system::compression::w_lz4_blocks;
+
+        constexpr size_t _block_size = 64 * 1024;
+
+        // a compressible text followed by an incompressible noise, the last
+        // block is not full
+        auto _src = s_make_text_corpus(1024 * 1024);
+        auto _rand = std::minstd_rand(11);
+        for (size_t i = 0; i < 300 * 1024; ++i) {
+          _src.push_back(static_cast<std::byte>(_rand() & 0xFF));
+        }
+
+        BOOST_LEAF_AUTO(_blocks, w_lz4_blocks::make(_block_size, 4));
+        BOOST_REQUIRE(_blocks.get_concurrency() == 4);
+
+        BOOST_LEAF_AUTO(_container, _blocks.compress(_src));
+        BOOST_REQUIRE(_container.size() < _src.size());
+
+        BOOST_LEAF_AUTO(_index, w_lz4_blocks::read_index(_container));
+        BOOST_REQUIRE(_index.content_size == _src.size());
+        BOOST_REQUIRE(_index.blocks.size() == (_src.size() + _block_size - 1) / _block_size);
+        BOOST_REQUIRE(!_index.blocks.front().stored);
+        BOOST_REQUIRE(_index.blocks.back().stored);
+
+        // the parallel decompression
+        BOOST_LEAF_AUTO(_dst, _blocks.decompress(_container));
+        BOOST_REQUIRE(_dst == _src);
+
+        // the random reads of single blocks
+        auto _block = std::vector<std::byte>(_block_size);
+        for (const size_t _block_index : {size_t(7), size_t(0), _index.blocks.size() - 1}) {
+          BOOST_LEAF_AUTO(_size, w_lz4_blocks::decompress_block(_container, _index,
+                                                                _block_index, _block));
+          BOOST_REQUIRE(_size == _index.get_block_content_size(_block_index));
+          BOOST_REQUIRE(std::equal(_block.begin(), _block.begin() + _size,
+                                   _src.begin() + _block_index * _block_size));
+        }
+
+        // a single thread must produce the same container
+        BOOST_LEAF_AUTO(_serial, w_lz4_blocks::make(_block_size, 1));
+        BOOST_LEAF_AUTO(_serial_container, _serial.compress(_src));
+        BOOST_REQUIRE(_serial_container == _container);
+
+        // the empty source
+        BOOST_LEAF_AUTO(_empty, _blocks.compress({}));
+        BOOST_REQUIRE(_empty.size() == w_lz4_blocks::HEADER_SIZE);
+        BOOST_LEAF_AUTO(_empty_dst, _blocks.decompress(_empty));
+        BOOST_REQUIRE(_empty_dst.empty());
+
+        // the truncated and corrupted containers must fail
+        auto _truncated = _container;
+        _truncated.resize(_truncated.size() - 1);
+        BOOST_REQUIRE(!w_lz4_blocks::read_index(_truncated));
+
+        auto _corrupted = _container;
+        const auto &_first = _index.blocks.front();
+        for (size_t i = 0; i < 64; ++i) {
+          _corrupted[_first.offset + i] = std::byte{0xFF};
+        }
+        BOOST_REQUIRE(!_blocks.decompress(_corrupted, _dst));
+
+        // a content size near UINT64_MAX must not round up to zero blocks
+        auto _overflowed = _empty;
+        std::fill(_overflowed.begin() + 16, _overflowed.begin() + 24, std::byte{0xFF});
+        _overflowed[16] = std::byte{0xF5};
+        BOOST_REQUIRE(!w_lz4_blocks::read_index(_overflowed));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_lz4_blocks_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_blocks_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_blocks_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_lz4_blocks_benchmark) {
+  std::cout << "entering test case 'compress_lz4_blocks_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lz4 = wolf::system::compression::w_lz4;
+        using w_lz4_blocks = wolf::system::compression::w_lz4_blocks;
+        using clock = std::chrono::steady_clock;
+
+        constexpr size_t _iterations = 4;
+        const auto _src = s_make_text_corpus(128 * 1024 * 1024);
+        const auto _mb = static_cast<double>(_src.size() * _iterations) / (1024.0 * 1024.0);
+
+        // the baseline on the calling thread
+        {
+          auto _start = clock::now();
+          std::vector<std::byte> _compressed;
+          for (size_t i = 0; i < _iterations; ++i) {
+            BOOST_LEAF_ASSIGN(_compressed, w_lz4::compress_default(_src));
+          }
+          const auto _compress = std::chrono::duration<double>(clock::now() - _start).count();
+          std::cout << wolf::format("w_lz4        |          | compress {:>8.1f} MB/s | ratio {:.3f}",
+                                    _mb / _compress,
+                                    static_cast<double>(_compressed.size()) / _src.size())
+                    << std::endl;
+        }
+
+        const auto _cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        double _single_compress = 0.0;
+        double _single_decompress = 0.0;
+        // 1, 2, 4, ... and all the cores
+        std::vector<size_t> _concurrencies;
+        for (size_t _threads = 1; _threads < _cores; _threads *= 2) {
+          _concurrencies.push_back(_threads);
+        }
+        _concurrencies.push_back(_cores);
+
+        for (const auto _threads : _concurrencies) {
+          BOOST_LEAF_AUTO(_blocks, w_lz4_blocks::make(1024 * 1024, _threads));
+
+          auto _start = clock::now();
+          std::vector<std::byte> _container;
+          for (size_t i = 0; i < _iterations; ++i) {
+            BOOST_LEAF_ASSIGN(_container, _blocks.compress(_src));
+          }
+          const auto _compress = std::chrono::duration<double>(clock::now() - _start).count();
+
+          auto _dst = std::vector<std::byte>(_src.size());
+          _start = clock::now();
+          for (size_t i = 0; i < _iterations; ++i) {
+            BOOST_LEAF_AUTO(_size, _blocks.decompress(_container, _dst));
+            BOOST_REQUIRE(_size == _src.size());
+          }
+          const auto _decompress = std::chrono::duration<double>(clock::now() - _start).count();
+
+          if (_threads == 1) {
+            _single_compress = _compress;
+            _single_decompress = _decompress;
+          }
+          std::cout << wolf::format(
+                           "w_lz4_blocks | {:>2} cores | compress {:>8.1f} MB/s ({:>4.1f}x) | "
+                           "decompress {:>8.1f} MB/s ({:>4.1f}x) | ratio {:.3f}",
+                           _threads, _mb / _compress, _single_compress / _compress,
+                           _mb / _decompress, _single_decompress / _decompress,
+                           static_cast<double>(_container.size()) / _src.size())
+                    << std::endl;
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_lz4_blocks_benchmark got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lz4_blocks_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'compress_lz4_blocks_benchmark'" << std::endl;
+}
+
 #endif  // WOLF_SYSTEM_LZ4
 
 #ifdef WOLF_SYSTEM_LZMA
@@ -90,6 +641,11 @@ BOOST_AUTO_TEST_CASE(compress_lzma_test) {
         BOOST_LEAF_AUTO(_decompress_lzm2,
                         lzma::decompress_lzma2(_compress_lzm2));
 
+        BOOST_REQUIRE(std::equal(_decompress_lzm1.begin(), _decompress_lzm1.end(),
+                                 _bytes.begin(), _bytes.end()));
+        BOOST_REQUIRE(std::equal(_decompress_lzm2.begin(), _decompress_lzm2.end(),
+                                 _bytes.begin(), _bytes.end()));
+
         return {};
       },
       [](const w_trace &p_trace) {
@@ -102,6 +658,416 @@ BOOST_AUTO_TEST_CASE(compress_lzma_test) {
   std::cout << "leaving test case 'compress_lzma_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(compress_lzma2_decoder_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_lzma2_decoder_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_lzma = wolf::system::compression::w_lzma;
+        using w_lzma2_decoder = wolf::system::compression::w_lzma2_decoder;
+        using w_lzma_pooled_allocator = wolf::system::compression::w_lzma_pooled_allocator;
+
+        auto _allocator = w_lzma_pooled_allocator();
+
+        const auto _src = s_make_text_corpus(2 * 1024 * 1024);
+        BOOST_LEAF_AUTO(_compressed, w_lzma::compress_lzma2(_src, 5, &_allocator));
+
+        // 1 byte properties and the 8 bytes little-endian size of source
+        uint64_t _header_size = 0;
+        for (size_t i = 0; i < sizeof(_header_size); ++i) {
+          _header_size |= std::to_integer<uint64_t>(_compressed[1 + i]) << (i * 8);
+        }
+        BOOST_REQUIRE(_header_size == _src.size());
+
+        // the one-shot function is built on the decoder
+        BOOST_LEAF_AUTO(_one_shot, w_lzma::decompress_lzma2(_compressed, &_allocator));
+        BOOST_REQUIRE(_one_shot == _src);
+
+        BOOST_LEAF_AUTO(_decoder, w_lzma2_decoder::make(&_allocator));
+
+        // small input chunks into a small output span
+        {
+          std::vector<std::byte> _dst;
+          auto _out = std::array<std::byte, 4096>{};
+          size_t _consumed = 0;
+          for (bool _done = false; !_done;) {
+            const auto _in = gsl::span<const std::byte>(_compressed)
+                                 .subspan(_consumed, std::min<size_t>(
+                                                         777, _compressed.size() - _consumed));
+            BOOST_LEAF_AUTO(_progress, _decoder.decode(_in, _out));
+            BOOST_REQUIRE(_progress.consumed != 0 || _progress.produced != 0 ||
+                          _progress.done);
+            _consumed += _progress.consumed;
+            _dst.insert(_dst.end(), _out.begin(), _out.begin() + _progress.produced);
+            _done = _progress.done;
+          }
+          BOOST_LEAF_AUTO(_content_size, _decoder.get_content_size());
+          BOOST_REQUIRE(_content_size == _src.size());
+          BOOST_REQUIRE(_dst == _src);
+        }
+
+        // the same decoder, the output goes to a sink without any copy into
+        // an output buffer
+        BOOST_LEAF_CHECK(_decoder.reset());
+        {
+          const auto _before = _allocator.get_stats();
+          size_t _offset = 0;
+          bool _matched = true;
+          const auto _sink =
+              [&](gsl::span<const std::byte> p_chunk) -> boost::leaf::result<void> {
+            _matched = _matched && std::equal(p_chunk.begin(), p_chunk.end(),
+                                              _src.begin() + _offset);
+            _offset += p_chunk.size();
+            return {};
+          };
+          size_t _consumed = 0;
+          for (bool _done = false; !_done;) {
+            const auto _in = gsl::span<const std::byte>(_compressed)
+                                 .subspan(_consumed, std::min<size_t>(
+                                                         64 * 1024, _compressed.size() - _consumed));
+            BOOST_LEAF_AUTO(_progress, _decoder.decode(_in, _sink));
+            _consumed += _progress.consumed;
+            _done = _progress.done;
+          }
+          BOOST_REQUIRE(_matched);
+          BOOST_REQUIRE(_offset == _src.size());
+
+          // the dictionary of the first stream was reused
+          const auto _after = _allocator.get_stats();
+          BOOST_REQUIRE(_after.allocations == _before.allocations);
+        }
+
+        // a failing sink stops the decoding, a corrupted stream fails
+        BOOST_LEAF_CHECK(_decoder.reset());
+        const auto _failing_sink = [](gsl::span<const std::byte>) -> boost::leaf::result<void> {
+          return W_FAILURE(std::errc::no_space_on_device, "the disk is full");
+        };
+        BOOST_REQUIRE(!_decoder.decode(_compressed, _failing_sink));
+
+        auto _corrupted = _compressed;
+        for (size_t i = _corrupted.size() / 2; i < _corrupted.size() / 2 + 64; ++i) {
+          _corrupted[i] ^= std::byte{0x5A};
+        }
+        BOOST_LEAF_CHECK(_decoder.reset());
+        auto _dst = std::vector<std::byte>(_src.size());
+        BOOST_REQUIRE(!_decoder.decode(_corrupted, _dst));
+
+        // a moved-from decoder fails instead of dereferencing its state
+        auto _moved = std::move(_decoder);
+        BOOST_REQUIRE(!_decoder.decode(_compressed, _dst));
+        BOOST_REQUIRE(!_decoder.decode(_compressed, _failing_sink));
+        BOOST_REQUIRE(!_decoder.get_content_size());
+        BOOST_REQUIRE(!_decoder.reset());
+        BOOST_LEAF_CHECK(_moved.reset());
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_lzma2_decoder_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_lzma2_decoder_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_lzma2_decoder_test'" << std::endl;
+}
+
 #endif  // WOLF_SYSTEM_LZMA
 
-#endif  // WOLF_TESTS
\ No newline at end of file
+#ifdef WOLF_SYSTEM_ZLIB
+
+BOOST_AUTO_TEST_CASE(compress_zlib_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_zlib_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_zlib = wolf::system::compression::w_zlib;
+        using w_zlib_format = wolf::system::compression::w_zlib_format;
+
+        const auto _src = s_make_text_corpus(300 * 1024);
+
+        for (const auto _format :
+             {w_zlib_format::deflate, w_zlib_format::zlib, w_zlib_format::gzip}) {
+          BOOST_LEAF_AUTO(_codec, w_zlib::make(6, _format));
+
+          // whole streams, the same contexts are used twice
+          for (auto i = 0; i < 2; ++i) {
+            BOOST_LEAF_AUTO(_compressed, _codec.compress(_src));
+            BOOST_REQUIRE(_compressed.size() < _src.size() / 2);
+            BOOST_LEAF_AUTO(_dst, _codec.decompress(_compressed));
+            BOOST_REQUIRE(_dst == _src);
+          }
+
+          // chunked streams
+          BOOST_LEAF_AUTO(_dst, s_stream_round_trip(_codec, _src, 1000));
+          BOOST_REQUIRE(_dst == _src);
+        }
+
+        // a gzip stream must be readable by a codec of another level, and a
+        // corrupted one must fail without breaking the next one
+        BOOST_LEAF_AUTO(_fast, w_zlib::make(1));
+        BOOST_LEAF_AUTO(_best, w_zlib::make(9));
+        BOOST_LEAF_AUTO(_compressed, _fast.compress(_src));
+        auto _corrupted = _compressed;
+        _corrupted[_corrupted.size() / 2] ^= std::byte{0xFF};
+        auto _dst = std::vector<std::byte>(_src.size());
+        BOOST_REQUIRE(!_best.decompress(_corrupted, _dst));
+        BOOST_LEAF_AUTO(_size, _best.decompress(_compressed, _dst));
+        BOOST_REQUIRE(_size == _src.size());
+
+        // a forged gzip trailer must not make the output allocate its size
+        {
+          const auto _tiny = std::array{std::byte{'w'}, std::byte{'o'}, std::byte{'l'},
+                                        std::byte{'f'}};
+          BOOST_LEAF_AUTO(_forged, _fast.compress(_tiny));
+          std::fill(_forged.end() - 4, _forged.end(), std::byte{0xFF});
+
+          const auto _bytes = get_test_alloc_bytes();
+          BOOST_REQUIRE(!_best.decompress(_forged));
+          BOOST_REQUIRE(get_test_alloc_bytes() - _bytes < 1024 * 1024);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_zlib_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_zlib_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_zlib_test'" << std::endl;
+}
+
+#endif  // WOLF_SYSTEM_ZLIB
+
+#ifdef WOLF_SYSTEM_ZSTD
+
+BOOST_AUTO_TEST_CASE(compress_zstd_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_zstd_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_zstd = wolf::system::compression::w_zstd;
+
+        const auto _src = s_make_text_corpus(300 * 1024);
+
+        for (const auto _level : {-5, 3, 19}) {
+          BOOST_LEAF_AUTO(_codec, w_zstd::make(_level));
+
+          // whole frames, the same contexts are used twice
+          for (auto i = 0; i < 2; ++i) {
+            BOOST_LEAF_AUTO(_frame, _codec.compress(_src));
+            BOOST_LEAF_AUTO(_content_size, w_zstd::get_content_size(_frame));
+            BOOST_REQUIRE(_content_size == _src.size());
+            BOOST_LEAF_AUTO(_dst, _codec.decompress(_frame));
+            BOOST_REQUIRE(_dst == _src);
+          }
+
+          // chunked frames
+          BOOST_LEAF_AUTO(_dst, s_stream_round_trip(_codec, _src, 1000));
+          BOOST_REQUIRE(_dst == _src);
+        }
+
+        // a corrupted frame must fail without breaking the next one
+        BOOST_LEAF_AUTO(_codec, w_zstd::make());
+        BOOST_LEAF_AUTO(_frame, _codec.compress(_src));
+        auto _truncated = _frame;
+        _truncated.resize(_truncated.size() / 2);
+        auto _dst = std::vector<std::byte>(_src.size());
+        BOOST_REQUIRE(!_codec.decompress(_truncated, _dst));
+        BOOST_LEAF_AUTO(_size, _codec.decompress(_frame, _dst));
+        BOOST_REQUIRE(_size == _src.size());
+
+        // beyond the trusted ratio the known size is reached by growing
+        {
+          const auto _zeros = std::vector<std::byte>(8 * 1024 * 1024);
+          BOOST_LEAF_AUTO(_zeros_frame, _codec.compress(_zeros));
+          BOOST_REQUIRE(_zeros_frame.size() * 256 < _zeros.size());
+          BOOST_LEAF_AUTO(_zeros_dst, _codec.decompress(_zeros_frame));
+          BOOST_REQUIRE(_zeros_dst == _zeros);
+        }
+
+        // a forged content size must not make the output allocate it
+        {
+          // magic, single segment with an 8 bytes content size of 4 GiB, then
+          // the last raw block of 4 bytes
+          const auto _forged = std::vector<std::byte>{
+              std::byte{0x28}, std::byte{0xB5}, std::byte{0x2F}, std::byte{0xFD},
+              std::byte{0xE0}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+              std::byte{0x00}, std::byte{0x01}, std::byte{0x00}, std::byte{0x00},
+              std::byte{0x00}, std::byte{0x21}, std::byte{0x00}, std::byte{0x00},
+              std::byte{'w'},  std::byte{'o'},  std::byte{'l'},  std::byte{'f'}};
+          BOOST_LEAF_AUTO(_forged_size, w_zstd::get_content_size(_forged));
+          BOOST_REQUIRE(_forged_size == 4ull * 1024 * 1024 * 1024);
+
+          const auto _bytes = get_test_alloc_bytes();
+          BOOST_REQUIRE(!_codec.decompress(_forged));
+          BOOST_REQUIRE(get_test_alloc_bytes() - _bytes < 1024 * 1024);
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_zstd_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_zstd_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_zstd_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(compress_zstd_dictionary_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'compress_zstd_dictionary_test'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        using w_zstd = wolf::system::compression::w_zstd;
+
+        // small messages which look alike
+        const auto _corpus = s_make_text_corpus(2 * 1024 * 1024);
+        std::vector<std::vector<std::byte>> _samples;
+        for (size_t _offset = 0; _offset + 256 <= _corpus.size(); _offset += 256) {
+          _samples.emplace_back(_corpus.begin() + _offset, _corpus.begin() + _offset + 256);
+        }
+
+        BOOST_LEAF_AUTO(_dictionary,
+                        w_zstd::train_dictionary(gsl::span(_samples).first(4000), 16 * 1024));
+        BOOST_REQUIRE(!_dictionary.empty());
+
+        BOOST_LEAF_AUTO(_plain, w_zstd::make(3));
+        BOOST_LEAF_AUTO(_primed, w_zstd::make(3, _dictionary));
+
+        size_t _plain_size = 0;
+        size_t _primed_size = 0;
+        // the messages which were not used for training
+        for (size_t i = 4000; i < _samples.size(); ++i) {
+          BOOST_LEAF_AUTO(_plain_frame, _plain.compress(_samples[i]));
+          BOOST_LEAF_AUTO(_primed_frame, _primed.compress(_samples[i]));
+          _plain_size += _plain_frame.size();
+          _primed_size += _primed_frame.size();
+
+          BOOST_LEAF_AUTO(_dst, _primed.decompress(_primed_frame));
+          BOOST_REQUIRE(_dst == _samples[i]);
+        }
+        std::cout << wolf::format("zstd 256-byte messages: plain {} bytes, primed {} bytes",
+                                  _plain_size, _primed_size)
+                  << std::endl;
+        BOOST_REQUIRE(_primed_size < _plain_size * 3 / 4);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_zstd_dictionary_test got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_zstd_dictionary_test got an error!"); });
+
+  std::cout << "leaving test case 'compress_zstd_dictionary_test'" << std::endl;
+}
+
+#endif  // WOLF_SYSTEM_ZSTD
+
+#if defined(WOLF_SYSTEM_LZ4) || defined(WOLF_SYSTEM_ZLIB) || defined(WOLF_SYSTEM_ZSTD)
+
+// measure one codec over one corpus
+template <wolf::system::compression::w_compressor T>
+static boost::leaf::result<void> s_bench_codec(_In_ std::string_view p_name,
+                                               _In_ int p_level, _Inout_ T &p_codec,
+                                               _In_ std::string_view p_corpus_name,
+                                               _In_ gsl::span<const std::byte> p_corpus) {
+  using clock = std::chrono::steady_clock;
+
+  auto _compressed = std::vector<std::byte>(p_codec.get_compress_bound(p_corpus.size()));
+  auto _dst = std::vector<std::byte>(p_corpus.size());
+  size_t _compressed_size = 0;
+
+  // each direction runs for at least 300 ms, so the slow levels get fewer
+  // rounds
+  size_t _compress_rounds = 0;
+  auto _start = clock::now();
+  do {
+    BOOST_LEAF_ASSIGN(_compressed_size, p_codec.compress(p_corpus, _compressed));
+    _compress_rounds++;
+  } while (clock::now() - _start < std::chrono::milliseconds(300));
+  const auto _compress = std::chrono::duration<double>(clock::now() - _start).count();
+
+  const auto _frame = gsl::span<const std::byte>(_compressed).first(_compressed_size);
+  size_t _decompress_rounds = 0;
+  _start = clock::now();
+  do {
+    BOOST_LEAF_AUTO(_size, p_codec.decompress(_frame, _dst));
+    BOOST_REQUIRE(_size == p_corpus.size());
+    _decompress_rounds++;
+  } while (clock::now() - _start < std::chrono::milliseconds(300));
+  const auto _decompress = std::chrono::duration<double>(clock::now() - _start).count();
+  BOOST_REQUIRE(std::equal(_dst.begin(), _dst.end(), p_corpus.begin()));
+
+  const auto _mb = static_cast<double>(p_corpus.size()) / (1024.0 * 1024.0);
+  std::cout << wolf::format(
+                   "{:<5} | {:<9} | level {:>3} | ratio {:>6.3f} | compress {:>8.1f} MB/s | "
+                   "decompress {:>8.1f} MB/s",
+                   p_name, p_corpus_name, p_level,
+                   static_cast<double>(_compressed_size) / p_corpus.size(),
+                   _mb * _compress_rounds / _compress, _mb * _decompress_rounds / _decompress)
+            << std::endl;
+  return {};
+}
+
+BOOST_AUTO_TEST_CASE(compress_codecs_benchmark) {
+  std::cout << "entering test case 'compress_codecs_benchmark'" << std::endl;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        constexpr size_t _size = 8 * 1024 * 1024;
+        const auto _corpora = std::array<std::pair<std::string_view, std::vector<std::byte>>, 3>{
+            std::pair{"text", s_make_text_corpus(_size)},
+            std::pair{"assets", s_make_asset_corpus(_size)},
+            std::pair{"side-data", s_make_side_data_corpus(_size)}};
+
+        for (const auto &[_corpus_name, _corpus] : _corpora) {
+#ifdef WOLF_SYSTEM_LZ4
+          for (const auto _level : {0, 3, 9}) {
+            BOOST_LEAF_AUTO(_codec, wolf::system::compression::w_lz4_stream::make(_level));
+            BOOST_LEAF_CHECK(s_bench_codec("lz4", _level, _codec, _corpus_name, _corpus));
+          }
+#endif
+#ifdef WOLF_SYSTEM_ZLIB
+          for (const auto _level : {1, 6, 9}) {
+            BOOST_LEAF_AUTO(_codec, wolf::system::compression::w_zlib::make(_level));
+            BOOST_LEAF_CHECK(s_bench_codec("gzip", _level, _codec, _corpus_name, _corpus));
+          }
+#endif
+#ifdef WOLF_SYSTEM_ZSTD
+          for (const auto _level : {-5, 1, 3, 9, 19}) {
+            BOOST_LEAF_AUTO(_codec, wolf::system::compression::w_zstd::make(_level));
+            BOOST_LEAF_CHECK(s_bench_codec("zstd", _level, _codec, _corpus_name, _corpus));
+          }
+#endif
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg = wolf::format("compress_codecs_benchmark got an error : {}",
+                                       p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("compress_codecs_benchmark got an error!"); });
+
+  std::cout << "leaving test case 'compress_codecs_benchmark'" << std::endl;
+}
+
+#endif  // WOLF_SYSTEM_LZ4 || WOLF_SYSTEM_ZLIB || WOLF_SYSTEM_ZSTD
+
+#endif  // WOLF_TESTS
@@ -6,6 +6,9 @@
 #if defined(WOLF_TEST) && defined(WOLF_SYSTEM_LOG)
 
 #include <boost/test/included/unit_test.hpp>
+#include <spdlog/fmt/ranges.h>
+#include <chrono>
+#include <fstream>
 #include <random>
 #include <sstream>
 #include <system/log/w_log.hpp>
@@ -101,4 +104,142 @@ BOOST_AUTO_TEST_CASE(log_stress_test) {
   std::cout << "leaving test case 'log_stress_test'" << std::endl;
 }
 
+static wolf::system::log::w_log_config s_make_log_config(
+    _In_ const std::filesystem::path &p_path, _In_ bool p_deferred) {
+  auto _config = wolf::system::log::w_log_config{};
+  _config.multi_threaded = true;
+  _config.path = p_path;
+  _config.level = spdlog::level::level_enum::debug;
+  _config.flush_level = spdlog::level::level_enum::err;
+  _config.type = wolf::system::log::w_log_sink::ASYNC_FILE;
+  _config.deferred = p_deferred;
+  return _config;
+}
+
+BOOST_AUTO_TEST_CASE(log_deferred_test) {
+  std::cout << "entering test case 'log_deferred_test'" << std::endl;
+
+  using w_log = wolf::system::log::w_log;
+
+  const auto _dir = std::filesystem::temp_directory_path() / "wolf_log_deferred_test";
+  std::filesystem::remove_all(_dir);
+  std::filesystem::create_directories(_dir);
+  const auto _path = _dir / "deferred.log";
+
+  constexpr size_t _threads_count = 4;
+  constexpr size_t _logs_per_thread = 10000;
+  {
+    w_log _log(s_make_log_config(_path, true));
+    BOOST_REQUIRE(_log.init().has_error() == false);
+
+    std::vector<std::thread> _threads;
+    for (size_t i = 0; i < _threads_count; ++i) {
+      _threads.emplace_back([&_log, i]() {
+        const auto _name = std::string("producer-") + std::to_string(i);
+        for (size_t j = 0; j < _logs_per_thread; ++j) {
+          _log.write("#{} log {} of {} took {:.2f} ms", i, j, _name, 0.25 * j);
+        }
+      });
+    }
+    for (auto &_thread : _threads) {
+      _thread.join();
+    }
+
+    // the levels below the level of logger are not pushed
+    _log.write(spdlog::level::level_enum::trace, "hidden {}", 1);
+    // the arguments which are not trivially copyable are formatted by the caller
+    _log.write("a vector {}", std::vector<int>{1, 2, 3});
+    _log.write(spdlog::level::level_enum::warn, std::string_view("the last log"));
+    BOOST_REQUIRE(_log.flush().has_error() == false);
+    BOOST_REQUIRE(_log.get_dropped() == 0);
+  }
+
+  size_t _lines = 0;
+  size_t _last_index = 0;
+  bool _found_vector = false;
+  bool _found_last = false;
+  auto _file = std::ifstream(_path);
+  for (std::string _line; std::getline(_file, _line);) {
+    _lines++;
+    BOOST_REQUIRE(_line.find("hidden") == std::string::npos);
+    if (_line.find("#0 log ") != std::string::npos) {
+      // the logs of a thread keep their order
+      const auto _index = std::stoul(_line.substr(_line.find(" log ") + 5));
+      BOOST_REQUIRE(_index == 0 || _index == _last_index + 1);
+      BOOST_REQUIRE(_line.find(" of producer-0 took ") != std::string::npos);
+      _last_index = _index;
+    }
+    _found_vector = _found_vector || _line.find("a vector [1, 2, 3]") != std::string::npos;
+    _found_last = _found_last || _line.find("the last log") != std::string::npos;
+  }
+  BOOST_REQUIRE(_lines == _threads_count * _logs_per_thread + 2);
+  BOOST_REQUIRE(_found_vector);
+  BOOST_REQUIRE(_found_last);
+
+  std::cout << "leaving test case 'log_deferred_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(log_deferred_benchmark) {
+  std::cout << "entering test case 'log_deferred_benchmark'" << std::endl;
+
+  using w_log = wolf::system::log::w_log;
+  using clock = std::chrono::steady_clock;
+
+  const auto _dir = std::filesystem::temp_directory_path() / "wolf_log_deferred_benchmark";
+  std::filesystem::remove_all(_dir);
+  std::filesystem::create_directories(_dir);
+
+  constexpr size_t _logs_per_thread = 200000;
+  const auto _max_threads =
+      std::max<size_t>(4, std::thread::hardware_concurrency());
+
+  for (size_t _threads_count = 1; _threads_count <= _max_threads; _threads_count *= 2) {
+    for (const bool _deferred : {false, true}) {
+      const auto _name = wolf::format("{}_{}.log", _deferred ? "deferred" : "async_nb",
+                                      _threads_count);
+      auto _config = s_make_log_config(_dir / _name, _deferred);
+      // a ring which holds a whole burst, so the cost of calls is measured
+      // without drops
+      _config.deferred_ring_size = 32 * 1024 * 1024;
+      w_log _log(std::move(_config));
+      BOOST_REQUIRE(_log.init().has_error() == false);
+
+      std::vector<std::thread> _threads;
+      std::vector<clock::duration> _elapsed(_threads_count);
+      const auto _start = clock::now();
+      for (size_t i = 0; i < _threads_count; ++i) {
+        _threads.emplace_back([&, i]() {
+          const auto _thread_start = clock::now();
+          for (size_t j = 0; j < _logs_per_thread; ++j) {
+            _log.write("frame {} of {} took {} us", j, std::string_view("render"), 16.6);
+          }
+          _elapsed[i] = clock::now() - _thread_start;
+        });
+      }
+      for (auto &_thread : _threads) {
+        _thread.join();
+      }
+      BOOST_REQUIRE(_log.flush().has_error() == false);
+      const auto _total = clock::now() - _start;
+
+      auto _calls = clock::duration::zero();
+      for (const auto &_duration : _elapsed) {
+        _calls += _duration;
+      }
+      const auto _logs = _threads_count * _logs_per_thread;
+      std::cout << wolf::format(
+                       "{:<9} | {:>2} producers | {:>7.1f} ns/call | {:>6.2f} M logs/s until "
+                       "flushed | {} dropped by the deferred rings",
+                       _deferred ? "deferred" : "async_nb", _threads_count,
+                       std::chrono::duration<double, std::nano>(_calls).count() / _logs,
+                       _logs / std::chrono::duration<double, std::micro>(_total).count(),
+                       _log.get_dropped())
+                << std::endl;
+    }
+  }
+  spdlog::drop_all();
+
+  std::cout << "leaving test case 'log_deferred_benchmark'" << std::endl;
+}
+
 #endif  // defined(WOLF_TEST) && defined(WOLF_SYSTEM_LOG)
\ No newline at end of file
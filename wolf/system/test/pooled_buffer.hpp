@@ -0,0 +1,192 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#if defined(WOLF_TEST)
+
+#include <boost/test/included/unit_test.hpp>
+#include <system/w_leak_detector.hpp>
+#include <system/test/alloc_counter.hpp>
+#include <system/w_pooled_buffer.hpp>
+#include <wolf/wolf.hpp>
+
+#ifdef WOLF_SYSTEM_SOCKET
+#include <system/socket/w_tcp_server.hpp>
+#endif
+
+BOOST_AUTO_TEST_CASE(pooled_buffer_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'pooled_buffer_test'" << std::endl;
+
+  using w_pooled_buffer = wolf::system::w_pooled_buffer;
+  {
+    // bigger than the old 1 KiB w_buffer, must not be truncated
+    const auto _str = std::string(5000, 'w');
+    auto _buffer = w_pooled_buffer(_str);
+    BOOST_REQUIRE(_buffer.size() == _str.size());
+    BOOST_REQUIRE(_buffer.capacity() == 16 * 1024);
+    BOOST_REQUIRE(_buffer.to_string() == _str);
+
+    // copies share the storage
+    auto _shared = _buffer;
+    BOOST_REQUIRE(!_buffer.unique());
+    BOOST_REQUIRE(_shared.data() == _buffer.data());
+
+    // writing a string must detach from the other owners
+    _buffer.from_string("hello");
+    BOOST_REQUIRE(_buffer.unique());
+    BOOST_REQUIRE(_buffer.to_string() == "hello");
+    BOOST_REQUIRE(_shared.to_string() == _str);
+
+    // growing keeps the content
+    _buffer.resize(2 * 1024 * 1024);
+    BOOST_REQUIRE(_buffer.to_string_view().substr(0, 5) == "hello");
+
+    // released blocks must be reused
+    const auto _before = w_pooled_buffer::get_stats();
+    for (auto i = 0; i < 100; ++i) {
+      auto _tmp = w_pooled_buffer(1024);
+      BOOST_REQUIRE(_tmp.capacity() == 1024);
+    }
+    const auto _after = w_pooled_buffer::get_stats();
+    BOOST_REQUIRE(_after.slab_allocations - _before.slab_allocations <= 1);
+  }
+  w_pooled_buffer::trim();
+
+  std::cout << "leaving test case 'pooled_buffer_test'" << std::endl;
+}
+
+#ifdef WOLF_SYSTEM_SOCKET
+
+static boost::asio::awaitable<void> s_bench_echo_client(
+    _In_ const uint16_t p_port, _In_ const size_t p_msg_size,
+    _In_ const size_t p_msg_count, _Inout_ double &p_elapsed_secs) {
+  using tcp = boost::asio::ip::tcp;
+
+  auto _socket = tcp::socket(co_await boost::asio::this_coro::executor);
+  co_await _socket.async_connect({boost::asio::ip::make_address("127.0.0.1"), p_port},
+                                 boost::asio::use_awaitable);
+  _socket.set_option(tcp::no_delay(true));
+
+  auto _send = std::vector<char>(p_msg_size, 'w');
+  auto _recv = std::vector<char>(p_msg_size);
+
+  const auto _start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < p_msg_count; ++i) {
+    co_await boost::asio::async_write(_socket, boost::asio::buffer(_send),
+                                      boost::asio::use_awaitable);
+    co_await boost::asio::async_read(_socket, boost::asio::buffer(_recv),
+                                     boost::asio::use_awaitable);
+  }
+  p_elapsed_secs =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+// the session loop of w_tcp_server before w_pooled_buffer
+static boost::asio::awaitable<void> s_bench_w_buffer_session(
+    _In_ boost::asio::ip::tcp::socket p_socket, _Inout_ size_t &p_reads) {
+  w_buffer _buffer = {};
+  try {
+    for (;;) {
+      _buffer.used_bytes = co_await p_socket.async_receive(
+          boost::asio::buffer(_buffer.buf), boost::asio::use_awaitable);
+      p_reads++;
+      co_await p_socket.async_send(boost::asio::buffer(_buffer.buf, _buffer.used_bytes),
+                                   boost::asio::use_awaitable);
+    }
+  } catch (...) {
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pooled_buffer_benchmark) {
+  std::cout << "entering test case 'pooled_buffer_benchmark'" << std::endl;
+
+  using tcp = boost::asio::ip::tcp;
+  using w_pooled_buffer = wolf::system::w_pooled_buffer;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  using w_socket_options = wolf::system::socket::w_socket_options;
+
+  constexpr size_t _msg_count = 2000;
+  constexpr uint16_t _port = 8090;
+
+  for (const size_t _msg_size : {64, 1024, 16 * 1024, 64 * 1024}) {
+    // w_buffer path
+    {
+      auto _io = boost::asio::io_context();
+      size_t _reads = 0;
+      double _elapsed = 0.0;
+
+      // reuse the port of the previous round, which may be in TIME_WAIT
+      const auto _endpoint = tcp::endpoint{tcp::v4(), _port};
+      auto _acceptor = tcp::acceptor(_io);
+      _acceptor.open(_endpoint.protocol());
+      _acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+      _acceptor.bind(_endpoint);
+      _acceptor.listen();
+      _acceptor.async_accept([&](boost::system::error_code p_error, tcp::socket p_socket) {
+        if (!p_error) {
+          p_socket.set_option(tcp::no_delay(true));
+          boost::asio::co_spawn(_io, s_bench_w_buffer_session(std::move(p_socket), _reads),
+                                boost::asio::detached);
+        }
+      });
+      boost::asio::co_spawn(_io, s_bench_echo_client(_port, _msg_size, _msg_count, _elapsed),
+                            [&](std::exception_ptr) { _io.stop(); });
+      const auto _allocs = get_test_alloc_count();
+      _io.run();
+      const auto _heap_allocs = get_test_alloc_count() - _allocs;
+
+      std::cout << wolf::format(
+                       "w_buffer        | {:>6} bytes | {:>10.0f} msg/s | {:>6.2f} reads/msg | "
+                       "{:>6.2f} heap allocs/msg | {:.2f} slab allocs/msg",
+                       _msg_size, _msg_count / _elapsed,
+                       static_cast<double>(_reads) / _msg_count,
+                       static_cast<double>(_heap_allocs) / _msg_count, 0.0)
+                << std::endl;
+    }
+
+    // w_pooled_buffer path through w_tcp_server
+    {
+      auto _io = boost::asio::io_context();
+      size_t _reads = 0;
+      double _elapsed = 0.0;
+
+      const auto _before = w_pooled_buffer::get_stats();
+      auto _res = w_tcp_server::run(
+          _io, tcp::endpoint{tcp::v4(), _port + 1}, std::chrono::seconds(30), w_socket_options{},
+          [&](const std::string &p_conn_id, w_pooled_buffer &p_mut_data) -> auto{
+            _reads++;
+            return boost::system::errc::success;
+          },
+          [](const std::string &p_conn_id, const boost::system::system_error &p_error) {});
+      BOOST_REQUIRE(_res);
+
+      boost::asio::co_spawn(_io,
+                            s_bench_echo_client(_port + 1, _msg_size, _msg_count, _elapsed),
+                            [&](std::exception_ptr) { _io.stop(); });
+      const auto _allocs = get_test_alloc_count();
+      _io.run();
+      const auto _heap_allocs = get_test_alloc_count() - _allocs;
+      const auto _after = w_pooled_buffer::get_stats();
+
+      const auto _slab_allocs = (_after.slab_allocations - _before.slab_allocations) +
+                                (_after.large_allocations - _before.large_allocations);
+      std::cout << wolf::format(
+                       "w_pooled_buffer | {:>6} bytes | {:>10.0f} msg/s | {:>6.2f} reads/msg | "
+                       "{:>6.2f} heap allocs/msg | {:.2f} slab allocs/msg",
+                       _msg_size, _msg_count / _elapsed,
+                       static_cast<double>(_reads) / _msg_count,
+                       static_cast<double>(_heap_allocs) / _msg_count,
+                       static_cast<double>(_slab_allocs) / _msg_count)
+                << std::endl;
+    }
+  }
+
+  std::cout << "leaving test case 'pooled_buffer_benchmark'" << std::endl;
+}
+
+#endif  // WOLF_SYSTEM_SOCKET
+
+#endif  // WOLF_TEST
@@ -6,9 +6,19 @@
 #include <system/w_leak_detector.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <system/db/w_pgdb_async.hpp>
+#include <system/db/w_pgdb_pool.hpp>
 #include <system/db/w_postgresql.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
 using wolf::system::db::w_pgdb_conection;
+using wolf::system::db::w_pgdb_copy_row;
 using wolf::system::db::w_pgdb_execresult;
 using wolf::system::db::w_pgdb_queryresult;
 using wolf::system::db::w_pgdb_record;
@@ -194,4 +204,694 @@ BOOST_AUTO_TEST_CASE(postgresql_client_commands_and_queries) {
         });
 }
 
+BOOST_AUTO_TEST_CASE(postgresql_client_binary_format) {
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  auto conn = w_pgdb_conection::make(conn_info_str);
+
+  BOOST_REQUIRE(conn);
+
+  // example: typed binary parameters read back in binary format
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        const std::int64_t big = -9'000'000'000'000LL;
+        const double real = 0.1;
+        const std::string name = "Lizard";
+        const auto blob = std::vector<std::byte>{std::byte{0x00}, std::byte{0xff}, std::byte{0x7f}};
+        const auto time = std::chrono::time_point_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now());
+        const std::optional<int> missing = std::nullopt;
+
+        auto res = conn->query_binary("SELECT $1, $2, $3, $4, $5, $6, $7;", big, real, name, blob,
+                                      time, missing, true);
+        BOOST_LEAF_CHECK(res);
+
+        BOOST_LEAF_CHECK(res->on_single([&](w_pgdb_record record) -> boost::leaf::result<void> {
+          std::int64_t big_out = 0;
+          double real_out = 0;
+          std::string name_out;
+          std::span<const std::byte> blob_out;
+          wolf::system::db::internal::pg_time_point time_out;
+          std::optional<int> missing_out = 1;
+          bool flag_out = false;
+
+          BOOST_LEAF_CHECK(record.scan(&big_out, &real_out, &name_out, &blob_out, &time_out,
+                                       &missing_out, &flag_out));
+
+          BOOST_CHECK(big_out == big);
+          BOOST_CHECK(real_out == real);
+          BOOST_CHECK(name_out == name);
+          BOOST_CHECK(std::equal(blob_out.begin(), blob_out.end(), blob.begin(), blob.end()));
+          BOOST_CHECK(time_out == time);
+          BOOST_CHECK(!missing_out.has_value());
+          BOOST_CHECK(flag_out);
+
+          return {};
+        }));
+
+        res->done();
+
+        // an int4 column widens into int64, but doesn't narrow into int8_t when out of range.
+        auto int_res = conn->query_binary("SELECT 100000::INT4;");
+        BOOST_LEAF_CHECK(int_res);
+        BOOST_LEAF_CHECK(int_res->on_single([](w_pgdb_record record) -> boost::leaf::result<void> {
+          std::int64_t wide = 0;
+          BOOST_LEAF_CHECK(record.scan(&wide));
+          BOOST_CHECK(wide == 100000);
+
+          std::int8_t narrow = 0;
+          BOOST_CHECK(!record.scan(&narrow));
+
+          // the raw bytes of an integer are neither a string nor a bytea.
+          std::string text;
+          BOOST_CHECK(!record.scan(&text));
+          std::span<const std::byte> bytes;
+          BOOST_CHECK(!record.scan(&bytes));
+
+          return {};
+        }));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_binary_benchmark) {
+  using clock = std::chrono::steady_clock;
+
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  // a wide numeric result set, the server cost is the same for both formats.
+  constexpr auto rows = 200'000;
+  constexpr auto runs = 3;
+  constexpr auto sqlstr =
+      "SELECT i::INT8, (i * 3)::INT8, (i * 7)::INT8, (i * 11)::INT8,"
+      "       i::FLOAT8 / 3, i::FLOAT8 / 7, i::FLOAT8 / 11, i::FLOAT8 / 13 "
+      "FROM generate_series(1, $1) AS g(i);";
+
+  auto conn = w_pgdb_conection::make(conn_info_str);
+
+  BOOST_REQUIRE(conn);
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        const auto scan_row = [](w_pgdb_record record) -> boost::leaf::result<void> {
+          std::int64_t a = 0, b = 0, c = 0, d = 0;
+          double e = 0, f = 0, g = 0, h = 0;
+          return record.scan(&a, &b, &c, &d, &e, &f, &g, &h);
+        };
+
+        const auto report = [&](const char *p_name, clock::duration p_elapsed) {
+          const auto seconds = std::chrono::duration<double>(p_elapsed).count();
+          std::cout << wolf::format("postgresql {:<6} | {:>12.0f} rows/s", p_name,
+                                    rows * runs / seconds)
+                    << std::endl;
+        };
+
+        auto start = clock::now();
+        for (int i = 0; i < runs; ++i) {
+          BOOST_LEAF_AUTO(res, conn->query(sqlstr, rows));
+          BOOST_LEAF_AUTO(count, res.on_each(scan_row));
+          BOOST_REQUIRE(count == static_cast<std::size_t>(rows));
+        }
+        report("text", clock::now() - start);
+
+        start = clock::now();
+        for (int i = 0; i < runs; ++i) {
+          BOOST_LEAF_AUTO(res, conn->query_binary(sqlstr, std::int64_t{rows}));
+          BOOST_LEAF_AUTO(count, res.on_each(scan_row));
+          BOOST_REQUIRE(count == static_cast<std::size_t>(rows));
+        }
+        report("binary", clock::now() - start);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_statement_cache) {
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  auto conn = w_pgdb_conection::make(conn_info_str);
+
+  BOOST_REQUIRE(conn);
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        const auto select = [&](const char *p_sqlstr, int p_value) -> boost::leaf::result<void> {
+          BOOST_LEAF_AUTO(res, conn->query(p_sqlstr, p_value));
+          return res.on_single([&](w_pgdb_record record) -> boost::leaf::result<void> {
+            int value = 0;
+            BOOST_LEAF_CHECK(record.scan(&value));
+            BOOST_CHECK(value == p_value + 1);
+            return {};
+          });
+        };
+
+        conn->set_statement_cache_capacity(2);
+
+        // prepared on first use, executed by name afterwards.
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1;", 1));
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1;", 2));
+        auto stats = conn->statement_cache_stats();
+        BOOST_CHECK(stats.misses == 1 && stats.hits == 1 && stats.size == 1);
+
+        // the least recently used statement is evicted by the capacity.
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1 AS a;", 3));
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1 AS b;", 4));
+        stats = conn->statement_cache_stats();
+        BOOST_CHECK(stats.misses == 3 && stats.evictions == 1 && stats.size == 2);
+
+        // statements dropped behind the cache are prepared again.
+        BOOST_LEAF_CHECK(conn->execute("DEALLOCATE ALL;"));
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1 AS b;", 5));
+        stats = conn->statement_cache_stats();
+        BOOST_CHECK(stats.reprepares == 1);
+
+        // inside a transaction block the failure aborts it, so no retry.
+        BOOST_LEAF_CHECK(conn->execute("BEGIN;"));
+        BOOST_LEAF_CHECK(conn->execute("DEALLOCATE ALL;"));
+        BOOST_CHECK(!conn->query("SELECT $1::INT4 + 1 AS b;", 6));
+        BOOST_CHECK(conn->in_transaction());
+        BOOST_LEAF_CHECK(conn->execute("ROLLBACK;"));
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1 AS b;", 6));
+
+        // a reset starts a new session without any statement.
+        BOOST_LEAF_CHECK(conn->reset());
+        BOOST_CHECK(conn->statement_cache_stats().size == 0);
+        BOOST_LEAF_CHECK(select("SELECT $1::INT4 + 1 AS b;", 6));
+        BOOST_CHECK(conn->statement_cache_stats().size == 1);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_statement_cache_benchmark) {
+  using clock = std::chrono::steady_clock;
+
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  // a short statement, so parsing and planning are a good part of the round trip.
+  constexpr auto executions = 5'000;
+  constexpr auto sqlstr =
+      "SELECT g.i, g.i * 2, g.i::STRING FROM generate_series($1::INT8, $1::INT8 + 3) AS g(i) "
+      "WHERE g.i % 2 = 0 ORDER BY g.i DESC;";
+
+  auto conn = w_pgdb_conection::make(conn_info_str);
+
+  BOOST_REQUIRE(conn);
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        for (const auto capacity : {std::size_t{0}, std::size_t{64}}) {
+          conn->set_statement_cache_capacity(capacity);
+          const auto before = conn->statement_cache_stats();
+
+          const auto start = clock::now();
+          for (int i = 0; i < executions; ++i) {
+            BOOST_LEAF_AUTO(res, conn->query_binary(sqlstr, std::int64_t{i}));
+            BOOST_REQUIRE(res.size() == 2);
+          }
+          const auto seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+          const auto stats = conn->statement_cache_stats();
+          const auto hits = stats.hits - before.hits;
+          const auto misses = stats.misses - before.misses;
+          const auto hit_rate =
+              hits + misses == 0 ? 0.0 : 100.0 * static_cast<double>(hits) / (hits + misses);
+          std::cout << wolf::format(
+                           "postgresql statement cache {:>2} | {:>10.0f} executions/s | hit "
+                           "rate {:>6.2f}%",
+                           capacity, executions / seconds, hit_rate)
+                    << std::endl;
+        }
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+
+BOOST_AUTO_TEST_CASE(postgresql_client_copy) {
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  auto conn = w_pgdb_conection::make(conn_info_str);
+
+  BOOST_REQUIRE(conn);
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        BOOST_LEAF_CHECK(conn->execute("DROP TABLE IF EXISTS wolf_copy_test;"));
+        BOOST_LEAF_CHECK(
+            conn->execute("CREATE TABLE wolf_copy_test (id INT8, value FLOAT8, name STRING NULL);"));
+
+        // text format escapes special characters, and std::nullopt is sql null.
+        const auto names = std::vector<std::optional<std::string>>{
+            "plain", "tab\there", "line\nbreak", "back\\slash", std::nullopt};
+        {
+          BOOST_LEAF_AUTO(writer, conn->copy_from("COPY wolf_copy_test FROM STDIN;"));
+          for (std::size_t i = 0; i < names.size(); ++i) {
+            BOOST_LEAF_CHECK(writer.write_row(std::int64_t(i), i * 0.5, names[i]));
+          }
+          BOOST_LEAF_AUTO(rows, writer.finish());
+          BOOST_CHECK(rows == names.size());
+        }
+
+        // a writer which isn't finished aborts the copy.
+        {
+          BOOST_LEAF_AUTO(writer, conn->copy_from("COPY wolf_copy_test FROM STDIN;"));
+          BOOST_LEAF_CHECK(writer.write_row(std::int64_t{100}, 1.0, "aborted"));
+        }
+
+        BOOST_LEAF_AUTO(count, conn->copy_to(
+                                   "COPY (SELECT id, value, name FROM wolf_copy_test ORDER BY id) "
+                                   "TO STDOUT;",
+                                   [&](w_pgdb_copy_row row) -> boost::leaf::result<void> {
+                                     std::int64_t id = 0;
+                                     double value = 0;
+                                     std::optional<std::string> name;
+                                     BOOST_LEAF_CHECK(row.scan(&id, &value, &name));
+                                     BOOST_CHECK(value == id * 0.5);
+                                     BOOST_CHECK(name == names[static_cast<std::size_t>(id)]);
+                                     return {};
+                                   }));
+        BOOST_CHECK(count == names.size());
+
+        // binary format needs the exact types of columns.
+        {
+          BOOST_LEAF_AUTO(writer,
+                          conn->copy_from("COPY wolf_copy_test FROM STDIN WITH (FORMAT binary);"));
+          BOOST_LEAF_CHECK(writer.write_row(std::int64_t{10}, 5.0, std::string("binary")));
+          BOOST_LEAF_CHECK(writer.finish());
+        }
+
+        BOOST_LEAF_CHECK(conn->copy_to(
+            "COPY (SELECT id, name FROM wolf_copy_test WHERE id = 10) TO STDOUT WITH (FORMAT "
+            "binary);",
+            [&](w_pgdb_copy_row row) -> boost::leaf::result<void> {
+              std::int64_t id = 0;
+              std::string name;
+              BOOST_LEAF_CHECK(row.scan(&id, &name));
+              BOOST_CHECK(id == 10 && name == "binary");
+              return {};
+            }));
+
+        // the connection stays usable after the handler fails.
+        auto failed = conn->copy_to("COPY wolf_copy_test TO STDOUT;",
+                                    [](w_pgdb_copy_row) -> boost::leaf::result<void> {
+                                      return W_FAILURE(std::errc::operation_canceled, "stop");
+                                    });
+        BOOST_CHECK(!failed);
+        BOOST_LEAF_CHECK(conn->execute("DROP TABLE wolf_copy_test;"));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_copy_benchmark) {
+  using clock = std::chrono::steady_clock;
+
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  // row by row execute is measured on fewer rows, it takes a round trip each.
+  constexpr auto execute_rows = 10'000;
+  constexpr auto rows = 2'000'000;
+  constexpr auto insert_batch = 1'000;
+
+  auto conn = w_pgdb_conection::make(conn_info_str);
+
+  BOOST_REQUIRE(conn);
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        const auto run = [&](const char *p_name, int p_rows,
+                             const auto &p_insert) -> boost::leaf::result<void> {
+          BOOST_LEAF_CHECK(conn->execute("DROP TABLE IF EXISTS wolf_copy_bench;"));
+          BOOST_LEAF_CHECK(conn->execute(
+              "CREATE TABLE wolf_copy_bench (id INT8, value FLOAT8, name STRING);"));
+
+          const auto start = clock::now();
+          BOOST_LEAF_CHECK(p_insert(p_rows));
+          const auto seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+          std::cout << wolf::format("postgresql ingest {:<16} | {:>9} rows | {:>10.0f} rows/s",
+                                    p_name, p_rows, p_rows / seconds)
+                    << std::endl;
+          return {};
+        };
+
+        BOOST_LEAF_CHECK(run("execute", execute_rows, [&](int p_rows) -> boost::leaf::result<void> {
+          for (int i = 0; i < p_rows; ++i) {
+            BOOST_LEAF_CHECK(conn->execute_binary(
+                "INSERT INTO wolf_copy_bench VALUES ($1, $2, $3);", std::int64_t{i}, i * 0.5,
+                "telemetry"));
+          }
+          return {};
+        }));
+
+        BOOST_LEAF_CHECK(
+            run("multi-row insert", rows, [&](int p_rows) -> boost::leaf::result<void> {
+              auto sqlstr = std::string();
+              for (int i = 0; i < p_rows; i += insert_batch) {
+                sqlstr = "INSERT INTO wolf_copy_bench VALUES ";
+                for (int j = i; j < std::min(i + insert_batch, p_rows); ++j) {
+                  sqlstr += wolf::format("{}({}, {}, 'telemetry')", j == i ? "" : ",", j, j * 0.5);
+                }
+                BOOST_LEAF_CHECK(conn->execute(sqlstr.c_str()));
+              }
+              return {};
+            }));
+
+        for (const auto *format : {"", " WITH (FORMAT binary)"}) {
+          const auto sqlstr = wolf::format("COPY wolf_copy_bench FROM STDIN{};", format);
+          BOOST_LEAF_CHECK(run(*format ? "copy binary" : "copy text", rows,
+                               [&](int p_rows) -> boost::leaf::result<void> {
+                                 BOOST_LEAF_AUTO(writer, conn->copy_from(sqlstr.c_str()));
+                                 for (int i = 0; i < p_rows; ++i) {
+                                   BOOST_LEAF_CHECK(writer.write_row(
+                                       std::int64_t{i}, i * 0.5, std::string_view("telemetry")));
+                                 }
+                                 BOOST_LEAF_AUTO(copied, writer.finish());
+                                 BOOST_REQUIRE(copied == static_cast<std::size_t>(p_rows));
+                                 return {};
+                               }));
+        }
+
+        // export, the table has the rows of the last copy.
+        const auto start = clock::now();
+        BOOST_LEAF_AUTO(exported,
+                        conn->copy_to("COPY wolf_copy_bench TO STDOUT;",
+                                      [](w_pgdb_copy_row row) -> boost::leaf::result<void> {
+                                        std::int64_t id = 0;
+                                        double value = 0;
+                                        std::string_view name;
+                                        return row.scan(&id, &value, &name);
+                                      }));
+        const auto seconds = std::chrono::duration<double>(clock::now() - start).count();
+        BOOST_REQUIRE(exported == static_cast<std::size_t>(rows));
+        std::cout << wolf::format("postgresql export {:<16} | {:>9} rows | {:>10.0f} rows/s",
+                                  "copy text", exported, exported / seconds)
+                  << std::endl;
+
+        BOOST_LEAF_CHECK(conn->execute("DROP TABLE wolf_copy_bench;"));
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_pool) {
+  using wolf::system::db::w_pgdb_pool;
+  using wolf::system::db::w_pgdb_pool_config;
+
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        auto config = w_pgdb_pool_config();
+        config.min_size = 1;
+        config.max_size = 2;
+        config.validate_after = std::chrono::milliseconds(0);
+
+        BOOST_LEAF_AUTO(pool, w_pgdb_pool::make(conn_info_str, config));
+        BOOST_CHECK(pool->stats().size == 1);
+
+        // the connection keeps its prepared statements between checkouts.
+        {
+          BOOST_LEAF_AUTO(conn, pool->acquire());
+          BOOST_LEAF_CHECK(conn->query("SELECT $1::INT4 + 1;", 1));
+        }
+        {
+          BOOST_LEAF_AUTO(conn, pool->acquire());
+          BOOST_LEAF_CHECK(conn->query("SELECT $1::INT4 + 1;", 2));
+          BOOST_CHECK(conn->statement_cache_stats().hits == 1);
+
+          // an open transaction is rolled back on release.
+          BOOST_LEAF_CHECK(conn->execute("BEGIN;"));
+        }
+
+        // an acquire times out when all connections are in use.
+        {
+          BOOST_LEAF_AUTO(first, pool->acquire());
+          BOOST_CHECK(!first->in_transaction());
+          BOOST_LEAF_AUTO(second, pool->acquire());
+          BOOST_CHECK(pool->stats().in_use == 2);
+
+          auto third = pool->acquire(std::chrono::milliseconds(50));
+          BOOST_CHECK(!third);
+          BOOST_CHECK(pool->stats().timeouts == 1);
+
+          // a waiter gets the connection which is released by another thread.
+          auto releaser = std::thread([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            second.release();
+          });
+          auto fourth = pool->acquire(std::chrono::seconds(5));
+          releaser.join();
+          BOOST_CHECK(fourth);
+
+          // a discarded connection is closed instead of being put back.
+          first.discard();
+        }
+
+        auto stats = pool->stats();
+        BOOST_CHECK(stats.discarded == 1 && stats.size == 1 && stats.in_use == 0);
+        BOOST_CHECK(stats.waits == 1 && stats.created == 2);
+
+        // coroutines wait without blocking their thread.
+        boost::asio::io_context io;
+        auto acquired = false;
+        boost::asio::co_spawn(
+            io,
+            [&]() -> boost::asio::awaitable<void> {
+              auto conn = co_await pool->async_acquire();
+              BOOST_REQUIRE(conn);
+              acquired = static_cast<bool>((*conn)->query("SELECT 1;"));
+            },
+            boost::asio::detached);
+        io.run();
+        BOOST_CHECK(acquired);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        std::cout << "got error :" << p_trace << std::endl;
+        BOOST_REQUIRE(false);
+      },
+      [] {
+        std::cout << "got an error!" << std::endl;
+        BOOST_ERROR(false);
+      });
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_pool_benchmark) {
+  using clock = std::chrono::steady_clock;
+  using wolf::system::db::w_pgdb_pool;
+  using wolf::system::db::w_pgdb_pool_config;
+
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+  constexpr auto requests = 4'000;
+
+  // more workers than connections, so they contend for the pool.
+  for (const auto workers : {1, 8, 32, 128}) {
+    auto config = w_pgdb_pool_config();
+    config.min_size = 8;
+    config.max_size = 8;
+
+    auto pool = w_pgdb_pool::make(conn_info_str, config);
+    BOOST_REQUIRE(pool);
+
+    auto failures = std::atomic<int>(0);
+    const auto start = clock::now();
+
+    auto threads = std::vector<std::thread>();
+    for (int worker = 0; worker < workers; ++worker) {
+      threads.emplace_back([&, worker] {
+        for (int i = worker; i < requests; i += workers) {
+          auto conn = (*pool)->acquire();
+          if (!conn || !(*conn)->query_binary("SELECT $1::INT8 + 1;", std::int64_t{i})) {
+            ++failures;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    const auto seconds = std::chrono::duration<double>(clock::now() - start).count();
+    const auto stats = (*pool)->stats();
+    BOOST_REQUIRE(failures == 0);
+
+    std::cout << wolf::format(
+                     "postgresql pool workers {:>3} | {:>10.0f} requests/s | avg wait "
+                     "{:>8.1f} us | max wait {:>8.1f} us | utilization {:>6.2f}%",
+                     workers, requests / seconds,
+                     std::chrono::duration<double, std::micro>(stats.total_wait).count() /
+                         static_cast<double>(stats.acquires),
+                     std::chrono::duration<double, std::micro>(stats.max_wait).count(),
+                     100.0 * stats.utilization)
+              << std::endl;
+  }
+}
+
+#if defined(LIBPQ_HAS_PIPELINING) && defined(BOOST_ASIO_HAS_POSIX_STREAM_DESCRIPTOR)
+
+using wolf::system::db::w_pgdb_async_connection;
+using wolf::system::db::w_pgdb_async_result;
+
+BOOST_AUTO_TEST_CASE(postgresql_client_async_pipeline) {
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+  constexpr auto queries = 100;
+
+  boost::asio::io_context io;
+  auto completed = 0;
+
+  boost::asio::co_spawn(
+      io,
+      [&]() -> boost::asio::awaitable<void> {
+        auto conn = co_await w_pgdb_async_connection::connect(conn_info_str);
+        BOOST_REQUIRE(conn);
+
+        // example: many queries in flight, each one gets its own result.
+        for (int i = 0; i < queries; ++i) {
+          boost::asio::co_spawn(
+              io,
+              [&, conn = *conn, i]() -> boost::asio::awaitable<void> {
+                // a failed query doesn't abort the others in the pipeline.
+                if (i == queries / 2) {
+                  auto res = co_await conn->query("SELECT 1 / $1::INT8;", std::int64_t{0});
+                  BOOST_CHECK(!res);
+                  ++completed;
+                  co_return;
+                }
+
+                auto res = co_await conn->query("SELECT $1::INT8 * 2;", std::int64_t{i});
+                BOOST_REQUIRE(res);
+                BOOST_CHECK(res->size() == 1);
+
+                BOOST_CHECK(res->on_each([&](w_pgdb_record record) -> boost::leaf::result<void> {
+                  std::int64_t value = 0;
+                  BOOST_LEAF_CHECK(record.scan(&value));
+                  BOOST_CHECK(value == i * 2);
+                  return {};
+                }));
+                ++completed;
+              },
+              boost::asio::detached);
+        }
+      },
+      boost::asio::detached);
+
+  io.run();
+
+  BOOST_CHECK(completed == queries);
+}
+
+BOOST_AUTO_TEST_CASE(postgresql_client_async_pipeline_benchmark) {
+  using clock = std::chrono::steady_clock;
+
+  constexpr auto conn_info_str =
+      "postgresql://root@" POSTGRESQL_SERVER_ADDRESS ":26257/defaultdb";
+  constexpr auto queries = 20'000;
+
+  // a depth of 1 waits a round trip for each query, like the blocking client.
+  for (const auto depth : {1, 8, 64, 256}) {
+    boost::asio::io_context io;
+    auto completed = 0;
+    auto elapsed = clock::duration::zero();
+
+    boost::asio::co_spawn(
+        io,
+        [&]() -> boost::asio::awaitable<void> {
+          auto conn = co_await w_pgdb_async_connection::connect(conn_info_str, depth);
+          BOOST_REQUIRE(conn);
+
+          const auto start = clock::now();
+          auto workers = depth;
+
+          for (int worker = 0; worker < depth; ++worker) {
+            boost::asio::co_spawn(
+                io,
+                [&, conn = *conn, worker]() -> boost::asio::awaitable<void> {
+                  for (int i = worker; i < queries; i += depth) {
+                    auto res = co_await conn->query("SELECT $1::INT8 + 1;", std::int64_t{i});
+                    BOOST_REQUIRE(res);
+                    ++completed;
+                  }
+
+                  if (--workers == 0) {
+                    elapsed = clock::now() - start;
+                  }
+                },
+                boost::asio::detached);
+          }
+        },
+        boost::asio::detached);
+
+    io.run();
+
+    BOOST_REQUIRE(completed == queries);
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << wolf::format("postgresql pipeline depth {:>3} | {:>10.0f} queries/s", depth,
+                              queries / seconds)
+              << std::endl;
+  }
+}
+
+#endif  // LIBPQ_HAS_PIPELINING && BOOST_ASIO_HAS_POSIX_STREAM_DESCRIPTOR
+
 #endif  // WOLF_TEST
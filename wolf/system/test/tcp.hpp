@@ -38,10 +38,11 @@ BOOST_AUTO_TEST_CASE(tcp_server_timeout_test) {
             _run_res,
             w_tcp_server::run(
                 _io, std::move(_endpoint), std::move(timeout), std::move(_opts),
-                [](const std::string &p_conn_id, w_buffer &p_mut_data) -> auto{
+                [](const std::string &p_conn_id,
+                   wolf::system::w_pooled_buffer &p_mut_data) -> auto{
                   std::cout << "tcp server just got: /'"
                             << p_mut_data.to_string() << "/'"
-                            << " and " << p_mut_data.used_bytes
+                            << " and " << p_mut_data.size()
                             << " bytes from connection id: " << p_conn_id
                             << std::endl;
                   return boost::system::errc::connection_aborted;
@@ -165,8 +166,8 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
         // expect the connection
         BOOST_REQUIRE(_conn_res.index() == 1);
 
-        w_buffer _send_buffer("hello");
-        w_buffer _recv_buffer{};
+        wolf::system::w_pooled_buffer _send_buffer("hello");
+        wolf::system::w_pooled_buffer _recv_buffer{};
 
         for (size_t i = 0; i < 5; i++) {
           auto _res = co_await (_timer.async_wait(boost::asio::use_awaitable) ||
@@ -179,9 +180,9 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
                            _client.async_read(_recv_buffer));
           // expect the connection
           BOOST_REQUIRE(_res.index() == 1);
-          _recv_buffer.used_bytes = std::get<1>(_res);
+          BOOST_REQUIRE(std::get<1>(_res) == _recv_buffer.size());
 
-          BOOST_REQUIRE(_recv_buffer.used_bytes == 10);  // hello-back
+          BOOST_REQUIRE(_recv_buffer.size() == 10);  // hello-back
           BOOST_REQUIRE(_recv_buffer.to_string() ==
                         "hello-back");  // hello-back
         }
@@ -204,13 +205,8 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
   w_tcp_server::run(
       _io, std::move(_endpoint), _timeout, std::move(_opts),
       [](_In_ const std::string &p_conn_id,
-         _Inout_ w_buffer &p_mut_data) -> auto{
-        // close on overflow
-        if (p_mut_data.used_bytes > 1025) {
-          return boost::system::errc::connection_aborted;
-        }
-
-        auto _reply = std::string(p_mut_data.buf.data(), p_mut_data.used_bytes);
+         _Inout_ wolf::system::w_pooled_buffer &p_mut_data) -> auto{
+        auto _reply = p_mut_data.to_string();
 
         std::cout << "tcp server just got: \"" << _reply
                   << "\" from connection id: " << p_conn_id << std::endl;
@@ -235,4 +231,497 @@ BOOST_AUTO_TEST_CASE(tcp_read_write_test) {
   std::cout << "leaving test case 'tcp_read_write_test'" << std::endl;
 }
 
+static boost::asio::awaitable<void> s_shards_bench_client(
+    _In_ const boost::asio::ip::tcp::endpoint p_endpoint, _In_ const size_t p_connections,
+    _Inout_ std::vector<double> &p_latencies_us) {
+  using tcp = boost::asio::ip::tcp;
+
+  auto _executor = co_await boost::asio::this_coro::executor;
+  auto _send = std::array<char, 64>{};
+  auto _recv = std::array<char, 64>{};
+  _send.fill('w');
+
+  for (size_t i = 0; i < p_connections; ++i) {
+    const auto _start = std::chrono::steady_clock::now();
+
+    auto _socket = tcp::socket(_executor);
+    co_await _socket.async_connect(p_endpoint, boost::asio::use_awaitable);
+    _socket.set_option(tcp::no_delay(true));
+    co_await boost::asio::async_write(_socket, boost::asio::buffer(_send),
+                                      boost::asio::use_awaitable);
+    co_await boost::asio::async_read(_socket, boost::asio::buffer(_recv),
+                                     boost::asio::use_awaitable);
+    _socket.close();
+
+    p_latencies_us.push_back(
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _start)
+            .count());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(tcp_server_shards_benchmark) {
+  std::cout << "entering test case 'tcp_server_shards_benchmark'" << std::endl;
+
+  using tcp = boost::asio::ip::tcp;
+  using w_tcp_server_shards = wolf::system::socket::w_tcp_server_shards;
+  using w_socket_options = wolf::system::socket::w_socket_options;
+
+  constexpr size_t _clients = 64;
+  constexpr size_t _connections_per_client = 200;
+  constexpr uint16_t _port = 8092;
+
+  const auto _cores = std::max(std::thread::hardware_concurrency(), 1U);
+  auto _shards_counts = std::vector<size_t>{};
+  for (size_t i = 1; i < _cores; i *= 2) {
+    _shards_counts.push_back(i);
+  }
+  _shards_counts.push_back(_cores);
+
+  for (const auto _shards_count : _shards_counts) {
+    const auto _endpoint = tcp::endpoint{boost::asio::ip::make_address("127.0.0.1"), _port};
+
+    auto _shards_res = w_tcp_server_shards::make(
+        _shards_count, _endpoint, std::chrono::seconds(10), w_socket_options{},
+        [](const std::string &p_conn_id, wolf::system::w_pooled_buffer &p_mut_data) -> auto{
+          // echo
+          return boost::system::errc::success;
+        },
+        [](const std::string &p_conn_id, const boost::system::system_error &p_error) {});
+    BOOST_REQUIRE(_shards_res);
+    auto _shards = std::move(_shards_res.value());
+
+    auto _io = boost::asio::io_context();
+    auto _latencies = std::vector<std::vector<double>>(_clients);
+    for (auto &_latency : _latencies) {
+      _latency.reserve(_connections_per_client);
+      boost::asio::co_spawn(_io,
+                            s_shards_bench_client(_endpoint, _connections_per_client, _latency),
+                            boost::asio::detached);
+    }
+
+    const auto _start = std::chrono::steady_clock::now();
+    {
+      auto _threads = std::vector<std::jthread>{};
+      for (size_t i = 0; i < _shards_count; ++i) {
+        _threads.emplace_back([&]() { _io.run(); });
+      }
+    }
+    const auto _elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+
+    _shards.reset();
+
+    auto _all = std::vector<double>{};
+    for (const auto &_latency : _latencies) {
+      _all.insert(_all.end(), _latency.cbegin(), _latency.cend());
+    }
+    BOOST_REQUIRE(_all.size() == _clients * _connections_per_client);
+    std::sort(_all.begin(), _all.end());
+
+    const auto _p99 = _all[_all.size() * 99 / 100];
+    std::cout << wolf::format("shards {:>3} | {:>10.0f} connections/s | p99 {:>8.1f} us",
+                              _shards_count, static_cast<double>(_all.size()) / _elapsed, _p99)
+              << std::endl;
+  }
+
+  std::cout << "leaving test case 'tcp_server_shards_benchmark'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_server_pipelined_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_server_pipelined_test'" << std::endl;
+
+  using tcp = boost::asio::ip::tcp;
+  using w_pooled_buffer = wolf::system::w_pooled_buffer;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  using w_socket_options = wolf::system::socket::w_socket_options;
+
+  auto _io = boost::asio::io_context();
+  constexpr uint16_t _port = 8094;
+
+  auto _res = w_tcp_server::run(
+      _io, tcp::endpoint{tcp::v4(), _port}, std::chrono::seconds(5), w_socket_options{},
+      [](const std::string &p_conn_id, const w_pooled_buffer &p_data,
+         std::vector<w_pooled_buffer> &p_mut_frames) -> auto{
+        const auto _msg = p_data.to_string_view();
+        if (_msg == "exit") {
+          return boost::system::errc::connection_aborted;
+        }
+        // no reply for "skip", two frames for the others
+        if (_msg != "skip") {
+          p_mut_frames.push_back(p_data);
+          p_mut_frames.emplace_back(std::string_view("-back"));
+        }
+        return boost::system::errc::success;
+      },
+      [](const std::string &p_conn_id, const boost::system::system_error &p_error) {});
+  BOOST_REQUIRE(_res);
+
+  boost::asio::co_spawn(
+      _io,
+      [&]() -> boost::asio::awaitable<void> {
+        auto _socket = tcp::socket(co_await boost::asio::this_coro::executor);
+        co_await _socket.async_connect({boost::asio::ip::make_address("127.0.0.1"), _port},
+                                       boost::asio::use_awaitable);
+
+        auto _reply = std::array<char, 10>{};
+        for (const auto _msg : {"hello", "skip", "world"}) {
+          co_await boost::asio::async_write(_socket, boost::asio::buffer(std::string_view(_msg)),
+                                            boost::asio::use_awaitable);
+          if (std::string_view(_msg) == "skip") {
+            continue;
+          }
+          co_await boost::asio::async_read(_socket, boost::asio::buffer(_reply),
+                                           boost::asio::use_awaitable);
+          BOOST_REQUIRE(std::string_view(_reply.data(), _reply.size()) ==
+                        std::string(_msg) + "-back");
+        }
+        co_await boost::asio::async_write(_socket, boost::asio::buffer(std::string_view("exit")),
+                                          boost::asio::use_awaitable);
+
+        // the server must close the connection after "exit"
+        boost::system::error_code _error_code;
+        co_await _socket.async_receive(
+            boost::asio::buffer(_reply),
+            boost::asio::redirect_error(boost::asio::use_awaitable, _error_code));
+        BOOST_REQUIRE(_error_code == boost::asio::error::eof);
+      },
+      [&](std::exception_ptr p_ex) {
+        BOOST_REQUIRE(p_ex == nullptr);
+        _io.stop();
+      });
+
+  _io.run();
+
+  std::cout << "leaving test case 'tcp_server_pipelined_test'" << std::endl;
+}
+
+static boost::asio::awaitable<void> s_pipelined_bench_client(_In_ const uint16_t p_port,
+                                                             _In_ const size_t p_requests,
+                                                             _Inout_ double &p_elapsed_secs) {
+  using tcp = boost::asio::ip::tcp;
+  using namespace boost::asio::experimental::awaitable_operators;
+
+  constexpr size_t _request_size = 64;
+  constexpr size_t _batch = 256;
+
+  auto _socket = tcp::socket(co_await boost::asio::this_coro::executor);
+  co_await _socket.async_connect({boost::asio::ip::make_address("127.0.0.1"), p_port},
+                                 boost::asio::use_awaitable);
+  _socket.set_option(tcp::no_delay(true));
+
+  auto _send = std::vector<char>(_request_size * _batch, 'w');
+  auto _recv = std::vector<char>(_request_size * _batch);
+
+  const auto _writer = [&]() -> boost::asio::awaitable<void> {
+    for (size_t i = 0; i < p_requests; i += _batch) {
+      co_await boost::asio::async_write(_socket, boost::asio::buffer(_send),
+                                        boost::asio::use_awaitable);
+    }
+  };
+  const auto _reader = [&]() -> boost::asio::awaitable<void> {
+    for (size_t i = 0; i < p_requests; i += _batch) {
+      co_await boost::asio::async_read(_socket, boost::asio::buffer(_recv),
+                                       boost::asio::use_awaitable);
+    }
+  };
+
+  const auto _start = std::chrono::steady_clock::now();
+  co_await (_writer() && _reader());
+  p_elapsed_secs =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+
+BOOST_AUTO_TEST_CASE(tcp_server_pipelined_benchmark) {
+  std::cout << "entering test case 'tcp_server_pipelined_benchmark'" << std::endl;
+
+  using tcp = boost::asio::ip::tcp;
+  using w_pooled_buffer = wolf::system::w_pooled_buffer;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  using w_socket_options = wolf::system::socket::w_socket_options;
+
+  constexpr size_t _requests = 256 * 1024;
+  // each mode has its own port, 8096 belongs to the framed read/write test
+  constexpr uint16_t _lockstep_port = 8095;
+  constexpr uint16_t _pipelined_port = 8098;
+
+  const auto _on_error = [](const std::string &p_conn_id,
+                            const boost::system::system_error &p_error) {};
+  const auto _report = [](const char *p_mode, double p_elapsed) {
+    std::cout << wolf::format("{:<9} | {:>10.0f} requests/s | {:>8.1f} MiB/s", p_mode,
+                              _requests / p_elapsed,
+                              _requests * 64 / p_elapsed / (1024.0 * 1024.0))
+              << std::endl;
+  };
+
+  // receive, callback then send in lockstep
+  {
+    auto _io = boost::asio::io_context();
+    double _elapsed = 0.0;
+    auto _res = w_tcp_server::run(
+        _io, tcp::endpoint{tcp::v4(), _lockstep_port}, std::chrono::seconds(30),
+        w_socket_options{},
+        [](const std::string &p_conn_id, w_pooled_buffer &p_mut_data) -> auto{
+          return boost::system::errc::success;
+        },
+        _on_error);
+    BOOST_REQUIRE(_res);
+
+    boost::asio::co_spawn(_io, s_pipelined_bench_client(_lockstep_port, _requests, _elapsed),
+                          [&](std::exception_ptr) { _io.stop(); });
+    _io.run();
+    _report("lockstep", _elapsed);
+  }
+
+  // concurrent reader and writer with gathered writes
+  {
+    auto _io = boost::asio::io_context();
+    double _elapsed = 0.0;
+    auto _res = w_tcp_server::run(
+        _io, tcp::endpoint{tcp::v4(), _pipelined_port}, std::chrono::seconds(30),
+        w_socket_options{},
+        [](const std::string &p_conn_id, const w_pooled_buffer &p_data,
+           std::vector<w_pooled_buffer> &p_mut_frames) -> auto{
+          p_mut_frames.push_back(p_data);
+          return boost::system::errc::success;
+        },
+        _on_error);
+    BOOST_REQUIRE(_res);
+
+    boost::asio::co_spawn(_io, s_pipelined_bench_client(_pipelined_port, _requests, _elapsed),
+                          [&](std::exception_ptr) { _io.stop(); });
+    _io.run();
+    _report("pipelined", _elapsed);
+  }
+
+  std::cout << "leaving test case 'tcp_server_pipelined_benchmark'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_frame_codec_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_frame_codec_test'" << std::endl;
+
+  using w_frame_codec = wolf::system::socket::w_frame_codec;
+  using w_frame_prefix = wolf::system::socket::w_frame_prefix;
+
+  boost::leaf::try_handle_all(
+      [&]() -> boost::leaf::result<void> {
+        auto _header = std::array<uint8_t, w_frame_codec::MAX_HEADER_SIZE>{};
+        size_t _payload_size = 0;
+
+        for (const auto _prefix : {w_frame_prefix::varint, w_frame_prefix::fixed32}) {
+          for (const size_t _size : {0, 1, 127, 128, 300, 16384, 1 << 24}) {
+            BOOST_LEAF_AUTO(_encoded, w_frame_codec::encode_header(_prefix, _size, _header));
+            BOOST_REQUIRE(_prefix == w_frame_prefix::varint || _encoded == 4);
+
+            // a partial prefix is not complete yet
+            BOOST_LEAF_AUTO(_partial, w_frame_codec::decode_header(
+                                          _prefix, gsl::span(_header.data(), _encoded - 1),
+                                          _payload_size));
+            BOOST_REQUIRE(_partial == 0);
+
+            BOOST_LEAF_AUTO(_decoded, w_frame_codec::decode_header(
+                                          _prefix, gsl::span(_header.data(), _encoded),
+                                          _payload_size));
+            BOOST_REQUIRE(_decoded == _encoded);
+            BOOST_REQUIRE(_payload_size == _size);
+          }
+        }
+
+        // a varint which never ends must be rejected
+        _header.fill(0xFF);
+        const auto _res = w_frame_codec::decode_header(w_frame_prefix::varint,
+                                                       gsl::span(_header), _payload_size);
+        BOOST_REQUIRE(!_res);
+
+        return {};
+      },
+      [](const w_trace &p_trace) {
+        const auto _msg =
+            wolf::format("tcp_frame_codec_test got an error : {}", p_trace.to_string());
+        BOOST_ERROR(_msg);
+      },
+      [] { BOOST_ERROR("tcp_frame_codec_test got an error!"); });
+
+  std::cout << "leaving test case 'tcp_frame_codec_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_framed_read_write_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'tcp_framed_read_write_test'" << std::endl;
+
+  using tcp = boost::asio::ip::tcp;
+  using w_pooled_buffer = wolf::system::w_pooled_buffer;
+  using w_tcp_client = wolf::system::socket::w_tcp_client;
+  using w_tcp_server = wolf::system::socket::w_tcp_server;
+  using w_socket_options = wolf::system::socket::w_socket_options;
+  using w_frame_prefix = wolf::system::socket::w_frame_prefix;
+  using w_frame_reader = wolf::system::socket::w_frame_reader;
+  using w_frame_writer = wolf::system::socket::w_frame_writer;
+
+  constexpr uint16_t _port = 8096;
+
+  for (const auto _prefix : {w_frame_prefix::varint, w_frame_prefix::fixed32}) {
+    auto _io = boost::asio::io_context();
+
+    auto _opts = w_socket_options{};
+    _opts.framing = _prefix;
+
+    // echo each frame, but split "hello world" into two frames
+    auto _res = w_tcp_server::run(
+        _io, tcp::endpoint{tcp::v4(), _port}, std::chrono::seconds(5), std::move(_opts),
+        [](const std::string &p_conn_id, const w_pooled_buffer &p_frame,
+           std::vector<w_pooled_buffer> &p_mut_frames) -> auto{
+          if (p_frame.to_string_view() == "hello world") {
+            p_mut_frames.emplace_back(std::string_view("hello"));
+            p_mut_frames.emplace_back(std::string_view("world"));
+          } else {
+            p_mut_frames.push_back(p_frame);
+          }
+          return boost::system::errc::success;
+        },
+        [](const std::string &p_conn_id, const boost::system::system_error &p_error) {});
+    BOOST_REQUIRE(_res);
+
+    boost::asio::co_spawn(
+        _io,
+        [&]() -> boost::asio::awaitable<void> {
+          auto _client = w_tcp_client(_io);
+          co_await _client.async_connect({boost::asio::ip::make_address("127.0.0.1"), _port},
+                                         w_socket_options{});
+
+          auto _reader = w_frame_reader(_prefix);
+          auto _writer = w_frame_writer(_prefix);
+
+          // a batch of frames with one send, the big one is bigger than the
+          // staging buffer of reader
+          const auto _big = std::string(100 * 1024, 'w');
+          const auto _frames = std::array<w_pooled_buffer, 3>{
+              w_pooled_buffer(std::string_view("hello world")), w_pooled_buffer(),
+              w_pooled_buffer(_big)};
+          co_await _client.async_write(_writer, _frames);
+
+          auto _frame = w_pooled_buffer();
+          for (const std::string_view _expected : {std::string_view("hello"),
+                                                   std::string_view("world"),
+                                                   std::string_view(), std::string_view(_big)}) {
+            const auto _size = co_await _client.async_read(_reader, _frame);
+            BOOST_REQUIRE(_size == _expected.size());
+            BOOST_REQUIRE(_frame.size() == _expected.size());
+            BOOST_REQUIRE(_frame.to_string_view() == _expected);
+          }
+          BOOST_REQUIRE(_reader.get_pending_bytes() == 0);
+        },
+        [&](std::exception_ptr p_ex) {
+          BOOST_REQUIRE(p_ex == nullptr);
+          _io.stop();
+        });
+
+    _io.run();
+  }
+
+  std::cout << "leaving test case 'tcp_framed_read_write_test'" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(tcp_framing_benchmark) {
+  std::cout << "entering test case 'tcp_framing_benchmark'" << std::endl;
+
+  using tcp = boost::asio::ip::tcp;
+  using w_pooled_buffer = wolf::system::w_pooled_buffer;
+  using w_frame_prefix = wolf::system::socket::w_frame_prefix;
+  using w_frame_reader = wolf::system::socket::w_frame_reader;
+  using w_frame_writer = wolf::system::socket::w_frame_writer;
+
+  constexpr uint16_t _port = 8097;
+  constexpr size_t _frames_count = 200000;
+
+  for (const size_t _frame_size : {32, 512, 8 * 1024}) {
+    // a stream of fixed32 prefixed frames
+    const auto _frames =
+        std::vector<w_pooled_buffer>(256, w_pooled_buffer(std::string(_frame_size, 'w')));
+    auto _writer = w_frame_writer(w_frame_prefix::fixed32);
+    auto _stream = std::vector<uint8_t>();
+    for (const auto &_buffer : _writer.prepare(_frames)) {
+      const auto *_data = static_cast<const uint8_t *>(_buffer.data());
+      _stream.insert(_stream.end(), _data, _data + _buffer.size());
+    }
+
+    for (const auto _framed : {false, true}) {
+      auto _io = boost::asio::io_context();
+      auto _acceptor = tcp::acceptor(_io, {tcp::v4(), _port});
+      double _elapsed = 0.0;
+      size_t _bytes = 0;
+
+      boost::asio::co_spawn(
+          _io,
+          [&]() -> boost::asio::awaitable<void> {
+            auto _socket = co_await _acceptor.async_accept(boost::asio::use_awaitable);
+            for (size_t i = 0; i < _frames_count; i += _frames.size()) {
+              co_await boost::asio::async_write(_socket, boost::asio::buffer(_stream),
+                                                boost::asio::use_awaitable);
+            }
+          },
+          boost::asio::detached);
+
+      boost::asio::co_spawn(
+          _io,
+          [&]() -> boost::asio::awaitable<void> {
+            auto _socket = tcp::socket(_io);
+            co_await _socket.async_connect({boost::asio::ip::make_address("127.0.0.1"), _port},
+                                           boost::asio::use_awaitable);
+            const auto _start = std::chrono::steady_clock::now();
+
+            if (_framed) {
+              auto _reader = w_frame_reader(w_frame_prefix::fixed32);
+              auto _frame = w_pooled_buffer();
+              for (size_t i = 0; i < _frames_count; ++i) {
+                if (!_reader.try_decode(_frame)) {
+                  co_await _reader.async_read(_socket, _frame);
+                }
+                _bytes += _frame.size();
+              }
+            } else {
+              // rebuild the boundaries from raw chunks, the way it was done
+              // on top of w_tcp_client::async_read
+              auto _pending = std::string();
+              auto _chunk = std::array<char, 4096>{};
+              for (size_t i = 0; i < _frames_count;) {
+                const auto _size = co_await _socket.async_read_some(
+                    boost::asio::buffer(_chunk), boost::asio::use_awaitable);
+                _pending.append(_chunk.data(), _size);
+                while (_pending.size() >= 4) {
+                  const auto *_header = reinterpret_cast<const uint8_t *>(_pending.data());
+                  const size_t _payload_size = (size_t(_header[0]) << 24) |
+                                               (size_t(_header[1]) << 16) |
+                                               (size_t(_header[2]) << 8) | size_t(_header[3]);
+                  if (_pending.size() < 4 + _payload_size) {
+                    break;
+                  }
+                  const auto _frame = _pending.substr(4, _payload_size);
+                  _pending.erase(0, 4 + _payload_size);
+                  _bytes += _frame.size();
+                  i++;
+                }
+              }
+            }
+            _elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start)
+                           .count();
+          },
+          [&](std::exception_ptr) { _io.stop(); });
+
+      _io.run();
+
+      std::cout << wolf::format("{:<14} | {:>6} bytes | {:>10.0f} frames/s | {:>8.1f} MiB/s",
+                                _framed ? "w_frame_reader" : "manual parse", _frame_size,
+                                _frames_count / _elapsed, _bytes / _elapsed / (1024.0 * 1024.0))
+                << std::endl;
+    }
+  }
+
+  std::cout << "leaving test case 'tcp_framing_benchmark'" << std::endl;
+}
+
 #endif  // defined(WOLF_TEST) && defined(WOLF_SYSTEM_SOCKET)
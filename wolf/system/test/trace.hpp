@@ -9,6 +9,11 @@
 #include <system/w_leak_detector.hpp>
 #include <wolf/wolf.hpp>
 
+#include <chrono>
+#include <deque>
+
+#include "alloc_counter.hpp"
+
 BOOST_AUTO_TEST_CASE(trace_test) {
   const wolf::system::w_leak_detector _detector = {};
 
@@ -40,4 +45,111 @@ BOOST_AUTO_TEST_CASE(trace_test) {
   std::cout << "leaving test case 'trace_test'" << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(trace_format_test) {
+  const wolf::system::w_leak_detector _detector = {};
+
+  std::cout << "entering test case 'trace_format_test'" << std::endl;
+
+  const auto _allocs = get_test_alloc_count();
+  const auto _trace = w_trace(std::errc::timed_out, std::source_location::current(),
+                              "read {} bytes from {} ({}s), {{retry}}: {}", size_t(64),
+                              std::string_view("127.0.0.1"), 0.5, true);
+  BOOST_REQUIRE(get_test_alloc_count() == _allocs);
+
+  const auto _stacks = _trace.get_stacks();
+  BOOST_REQUIRE(_stacks.size() == 1);
+  BOOST_REQUIRE(_stacks[0].err_code == static_cast<int64_t>(std::errc::timed_out));
+  BOOST_REQUIRE(_stacks[0].message() ==
+                "read 64 bytes from 127.0.0.1 (0.500000s), {retry}: true");
+  BOOST_REQUIRE(std::string_view(_stacks[0].source_file).ends_with("trace.hpp"));
+
+  // the first frame and the latest ones are kept
+  auto _deep = w_trace(1, "origin", __FILE__, __LINE__);
+  for (int i = 0; i < 2 * gsl::narrow_cast<int>(w_trace::MAX_STACKS); ++i) {
+    _deep.push(i, std::source_location::current(), "frame {}", i);
+  }
+  BOOST_REQUIRE(_deep.get_stacks().size() == w_trace::MAX_STACKS);
+  BOOST_REQUIRE(_deep.get_stacks().front().message() == "origin");
+  BOOST_REQUIRE(_deep.get_stacks().back().message() ==
+                wolf::format("frame {}", 2 * w_trace::MAX_STACKS - 1));
+  BOOST_REQUIRE(_deep.get_dropped() == w_trace::MAX_STACKS + 1);
+
+  // long messages are truncated
+  const auto _long = w_trace(2, std::string(1024, 'w'), __FILE__, __LINE__);
+  BOOST_REQUIRE(_long.get_stacks()[0].message().size() == w_trace::MAX_TEXT_SIZE);
+
+  std::cout << "leaving test case 'trace_format_test'" << std::endl;
+}
+
+// the trace which was used before w_trace kept its frames inline, it is kept
+// here as the baseline of benchmark
+struct w_legacy_trace {
+  struct stack {
+    std::thread::id thread_id;
+    int64_t err_code = 0;
+    std::string err_msg;
+    std::string source_file;
+    int source_file_line = 0;
+  };
+
+  w_legacy_trace(_In_ std::errc p_err_code, _In_ std::string p_err_msg,
+                 _In_ const char *p_source_file, _In_ int p_source_file_line) noexcept {
+    try {
+      this->stacks.emplace_front(stack{std::this_thread::get_id(),
+                                       static_cast<int64_t>(p_err_code),
+                                       std::move(p_err_msg), p_source_file,
+                                       p_source_file_line});
+    } catch (...) {
+    }
+  }
+
+  std::deque<stack> stacks;
+};
+
+BOOST_AUTO_TEST_CASE(trace_benchmark) {
+  std::cout << "entering test case 'trace_benchmark'" << std::endl;
+
+  using clock = std::chrono::steady_clock;
+  constexpr size_t _iterations = 1000000;
+
+  const auto _run = [&](const char *p_name, auto &&p_fail) {
+    size_t _handled = 0;
+    const auto _allocs = get_test_alloc_count();
+    const auto _start = clock::now();
+    for (size_t i = 0; i < _iterations; ++i) {
+      boost::leaf::try_handle_all(
+          [&]() -> boost::leaf::result<void> { return p_fail(i); },
+          [&](const w_legacy_trace &) { _handled++; },
+          [&](const w_trace &) { _handled++; }, [] {});
+    }
+    const auto _elapsed = clock::now() - _start;
+    BOOST_REQUIRE(_handled == _iterations);
+
+    std::cout << wolf::format(
+                     "{:<16} | {:>8.1f} ns/op | {:>5.2f} allocs/op", p_name,
+                     std::chrono::duration<double, std::nano>(_elapsed).count() / _iterations,
+                     static_cast<double>(get_test_alloc_count() - _allocs) / _iterations)
+              << std::endl;
+  };
+
+  _run("legacy", [](size_t p_index) -> boost::leaf::result<void> {
+    return boost::leaf::new_error(
+        w_legacy_trace(std::errc::timed_out,
+                       "could not read " + std::to_string(p_index) + " bytes", __FILE__,
+                       __LINE__));
+  });
+  _run("w_trace string", [](size_t p_index) -> boost::leaf::result<void> {
+    return W_FAILURE(std::errc::timed_out,
+                     "could not read " + std::to_string(p_index) + " bytes");
+  });
+  _run("w_trace literal", [](size_t) -> boost::leaf::result<void> {
+    return W_FAILURE(std::errc::timed_out, "could not read the bytes");
+  });
+  _run("w_trace lazy", [](size_t p_index) -> boost::leaf::result<void> {
+    return W_FAILURE(std::errc::timed_out, "could not read {} bytes", p_index);
+  });
+
+  std::cout << "leaving test case 'trace_benchmark'" << std::endl;
+}
+
 #endif  // WOLF_TESTS
\ No newline at end of file
@@ -45,10 +45,11 @@ BOOST_AUTO_TEST_CASE(ws_server_timeout_test) {
 
   w_ws_server::run(
       _io, std::move(_endpoint), _timeout, std::move(_opts),
-      [](const std::string &p_conn_id, _Inout_ w_buffer &p_buffer,
+      [](const std::string &p_conn_id,
+         _Inout_ wolf::system::w_pooled_buffer &p_buffer,
          _Inout_ bool &p_is_binary) -> auto{
         std::cout << "websocket server just got: /'" << p_buffer.to_string()
-                  << "/' and " << p_buffer.used_bytes
+                  << "/' and " << p_buffer.size()
                   << " bytes from connection id: " << p_conn_id << std::endl;
         return boost::beast::websocket::close_code::normal;
       },
@@ -0,0 +1,269 @@
+#include "w_pooled_buffer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using w_pooled_buffer = wolf::system::w_pooled_buffer;
+using w_pooled_buffer_stats = wolf::system::w_pooled_buffer_stats;
+using block = w_pooled_buffer::block;
+
+constexpr auto LARGE_SIZE_CLASS = std::numeric_limits<uint32_t>::max();
+constexpr size_t SLAB_SIZE = 256 * 1024;
+
+struct w_size_class_pool {
+  std::mutex mutex;
+  block *free_list = nullptr;
+  std::vector<void *> slabs;
+  size_t in_use = 0;
+};
+
+struct w_pool {
+  w_pool() noexcept = default;
+
+  ~w_pool() noexcept {
+    // the slabs of a size class which still has live blocks will be
+    // left for the os, since the buffers may be released after this pool
+    for (auto &_class : this->classes) {
+      if (_class.in_use == 0) {
+        for (auto *_slab : _class.slabs) {
+          std::free(_slab);
+        }
+      }
+    }
+  }
+
+  w_pool(const w_pool &) = delete;
+  w_pool &operator=(const w_pool &) = delete;
+  w_pool(w_pool &&) = delete;
+  w_pool &operator=(w_pool &&) = delete;
+
+  std::array<w_size_class_pool, w_pooled_buffer::SIZE_CLASSES.size()> classes;
+  std::atomic<uint64_t> slab_allocations = 0;
+  std::atomic<uint64_t> large_allocations = 0;
+  std::atomic<uint64_t> acquires = 0;
+  std::atomic<uint64_t> releases = 0;
+};
+
+static w_pool &s_pool() noexcept {
+  static w_pool _pool;
+  return _pool;
+}
+
+static uint32_t s_size_class(_In_ size_t p_size) noexcept {
+  const auto &_classes = w_pooled_buffer::SIZE_CLASSES;
+  for (uint32_t i = 0; i < _classes.size(); ++i) {
+    if (p_size <= gsl::at(_classes, i)) {
+      return i;
+    }
+  }
+  return LARGE_SIZE_CLASS;
+}
+
+static block *s_make_block(_In_ void *p_mem, _In_ uint32_t p_size_class,
+                           _In_ size_t p_capacity) noexcept {
+  auto *_block = new (p_mem) block{};
+  _block->refs.store(1, std::memory_order_relaxed);
+  _block->size_class = p_size_class;
+  _block->capacity = p_capacity;
+  _block->next = nullptr;
+  return _block;
+}
+
+static block *s_acquire(_In_ size_t p_size) {
+  auto &_pool = s_pool();
+  _pool.acquires.fetch_add(1, std::memory_order_relaxed);
+
+  const auto _size_class = s_size_class(p_size);
+  if (_size_class == LARGE_SIZE_CLASS) {
+    auto *_mem = std::malloc(sizeof(block) + p_size);
+    if (_mem == nullptr) {
+      throw std::bad_alloc();
+    }
+    _pool.large_allocations.fetch_add(1, std::memory_order_relaxed);
+    return s_make_block(_mem, LARGE_SIZE_CLASS, p_size);
+  }
+
+  const auto _capacity = gsl::at(w_pooled_buffer::SIZE_CLASSES, _size_class);
+  auto &_class = gsl::at(_pool.classes, _size_class);
+
+  const std::scoped_lock _lock(_class.mutex);
+  if (_class.free_list == nullptr) {
+    // carve a new slab into blocks of this size class
+    const auto _stride = sizeof(block) + _capacity;
+    const auto _count = std::max<size_t>(1, SLAB_SIZE / _stride);
+
+    _class.slabs.reserve(_class.slabs.size() + 1);
+    auto *_slab = static_cast<std::byte *>(std::malloc(_stride * _count));
+    if (_slab == nullptr) {
+      throw std::bad_alloc();
+    }
+    _class.slabs.push_back(_slab);
+    _pool.slab_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < _count; ++i) {
+      auto *_block = s_make_block(_slab + i * _stride, _size_class, _capacity);
+      _block->next = _class.free_list;
+      _class.free_list = _block;
+    }
+  }
+
+  auto *_block = _class.free_list;
+  _class.free_list = _block->next;
+  _class.in_use++;
+
+  _block->next = nullptr;
+  _block->refs.store(1, std::memory_order_relaxed);
+  return _block;
+}
+
+static void s_release(_In_ block *p_block) noexcept {
+  if (p_block == nullptr ||
+      p_block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  auto &_pool = s_pool();
+  _pool.releases.fetch_add(1, std::memory_order_relaxed);
+
+  if (p_block->size_class == LARGE_SIZE_CLASS) {
+    p_block->~block();
+    std::free(p_block);
+    return;
+  }
+
+  auto &_class = gsl::at(_pool.classes, p_block->size_class);
+  const std::scoped_lock _lock(_class.mutex);
+  p_block->next = _class.free_list;
+  _class.free_list = p_block;
+  _class.in_use--;
+}
+
+w_pooled_buffer::w_pooled_buffer(_In_ size_t p_size)
+    : _block(p_size == 0 ? nullptr : s_acquire(p_size)), _size(p_size) {}
+
+w_pooled_buffer::w_pooled_buffer(_In_ std::string_view p_str) {
+  from_string(p_str);
+}
+
+w_pooled_buffer::w_pooled_buffer(const w_pooled_buffer &p_other) noexcept
+    : _block(p_other._block), _size(p_other._size) {
+  if (this->_block != nullptr) {
+    this->_block->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+w_pooled_buffer &w_pooled_buffer::operator=(
+    const w_pooled_buffer &p_other) noexcept {
+  if (this != &p_other) {
+    if (p_other._block != nullptr) {
+      p_other._block->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_release(this->_block);
+    this->_block = p_other._block;
+    this->_size = p_other._size;
+  }
+  return *this;
+}
+
+w_pooled_buffer::w_pooled_buffer(w_pooled_buffer &&p_other) noexcept
+    : _block(std::exchange(p_other._block, nullptr)),
+      _size(std::exchange(p_other._size, 0)) {}
+
+w_pooled_buffer &w_pooled_buffer::operator=(
+    w_pooled_buffer &&p_other) noexcept {
+  if (this != &p_other) {
+    s_release(this->_block);
+    this->_block = std::exchange(p_other._block, nullptr);
+    this->_size = std::exchange(p_other._size, 0);
+  }
+  return *this;
+}
+
+w_pooled_buffer::~w_pooled_buffer() noexcept { s_release(this->_block); }
+
+void w_pooled_buffer::resize(_In_ size_t p_size) {
+  reserve(p_size);
+  this->_size = p_size;
+}
+
+void w_pooled_buffer::reserve(_In_ size_t p_capacity) {
+  if (p_capacity <= capacity()) {
+    return;
+  }
+
+  auto *_block = s_acquire(p_capacity);
+  if (this->_size != 0) {
+    std::memcpy(reinterpret_cast<char *>(_block + 1), data(), this->_size);
+  }
+  s_release(this->_block);
+  this->_block = _block;
+}
+
+void w_pooled_buffer::make_unique() {
+  if (this->_block == nullptr || unique()) {
+    return;
+  }
+
+  auto *_block = s_acquire(capacity());
+  std::memcpy(reinterpret_cast<char *>(_block + 1), data(), this->_size);
+  s_release(this->_block);
+  this->_block = _block;
+}
+
+void w_pooled_buffer::reset() noexcept {
+  s_release(this->_block);
+  this->_block = nullptr;
+  this->_size = 0;
+}
+
+void w_pooled_buffer::from_string(_In_ std::string_view p_str) {
+  // never write into a storage which is shared with other owners
+  if (!unique()) {
+    reset();
+  }
+  this->_size = 0;
+  resize(p_str.size());
+  if (!p_str.empty()) {
+    std::memcpy(data(), p_str.data(), p_str.size());
+  }
+}
+
+std::string w_pooled_buffer::to_string() const {
+  if (this->_size == 0) {
+    return {};
+  }
+  return {data(), this->_size};
+}
+
+bool w_pooled_buffer::unique() const noexcept {
+  return this->_block == nullptr ||
+         this->_block->refs.load(std::memory_order_acquire) == 1;
+}
+
+w_pooled_buffer_stats w_pooled_buffer::get_stats() noexcept {
+  const auto &_pool = s_pool();
+  return w_pooled_buffer_stats{
+      _pool.slab_allocations.load(std::memory_order_relaxed),
+      _pool.large_allocations.load(std::memory_order_relaxed),
+      _pool.acquires.load(std::memory_order_relaxed),
+      _pool.releases.load(std::memory_order_relaxed)};
+}
+
+void w_pooled_buffer::trim() noexcept {
+  for (auto &_class : s_pool().classes) {
+    const std::scoped_lock _lock(_class.mutex);
+    if (_class.in_use != 0) {
+      continue;
+    }
+    for (auto *_slab : _class.slabs) {
+      std::free(_slab);
+    }
+    _class.slabs.clear();
+    _class.slabs.shrink_to_fit();
+    _class.free_list = nullptr;
+  }
+}
@@ -0,0 +1,163 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace wolf::system {
+
+/*
+ * the statistics of the shared pool of w_pooled_buffer
+ */
+struct w_pooled_buffer_stats {
+  // number of slabs which were allocated from the heap
+  uint64_t slab_allocations = 0;
+  // number of blocks which were bigger than the largest size class and
+  // allocated directly from the heap
+  uint64_t large_allocations = 0;
+  // number of blocks which were taken from the pool
+  uint64_t acquires = 0;
+  // number of blocks which were given back to the pool
+  uint64_t releases = 0;
+};
+
+/*
+ * a refcounted, variable-size byte buffer which takes its storage from a
+ * shared slab pool with power-of-four size classes. copies of a buffer share
+ * the same storage, so a buffer can be handed over to another owner (e.g.
+ * from a socket session to the user) without copying bytes.
+ */
+class w_pooled_buffer {
+ public:
+  // size classes of the pool, bigger blocks are allocated from the heap
+  static constexpr std::array<size_t, 7> SIZE_CLASSES = {
+      256, 1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024};
+
+  // default constructor
+  W_API w_pooled_buffer() noexcept = default;
+
+  /*
+   * create a buffer with p_size bytes
+   * @param p_size, the size of buffer in bytes
+   */
+  W_API explicit w_pooled_buffer(_In_ size_t p_size);
+
+  /*
+   * create a buffer with a copy of a string
+   * @param p_str, the source string
+   */
+  W_API explicit w_pooled_buffer(_In_ std::string_view p_str);
+
+  // copy constructor, shares the storage of p_other
+  W_API w_pooled_buffer(const w_pooled_buffer &p_other) noexcept;
+
+  // copy assignment operator, shares the storage of p_other
+  W_API w_pooled_buffer &operator=(const w_pooled_buffer &p_other) noexcept;
+
+  // move constructor
+  W_API w_pooled_buffer(w_pooled_buffer &&p_other) noexcept;
+
+  // move assignment operator
+  W_API w_pooled_buffer &operator=(w_pooled_buffer &&p_other) noexcept;
+
+  // destructor
+  W_API ~w_pooled_buffer() noexcept;
+
+  /*
+   * resize the buffer, the content will be kept and the storage will be
+   * taken from a bigger size class if needed
+   * @param p_size, the new size in bytes
+   */
+  W_API void resize(_In_ size_t p_size);
+
+  /*
+   * make sure the buffer has at least p_capacity bytes of storage
+   * @param p_capacity, the requested capacity in bytes
+   */
+  W_API void reserve(_In_ size_t p_capacity);
+
+  /*
+   * detach from the shared storage, if there is another owner the content
+   * will be copied into a new block
+   */
+  W_API void make_unique();
+
+  /*
+   * give the storage back to the pool
+   */
+  W_API void reset() noexcept;
+
+  /*
+   * copy a string into the buffer, the buffer will grow when needed
+   * @param p_str, the source string
+   */
+  W_API void from_string(_In_ std::string_view p_str);
+
+  // returns a copy of the buffer as string
+  [[nodiscard]] W_API std::string to_string() const;
+
+  // returns a view of the buffer
+  [[nodiscard]] std::string_view to_string_view() const noexcept {
+    return {data(), this->_size};
+  }
+
+  [[nodiscard]] char *data() noexcept {
+    return this->_block == nullptr ? nullptr
+                                   : reinterpret_cast<char *>(this->_block + 1);
+  }
+
+  [[nodiscard]] const char *data() const noexcept {
+    return this->_block == nullptr
+               ? nullptr
+               : reinterpret_cast<const char *>(this->_block + 1);
+  }
+
+  [[nodiscard]] gsl::span<std::byte> as_bytes() noexcept {
+    return {reinterpret_cast<std::byte *>(data()), this->_size};
+  }
+
+  [[nodiscard]] gsl::span<const std::byte> as_bytes() const noexcept {
+    return {reinterpret_cast<const std::byte *>(data()), this->_size};
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return this->_size; }
+
+  [[nodiscard]] bool empty() const noexcept { return this->_size == 0; }
+
+  [[nodiscard]] size_t capacity() const noexcept {
+    return this->_block == nullptr ? 0 : this->_block->capacity;
+  }
+
+  // returns true if this buffer is the only owner of its storage
+  [[nodiscard]] W_API bool unique() const noexcept;
+
+  // returns a snapshot of the statistics of the shared pool
+  [[nodiscard]] W_API static w_pooled_buffer_stats get_stats() noexcept;
+
+  /*
+   * free the slabs of the size classes which have no block in use, this is
+   * useful before checking for memory leaks
+   */
+  W_API static void trim() noexcept;
+
+  struct alignas(std::max_align_t) block {
+    std::atomic<uint32_t> refs;
+    uint32_t size_class;
+    size_t capacity;
+    block *next;
+  };
+
+ private:
+  block *_block = nullptr;
+  size_t _size = 0;
+};
+}  // namespace wolf::system
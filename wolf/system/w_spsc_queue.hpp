@@ -0,0 +1,105 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace wolf::system {
+
+/*
+ * a bounded, lock-free, single-producer/single-consumer ring buffer.
+ * one thread (or coroutine) may only push and another one may only pop,
+ * neither of them ever blocks or allocates after construction.
+ */
+template <typename T> class w_spsc_queue {
+ public:
+  /*
+   * @param p_capacity, the capacity of queue, it will be rounded up to the
+   * next power of two
+   */
+  explicit w_spsc_queue(_In_ size_t p_capacity)
+      : _slots(std::bit_ceil(std::max<size_t>(p_capacity, 2))),
+        _mask(_slots.size() - 1) {}
+
+  w_spsc_queue(const w_spsc_queue &) = delete;
+  w_spsc_queue &operator=(const w_spsc_queue &) = delete;
+  w_spsc_queue(w_spsc_queue &&) = delete;
+  w_spsc_queue &operator=(w_spsc_queue &&) = delete;
+  ~w_spsc_queue() noexcept = default;
+
+  /*
+   * push an item, only call it from the producer
+   * @param p_item, the item which will be moved into the queue
+   * @returns false if the queue is full, p_item is left untouched then
+   */
+  [[nodiscard]] bool try_push(_Inout_ T &p_item) noexcept(
+      std::is_nothrow_move_assignable_v<T>) {
+    const auto _tail = this->_tail.load(std::memory_order_relaxed);
+    if (_tail - this->_head_cache == this->_slots.size()) {
+      this->_head_cache = this->_head.load(std::memory_order_acquire);
+      if (_tail - this->_head_cache == this->_slots.size()) {
+        return false;
+      }
+    }
+    this->_slots[_tail & this->_mask] = std::move(p_item);
+    this->_tail.store(_tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*
+   * pop an item, only call it from the consumer
+   * @returns the front item or std::nullopt if the queue is empty
+   */
+  [[nodiscard]] std::optional<T> try_pop() noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    const auto _head = this->_head.load(std::memory_order_relaxed);
+    if (_head == this->_tail_cache) {
+      this->_tail_cache = this->_tail.load(std::memory_order_acquire);
+      if (_head == this->_tail_cache) {
+        return std::nullopt;
+      }
+    }
+    auto _item = std::optional<T>(std::move(this->_slots[_head & this->_mask]));
+    // release the resources of the moved-from slot right away
+    this->_slots[_head & this->_mask] = T{};
+    this->_head.store(_head + 1, std::memory_order_release);
+    return _item;
+  }
+
+  // returns an estimated number of items, exact when called from either side
+  [[nodiscard]] size_t size() const noexcept {
+    return this->_tail.load(std::memory_order_acquire) -
+           this->_head.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  [[nodiscard]] size_t capacity() const noexcept { return this->_slots.size(); }
+
+ private:
+  // a fixed line size, std::hardware_destructive_interference_size may differ
+  // between compilers and flags, which would change the layout of this type
+  static constexpr size_t CACHE_LINE = 64;
+
+  std::vector<T> _slots;
+  const size_t _mask;
+
+  // the consumer side
+  alignas(CACHE_LINE) std::atomic<size_t> _head = 0;
+  size_t _tail_cache = 0;
+
+  // the producer side
+  alignas(CACHE_LINE) std::atomic<size_t> _tail = 0;
+  size_t _head_cache = 0;
+};
+
+}  // namespace wolf::system
@@ -0,0 +1,174 @@
+/*
+    Project: Wolf Engine. Copyright © 2014-2023 Pooya Eimandar
+    https://github.com/WolfEngine/wolf
+*/
+
+#pragma once
+
+#include <wolf/wolf.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace wolf::system {
+
+/*
+ * a fixed set of worker threads which run data-parallel loops. the threads
+ * are created once and sleep between the loops, the calling thread takes
+ * part in every loop, so a pool with a concurrency of N owns N - 1 threads.
+ * only one loop runs at a time, parallel_for calls from several threads are
+ * serialized.
+ */
+class w_thread_pool {
+ public:
+  /*
+   * @param p_concurrency, number of threads which run a loop including the
+   * calling thread, zero for the number of cores
+   */
+  explicit w_thread_pool(_In_ size_t p_concurrency = 0) {
+    if (p_concurrency == 0) {
+      p_concurrency = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    this->_threads.reserve(p_concurrency - 1);
+    for (size_t i = 1; i < p_concurrency; ++i) {
+      this->_threads.emplace_back([this]() { worker(); });
+    }
+  }
+
+  w_thread_pool(const w_thread_pool &) = delete;
+  w_thread_pool &operator=(const w_thread_pool &) = delete;
+  w_thread_pool(w_thread_pool &&) = delete;
+  w_thread_pool &operator=(w_thread_pool &&) = delete;
+
+  ~w_thread_pool() noexcept {
+    {
+      const auto _lock = std::scoped_lock(this->_mutex);
+      this->_stopped = true;
+    }
+    this->_wake.notify_all();
+    for (auto &_thread : this->_threads) {
+      _thread.join();
+    }
+  }
+
+  /*
+   * run p_func(i) for every i in [0, p_count) on the workers and the calling
+   * thread, the indices are handed out one at a time so uneven items are
+   * balanced. returns when all of them are done.
+   * @param p_count, number of items
+   * @param p_func, the function which must not throw
+   */
+  template <typename F>
+  void parallel_for(_In_ size_t p_count, _In_ F &&p_func) noexcept {
+    if (p_count == 0) {
+      return;
+    }
+    if (p_count == 1 || this->_threads.empty()) {
+      for (size_t i = 0; i < p_count; ++i) {
+        p_func(i);
+      }
+      return;
+    }
+
+    const auto _serial = std::scoped_lock(this->_serial_mutex);
+
+    // the loop body is passed by address, so nothing is allocated per loop
+    using w_body = std::remove_reference_t<F>;
+    w_func _invoke = [](void *p_ctx, size_t p_index) {
+      (*static_cast<w_body *>(p_ctx))(p_index);
+    };
+    {
+      const auto _lock = std::scoped_lock(this->_mutex);
+      this->_func = _invoke;
+      this->_ctx = const_cast<void *>(static_cast<const void *>(&p_func));
+      this->_count = p_count;
+      this->_next.store(0, std::memory_order_relaxed);
+      this->_pending = this->_threads.size();
+      this->_generation++;
+    }
+    this->_wake.notify_all();
+
+    run(_invoke, this->_ctx, p_count);
+
+    auto _lock = std::unique_lock(this->_mutex);
+    this->_done.wait(_lock, [this]() { return this->_pending == 0; });
+  }
+
+  // returns number of the threads which run a loop, including the caller
+  [[nodiscard]] size_t get_concurrency() const noexcept { return this->_threads.size() + 1; }
+
+ private:
+  using w_func = void (*)(void *, size_t);
+
+  void run(_In_ w_func p_func, _In_ void *p_ctx, _In_ size_t p_count) noexcept {
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      const auto _index = this->_next.fetch_add(1, std::memory_order_relaxed);
+      if (_index >= p_count) {
+        return;
+      }
+      p_func(p_ctx, _index);
+    }
+  }
+
+  void worker() noexcept {
+    uint64_t _generation = 0;
+#ifdef __clang__
+#pragma unroll
+#endif
+    for (;;) {
+      w_func _func = nullptr;
+      void *_ctx = nullptr;
+      size_t _count = 0;
+      {
+        auto _lock = std::unique_lock(this->_mutex);
+        this->_wake.wait(_lock, [&]() {
+          return this->_stopped || this->_generation != _generation;
+        });
+        if (this->_stopped) {
+          return;
+        }
+        _generation = this->_generation;
+        _func = this->_func;
+        _ctx = this->_ctx;
+        _count = this->_count;
+      }
+
+      run(_func, _ctx, _count);
+
+      {
+        const auto _lock = std::scoped_lock(this->_mutex);
+        this->_pending--;
+        if (this->_pending != 0) {
+          continue;
+        }
+      }
+      this->_done.notify_one();
+    }
+  }
+
+  std::vector<std::thread> _threads;
+  std::mutex _serial_mutex;
+
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+  bool _stopped = false;
+  uint64_t _generation = 0;
+  size_t _pending = 0;
+
+  // the current loop
+  w_func _func = nullptr;
+  void *_ctx = nullptr;
+  size_t _count = 0;
+  std::atomic<size_t> _next = 0;
+};
+
+}  // namespace wolf::system
@@ -7,94 +7,258 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <array>
 #include <boost/leaf.hpp>
-#include <deque>
+#include <concepts>
 #include <gsl/gsl>
 #include <iostream>
 #include <ostream>
+#include <source_location>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
 
+/*
+ * the format of a failure, it must be a string literal, so it can be kept as
+ * a pointer and formatted only when the trace is printed. it supports the
+ * "{}" placeholders, "{{" and "}}" escape the braces.
+ */
+struct w_trace_format {
+  template <typename T>
+    requires std::convertible_to<const T &, const char *>
+  consteval w_trace_format(const T &p_str) noexcept : str(p_str) {}
+
+  const char *str;
+};
+
+/*
+ * the trace of an error, the frames, their messages and arguments are kept
+ * inline, so creating, propagating and handling an error does not allocate.
+ * the source locations are pointers to the static strings of
+ * std::source_location.
+ */
 class w_trace {
  public:
+  // the maximum number of frames, the first frame and the latest ones are
+  // kept when more frames are pushed
+  static constexpr size_t MAX_STACKS = 8;
+  // the maximum number of lazily formatted arguments of a frame
+  static constexpr size_t MAX_ARGS = 4;
+  // the size of the inline text of a frame, longer messages are truncated
+  static constexpr size_t MAX_TEXT_SIZE = 144;
+
+  struct arg {
+    enum class kind : uint8_t { none = 0, boolean, int64, uint64, float64, text };
+
+    kind type = kind::none;
+    uint16_t text_offset = 0;
+    uint16_t text_size = 0;
+    union {
+      int64_t i64;
+      uint64_t u64;
+      double f64;
+    } value = {0};
+  };
+
   struct stack {
-    friend std::ostream &operator<<(std::ostream &p_os,
-                                    stack const &p_trace) noexcept {
+    /*
+     * format the message of the frame
+     * @returns the message
+     */
+    std::string message() const {
+      const auto _text = std::string_view(this->text.data(), this->text_size);
+      if (this->format == nullptr) {
+        return std::string(_text);
+      }
+
+      std::string _result;
+      size_t _arg_index = 0;
+      for (const char *_ptr = this->format; *_ptr != '\0'; ++_ptr) {
+        if ((_ptr[0] == '{' && _ptr[1] == '{') || (_ptr[0] == '}' && _ptr[1] == '}')) {
+          _result.push_back(*_ptr++);
+          continue;
+        }
+        if (_ptr[0] != '{') {
+          _result.push_back(*_ptr);
+          continue;
+        }
+
+        // skip the specification of placeholder
+        while (_ptr[1] != '\0' && _ptr[1] != '}') {
+          ++_ptr;
+        }
+        if (_ptr[1] == '\0') {
+          break;
+        }
+        ++_ptr;
+
+        if (_arg_index >= this->arg_count) {
+          _result.append("{?}");
+          continue;
+        }
+        const auto &_arg = this->args[_arg_index++];
+        switch (_arg.type) {
+          case arg::kind::boolean:
+            _result.append(_arg.value.u64 != 0 ? "true" : "false");
+            break;
+          case arg::kind::int64:
+            _result.append(std::to_string(_arg.value.i64));
+            break;
+          case arg::kind::uint64:
+            _result.append(std::to_string(_arg.value.u64));
+            break;
+          case arg::kind::float64:
+            _result.append(std::to_string(_arg.value.f64));
+            break;
+          case arg::kind::text:
+            _result.append(_text.substr(_arg.text_offset, _arg.text_size));
+            break;
+          default:
+            break;
+        }
+      }
+      return _result;
+    }
+
+    friend std::ostream &operator<<(std::ostream &p_os, stack const &p_trace) noexcept {
       try {
         p_os << "|tid:" << p_trace.thread_id << "|code:" << p_trace.err_code
-             << "|msg:" << p_trace.err_msg << "|src:" << p_trace.source_file
-             << "(" << p_trace.source_file_line << ")" << std::endl;
+             << "|msg:" << p_trace.message() << "|src:"
+             << (p_trace.source_file != nullptr ? p_trace.source_file : "") << "("
+             << p_trace.source_file_line << ")" << std::endl;
       } catch (...) {
       }
       return p_os;
     }
+
     std::thread::id thread_id;
     int64_t err_code = 0;
-    std::string err_msg;
-    std::string source_file;
+    // the static format of message, nullptr if the message is in text
+    const char *format = nullptr;
+    const char *source_file = nullptr;
+    const char *function_name = nullptr;
     int source_file_line = 0;
-  } W_ALIGNMENT_128;
+    uint16_t text_size = 0;
+    uint8_t arg_count = 0;
+    std::array<arg, MAX_ARGS> args = {};
+    std::array<char, MAX_TEXT_SIZE> text = {};
+  };
 
   w_trace() noexcept = default;
 
-  explicit w_trace(_In_ stack &&p_stack) noexcept {
-    try {
-      this->_stacks.emplace_front(p_stack);
-    } catch (...) {
-    }
+  explicit w_trace(_In_ stack &&p_stack) noexcept { _emplace() = p_stack; }
+
+  w_trace(_In_ int64_t p_err_code, _In_ std::string_view p_err_msg,
+          _In_ const char *p_source_file, _In_ int p_source_file_line) noexcept {
+    push(p_err_code, p_err_msg, p_source_file, p_source_file_line);
   }
 
-  w_trace(_In_ int64_t p_err_code, _In_ std::string p_err_msg,
-          _In_ const char *p_source_file,
-          _In_ int p_source_file_line) noexcept {
-    try {
-      this->_stacks.emplace_front(stack{std::this_thread::get_id(), p_err_code,
-                                        std::move(p_err_msg), p_source_file,
-                                        p_source_file_line});
-    } catch (...) {
-    }
+  w_trace(_In_ std::errc p_err_code, _In_ std::string_view p_err_msg,
+          _In_ const char *p_source_file, _In_ int p_source_file_line) noexcept {
+    push(gsl::narrow_cast<int64_t>(p_err_code), p_err_msg, p_source_file,
+         p_source_file_line);
   }
 
-  w_trace(_In_ std::errc p_err_code, _In_ std::string p_err_msg,
-          _In_ const char *p_source_file,
-          _In_ int p_source_file_line) noexcept {
-    try {
-      this->_stacks.emplace_front(stack{
-          std::this_thread::get_id(), gsl::narrow_cast<int64_t>(p_err_code),
-          std::move(p_err_msg), p_source_file, p_source_file_line});
-    } catch (...) {
-    }
+  w_trace(_In_ int64_t p_err_code, _In_ const std::source_location &p_location,
+          _In_ std::string_view p_err_msg) noexcept {
+    push(p_err_code, p_location, p_err_msg);
   }
 
-  void push(_In_ int64_t p_err_code, _In_ std::string p_err_msg,
-            _In_ const char *p_source_file,
-            _In_ int p_source_file_line) noexcept {
-    try {
-      this->_stacks.emplace_front(stack{std::this_thread::get_id(), p_err_code,
-                                        std::move(p_err_msg), p_source_file,
-                                        p_source_file_line});
-    } catch (...) {
-    }
+  w_trace(_In_ std::errc p_err_code, _In_ const std::source_location &p_location,
+          _In_ std::string_view p_err_msg) noexcept {
+    push(gsl::narrow_cast<int64_t>(p_err_code), p_location, p_err_msg);
+  }
+
+  template <typename... Args>
+    requires(sizeof...(Args) > 0 && sizeof...(Args) <= MAX_ARGS)
+  w_trace(_In_ int64_t p_err_code, _In_ const std::source_location &p_location,
+          _In_ w_trace_format p_format, _In_ const Args &...p_args) noexcept {
+    push(p_err_code, p_location, p_format, p_args...);
+  }
+
+  template <typename... Args>
+    requires(sizeof...(Args) > 0 && sizeof...(Args) <= MAX_ARGS)
+  w_trace(_In_ std::errc p_err_code, _In_ const std::source_location &p_location,
+          _In_ w_trace_format p_format, _In_ const Args &...p_args) noexcept {
+    push(gsl::narrow_cast<int64_t>(p_err_code), p_location, p_format, p_args...);
+  }
+
+  void push(_In_ int64_t p_err_code, _In_ std::string_view p_err_msg,
+            _In_ const char *p_source_file, _In_ int p_source_file_line) noexcept {
+    auto &_stack = _emplace();
+    _stack.err_code = p_err_code;
+    _stack.source_file = p_source_file;
+    _stack.source_file_line = p_source_file_line;
+    _stack.text_size = _copy_text(_stack, p_err_msg);
+  }
+
+  void push(_In_ int64_t p_err_code, _In_ const std::source_location &p_location,
+            _In_ std::string_view p_err_msg) noexcept {
+    auto &_stack = _emplace();
+    _stack.err_code = p_err_code;
+    _stack.source_file = p_location.file_name();
+    _stack.function_name = p_location.function_name();
+    _stack.source_file_line = gsl::narrow_cast<int>(p_location.line());
+    _stack.text_size = _copy_text(_stack, p_err_msg);
+  }
+
+  /*
+   * push a frame whose message is formatted when the trace is printed
+   * @param p_err_code, the error code
+   * @param p_location, the source location
+   * @param p_format, the format literal with "{}" placeholders
+   * @param p_args, the arguments, booleans, integers, enums, floating points
+   * and strings. strings are copied into the inline text of frame
+   */
+  template <typename... Args>
+    requires(sizeof...(Args) <= MAX_ARGS)
+  void push(_In_ int64_t p_err_code, _In_ const std::source_location &p_location,
+            _In_ w_trace_format p_format, _In_ const Args &...p_args) noexcept {
+    auto &_stack = _emplace();
+    _stack.err_code = p_err_code;
+    _stack.format = p_format.str;
+    _stack.source_file = p_location.file_name();
+    _stack.function_name = p_location.function_name();
+    _stack.source_file_line = gsl::narrow_cast<int>(p_location.line());
+    (_push_arg(_stack, p_args), ...);
+  }
+
+  /*
+   * get the frames, the first one is where the error was created
+   * @returns the frames
+   */
+  gsl::span<const stack> get_stacks() const noexcept {
+    return gsl::span<const stack>(this->_stacks.data(), this->_size);
   }
 
+  /*
+   * get the number of frames which were dropped because the trace was full
+   * @returns the number of dropped frames
+   */
+  size_t get_dropped() const noexcept { return this->_dropped; }
+
   std::string to_string() const noexcept {
     std::string _result;
     try {
       std::stringstream ss;
-      for (const auto &_stack : this->_stacks) {
-        ss << _stack;
-      }
+      ss << *this;
       _result = ss.str();
     } catch (...) {
     }
     return _result;
   }
 
-  friend std::ostream &operator<<(std::ostream &p_os,
-                                  w_trace const &p_trace) noexcept {
+  friend std::ostream &operator<<(std::ostream &p_os, w_trace const &p_trace) noexcept {
     try {
-      for (const auto &index : p_trace._stacks) {
-        p_os << index;
+      // the latest frame first
+      for (size_t i = p_trace._size; i > 0; --i) {
+        p_os << p_trace._stacks[i - 1];
+      }
+      if (p_trace._dropped != 0) {
+        p_os << "|dropped:" << p_trace._dropped << std::endl;
       }
     } catch (...) {
     }
@@ -102,7 +266,57 @@ class w_trace {
   }
 
  private:
-  std::deque<stack> _stacks = {};
+  stack &_emplace() noexcept {
+    if (this->_size == MAX_STACKS) {
+      // keep the origin of error, replace the latest frame
+      this->_dropped++;
+      this->_size--;
+    }
+    auto &_stack = this->_stacks[this->_size++];
+    _stack = stack{};
+    _stack.thread_id = std::this_thread::get_id();
+    return _stack;
+  }
+
+  static uint16_t _copy_text(_Inout_ stack &p_stack, _In_ std::string_view p_str) noexcept {
+    const auto _size = std::min(p_str.size(), MAX_TEXT_SIZE - p_stack.text_size);
+    std::copy_n(p_str.data(), _size, p_stack.text.data() + p_stack.text_size);
+    return gsl::narrow_cast<uint16_t>(p_stack.text_size + _size);
+  }
+
+  template <typename T>
+  static void _push_arg(_Inout_ stack &p_stack, _In_ const T &p_arg) noexcept {
+    using type = std::remove_cvref_t<T>;
+    auto &_arg = p_stack.args[p_stack.arg_count++];
+
+    if constexpr (std::is_same_v<type, bool>) {
+      _arg.type = arg::kind::boolean;
+      _arg.value.u64 = p_arg ? 1 : 0;
+    } else if constexpr (std::is_enum_v<type>) {
+      _arg.type = arg::kind::int64;
+      _arg.value.i64 = static_cast<int64_t>(p_arg);
+    } else if constexpr (std::is_integral_v<type> && std::is_signed_v<type>) {
+      _arg.type = arg::kind::int64;
+      _arg.value.i64 = p_arg;
+    } else if constexpr (std::is_integral_v<type>) {
+      _arg.type = arg::kind::uint64;
+      _arg.value.u64 = p_arg;
+    } else if constexpr (std::is_floating_point_v<type>) {
+      _arg.type = arg::kind::float64;
+      _arg.value.f64 = p_arg;
+    } else {
+      static_assert(std::is_convertible_v<const T &, std::string_view>,
+                    "the argument of w_trace must be a number, an enum or a string");
+      _arg.type = arg::kind::text;
+      _arg.text_offset = p_stack.text_size;
+      p_stack.text_size = _copy_text(p_stack, std::string_view(p_arg));
+      _arg.text_size = gsl::narrow_cast<uint16_t>(p_stack.text_size - _arg.text_offset);
+    }
+  }
+
+  std::array<stack, MAX_STACKS> _stacks = {};
+  size_t _size = 0;
+  size_t _dropped = 0;
 };
 
 template <typename T>
@@ -113,8 +327,14 @@ constexpr inline boost::leaf::result<T> W_SUCCESS(T &p_param) noexcept {
   return boost::leaf::result<T>(std::move(p_param));
 }
 
-#define W_FAILURE(p_code, p_msg) \
-  boost::leaf::new_error(w_trace(p_code, p_msg, __FILE__, __LINE__))
+/*
+ * create an error with a w_trace, the message is either a string which is
+ * copied into the trace, or a format literal followed by its arguments which
+ * is formatted only when the trace is printed, e.g.
+ * W_FAILURE(std::errc::timed_out, "could not read {} bytes", _size)
+ */
+#define W_FAILURE(p_code, ...) \
+  boost::leaf::new_error(w_trace(p_code, std::source_location::current(), __VA_ARGS__))
 
 #ifdef WIN32
 
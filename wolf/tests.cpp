@@ -39,6 +39,7 @@ BOOST_AUTO_TEST_CASE(wolf_test) {
 // #include <wolf/system/test/gamepad.hpp>
 // #include <wolf/system/test/gametime.hpp>
 // #include <wolf/system/test/log.hpp>
+// #include <wolf/system/test/pooled_buffer.hpp>
 ////#include <wolf/system/test/postgresql.hpp>
 // #include <wolf/system/test/process.hpp>
 // #include <wolf/system/test/signal_slot.hpp>